@@ -36,10 +36,35 @@
 #include <daos_task.h>
 
 #define AKEY_MAGIC_V	0xdaca55a9daca55a9
+/** magic of arrays which maintain the size index, see ARRAY_SIZE_KEY */
+#define AKEY_MAGIC_V2	0xdaca55a9daca55aa
 #define ARRAY_MD_KEY	"daos_array_metadata"
 #define CELL_SIZE	"daos_array_cell_size"
 #define CHUNK_SIZE	"daos_array_chunk_size"
 
+/**
+ * The size index of an array is made of two radix trees of 1-byte cells,
+ * stored as extents of akeys, with one level per akey:
+ * - the record tree of each chunk, ARRAY_SIZE_KEY "_r"<level> akeys of the
+ *   dkey of the chunk, indexes the records of the chunk.
+ * - the chunk tree, ARRAY_SIZE_KEY "_c"<level> akeys of dkey "0", indexes
+ *   the chunks.
+ * A write sets the cells of its last record in the record tree of its last
+ * chunk, in the same update as the data of that chunk, and the cells of that
+ * chunk in the chunk tree. The array size is found from the highest set cell
+ * of the chunk tree and then the highest set cell of the record tree of that
+ * chunk. Setting cells is idempotent, so concurrent writers never serialize
+ * and the result is the max of all of them, and being regular extents, the
+ * cells are versioned by epoch like the array data. A truncate punches the
+ * cells above the new size in both trees.
+ */
+#define ARRAY_SIZE_KEY		"daos_array_size"
+/** each cell covers 2^ARRAY_SIZE_BITS cells of the lower level */
+#define ARRAY_SIZE_BITS		6
+#define ARRAY_SIZE_FANOUT	(1 << ARRAY_SIZE_BITS)
+/** enough levels to index 64-bit indices */
+#define ARRAY_SIZE_LEVELS	((64 + ARRAY_SIZE_BITS - 1) / ARRAY_SIZE_BITS)
+
 struct dac_array {
 	/** DAOS KV object handle */
 	daos_handle_t		daos_oh;
@@ -55,13 +80,22 @@ struct dac_array {
 	unsigned int		mode;
 	/** ref count on array */
 	unsigned int		cob_ref;
-	/** protect ref count */
+	/** the array maintains the size index */
+	bool			size_index;
+	/** chunks are keyed by 8-byte integers, see array_dkey_uint64() */
+	bool			dkey_uint64;
+	/** epoch of \a size_chunks */
+	daos_epoch_t		size_epoch;
+	/** the chunk tree has a cell >= size_chunks - 1 at \a size_epoch */
+	daos_size_t		size_chunks;
+	/** last known size, to guess the path of the size index lookup */
+	daos_size_t		size_guess;
+	/** protect ref count and size hints */
 	pthread_spinlock_t	cob_lock;
 };
 
 struct md_params {
 	daos_key_t		dkey;
-	char			*dkey_str;
 	char			*akey_str;
 	daos_iod_t		iod;
 	daos_recx_t		recx;
@@ -72,7 +106,8 @@ struct md_params {
 
 struct io_params {
 	daos_key_t		dkey;
-	char			*dkey_str;
+	/** key of the chunk, see array_dkey_alloc() */
+	char			*dkey_buf;
 	char			akey_str;
 	daos_iod_t		iod;
 	daos_sg_list_t		sgl;
@@ -178,9 +213,9 @@ free_io_params_cb(tse_task_t *task, void *data)
 			free(current->sgl.sg_iovs);
 			current->sgl.sg_iovs = NULL;
 		}
-		if (current->dkey_str) {
-			free(current->dkey_str);
-			current->dkey_str = NULL;
+		if (current->dkey_buf) {
+			free(current->dkey_buf);
+			current->dkey_buf = NULL;
 		}
 
 		io_list = current->next;
@@ -190,6 +225,72 @@ free_io_params_cb(tse_task_t *task, void *data)
 	return rc;
 }
 
+/**
+ * Arrays of objects with the DAOS_OF_DKEY_UINT64 feature key each chunk by
+ * its number as an 8-byte integer. VOS then keeps the dkeys in numerical
+ * order without hashing them, so sequential chunks are neighbours in the
+ * dkey tree. Other arrays use the decimal string of the chunk number.
+ */
+static inline bool
+array_dkey_uint64(daos_obj_id_t oid)
+{
+	return daos_obj_id2feat(oid) & DAOS_OF_DKEY_UINT64;
+}
+
+/** array akeys are strings, they can't be stored under integer akeys */
+static int
+array_oid_check(daos_obj_id_t oid)
+{
+	if (daos_obj_id2feat(oid) & DAOS_OF_AKEY_UINT64) {
+		D_ERROR("Array objects can't have integer akeys\n");
+		return -DER_INVAL;
+	}
+	return 0;
+}
+
+/** dkey 0 holds the array metadata and the size index */
+static char		array_md_dkey_str[] = "0";
+static uint64_t		array_md_dkey_val;
+
+static void
+array_md_dkey_set(bool dkey_uint64, daos_key_t *dkey)
+{
+	if (dkey_uint64)
+		daos_iov_set(dkey, &array_md_dkey_val,
+			     sizeof(array_md_dkey_val));
+	else
+		daos_iov_set(dkey, array_md_dkey_str,
+			     strlen(array_md_dkey_str));
+}
+
+/**
+ * Set \a dkey to the key of chunk \a dkey_num, stored in \a dkey_buf which
+ * must be freed by the caller.
+ */
+static int
+array_dkey_alloc(struct dac_array *array, daos_size_t dkey_num,
+		 char **dkey_buf, daos_key_t *dkey)
+{
+	if (array->dkey_uint64) {
+		uint64_t *val;
+
+		val = malloc(sizeof(*val));
+		if (val == NULL)
+			return -DER_NOMEM;
+		*val = dkey_num;
+		*dkey_buf = (char *)val;
+		daos_iov_set(dkey, val, sizeof(*val));
+		return 0;
+	}
+
+	if (asprintf(dkey_buf, "%zu", dkey_num) < 0) {
+		*dkey_buf = NULL;
+		return -DER_NOMEM;
+	}
+	daos_iov_set(dkey, *dkey_buf, strlen(*dkey_buf));
+	return 0;
+}
+
 static int
 create_handle_cb(tse_task_t *task, void *data)
 {
@@ -213,6 +314,8 @@ create_handle_cb(tse_task_t *task, void *data)
 	array->mode = DAOS_OO_RW;
 	array->cell_size = args->cell_size;
 	array->chunk_size = args->chunk_size;
+	array->size_index = true;
+	array->dkey_uint64 = array_dkey_uint64(args->oid);
 	array->daos_oh = *args->oh;
 
 	*args->oh = array_ptr2hdl(array);
@@ -260,6 +363,8 @@ free_handle_cb(tse_task_t *task, void *data)
 struct dac_array_glob {
 	uint32_t	magic;
 	uint32_t	mode;
+	uint32_t	size_index;
+	uint32_t	pad;
 	daos_obj_id_t	oid;
 	daos_size_t	cell_size;
 	daos_size_t	chunk_size;
@@ -280,6 +385,7 @@ swap_array_glob(struct dac_array_glob *array_glob)
 
 	D_SWAP32S(&array_glob->magic);
 	D_SWAP32S(&array_glob->mode);
+	D_SWAP32S(&array_glob->size_index);
 	D_SWAP64S(&array_glob->cell_size);
 	D_SWAP64S(&array_glob->chunk_size);
 	D_SWAP64S(&array_glob->oid.hi);
@@ -330,6 +436,8 @@ dac_array_l2g(daos_handle_t oh, daos_iov_t *glob)
 	array_glob->cell_size	= array->cell_size;
 	array_glob->chunk_size	= array->chunk_size;
 	array_glob->mode	= array->mode;
+	array_glob->size_index	= array->size_index;
+	array_glob->pad		= 0;
 	array_glob->oid.hi	= array->oid.hi;
 	array_glob->oid.lo	= array->oid.lo;
 	uuid_copy(array_glob->coh_uuid, coh_uuid);
@@ -413,6 +521,8 @@ dac_array_g2l(daos_handle_t coh, struct dac_array_glob *array_glob,
 	array->oid.hi = array_glob->oid.hi;
 	array->oid.lo = array_glob->oid.lo;
 	array->mode = array_glob->mode;
+	array->size_index = array_glob->size_index;
+	array->dkey_uint64 = array_dkey_uint64(array_glob->oid);
 	*oh = array_ptr2hdl(array);
 
 out_array:
@@ -485,11 +595,10 @@ write_md_cb(tse_task_t *task, void *data)
 	}
 
 	/** write metadata to DKEY 0 */
-	params->dkey_str = "0";
-	daos_iov_set(&params->dkey, params->dkey_str, strlen(params->dkey_str));
+	array_md_dkey_set(array_dkey_uint64(args->oid), &params->dkey);
 
 	/** set SGL */
-	params->magic_val = AKEY_MAGIC_V;
+	params->magic_val = AKEY_MAGIC_V2;
 	daos_iov_set(&params->sg_iovs[0], &params->magic_val, sizeof(uint64_t));
 	daos_iov_set(&params->sg_iovs[1], &args->cell_size,
 		     sizeof(daos_size_t));
@@ -538,6 +647,12 @@ dac_array_create(tse_task_t *task)
 	daos_obj_open_t		*open_args;
 	int			rc;
 
+	rc = array_oid_check(args->oid);
+	if (rc != 0) {
+		tse_task_complete(task, rc);
+		return rc;
+	}
+
 	/** Create task to open object */
 	rc = daos_task_create(DAOS_OPC_OBJ_OPEN, tse_task2sched(task),
 			      0, NULL, &open_task);
@@ -612,7 +727,7 @@ open_handle_cb(tse_task_t *task, void *data)
 	/** Check magic value */
 	magic_val = daos_task_get_priv(task);
 	D_ASSERT(magic_val != NULL);
-	if (*magic_val != AKEY_MAGIC_V) {
+	if (*magic_val != AKEY_MAGIC_V && *magic_val != AKEY_MAGIC_V2) {
 		D_FREE(magic_val);
 		D_ERROR("DAOS Object is not an array object\n");
 		D_GOTO(err_obj, rc = -DER_NO_PERM);
@@ -635,6 +750,8 @@ open_handle_cb(tse_task_t *task, void *data)
 	array->mode = args->mode;
 	array->cell_size = *args->cell_size;
 	array->chunk_size = *args->chunk_size;
+	array->size_index = (*magic_val == AKEY_MAGIC_V2);
+	array->dkey_uint64 = array_dkey_uint64(args->oid);
 	array->daos_oh = *args->oh;
 
 	*args->oh = array_ptr2hdl(array);
@@ -676,8 +793,7 @@ fetch_md_cb(tse_task_t *task, void *data)
 	}
 
 	/** read metadata from DKEY 0 */
-	params->dkey_str = "0";
-	daos_iov_set(&params->dkey, params->dkey_str, strlen(params->dkey_str));
+	array_md_dkey_set(array_dkey_uint64(args->oid), &params->dkey);
 
 	/** set SGL */
 	magic_val = daos_task_get_priv(task);
@@ -730,6 +846,12 @@ dac_array_open(tse_task_t *task)
 	uint64_t		*magic_val;
 	int			rc;
 
+	rc = array_oid_check(args->oid);
+	if (rc != 0) {
+		tse_task_complete(task, rc);
+		return rc;
+	}
+
 	/** Create task to open object */
 	rc = daos_task_create(DAOS_OPC_OBJ_OPEN, tse_task2sched(task),
 			      0, NULL, &open_task);
@@ -926,37 +1048,25 @@ io_extent_same(daos_array_iod_t *iod, daos_sg_list_t *sgl,
 }
 
 /*
- * Compute the dkey given the array index for this range. Also compute: - the
- * number of records that the dkey can hold starting at the index where we start
- * writing. - the record index relative to the dkey.
+ * Compute the dkey number given the array index for this range. Also compute:
+ * - the number of records that the dkey can hold starting at the index where
+ * we start writing. - the record index relative to the dkey.
  */
-static int
+static void
 compute_dkey(struct dac_array *array, daos_off_t array_idx,
-	     daos_size_t *num_records, daos_off_t *record_i, char **dkey_str)
+	     daos_size_t *num_records, daos_off_t *record_i,
+	     daos_size_t *dkey_num)
 {
-	daos_size_t	dkey_num;	/* dkey number */
 	daos_off_t	dkey_i;		/* Logical Start IDX of dkey_num */
 
 	/* Compute dkey number and starting index relative to the array */
-	dkey_num = array_idx / array->chunk_size;
-	dkey_i = dkey_num * array->chunk_size;
+	*dkey_num = array_idx / array->chunk_size;
+	dkey_i = *dkey_num * array->chunk_size;
 
 	if (record_i)
 		*record_i = array_idx - dkey_i;
 	if (num_records)
 		*num_records = array->chunk_size - *record_i;
-
-	if (dkey_str) {
-		int ret;
-
-		ret = asprintf(dkey_str, "%zu", dkey_num);
-		if (ret < 0 || *dkey_str == NULL) {
-			D_ERROR("Failed memory allocation\n");
-			return -DER_NOMEM;
-		}
-	}
-
-	return 0;
 }
 
 static int
@@ -1018,6 +1128,342 @@ create_sgl(daos_sg_list_t *user_sgl, daos_size_t cell_size,
 	return 0;
 }
 
+/** akeys of the levels of the chunk tree, in dkey "0" */
+static const char	*size_ckeys[ARRAY_SIZE_LEVELS] = {
+	ARRAY_SIZE_KEY "_c0", ARRAY_SIZE_KEY "_c1", ARRAY_SIZE_KEY "_c2",
+	ARRAY_SIZE_KEY "_c3", ARRAY_SIZE_KEY "_c4", ARRAY_SIZE_KEY "_c5",
+	ARRAY_SIZE_KEY "_c6", ARRAY_SIZE_KEY "_c7", ARRAY_SIZE_KEY "_c8",
+	ARRAY_SIZE_KEY "_c9", ARRAY_SIZE_KEY "_c10",
+};
+
+/** akeys of the levels of the record tree, in the dkey of each chunk */
+static const char	*size_rkeys[ARRAY_SIZE_LEVELS] = {
+	ARRAY_SIZE_KEY "_r0", ARRAY_SIZE_KEY "_r1", ARRAY_SIZE_KEY "_r2",
+	ARRAY_SIZE_KEY "_r3", ARRAY_SIZE_KEY "_r4", ARRAY_SIZE_KEY "_r5",
+	ARRAY_SIZE_KEY "_r6", ARRAY_SIZE_KEY "_r7", ARRAY_SIZE_KEY "_r8",
+	ARRAY_SIZE_KEY "_r9", ARRAY_SIZE_KEY "_r10",
+};
+
+struct size_params {
+	struct dac_array	*array;
+	daos_epoch_t		epoch;
+	daos_size_t		size;
+	/** the update sets or punches the cells of the chunk tree */
+	bool			chunks;
+	bool			punch;
+	/** value of all the set cells */
+	uint8_t			cell;
+	daos_key_t		dkey;
+	char			*dkey_buf;
+	/** room for the data of a write and the cells of both trees */
+	daos_iod_t		iods[2 * ARRAY_SIZE_LEVELS + 1];
+	daos_recx_t		recxs[2 * ARRAY_SIZE_LEVELS + 1];
+	daos_sg_list_t		sgls[2 * ARRAY_SIZE_LEVELS + 1];
+	daos_iov_t		iovs[2 * ARRAY_SIZE_LEVELS + 1];
+};
+
+/** index of the cell covering \a idx at \a level of a size index tree */
+static inline daos_off_t
+size_cell(daos_off_t idx, int level)
+{
+	return idx >> (level * ARRAY_SIZE_BITS);
+}
+
+/** number of levels of a size index tree indexing [0, \a max] */
+static inline int
+size_levels(daos_size_t max)
+{
+	int	bits = max == 0 ? 0 : 64 - __builtin_clzll(max);
+
+	if (bits <= ARRAY_SIZE_BITS)
+		return 1;
+	return (bits + ARRAY_SIZE_BITS - 1) / ARRAY_SIZE_BITS;
+}
+
+static inline int
+size_chunk_levels(struct dac_array *array)
+{
+	return size_levels(UINT64_MAX / array->chunk_size);
+}
+
+static inline int
+size_rec_levels(struct dac_array *array)
+{
+	return size_levels(array->chunk_size - 1);
+}
+
+/** number of cells to keep in the chunk tree for an array of \a size */
+static inline daos_size_t
+size_chunk_nr(struct dac_array *array, daos_size_t size)
+{
+	return size == 0 ? 0 : (size - 1) / array->chunk_size + 1;
+}
+
+/** number of cells to keep in the record tree of the last chunk */
+static inline daos_size_t
+size_rec_nr(struct dac_array *array, daos_size_t size)
+{
+	return size == 0 ? 0 : (size - 1) % array->chunk_size + 1;
+}
+
+static void
+size_iod_set(daos_iod_t *iod, daos_recx_t *recx, const char *akey,
+	     daos_off_t idx, daos_size_t nr, daos_size_t size)
+{
+	daos_iov_set(&iod->iod_name, (void *)akey, strlen(akey));
+	daos_csum_set(&iod->iod_kcsum, NULL, 0);
+	recx->rx_idx	= idx;
+	recx->rx_nr	= nr;
+	iod->iod_nr	= 1;
+	iod->iod_size	= size;
+	iod->iod_recxs	= recx;
+	iod->iod_eprs	= NULL;
+	iod->iod_csums	= NULL;
+	iod->iod_type	= DAOS_IOD_ARRAY;
+}
+
+/**
+ * Set the iods from \a first to set the cells of index \a nr - 1 at all the
+ * levels of a tree, or to punch all the cells above them if \a punch is true.
+ * Return the index of the next iod.
+ */
+static int
+size_cells_set(struct size_params *params, int first, const char **akeys,
+	       int nr_levels, daos_size_t nr, bool punch)
+{
+	int	i;
+
+	for (i = 0; i < nr_levels; i++) {
+		daos_iod_t	*iod = &params->iods[first + i];
+		daos_recx_t	*recx = &params->recxs[first + i];
+		daos_off_t	 idx;
+
+		if (punch) {
+			idx = nr == 0 ? 0 : size_cell(nr - 1, i) + 1;
+			size_iod_set(iod, recx, akeys[i], idx, UINT64_MAX - idx,
+				     0 /* punch */);
+			continue;
+		}
+
+		size_iod_set(iod, recx, akeys[i], size_cell(nr - 1, i), 1,
+			     sizeof(params->cell));
+		daos_iov_set(&params->iovs[first + i], &params->cell,
+			     sizeof(params->cell));
+		params->sgls[first + i].sg_nr = 1;
+		params->sgls[first + i].sg_nr_out = 0;
+		params->sgls[first + i].sg_iovs = &params->iovs[first + i];
+	}
+
+	return first + nr_levels;
+}
+
+/**
+ * Check if the chunk tree is known to have a cell of \a chunk or above at
+ * \a epoch, so a write ending in \a chunk has no need to set it. Only the
+ * epoch of the last update of this handle is tracked, a truncate through
+ * another handle in another epoch might have punched the cells of any older
+ * one.
+ */
+static bool
+size_chunk_known(struct dac_array *array, daos_epoch_t epoch,
+		 daos_size_t chunk)
+{
+	bool	known;
+
+	D_SPIN_LOCK(&array->cob_lock);
+	known = array->size_epoch == epoch && chunk < array->size_chunks;
+	D_SPIN_UNLOCK(&array->cob_lock);
+
+	return known;
+}
+
+static int
+size_update_cb(tse_task_t *task, void *data)
+{
+	struct size_params	*params = *((struct size_params **)data);
+	struct dac_array	*array = params->array;
+	daos_size_t		 chunks;
+	int			 rc = task->dt_result;
+
+	if (rc == 0) {
+		chunks = size_chunk_nr(array, params->size);
+
+		D_SPIN_LOCK(&array->cob_lock);
+		if (!params->chunks) {
+			/** nothing known about the chunk tree */
+		} else if (array->size_epoch == params->epoch) {
+			if (params->punch || array->size_chunks < chunks)
+				array->size_chunks = chunks;
+		} else if (!params->punch ||
+			   array->size_epoch < params->epoch) {
+			/** a punch in an older epoch is hidden by the cells */
+			array->size_epoch = params->epoch;
+			array->size_chunks = chunks;
+		}
+		if (params->punch || array->size_guess < params->size)
+			array->size_guess = params->size;
+		D_SPIN_UNLOCK(&array->cob_lock);
+	}
+
+	if (params->dkey_buf)
+		free(params->dkey_buf);
+	array_decref(array);
+	D_FREE_PTR(params);
+	return rc;
+}
+
+static struct size_params *
+size_params_alloc(struct dac_array *array, daos_epoch_t epoch,
+		  daos_size_t size, bool chunks, bool punch)
+{
+	struct size_params	*params;
+
+	D_ALLOC_PTR(params);
+	if (params == NULL) {
+		D_ERROR("Failed memory allocation\n");
+		return NULL;
+	}
+
+	array_addref(array);
+	params->array = array;
+	params->epoch = epoch;
+	params->size = size;
+	params->chunks = chunks;
+	params->punch = punch;
+	params->cell = 1;
+	return params;
+}
+
+/**
+ * Add the cells of the last record of a write ending at \a size to
+ * \a io_task, the update of the data of its last chunk, and the cells of
+ * that chunk if \a chunks is true, which requires the chunk to be in dkey
+ * "0" with the chunk tree.
+ */
+static int
+size_update_add(struct dac_array *array, daos_epoch_t epoch, daos_size_t size,
+		bool chunks, tse_task_t *io_task)
+{
+	daos_obj_update_t	*io_arg = daos_task_get_args(io_task);
+	struct size_params	*params;
+	int			 nr;
+	int			 rc;
+
+	D_ASSERT(io_arg->nr == 1);
+	D_ASSERT(!chunks || size_chunk_nr(array, size) == 1);
+
+	params = size_params_alloc(array, epoch, size, chunks, false);
+	if (params == NULL)
+		return -DER_NOMEM;
+
+	params->iods[0] = io_arg->iods[0];
+	params->sgls[0] = io_arg->sgls[0];
+	nr = size_cells_set(params, 1, size_rkeys, size_rec_levels(array),
+			    size_rec_nr(array, size), false);
+	if (chunks)
+		nr = size_cells_set(params, nr, size_ckeys,
+				    size_chunk_levels(array), 1, false);
+
+	rc = tse_task_register_comp_cb(io_task, size_update_cb, &params,
+				       sizeof(params));
+	if (rc) {
+		array_decref(array);
+		D_FREE_PTR(params);
+		return rc;
+	}
+
+	io_arg->nr	= nr;
+	io_arg->iods	= params->iods;
+	io_arg->sgls	= params->sgls;
+	return 0;
+}
+
+/**
+ * Set the cells of the last record of an array of \a size in the chunk tree
+ * if \a chunks is true or in the record tree of the last chunk otherwise, or
+ * punch all the cells above them if \a punch is true. The update task is
+ * added as a dependency of \a task, and runs after \a dep if it's not NULL.
+ */
+static int
+size_update(struct dac_array *array, daos_epoch_t epoch, daos_size_t size,
+	    bool chunks, bool punch, tse_task_t *dep, tse_task_t *task,
+	    tse_task_t **taskp)
+{
+	struct size_params	*params;
+	daos_obj_update_t	*io_arg;
+	tse_task_t		*io_task = NULL;
+	int			 nr;
+	int			 rc;
+
+	D_ASSERT(punch || size > 0);
+
+	params = size_params_alloc(array, epoch, size, chunks, punch);
+	if (params == NULL)
+		return -DER_NOMEM;
+
+	if (chunks) {
+		array_md_dkey_set(array->dkey_uint64, &params->dkey);
+		nr = size_cells_set(params, 0, size_ckeys,
+				    size_chunk_levels(array),
+				    size_chunk_nr(array, size), punch);
+	} else {
+		rc = array_dkey_alloc(array, size == 0 ? 0 :
+				      (size - 1) / array->chunk_size,
+				      &params->dkey_buf, &params->dkey);
+		if (rc) {
+			array_decref(array);
+			D_FREE_PTR(params);
+			return rc;
+		}
+		nr = size_cells_set(params, 0, size_rkeys,
+				    size_rec_levels(array),
+				    size_rec_nr(array, size), punch);
+	}
+
+	rc = daos_task_create(DAOS_OPC_OBJ_UPDATE, tse_task2sched(task),
+			      dep == NULL ? 0 : 1, dep == NULL ? NULL : &dep,
+			      &io_task);
+	if (rc) {
+		D_ERROR("Task create failed (%d)\n", rc);
+		if (params->dkey_buf)
+			free(params->dkey_buf);
+		array_decref(array);
+		D_FREE_PTR(params);
+		return rc;
+	}
+
+	io_arg = daos_task_get_args(io_task);
+	io_arg->oh	= array->daos_oh;
+	io_arg->epoch	= epoch;
+	io_arg->dkey	= &params->dkey;
+	io_arg->nr	= nr;
+	io_arg->iods	= params->iods;
+	io_arg->sgls	= punch ? NULL : params->sgls;
+
+	rc = tse_task_register_comp_cb(io_task, size_update_cb, &params,
+				       sizeof(params));
+	if (rc) {
+		if (params->dkey_buf)
+			free(params->dkey_buf);
+		array_decref(array);
+		D_FREE_PTR(params);
+		D_GOTO(err, rc);
+	}
+
+	/* params are released by size_update_cb() from now on */
+	rc = tse_task_register_deps(task, 1, &io_task);
+	if (rc)
+		D_GOTO(err, rc);
+
+	tse_task_schedule(io_task, false);
+	if (taskp)
+		*taskp = io_task;
+	return 0;
+err:
+	tse_task_complete(io_task, rc);
+	return rc;
+}
+
 static int
 dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 	     daos_array_iod_t *rg_iod, daos_sg_list_t *user_sgl,
@@ -1035,6 +1481,10 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 	daos_csum_buf_t	null_csum;
 	struct io_params *head, *current;
 	daos_size_t	num_ios;
+	daos_size_t	size_end = 0; /* end of a write, for the size index */
+	daos_size_t	size_chunk = 0; /* last chunk of a write */
+	bool		size_chunks = false; /* set size_chunk in chunk tree */
+	bool		size_added = false;
 	int		rc;
 
 	if (rg_iod == NULL) {
@@ -1058,6 +1508,23 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 
 	oh = array->daos_oh;
 
+	/** the size index is set with the data of the last chunk written */
+	if (op_type == DAOS_OPC_ARRAY_WRITE && array->size_index) {
+		for (u = 0; u < rg_iod->arr_nr; u++) {
+			daos_range_t	*rg = &rg_iod->arr_rgs[u];
+
+			if (rg->rg_len != 0 &&
+			    size_end < rg->rg_idx + rg->rg_len)
+				size_end = rg->rg_idx + rg->rg_len;
+		}
+
+		if (size_end != 0) {
+			size_chunk = (size_end - 1) / array->chunk_size;
+			size_chunks = !size_chunk_known(array, epoch,
+							size_chunk);
+		}
+	}
+
 	cur_off = 0;
 	cur_i = 0;
 	u = 0;
@@ -1077,7 +1544,7 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 	while (u < rg_iod->arr_nr) {
 		daos_iod_t	*iod;
 		daos_sg_list_t	*sgl;
-		char		*dkey_str;
+		daos_size_t	dkey_num;
 		daos_key_t	*dkey;
 		daos_size_t	dkey_records;
 		tse_task_t	*io_task = NULL;
@@ -1123,21 +1590,19 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 
 		num_ios++;
 
-		rc = compute_dkey(array, array_idx, &num_records, &record_i,
-				  &params->dkey_str);
+		compute_dkey(array, array_idx, &num_records, &record_i,
+			     &dkey_num);
+		rc = array_dkey_alloc(array, dkey_num, &params->dkey_buf, dkey);
 		if (rc != 0) {
 			D_ERROR("Failed to compute dkey\n");
 			D_GOTO(err_task, rc);
 		}
-		dkey_str = params->dkey_str;
 
-		D_DEBUG(DB_IO, "DKEY IOD %s ---------------------------\n",
-			dkey_str);
+		D_DEBUG(DB_IO, "DKEY IOD %zu ---------------------------\n",
+			dkey_num);
 		D_DEBUG(DB_IO, "idx = %d\t num_records = %zu\t record_i = %d\n",
 			(int)array_idx, num_records, (int)record_i);
 
-		daos_iov_set(dkey, (void *)dkey_str, strlen(dkey_str));
-
 		/* set descriptor for KV object */
 		daos_iov_set(&iod->iod_name, &params->akey_str, 1);
 		iod->iod_kcsum = null_csum;
@@ -1220,7 +1685,7 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 			if (array_idx < old_array_idx + num_records &&
 			    array_idx >= ((old_array_idx + num_records) -
 					  array->chunk_size)) {
-				char	*dkey_str_tmp = NULL;
+				daos_size_t	dkey_num_tmp;
 
 				/*
 				 * verify that the dkey is the same as the one
@@ -1228,25 +1693,16 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 				 * also compute the number of records left in
 				 * the dkey and the record indexin the dkey.
 				 */
-				rc = compute_dkey(array, array_idx,
-						  &num_records, &record_i,
-						  &dkey_str_tmp);
-				if (rc != 0) {
-					D_ERROR("Failed to compute dkey\n");
-					D_GOTO(err_task, rc);
-				}
-
-				D_ASSERT(strcmp(dkey_str_tmp, dkey_str) == 0);
-
-				free(dkey_str_tmp);
-				dkey_str_tmp = NULL;
+				compute_dkey(array, array_idx, &num_records,
+					     &record_i, &dkey_num_tmp);
+				D_ASSERT(dkey_num_tmp == dkey_num);
 			} else {
 				break;
 			}
 		} while (1);
 
-		D_DEBUG(DB_IO, "END DKEY IOD %s ---------------------------\n",
-			dkey_str);
+		D_DEBUG(DB_IO, "END DKEY IOD %zu ---------------------------\n",
+			dkey_num);
 
 		/*
 		 * if the user sgl maps directly to the array range, no need to
@@ -1288,8 +1744,8 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 					      tse_task2sched(task),
 					      0, NULL, &io_task);
 			if (rc != 0) {
-				D_ERROR("KV Fetch of dkey %s failed (%d)\n",
-					dkey_str, rc);
+				D_ERROR("KV Fetch of dkey %zu failed (%d)\n",
+					dkey_num, rc);
 				D_GOTO(err_task, rc);
 			}
 			io_arg = daos_task_get_args(io_task);
@@ -1308,8 +1764,8 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 					      tse_task2sched(task),
 					      0, NULL, &io_task);
 			if (rc != 0) {
-				D_ERROR("KV Update of dkey %s failed (%d)\n",
-					dkey_str, rc);
+				D_ERROR("KV Update of dkey %zu failed (%d)\n",
+					dkey_num, rc);
 				D_GOTO(err_task, rc);
 			}
 			io_arg = daos_task_get_args(io_task);
@@ -1319,6 +1775,21 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 			io_arg->nr	= 1;
 			io_arg->iods	= iod;
 			io_arg->sgls	= sgl;
+
+			/** once if several ranges end in the last chunk */
+			if (size_end != 0 && !size_added &&
+			    dkey_num == size_chunk) {
+				rc = size_update_add(array, epoch, size_end,
+						     size_chunks &&
+						     size_chunk == 0, io_task);
+				if (rc != 0) {
+					D_ERROR("Failed to update array size "
+						"(%d)\n", rc);
+					tse_task_complete(io_task, rc);
+					D_GOTO(err_task, rc);
+				}
+				size_added = true;
+			}
 		} else {
 			D_ASSERTF(0, "Invalid array operation.\n");
 		}
@@ -1327,6 +1798,16 @@ dac_array_io(daos_handle_t array_oh, daos_epoch_t epoch,
 		tse_task_schedule(io_task, false);
 	} /* end while */
 
+	/** the cells of chunk 0 are set with its data by size_update_add() */
+	if (size_chunks && size_chunk != 0) {
+		rc = size_update(array, epoch, size_end, true, false, NULL,
+				 task, NULL);
+		if (rc != 0) {
+			D_ERROR("Failed to update array size (%d)\n", rc);
+			D_GOTO(err_task, rc);
+		}
+	}
+
 	array_decref(array);
 	tse_sched_progress(tse_task2sched(task));
 	return 0;
@@ -1369,9 +1850,38 @@ dac_array_punch(tse_task_t *task)
 #define ENUM_DESC_BUF	512
 #define ENUM_DESC_NR	5
 
+/**
+ * Convert an enumerated dkey back to its chunk number, fails for the keys
+ * that are not array chunks.
+ */
+static int
+array_dkey2num(struct dac_array *array, const char *key, daos_size_t key_len,
+	       daos_size_t *dkey_num)
+{
+	char	key_str[ENUM_KEY_BUF];
+
+	if (array->dkey_uint64) {
+		uint64_t val;
+
+		if (key_len != sizeof(val))
+			return -DER_INVAL;
+		memcpy(&val, key, sizeof(val));
+		*dkey_num = val;
+		return 0;
+	}
+
+	if (key_len == 0 || key_len >= ENUM_KEY_BUF)
+		return -DER_INVAL;
+	memcpy(key_str, key, key_len);
+	key_str[key_len] = '\0';
+
+	if (sscanf(key_str, "%zu", dkey_num) != 1)
+		return -DER_INVAL;
+	return 0;
+}
+
 struct get_size_props {
 	struct dac_array	*array;
-	char			key[ENUM_DESC_BUF];
 	char			buf[ENUM_DESC_BUF];
 	daos_key_desc_t		kds[ENUM_DESC_NR];
 	daos_iov_t		iov;
@@ -1386,7 +1896,8 @@ struct get_size_props {
 
 struct list_recxs_params {
 	daos_key_t		dkey;
-	char			*dkey_str;
+	char			*dkey_buf;
+	daos_size_t		dkey_num;
 	daos_key_t		akey;
 	char			akey_str;
 	daos_recx_t		recx;
@@ -1414,14 +1925,10 @@ list_recxs_cb(tse_task_t *task, void *data)
 {
 	daos_obj_list_recx_t *args = daos_task_get_args(task);
 	struct list_recxs_params *params = *((struct list_recxs_params **)data);
-	daos_size_t dkey_num;
-	int ret;
 	int rc = task->dt_result;
 	daos_size_t cur_size;
 
-	ret = sscanf(params->dkey_str, "%zu", &dkey_num);
-	D_ASSERT(ret == 1);
-	cur_size = dkey_num * params->chunk_size + params->recx.rx_idx +
+	cur_size = params->dkey_num * params->chunk_size + params->recx.rx_idx +
 		params->recx.rx_nr;
 	if (*params->size < cur_size)
 		*params->size = cur_size;
@@ -1446,9 +1953,9 @@ list_recxs_cb(tse_task_t *task, void *data)
 	}
 
 out:
-	if (params->dkey_str) {
-		free(params->dkey_str);
-		params->dkey_str = NULL;
+	if (params->dkey_buf) {
+		free(params->dkey_buf);
+		params->dkey_buf = NULL;
 	}
 	D_FREE_PTR(params);
 
@@ -1473,19 +1980,17 @@ get_array_size_cb(tse_task_t *task, void *data)
 	/** track the highest dkey from the ones currently enumerated */
 	for (ptr = props->buf, i = 0; i < props->nr; i++) {
 		daos_size_t dkey_num;
-		int ret;
 
-		snprintf(props->key, args->kds[i].kd_key_len + 1, "%s", ptr);
+		rc = array_dkey2num(array, ptr, args->kds[i].kd_key_len,
+				    &dkey_num);
 		ptr += args->kds[i].kd_key_len;
-
-		if (!strcmp(ARRAY_MD_KEY, props->key))
+		if (rc != 0) {
+			rc = 0;
 			continue;
+		}
 
 		props->found_dkey = true;
 		/** Keep a record of the highest dkey */
-		ret = sscanf(props->key, "%zu", &dkey_num);
-		D_ASSERT(ret == 1);
-
 		if (dkey_num > props->dkey_num)
 			props->dkey_num = dkey_num;
 	}
@@ -1517,10 +2022,6 @@ get_array_size_cb(tse_task_t *task, void *data)
 	if (!props->found_dkey)
 		return 0;
 
-	char key[ENUM_KEY_BUF];
-
-	sprintf(key, "%zu", props->dkey_num);
-
 	/** retrieve the highest index from the highest key */
 	props->nr = ENUM_DESC_NR;
 
@@ -1539,10 +2040,10 @@ get_array_size_cb(tse_task_t *task, void *data)
 	dkey = &params->dkey;
 
 	params->akey_str = '0';
-	params->dkey_str = strdup(key);
-	if (params->dkey_str == NULL)
-		D_GOTO(err, rc = -DER_NOMEM);
-	daos_iov_set(dkey, (void *)params->dkey_str, strlen(params->dkey_str));
+	params->dkey_num = props->dkey_num;
+	rc = array_dkey_alloc(array, props->dkey_num, &params->dkey_buf, dkey);
+	if (rc != 0)
+		D_GOTO(err, rc);
 	daos_iov_set(akey, &params->akey_str, 1);
 	params->nr = 1;
 	params->chunk_size = array->chunk_size;
@@ -1583,14 +2084,383 @@ get_array_size_cb(tse_task_t *task, void *data)
 	return rc;
 
 err:
-	if (params->dkey_str)
-		free(params->dkey_str);
+	if (params->dkey_buf)
+		free(params->dkey_buf);
 	if (io_task)
 		tse_task_complete(io_task, rc);
 	D_FREE_PTR(params);
 	return rc;
 }
 
+/** lookup of the highest set cell of a tree of the size index */
+struct size_lookup {
+	/** akeys of the levels of the tree, size_ckeys or size_rkeys */
+	const char		**akeys;
+	int			nr_levels;
+	/** highest level to resolve by the current fetch */
+	int			level;
+	/** the tree has no set cell */
+	bool			empty;
+	/** first cell of the fetched group of each level */
+	daos_off_t		base[ARRAY_SIZE_LEVELS];
+	/** highest set cell of each resolved level */
+	daos_off_t		high[ARRAY_SIZE_LEVELS];
+	daos_key_t		dkey;
+	char			*dkey_buf;
+	daos_iod_t		iods[ARRAY_SIZE_LEVELS];
+	daos_recx_t		recxs[ARRAY_SIZE_LEVELS];
+	daos_sg_list_t		sgls[ARRAY_SIZE_LEVELS];
+	daos_iov_t		iovs[ARRAY_SIZE_LEVELS];
+	uint8_t			cells[ARRAY_SIZE_LEVELS][ARRAY_SIZE_FANOUT];
+};
+
+struct get_size_md_props {
+	struct dac_array	*array;
+	daos_epoch_t		epoch;
+	daos_size_t		*size;
+	/** chunk of the last known size */
+	daos_size_t		guess;
+	struct size_lookup	chunks;
+	/** record trees of the guessed chunk and of the last chunk */
+	struct size_lookup	recs[2];
+};
+
+static int
+free_get_size_md_cb(tse_task_t *task, void *data)
+{
+	struct get_size_md_props *props =
+		*((struct get_size_md_props **)data);
+	struct dac_array	*array = props->array;
+	struct size_lookup	*lookup;
+	daos_size_t		 chunk;
+	int			 i;
+	int			 rc = task->dt_result;
+
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	if (props->chunks.empty) {
+		*props->size = 0;
+		D_GOTO(out, rc);
+	}
+
+	chunk = props->chunks.high[0];
+	lookup = &props->recs[chunk == props->guess ? 0 : 1];
+	if (lookup->empty) {
+		D_ERROR("No record in chunk "DF_U64"\n", chunk);
+		D_GOTO(out, rc = -DER_IO);
+	}
+	*props->size = chunk * array->chunk_size + lookup->high[0] + 1;
+
+	D_SPIN_LOCK(&array->cob_lock);
+	array->size_guess = *props->size;
+	if (array->size_epoch != props->epoch) {
+		array->size_epoch = props->epoch;
+		array->size_chunks = chunk + 1;
+	} else if (array->size_chunks < chunk + 1) {
+		array->size_chunks = chunk + 1;
+	}
+	D_SPIN_UNLOCK(&array->cob_lock);
+out:
+	for (i = 0; i < 2; i++) {
+		if (props->recs[i].dkey_buf)
+			free(props->recs[i].dkey_buf);
+	}
+	array_decref(array);
+	D_FREE_PTR(props);
+	return rc;
+}
+
+/** start a lookup along the path of cell \a guess */
+static void
+size_lookup_init(struct size_lookup *lookup, const char **akeys,
+		 int nr_levels, daos_off_t guess)
+{
+	int	i;
+
+	lookup->akeys = akeys;
+	lookup->nr_levels = nr_levels;
+	lookup->level = nr_levels - 1;
+	lookup->empty = false;
+	for (i = 0; i < nr_levels; i++)
+		lookup->base[i] = size_cell(guess, i) &
+				  ~((daos_off_t)ARRAY_SIZE_FANOUT - 1);
+}
+
+/** set the fetch of the cell groups of levels [0, lookup->level] */
+static void
+size_fetch_set(struct size_lookup *lookup, daos_obj_fetch_t *args)
+{
+	int	i;
+
+	for (i = 0; i <= lookup->level; i++) {
+		/** holes are not copied, unset cells stay 0 */
+		memset(lookup->cells[i], 0, ARRAY_SIZE_FANOUT);
+		size_iod_set(&lookup->iods[i], &lookup->recxs[i],
+			     lookup->akeys[i], lookup->base[i],
+			     ARRAY_SIZE_FANOUT, sizeof(lookup->cells[i][0]));
+		daos_iov_set(&lookup->iovs[i], lookup->cells[i],
+			     ARRAY_SIZE_FANOUT);
+		lookup->sgls[i].sg_nr = 1;
+		lookup->sgls[i].sg_nr_out = 0;
+		lookup->sgls[i].sg_iovs = &lookup->iovs[i];
+	}
+
+	args->dkey	= &lookup->dkey;
+	args->nr	= lookup->level + 1;
+	args->iods	= lookup->iods;
+	args->sgls	= lookup->sgls;
+}
+
+/**
+ * Look up the highest set cell from the top level down. The groups of the
+ * lower levels are fetched together with the top level along the path of the
+ * guess, so it takes a single fetch unless the highest cell is in another
+ * group, then 1 is returned after setting the fetch of the mismatched levels.
+ */
+static int
+size_lookup_resolve(struct size_lookup *lookup, daos_obj_fetch_t *args)
+{
+	int	level;
+	int	i;
+
+	for (level = lookup->level; level >= 0; level--) {
+		daos_off_t	base;
+
+		base = level == lookup->nr_levels - 1 ? 0 :
+		       lookup->high[level + 1] << ARRAY_SIZE_BITS;
+		if (base != lookup->base[level])
+			break;
+
+		for (i = ARRAY_SIZE_FANOUT - 1; i >= 0; i--) {
+			if (lookup->cells[level][i] != 0)
+				break;
+		}
+
+		if (i < 0) {
+			if (level == lookup->nr_levels - 1) {
+				lookup->empty = true;
+				return 0;
+			}
+			D_ERROR("No cell under "DF_U64" at level %d\n",
+				lookup->high[level + 1], level + 1);
+			return -DER_IO;
+		}
+		lookup->high[level] = base + i;
+	}
+
+	if (level < 0)
+		return 0;
+
+	/** wrong guess, fetch the right group of this level */
+	lookup->level = level;
+	lookup->base[level] = lookup->high[level + 1] << ARRAY_SIZE_BITS;
+	size_fetch_set(lookup, args);
+	return 1;
+}
+
+static int
+get_size_rec_cb(tse_task_t *task, void *data)
+{
+	daos_obj_fetch_t	*args = daos_task_get_args(task);
+	struct size_lookup	*lookup = *((struct size_lookup **)data);
+	int			 rc = task->dt_result;
+
+	if (rc != 0) {
+		D_ERROR("Array size index fetch failed (%d)\n", rc);
+		return rc;
+	}
+
+	rc = size_lookup_resolve(lookup, args);
+	if (rc <= 0)
+		return rc;
+
+	rc = tse_task_reinit(task);
+	if (rc != 0) {
+		D_ERROR("FAILED to reinit task\n");
+		return rc;
+	}
+
+	rc = tse_task_register_cbs(task, NULL, NULL, 0, get_size_rec_cb,
+				   &lookup, sizeof(lookup));
+	if (rc) {
+		tse_task_complete(task, rc);
+		return rc;
+	}
+
+	return rc;
+}
+
+/**
+ * Look up the last chunk in the chunk tree, in parallel with the record tree
+ * of the guessed chunk. If the guess is wrong, the task is reused to look up
+ * the record tree of the last chunk.
+ */
+static int
+get_size_chunk_cb(tse_task_t *task, void *data)
+{
+	daos_obj_fetch_t		*args = daos_task_get_args(task);
+	struct get_size_md_props	*props =
+		*((struct get_size_md_props **)data);
+	struct dac_array		*array = props->array;
+	struct size_lookup		*lookup = &props->recs[1];
+	daos_size_t			 chunk;
+	tse_task_cb_t			 cb = get_size_chunk_cb;
+	void				*cb_data = props;
+	int				 rc = task->dt_result;
+
+	if (rc != 0) {
+		D_ERROR("Array size index fetch failed (%d)\n", rc);
+		return rc;
+	}
+
+	rc = size_lookup_resolve(&props->chunks, args);
+	if (rc < 0)
+		return rc;
+
+	if (rc == 0) {
+		if (props->chunks.empty)
+			return 0;
+		chunk = props->chunks.high[0];
+		if (chunk == props->guess)
+			return 0;
+
+		/** a grown array is more likely to end low in its chunk */
+		size_lookup_init(lookup, size_rkeys, size_rec_levels(array),
+				 chunk > props->guess ? 0 :
+				 array->chunk_size - 1);
+		rc = array_dkey_alloc(array, chunk, &lookup->dkey_buf,
+				      &lookup->dkey);
+		if (rc != 0)
+			return rc;
+		size_fetch_set(lookup, args);
+		cb = get_size_rec_cb;
+		cb_data = lookup;
+	}
+
+	rc = tse_task_reinit(task);
+	if (rc != 0) {
+		D_ERROR("FAILED to reinit task\n");
+		return rc;
+	}
+
+	rc = tse_task_register_cbs(task, NULL, NULL, 0, cb, &cb_data,
+				   sizeof(cb_data));
+	if (rc) {
+		tse_task_complete(task, rc);
+		return rc;
+	}
+
+	return rc;
+}
+
+static int
+size_fetch_create(tse_task_t *task, struct dac_array *array,
+		  daos_epoch_t epoch, struct size_lookup *lookup,
+		  tse_task_cb_t cb, void *cb_data)
+{
+	daos_obj_fetch_t	*fetch_args;
+	tse_task_t		*fetch_task = NULL;
+	int			 rc;
+
+	rc = daos_task_create(DAOS_OPC_OBJ_FETCH, tse_task2sched(task),
+			      0, NULL, &fetch_task);
+	if (rc != 0)
+		return rc;
+
+	fetch_args		= daos_task_get_args(fetch_task);
+	fetch_args->oh		= array->daos_oh;
+	fetch_args->epoch	= epoch;
+	fetch_args->maps	= NULL;
+	size_fetch_set(lookup, fetch_args);
+
+	rc = tse_task_register_cbs(fetch_task, NULL, NULL, 0, cb, &cb_data,
+				   sizeof(cb_data));
+	if (rc != 0) {
+		D_ERROR("Failed to register completion cb\n");
+		D_GOTO(err, rc);
+	}
+
+	rc = tse_task_register_deps(task, 1, &fetch_task);
+	if (rc != 0) {
+		D_ERROR("Failed to register dependency\n");
+		D_GOTO(err, rc);
+	}
+
+	tse_task_schedule(fetch_task, false);
+	return 0;
+err:
+	tse_task_complete(fetch_task, rc);
+	return rc;
+}
+
+/**
+ * Fetch the chunk tree and the record tree of the chunk of the last known
+ * size in parallel. Each fetch gets the cell groups of all the levels along
+ * the path of the guess, ARRAY_SIZE_FANOUT bytes per level.
+ */
+static int
+get_size_md(tse_task_t *task, struct dac_array *array,
+	    daos_array_get_size_t *args)
+{
+	struct get_size_md_props	*props;
+	daos_size_t			 last;
+	int				 rc;
+
+	D_ALLOC_PTR(props);
+	if (props == NULL)
+		D_GOTO(err_task, rc = -DER_NOMEM);
+
+	props->array = array;
+	props->epoch = args->epoch;
+	props->size = args->size;
+
+	D_SPIN_LOCK(&array->cob_lock);
+	last = array->size_guess == 0 ? 0 : array->size_guess - 1;
+	D_SPIN_UNLOCK(&array->cob_lock);
+
+	props->guess = last / array->chunk_size;
+	size_lookup_init(&props->chunks, size_ckeys, size_chunk_levels(array),
+			 props->guess);
+	array_md_dkey_set(array->dkey_uint64, &props->chunks.dkey);
+	size_lookup_init(&props->recs[0], size_rkeys, size_rec_levels(array),
+			 last % array->chunk_size);
+	rc = array_dkey_alloc(array, props->guess, &props->recs[0].dkey_buf,
+			      &props->recs[0].dkey);
+	if (rc != 0)
+		D_GOTO(err_task, rc);
+
+	/** props are released by free_get_size_md_cb() from now on */
+	rc = tse_task_register_comp_cb(task, free_get_size_md_cb, &props,
+				       sizeof(props));
+	if (rc != 0)
+		D_GOTO(err_task, rc);
+
+	rc = size_fetch_create(task, array, args->epoch, &props->chunks,
+			       get_size_chunk_cb, props);
+	if (rc != 0)
+		D_GOTO(err_comp, rc);
+
+	rc = size_fetch_create(task, array, args->epoch, &props->recs[0],
+			       get_size_rec_cb, &props->recs[0]);
+	if (rc != 0)
+		D_GOTO(err_comp, rc);
+
+	tse_sched_progress(tse_task2sched(task));
+	return 0;
+
+err_task:
+	if (props) {
+		if (props->recs[0].dkey_buf)
+			free(props->recs[0].dkey_buf);
+		D_FREE_PTR(props);
+	}
+	array_decref(array);
+err_comp:
+	tse_task_complete(task, rc);
+	return rc;
+}
+
 int
 dac_array_get_size(tse_task_t *task)
 {
@@ -1606,6 +2476,9 @@ dac_array_get_size(tse_task_t *task)
 	if (array == NULL)
 		D_GOTO(err_task, rc = -DER_NO_HDL);
 
+	if (array->size_index)
+		return get_size_md(task, array, args);
+
 	oh = array->daos_oh;
 
 	D_ALLOC_PTR(get_size_props);
@@ -1682,7 +2555,6 @@ err_task:
 
 struct set_size_props {
 	struct dac_array *array;
-	char		key[ENUM_DESC_BUF];
 	char		buf[ENUM_DESC_BUF];
 	daos_key_desc_t kds[ENUM_DESC_NR];
 	char		*val;
@@ -1714,8 +2586,8 @@ free_set_size_cb(tse_task_t *task, void *data)
 }
 
 static int
-punch_key(daos_handle_t oh, daos_epoch_t epoch, const char *key, int dkey_num,
-	  tse_task_t *task)
+punch_key(struct dac_array *array, daos_handle_t oh, daos_epoch_t epoch,
+	  daos_size_t dkey_num, tse_task_t *task)
 {
 	daos_obj_punch_t	*p_args;
 	daos_key_t		*dkey;
@@ -1730,13 +2602,13 @@ punch_key(daos_handle_t oh, daos_epoch_t epoch, const char *key, int dkey_num,
 		return -DER_NOMEM;
 	}
 
-	params->dkey_str = strdup(key);
 	dkey = &params->dkey;
-	daos_iov_set(dkey, (void *)params->dkey_str,
-		     strlen(params->dkey_str));
+	rc = array_dkey_alloc(array, dkey_num, &params->dkey_buf, dkey);
+	if (rc)
+		D_GOTO(err, rc);
 
 	/** Punch this entire dkey */
-	D_DEBUG(DB_IO, "Punching Key %s\n", params->dkey_str);
+	D_DEBUG(DB_IO, "Punching Key %zu\n", dkey_num);
 
 	/*
 	 * If this is dkey "0", punch only the akey "0" because
@@ -1784,8 +2656,8 @@ punch_key(daos_handle_t oh, daos_epoch_t epoch, const char *key, int dkey_num,
 	return rc;
 err:
 	if (params) {
-		if (params->dkey_str)
-			free(params->dkey_str);
+		if (params->dkey_buf)
+			free(params->dkey_buf);
 		D_FREE_PTR(params);
 	}
 	if (io_task)
@@ -1794,8 +2666,9 @@ err:
 }
 
 static int
-punch_extent(daos_handle_t oh, daos_epoch_t epoch, const char *key,
-	     daos_off_t record_i, daos_size_t num_records, tse_task_t *task)
+punch_extent(struct dac_array *array, daos_handle_t oh, daos_epoch_t epoch,
+	     daos_size_t dkey_num, daos_off_t record_i,
+	     daos_size_t num_records, tse_task_t *task)
 {
 	daos_obj_update_t	*io_arg;
 	daos_iod_t		*iod;
@@ -1806,8 +2679,8 @@ punch_extent(daos_handle_t oh, daos_epoch_t epoch, const char *key,
 	tse_task_t		*io_task = NULL;
 	int			rc;
 
-	D_DEBUG(DB_IO, "Punching (%zu, %zu) in Key %s\n",
-		record_i + 1, num_records, key);
+	D_DEBUG(DB_IO, "Punching (%zu, %zu) in Key %zu\n",
+		record_i + 1, num_records, dkey_num);
 
 	D_ALLOC_PTR(params);
 	if (params == NULL) {
@@ -1822,10 +2695,9 @@ punch_extent(daos_handle_t oh, daos_epoch_t epoch, const char *key,
 	dkey = &params->dkey;
 	params->akey_str = '0';
 	params->user_sgl_used = false;
-	params->dkey_str = strdup(key);
-	dkey = &params->dkey;
-	daos_iov_set(dkey, (void *)params->dkey_str,
-		     strlen(params->dkey_str));
+	rc = array_dkey_alloc(array, dkey_num, &params->dkey_buf, dkey);
+	if (rc)
+		D_GOTO(err, rc);
 
 	/* set descriptor for KV object */
 	daos_iov_set(&iod->iod_name, &params->akey_str, 1);
@@ -1868,8 +2740,8 @@ punch_extent(daos_handle_t oh, daos_epoch_t epoch, const char *key,
 	return rc;
 err:
 	if (params) {
-		if (params->dkey_str)
-			free(params->dkey_str);
+		if (params->dkey_buf)
+			free(params->dkey_buf);
 		D_FREE_PTR(params);
 	}
 	if (io_task)
@@ -1947,16 +2819,17 @@ err_task:
 		tse_task_complete(io_task, rc);
 out:
 	if (params) {
-		if (params->dkey_str)
-			free(params->dkey_str);
+		if (params->dkey_buf)
+			free(params->dkey_buf);
 		D_FREE_PTR(params);
 	}
 	return rc;
 }
 
 static int
-check_record(daos_handle_t oh, daos_epoch_t epoch, const char *key,
-	     daos_off_t record_i, daos_size_t cell_size, tse_task_t *task)
+check_record(struct dac_array *array, daos_handle_t oh, daos_epoch_t epoch,
+	     daos_size_t dkey_num, daos_off_t record_i, daos_size_t cell_size,
+	     tse_task_t *task)
 {
 	daos_obj_fetch_t	*io_arg;
 	daos_iod_t		*iod;
@@ -1978,11 +2851,10 @@ check_record(daos_handle_t oh, daos_epoch_t epoch, const char *key,
 	dkey = &params->dkey;
 	params->akey_str = '0';
 	params->user_sgl_used = false;
-	params->dkey_str = strdup(key);
 	params->cell_size = cell_size;
-	dkey = &params->dkey;
-	daos_iov_set(dkey, (void *)params->dkey_str,
-		     strlen(params->dkey_str));
+	rc = array_dkey_alloc(array, dkey_num, &params->dkey_buf, dkey);
+	if (rc)
+		D_GOTO(err, rc);
 
 	/* set descriptor for KV object */
 	daos_iov_set(&iod->iod_name, &params->akey_str, 1);
@@ -2029,8 +2901,8 @@ check_record(daos_handle_t oh, daos_epoch_t epoch, const char *key,
 	return rc;
 err:
 	if (params) {
-		if (params->dkey_str)
-			free(params->dkey_str);
+		if (params->dkey_buf)
+			free(params->dkey_buf);
 		D_FREE_PTR(params);
 	}
 	if (io_task)
@@ -2066,14 +2938,13 @@ add_record(daos_handle_t oh, daos_epoch_t epoch, struct set_size_props *props)
 	params->next = NULL;
 	params->user_sgl_used = false;
 
-	rc = asprintf(&params->dkey_str, "%zu", props->dkey_num);
-	if (rc < 0 || params->dkey_str == NULL) {
+	rc = array_dkey_alloc(props->array, props->dkey_num, &params->dkey_buf,
+			      dkey);
+	if (rc) {
 		D_ERROR("Failed memory allocation\n");
-		D_GOTO(err, -DER_NOMEM);
+		D_GOTO(err, rc);
 	}
 
-	daos_iov_set(dkey, (void *)params->dkey_str, strlen(params->dkey_str));
-
 	/** set memory location */
 	props->val = calloc(1, props->cell_size);
 	sgl->sg_nr = 1;
@@ -2122,8 +2993,8 @@ add_record(daos_handle_t oh, daos_epoch_t epoch, struct set_size_props *props)
 	return rc;
 err:
 	if (params) {
-		if (params->dkey_str)
-			free(params->dkey_str);
+		if (params->dkey_buf)
+			free(params->dkey_buf);
 		D_FREE_PTR(params);
 	}
 	if (io_task)
@@ -2142,23 +3013,20 @@ adjust_array_size_cb(tse_task_t *task, void *data)
 
 	for (ptr = props->buf, j = 0; j < props->nr; j++) {
 		daos_size_t dkey_num;
-		int ret;
-
-		snprintf(props->key, args->kds[j].kd_key_len + 1, "%s", ptr);
-		ptr += args->kds[j].kd_key_len;
 
-		if (!strcmp(ARRAY_MD_KEY, props->key))
+		if (array_dkey2num(props->array, ptr, args->kds[j].kd_key_len,
+				   &dkey_num) != 0) {
+			ptr += args->kds[j].kd_key_len;
 			continue;
-
-		ret = sscanf(props->key, "%zu", &dkey_num);
-		D_ASSERT(ret == 1);
+		}
+		ptr += args->kds[j].kd_key_len;
 
 		if (props->size == 0 || dkey_num > props->dkey_num) {
 			/*
 			 * Punch the entire dkey since it's in a higher dkey
 			 * group than the intended size.
 			 */
-			rc = punch_key(args->oh, args->epoch, props->key,
+			rc = punch_key(props->array, args->oh, args->epoch,
 				       dkey_num, props->ptask);
 			if (rc)
 				return rc;
@@ -2169,15 +3037,15 @@ adjust_array_size_cb(tse_task_t *task, void *data)
 			 * Punch all records above record_i, then check if
 			 * record_i exists and insert a record if it doesn't.
 			 */
-			rc = punch_extent(args->oh, args->epoch, props->key,
-					  props->record_i, props->num_records,
-					  props->ptask);
+			rc = punch_extent(props->array, args->oh, args->epoch,
+					  dkey_num, props->record_i,
+					  props->num_records, props->ptask);
 			if (rc)
 				return rc;
 
-			rc = check_record(args->oh, args->epoch, props->key,
-					  props->record_i, props->cell_size,
-					  props->ptask);
+			rc = check_record(props->array, args->oh, args->epoch,
+					  dkey_num, props->record_i,
+					  props->cell_size, props->ptask);
 			if (rc)
 				return rc;
 		}
@@ -2226,13 +3094,13 @@ dac_array_set_size(tse_task_t *task)
 	daos_array_set_size_t	*args;
 	daos_handle_t		oh;
 	struct dac_array	*array;
-	char			*dkey_str = NULL;
+	daos_size_t		dkey_num;
 	daos_size_t		num_records;
 	daos_off_t		record_i;
 	daos_obj_list_dkey_t	*enum_args;
 	struct set_size_props	*set_size_props = NULL;
 	tse_task_t		*enum_task;
-	int			rc, ret;
+	int			rc;
 
 	args = daos_task_get_args(task);
 	array = array_hdl2ptr(args->oh);
@@ -2243,30 +3111,21 @@ dac_array_set_size(tse_task_t *task)
 
 	/** get key information for the last record */
 	if (args->size == 0) {
-		dkey_str = strdup("0");
+		dkey_num = 0;
 		num_records = array->chunk_size;
 		record_i = 0;
 	} else {
-		rc = compute_dkey(array, args->size-1, &num_records, &record_i,
-				  &dkey_str);
-		if (rc) {
-			D_ERROR("Failed to compute dkey\n");
-			D_GOTO(err_task, rc);
-		}
+		compute_dkey(array, args->size-1, &num_records, &record_i,
+			     &dkey_num);
 	}
 
 	D_ASSERT(record_i + num_records == array->chunk_size);
 
 	D_ALLOC_PTR(set_size_props);
-	if (set_size_props == NULL) {
-		free(dkey_str);
+	if (set_size_props == NULL)
 		D_GOTO(err_task, rc = -DER_NOMEM);
-	}
-
-	ret = sscanf(dkey_str, "%zu", &set_size_props->dkey_num);
-	D_ASSERT(ret == 1);
-	free(dkey_str);
 
+	set_size_props->dkey_num = dkey_num;
 	set_size_props->array = array;
 	set_size_props->cell_size = array->cell_size;
 	set_size_props->num_records = num_records;
@@ -2310,6 +3169,34 @@ dac_array_set_size(tse_task_t *task)
 	if (rc)
 		D_GOTO(err_enum_task, rc);
 
+	/*
+	 * Set the last record and then punch everything above it in both trees
+	 * of the size index, so a concurrent lookup never finds a cell without
+	 * children. The record trees of the chunks above are punched with their
+	 * dkeys.
+	 */
+	if (array->size_index) {
+		int	i;
+
+		for (i = 0; i < 2; i++) {
+			tse_task_t	*set_task = NULL;
+			bool		 chunks = (i == 0);
+
+			if (args->size != 0) {
+				rc = size_update(array, args->epoch,
+						 args->size, chunks, false,
+						 NULL, task, &set_task);
+				if (rc)
+					D_GOTO(err_enum_task, rc);
+			}
+
+			rc = size_update(array, args->epoch, args->size,
+					 chunks, true, set_task, task, NULL);
+			if (rc)
+				D_GOTO(err_enum_task, rc);
+		}
+	}
+
 	rc = tse_task_register_comp_cb(task, free_set_size_cb, &set_size_props,
 				       sizeof(set_size_props));
 	if (rc)
@@ -100,7 +100,9 @@ struct daos_eq_private {
 	struct d_hlink		eqx_hlink;
 	pthread_mutex_t		eqx_lock;
 	unsigned int		eqx_lock_init:1,
-				eqx_finalizing:1;
+				eqx_finalizing:1,
+				/* eqx_ctx is owned by this EQ */
+				eqx_ctx_priv:1;
 
 	/* CRT context associated with this eq */
 	crt_context_t		eqx_ctx;
@@ -71,6 +71,13 @@ static crt_context_t daos_eq_ctx;
 static pthread_mutex_t daos_eq_lock = PTHREAD_MUTEX_INITIALIZER;
 static unsigned int eq_ref;
 
+/*
+ * Give each EQ its own CRT context, so threads polling different EQs don't
+ * contend on the progress of the shared one. Events without EQ and the
+ * synchronous calls still use daos_eq_ctx.
+ */
+static bool daos_eq_ctx_priv;
+
 /*
  * Pointer to global scheduler for events not part of an EQ. Events initialized
  * as part of an EQ will be tracked in that EQ scheduler.
@@ -103,7 +110,11 @@ daos_eq_lib_init()
 		D_GOTO(unlock, rc);
 	}
 
-	/* use a global shared context for all eq for now */
+	d_getenv_bool("DAOS_EQ_PRIVATE_CTX", &daos_eq_ctx_priv);
+
+	/* global shared context for the non-eq events and the EQs without
+	 * private context
+	 */
 	rc = crt_context_create(&daos_eq_ctx);
 	if (rc != 0) {
 		D_ERROR("failed to create client context: %d\n", rc);
@@ -608,24 +619,46 @@ daos_eq_create(daos_handle_t *eqh)
 {
 	struct daos_eq_private	*eqx;
 	struct daos_eq		*eq;
+	crt_context_t		 ctx = daos_eq_ctx;
 	int			 rc = 0;
 
 	/** not thread-safe, but best effort */
 	if (eq_ref == 0)
 		return -DER_UNINIT;
 
+	if (daos_eq_ctx_priv) {
+		/* fall back to the shared context if we run out of them */
+		rc = crt_context_create(&ctx);
+		if (rc != 0) {
+			D_DEBUG(DB_TRACE, "No private context for EQ: %d\n",
+				rc);
+			ctx = daos_eq_ctx;
+			rc = 0;
+		}
+	}
+
 	eq = daos_eq_alloc();
 	if (eq == NULL)
-		return -DER_NOMEM;
+		D_GOTO(failed, rc = -DER_NOMEM);
 
 	eqx = daos_eq2eqx(eq);
+	/* tasks of this EQ get the context from the scheduler */
+	rc = tse_sched_init(&eqx->eqx_sched, NULL, ctx);
+	if (rc != 0) {
+		daos_eq_free(&eqx->eqx_hlink);
+		D_GOTO(failed, rc);
+	}
+
+	eqx->eqx_ctx = ctx;
+	eqx->eqx_ctx_priv = (ctx != daos_eq_ctx);
 	daos_eq_insert(eqx);
-	eqx->eqx_ctx = daos_eq_ctx;
 	daos_eq_handle(eqx, eqh);
 
-	rc = tse_sched_init(&eqx->eqx_sched, NULL, daos_eq_ctx);
-
 	daos_eq_putref(eqx);
+	return 0;
+failed:
+	if (ctx != daos_eq_ctx)
+		crt_context_destroy(ctx, 1 /* force */);
 	return rc;
 }
 
@@ -834,6 +867,7 @@ daos_eq_destroy(daos_handle_t eqh, int flags)
 	struct daos_eq			*eq;
 	struct daos_event_private	*evx;
 	struct daos_event_private	*tmp;
+	crt_context_t			 ctx;
 	int				 rc = 0;
 
 	eqx = daos_eq_lookup(eqh);
@@ -873,10 +907,19 @@ daos_eq_destroy(daos_handle_t eqh, int flags)
 		D_ASSERT(eq->eq_n_comp > 0);
 		eq->eq_n_comp--;
 	}
+	ctx = eqx->eqx_ctx;
 	eqx->eqx_ctx = NULL;
 
 	tse_sched_complete(&eqx->eqx_sched, rc, true);
 
+	if (eqx->eqx_ctx_priv) {
+		rc = crt_context_destroy(ctx, 1 /* force */);
+		if (rc != 0)
+			D_ERROR("failed to destroy EQ context: %d\n", rc);
+		eqx->eqx_ctx_priv = 0;
+		rc = 0;
+	}
+
 out:
 	D_MUTEX_UNLOCK(&eqx->eqx_lock);
 	if (rc == 0)
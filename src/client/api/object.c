@@ -203,6 +203,22 @@ daos_obj_list_dkey(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nr,
 	return dc_task_schedule(task, true);
 }
 
+int
+daos_obj_list_dkey_val(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nr,
+		       daos_key_desc_t *kds, daos_sg_list_t *sgl,
+		       daos_anchor_t *anchor, daos_event_t *ev)
+{
+	tse_task_t	*task;
+	int		rc;
+
+	rc = dc_obj_list_dkey_val_task_create(oh, epoch, nr, kds, sgl, anchor,
+					      ev, NULL, &task);
+	if (rc)
+		return rc;
+
+	return dc_task_schedule(task, true);
+}
+
 int
 daos_obj_list_akey(daos_handle_t oh, daos_epoch_t epoch, daos_key_t *dkey,
 		   uint32_t *nr, daos_key_desc_t *kds, daos_sg_list_t *sgl,
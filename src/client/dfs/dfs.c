@@ -70,6 +70,22 @@
 #define ENUM_DESC_NR    10
 #define ENUM_DESC_BUF   (ENUM_DESC_NR * DFS_MAX_PATH)
 
+/**
+ * Parameters for dkey enumeration with values (dfs_readdirplus): min number of
+ * descriptors of a valid entry (name, then mode, oid and times with their
+ * values) and max buffer size of an entry (name, akeys and values).
+ */
+#define ENUM_ENTRY_DESC	(1 + 2 * (INODE_AKEYS - 1))
+#define ENUM_ENTRY_BUF	(2 * DFS_MAX_PATH + 128)
+
+/** Max write-back buffer size of a file (see DFS_WRITEBACK), one chunk */
+#define WB_SIZE_MAX	STRIPE_SIZE
+
+/** Default number of entries of the lookup cache (see DFS_DCACHE_SIZE) */
+#define DCACHE_SIZE_DEF	(16 * 1024)
+/** Lookup cache key: parent object ID followed by the entry name */
+#define DCACHE_KEY_MAX	(sizeof(daos_obj_id_t) + DFS_MAX_PATH)
+
 /** OIDs for Superblock and Root objects */
 #define RESERVED_LO	0
 #define SB_HI		0
@@ -94,6 +110,50 @@ struct dfs_obj {
 	char			name[DFS_MAX_PATH];
 	/** Symlink value if object is a symbolic link */
 	char			*value;
+	/** cached size of a regular file, protected by dfs::lock */
+	daos_size_t		size;
+	/** dfs::gen \a size was read at, 0 if \a size is not cached */
+	uint64_t		size_gen;
+	/** write-back state of a regular file, NULL if disabled */
+	struct dfs_wb		*wb;
+};
+
+/** write-back state of an open regular file, see DFS_WRITEBACK */
+struct dfs_wb {
+	/** link in dfs::wb_list */
+	d_list_t		wb_link;
+	/** protects all members but wb_link */
+	pthread_mutex_t		wb_lock;
+	/** mount and open file the state belongs to */
+	dfs_t			*wb_dfs;
+	dfs_obj_t		*wb_obj;
+	/** buffered data, allocated on the first buffered write */
+	char			*wb_buf;
+	/** file offset and length of the buffered data */
+	daos_off_t		wb_off;
+	daos_size_t		wb_len;
+	/** last epoch the file was written in, and end of those writes */
+	daos_epoch_t		wb_epoch;
+	daos_off_t		wb_epoch_end;
+	/** error of a write that lost earlier writes, see io_internal() */
+	int			wb_err;
+};
+
+/** Path lookup cache, (parent OID, name) -> entry, of a mount */
+struct dfs_dcache {
+	/** protects all members */
+	pthread_mutex_t		dc_lock;
+	/** cached entries, keyed by parent OID and name */
+	struct d_hash_table	*dc_hash;
+	/** cached entries, least recently used first */
+	d_list_t		dc_lru;
+	/** max number of cached entries, 0 if the cache is disabled */
+	unsigned int		dc_max;
+	/** epoch of the namespace view of the mount, changed by dfs_sync() */
+	daos_epoch_t		dc_epoch;
+	/** bumped by each invalidation, see dcache_insert() */
+	uint64_t		dc_gen;
+	dfs_cache_stats_t	dc_stats;
 };
 
 /** dfs struct that is instantiated for a mounted DFS namespace */
@@ -122,6 +182,16 @@ struct dfs {
 	daos_handle_t		super_oh;
 	/** Root object info */
 	dfs_obj_t		root;
+	/** Path lookup cache */
+	struct dfs_dcache	dcache;
+	/** bumped by every update, validates the cached file sizes */
+	uint64_t		gen;
+	/** write-back buffer size of open files, 0 if write-back is off */
+	unsigned int		wb_size;
+	/** protects wb_list */
+	pthread_mutex_t		wb_lock;
+	/** write-back state of the open files */
+	d_list_t		wb_list;
 };
 
 struct dfs_entry {
@@ -220,6 +290,7 @@ incr_epoch(dfs_t *dfs)
 {
 	D_MUTEX_LOCK(&dfs->lock);
 	dfs->epoch++;
+	dfs->gen++;
 	D_MUTEX_UNLOCK(&dfs->lock);
 }
 
@@ -363,6 +434,290 @@ fetch_entry(daos_handle_t oh, daos_epoch_t epoch, const char *name,
 	return rc;
 }
 
+/** cached entry of the lookup cache */
+struct dcache_entry {
+	/** link in dc_hash */
+	d_list_t		dce_link;
+	/** link in dc_lru */
+	d_list_t		dce_lru;
+	/** namespace view epoch the entry was fetched in */
+	daos_epoch_t		dce_epoch;
+	mode_t			dce_mode;
+	daos_obj_id_t		dce_oid;
+	/** symlink value, NULL if the entry is not a symlink */
+	char			*dce_value;
+	unsigned int		dce_ksize;
+	char			dce_key[0];
+};
+
+static inline struct dcache_entry *
+dcache_link2entry(d_list_t *rlink)
+{
+	return container_of(rlink, struct dcache_entry, dce_link);
+}
+
+static bool
+dcache_key_cmp(struct d_hash_table *htable, d_list_t *rlink, const void *key,
+	       unsigned int ksize)
+{
+	struct dcache_entry *dce = dcache_link2entry(rlink);
+
+	return dce->dce_ksize == ksize && memcmp(dce->dce_key, key, ksize) == 0;
+}
+
+static d_hash_table_ops_t dcache_hash_ops = {
+	.hop_key_cmp	= dcache_key_cmp,
+};
+
+/** Build the cache key of \a name in \a parent, return its size or 0 */
+static unsigned int
+dcache_key(daos_obj_id_t parent, const char *name, char *key)
+{
+	size_t len = strlen(name);
+
+	if (len >= DFS_MAX_PATH)
+		return 0;
+
+	memcpy(key, &parent, sizeof(parent));
+	memcpy(key + sizeof(parent), name, len);
+	return sizeof(parent) + len;
+}
+
+static int
+dcache_init(struct dfs_dcache *dc, daos_epoch_t epoch)
+{
+	int rc;
+
+	D_INIT_LIST_HEAD(&dc->dc_lru);
+	dc->dc_epoch = epoch;
+	dc->dc_max = DCACHE_SIZE_DEF;
+	d_getenv_int("DFS_DCACHE_SIZE", &dc->dc_max);
+
+	rc = D_MUTEX_INIT(&dc->dc_lock, NULL);
+	if (rc)
+		return -DER_NOMEM;
+
+	rc = d_hash_table_create(D_HASH_FT_NOLOCK, 12, NULL, &dcache_hash_ops,
+				 &dc->dc_hash);
+	if (rc)
+		D_MUTEX_DESTROY(&dc->dc_lock);
+	return rc;
+}
+
+/** Drop \a dce from the cache, with dc_lock held */
+static void
+dcache_entry_del(struct dfs_dcache *dc, struct dcache_entry *dce)
+{
+	d_hash_rec_delete_at(dc->dc_hash, &dce->dce_link);
+	d_list_del(&dce->dce_lru);
+	if (dce->dce_value)
+		free(dce->dce_value);
+	D_FREE(dce);
+	dc->dc_stats.dcs_entries--;
+}
+
+static void
+dcache_fini(struct dfs_dcache *dc)
+{
+	struct dcache_entry *dce, *tmp;
+
+	D_DEBUG(DB_TRACE, "lookup cache: "DF_U64" hits, "DF_U64" misses, "
+		DF_U64" evictions, "DF_U64" invalidations\n",
+		dc->dc_stats.dcs_hits, dc->dc_stats.dcs_misses,
+		dc->dc_stats.dcs_evictions, dc->dc_stats.dcs_invalidations);
+
+	d_list_for_each_entry_safe(dce, tmp, &dc->dc_lru, dce_lru)
+		dcache_entry_del(dc, dce);
+	d_hash_table_destroy(dc->dc_hash, true);
+	D_MUTEX_DESTROY(&dc->dc_lock);
+}
+
+/** Entries fetched before \a epoch, the new view of the mount, are stale */
+static void
+dcache_set_epoch(struct dfs_dcache *dc, daos_epoch_t epoch)
+{
+	D_MUTEX_LOCK(&dc->dc_lock);
+	dc->dc_epoch = epoch;
+	dc->dc_gen++;
+	D_MUTEX_UNLOCK(&dc->dc_lock);
+}
+
+/** Generation of the cache, to be passed to dcache_insert() */
+static uint64_t
+dcache_gen(struct dfs_dcache *dc)
+{
+	uint64_t gen;
+
+	D_MUTEX_LOCK(&dc->dc_lock);
+	gen = dc->dc_gen;
+	D_MUTEX_UNLOCK(&dc->dc_lock);
+	return gen;
+}
+
+/** Look \a name in \a parent up in the cache, return true on a hit */
+static bool
+dcache_lookup(struct dfs_dcache *dc, daos_obj_id_t parent, const char *name,
+	      struct dfs_entry *entry)
+{
+	struct dcache_entry	*dce;
+	d_list_t		*rlink;
+	char			key[DCACHE_KEY_MAX];
+	unsigned int		ksize;
+	bool			hit = false;
+
+	if (dc->dc_max == 0)
+		return false;
+
+	ksize = dcache_key(parent, name, key);
+	if (ksize == 0)
+		return false;
+
+	D_MUTEX_LOCK(&dc->dc_lock);
+	rlink = d_hash_rec_find(dc->dc_hash, key, ksize);
+	if (rlink == NULL)
+		D_GOTO(out, hit = false);
+
+	dce = dcache_link2entry(rlink);
+	if (dce->dce_epoch != dc->dc_epoch) {
+		dcache_entry_del(dc, dce);
+		dc->dc_stats.dcs_invalidations++;
+		D_GOTO(out, hit = false);
+	}
+
+	if (dce->dce_value) {
+		entry->value = strdup(dce->dce_value);
+		if (entry->value == NULL)
+			D_GOTO(out, hit = false);
+	}
+	entry->mode = dce->dce_mode;
+	oid_cp(&entry->oid, dce->dce_oid);
+	d_list_move_tail(&dce->dce_lru, &dc->dc_lru);
+	hit = true;
+out:
+	if (hit)
+		dc->dc_stats.dcs_hits++;
+	else
+		dc->dc_stats.dcs_misses++;
+	D_MUTEX_UNLOCK(&dc->dc_lock);
+	return hit;
+}
+
+/**
+ * Cache \a entry, which was just fetched, as \a name in \a parent. \a gen is
+ * the generation of the cache taken before the fetch, the entry is dropped if
+ * anything was invalidated since, as it may have been fetched before a
+ * concurrent update.
+ */
+static void
+dcache_insert(struct dfs_dcache *dc, daos_obj_id_t parent, const char *name,
+	      struct dfs_entry *entry, uint64_t gen)
+{
+	struct dcache_entry	*dce;
+	d_list_t		*rlink;
+	char			key[DCACHE_KEY_MAX];
+	unsigned int		ksize;
+
+	if (dc->dc_max == 0)
+		return;
+
+	ksize = dcache_key(parent, name, key);
+	if (ksize == 0)
+		return;
+
+	D_ALLOC(dce, sizeof(*dce) + ksize);
+	if (dce == NULL)
+		return;
+
+	if (entry->value) {
+		dce->dce_value = strdup(entry->value);
+		if (dce->dce_value == NULL) {
+			D_FREE(dce);
+			return;
+		}
+	}
+	dce->dce_mode = entry->mode;
+	oid_cp(&dce->dce_oid, entry->oid);
+	dce->dce_ksize = ksize;
+	memcpy(dce->dce_key, key, ksize);
+
+	D_MUTEX_LOCK(&dc->dc_lock);
+	if (dc->dc_gen != gen) {
+		D_MUTEX_UNLOCK(&dc->dc_lock);
+		if (dce->dce_value)
+			free(dce->dce_value);
+		D_FREE(dce);
+		return;
+	}
+	dce->dce_epoch = dc->dc_epoch;
+
+	/** a concurrent lookup may have cached it already, keep the latest */
+	rlink = d_hash_rec_find(dc->dc_hash, key, ksize);
+	if (rlink != NULL)
+		dcache_entry_del(dc, dcache_link2entry(rlink));
+
+	if (dc->dc_stats.dcs_entries >= dc->dc_max) {
+		dcache_entry_del(dc, d_list_entry(dc->dc_lru.next,
+						  struct dcache_entry,
+						  dce_lru));
+		dc->dc_stats.dcs_evictions++;
+	}
+
+	d_hash_rec_insert(dc->dc_hash, key, ksize, &dce->dce_link, false);
+	d_list_add_tail(&dce->dce_lru, &dc->dc_lru);
+	dc->dc_stats.dcs_entries++;
+	D_MUTEX_UNLOCK(&dc->dc_lock);
+}
+
+/** Drop \a name in \a parent from the cache, it has just changed */
+static void
+dcache_invalidate(struct dfs_dcache *dc, daos_obj_id_t parent,
+		  const char *name)
+{
+	d_list_t	*rlink;
+	char		key[DCACHE_KEY_MAX];
+	unsigned int	ksize;
+
+	if (dc->dc_max == 0)
+		return;
+
+	ksize = dcache_key(parent, name, key);
+	if (ksize == 0)
+		return;
+
+	D_MUTEX_LOCK(&dc->dc_lock);
+	dc->dc_gen++;
+	rlink = d_hash_rec_find(dc->dc_hash, key, ksize);
+	if (rlink != NULL) {
+		dcache_entry_del(dc, dcache_link2entry(rlink));
+		dc->dc_stats.dcs_invalidations++;
+	}
+	D_MUTEX_UNLOCK(&dc->dc_lock);
+}
+
+/**
+ * fetch_entry() of \a name in directory \a parent, served from the lookup
+ * cache when possible. Only the mode, OID and symlink value of the entry are
+ * cached, callers that need the times must use fetch_entry().
+ */
+static int
+lookup_entry(dfs_t *dfs, dfs_obj_t *parent, const char *name, bool *exists,
+	     struct dfs_entry *entry)
+{
+	uint64_t	gen;
+	int		rc;
+
+	if (dcache_lookup(&dfs->dcache, parent->oid, name, entry)) {
+		*exists = true;
+		return 0;
+	}
+
+	gen = dcache_gen(&dfs->dcache);
+	rc = fetch_entry(parent->oh, dfs->epoch, name, true, exists, entry);
+	if (rc == 0 && *exists)
+		dcache_insert(&dfs->dcache, parent->oid, name, entry, gen);
+	return rc;
+}
+
 static int
 remove_entry(dfs_t *dfs, daos_handle_t parent_oh, const char *name,
 	     struct dfs_entry entry)
@@ -511,6 +866,27 @@ get_nlinks(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nlinks,
 	return rc;
 }
 
+/**
+ * Fill the attributes of \a stbuf that are stored in the entry itself, i.e.
+ * everything but the size of files and directories and the link count of
+ * directories.
+ */
+static void
+entry2stat(dfs_t *dfs, struct dfs_entry *entry, struct stat *stbuf)
+{
+	stbuf->st_nlink = 1;
+	if (S_ISLNK(entry->mode) && entry->value != NULL)
+		stbuf->st_size = strlen(entry->value);
+	stbuf->st_mode = entry->mode;
+	stbuf->st_uid = dfs->uid;
+	stbuf->st_gid = dfs->gid;
+	stbuf->st_atim.tv_sec = entry->atime;
+	stbuf->st_mtim.tv_sec = entry->mtime;
+	stbuf->st_ctim.tv_sec = entry->ctime;
+}
+
+static int wb_sync_oid(dfs_t *dfs, daos_obj_id_t oid);
+
 static int
 entry_stat(dfs_t *dfs, daos_handle_t oh, const char *name, struct stat *stbuf)
 {
@@ -561,6 +937,11 @@ entry_stat(dfs_t *dfs, daos_handle_t oh, const char *name, struct stat *stbuf)
 		daos_handle_t	file_oh;
 		daos_size_t	elem_size, dkey_size;
 
+		/* The size must account for the buffered writes */
+		rc = wb_sync_oid(dfs, entry.oid);
+		if (rc)
+			return rc;
+
 		rc = daos_array_open(dfs->coh, entry.oid, dfs->epoch,
 				     DAOS_OO_RO, &elem_size, &dkey_size,
 				     &file_oh, NULL);
@@ -605,18 +986,44 @@ entry_stat(dfs_t *dfs, daos_handle_t oh, const char *name, struct stat *stbuf)
 		return -DER_INVAL;
 	}
 
+	entry2stat(dfs, &entry, stbuf);
 	stbuf->st_nlink = (nlink_t)nlinks;
 	stbuf->st_size = size;
-	stbuf->st_mode = entry.mode;
-	stbuf->st_uid = dfs->uid;
-	stbuf->st_gid = dfs->gid;
-	stbuf->st_atim.tv_sec = entry.atime;
-	stbuf->st_mtim.tv_sec = entry.mtime;
-	stbuf->st_ctim.tv_sec = entry.ctime;
 
 	return rc;
 }
 
+/**
+ * Set up the write-back state of an open regular file. Write-back is only an
+ * optimization, so the file is written through if this fails.
+ */
+static void
+wb_init(dfs_t *dfs, dfs_obj_t *obj)
+{
+	struct dfs_wb	*wb;
+	int		rc;
+
+	if (dfs->wb_size == 0 || dfs->amode != O_RDWR)
+		return;
+
+	D_ALLOC_PTR(wb);
+	if (wb == NULL)
+		return;
+
+	rc = D_MUTEX_INIT(&wb->wb_lock, NULL);
+	if (rc != 0) {
+		D_FREE_PTR(wb);
+		return;
+	}
+	wb->wb_dfs = dfs;
+	wb->wb_obj = obj;
+	obj->wb = wb;
+
+	D_MUTEX_LOCK(&dfs->wb_lock);
+	d_list_add(&wb->wb_link, &dfs->wb_list);
+	D_MUTEX_UNLOCK(&dfs->wb_lock);
+}
+
 static int
 open_file(dfs_t *dfs, dfs_obj_t *parent, int flags, daos_oclass_id_t cid,
 	  dfs_obj_t *file)
@@ -679,6 +1086,7 @@ open_file(dfs_t *dfs, dfs_obj_t *parent, int flags, daos_oclass_id_t cid,
 			D_GOTO(err, rc);
 		}
 
+		wb_init(dfs, file);
 		return rc;
 	}
 
@@ -715,6 +1123,7 @@ open_file:
 		return -DER_INVAL;
 	}
 	oid_cp(&file->oid, entry.oid);
+	wb_init(dfs, file);
 
 	return rc;
 err:
@@ -955,6 +1364,17 @@ dfs_mount(daos_handle_t poh, daos_handle_t coh, int flags, dfs_t **_dfs)
 	rc = D_MUTEX_INIT(&dfs->lock, NULL);
 	if (rc != 0)
 		return rc;
+	rc = D_MUTEX_INIT(&dfs->wb_lock, NULL);
+	if (rc != 0)
+		D_GOTO(err_dfs, rc);
+	D_INIT_LIST_HEAD(&dfs->wb_list);
+	dfs->gen = 1;
+
+	/** write-back of small file writes, off by default */
+	dfs->wb_size = 0;
+	d_getenv_int("DFS_WRITEBACK", &dfs->wb_size);
+	if (dfs->wb_size > WB_SIZE_MAX)
+		dfs->wb_size = WB_SIZE_MAX;
 
 	rc = daos_pool_query(poh, NULL, &pool_info, NULL);
 	if (rc) {
@@ -986,6 +1406,12 @@ dfs_mount(daos_handle_t poh, daos_handle_t coh, int flags, dfs_t **_dfs)
 		D_GOTO(err_dfs, rc = -DER_INVAL);
 	}
 
+	rc = dcache_init(&dfs->dcache, dfs->epoch);
+	if (rc) {
+		D_ERROR("Failed to create the lookup cache (%d)\n", rc);
+		D_GOTO(err_epoch, rc);
+	}
+
 	dfs->oid.hi = 0;
 	dfs->oid.lo = 0;
 
@@ -998,7 +1424,7 @@ dfs_mount(daos_handle_t poh, daos_handle_t coh, int flags, dfs_t **_dfs)
 			   &dfs->super_oh, NULL);
 	if (rc) {
 		D_ERROR("daos_obj_open() Failed (%d)\n", rc);
-		D_GOTO(err_epoch, rc);
+		D_GOTO(err_dcache, rc);
 	}
 
 	D_DEBUG(DB_TRACE, "DFS super object %"PRIu64".%"PRIu64"\n",
@@ -1009,14 +1435,14 @@ dfs_mount(daos_handle_t poh, daos_handle_t coh, int flags, dfs_t **_dfs)
 		rc = daos_cont_oid_alloc(dfs->coh, 1, &dfs->oid.lo, NULL);
 		if (rc) {
 			D_ERROR("daos_cont_oid_alloc() Failed (%d)\n", rc);
-			D_GOTO(err_epoch, rc);
+			D_GOTO(err_dcache, rc);
 		}
 	}
 
 	/** Check if SB object exists already, and create it if it doesn't */
 	rc = check_sb(dfs, (amode == O_RDWR), &sb_exists);
 	if (rc)
-		D_GOTO(err_epoch, rc);
+		D_GOTO(err_dcache, rc);
 
 	/** Check if super object has the root entry */
 	strcpy(dfs->root.name, "/");
@@ -1100,6 +1526,8 @@ err_root:
 err_super:
 	daos_obj_punch(dfs->super_oh, dfs->epoch, NULL);
 	daos_obj_close(dfs->super_oh, NULL);
+err_dcache:
+	dcache_fini(&dfs->dcache);
 err_epoch:
 	daos_epoch_discard(coh, dfs->epoch, NULL, NULL);
 err_dfs:
@@ -1128,9 +1556,11 @@ dfs_umount(dfs_t *dfs, bool commit)
 
 	daos_obj_close(dfs->root.oh, NULL);
 	daos_obj_close(dfs->super_oh, NULL);
+	dcache_fini(&dfs->dcache);
 
 	D_MUTEX_UNLOCK(&dfs->lock);
 	D_MUTEX_DESTROY(&dfs->lock);
+	D_MUTEX_DESTROY(&dfs->wb_lock);
 	D_FREE_PTR(dfs);
 	return rc;
 }
@@ -1147,6 +1577,20 @@ dfs_get_epoch(dfs_t *dfs, daos_epoch_t *epoch)
 	return 0;
 }
 
+int
+dfs_cache_stats(dfs_t *dfs, dfs_cache_stats_t *stats)
+{
+	if (dfs == NULL || !dfs->mounted)
+		return -DER_INVAL;
+	if (stats == NULL)
+		return -DER_INVAL;
+
+	D_MUTEX_LOCK(&dfs->dcache.dc_lock);
+	*stats = dfs->dcache.dc_stats;
+	D_MUTEX_UNLOCK(&dfs->dcache.dc_lock);
+	return 0;
+}
+
 int
 dfs_get_file_oh(dfs_obj_t *obj, daos_handle_t *oh)
 {
@@ -1194,6 +1638,7 @@ dfs_mkdir(dfs_t *dfs, dfs_obj_t *parent, const char *name, mode_t mode)
 		daos_epoch_discard(dfs->coh, dfs->epoch, NULL, NULL);
 		D_ERROR("Inserting dir entry %s failed (%d)\n", name, rc);
 	}
+	dcache_invalidate(&dfs->dcache, parent->oid, name);
 
 	daos_obj_close(new_dir.oh, NULL);
 	return rc;
@@ -1336,9 +1781,11 @@ dfs_remove(dfs_t *dfs, dfs_obj_t *parent, const char *name, bool force)
 	if (rc)
 		D_GOTO(err, rc);
 
+	dcache_invalidate(&dfs->dcache, parent->oid, name);
 	return rc;
 err:
 	daos_epoch_discard(dfs->coh, dfs->epoch, NULL, NULL);
+	dcache_invalidate(&dfs->dcache, parent->oid, name);
 	return rc;
 }
 
@@ -1396,8 +1843,7 @@ dfs_lookup(dfs_t *dfs, const char *path, int flags, dfs_obj_t **_obj,
 dfs_lookup_loop:
 		D_DEBUG(DB_TRACE, "looking up %s in %"PRIu64".%"PRIu64"\n",
 			token, parent.oid.hi, parent.oid.lo);
-		rc = fetch_entry(parent.oh, dfs->epoch, token, true,
-				 &exists, &entry);
+		rc = lookup_entry(dfs, &parent, token, &exists, &entry);
 		if (rc)
 			D_GOTO(err_obj, rc);
 
@@ -1440,6 +1886,7 @@ dfs_lookup_loop:
 				daos_array_close(obj->oh, NULL);
 				D_GOTO(err_obj, rc);
 			}
+			wb_init(dfs, obj);
 
 			break;
 		}
@@ -1466,6 +1913,7 @@ dfs_lookup_loop:
 				}
 
 				parent.oh = sym->oh;
+				oid_cp(&parent.oid, sym->oid);
 				D_FREE_PTR(sym);
 				free(entry.value);
 				entry.value = NULL;
@@ -1505,6 +1953,110 @@ err_obj:
 	goto out;
 }
 
+int
+dfs_lookup_rel(dfs_t *dfs, dfs_obj_t *parent, const char *name, int flags,
+	       dfs_obj_t **_obj, mode_t *mode)
+{
+	dfs_obj_t		*obj;
+	struct dfs_entry	entry = {0};
+	bool			exists;
+	int			daos_mode;
+	int			rc;
+
+	if (dfs == NULL || !dfs->mounted)
+		return -DER_INVAL;
+	if (_obj == NULL || name == NULL)
+		return -DER_INVAL;
+	if (strlen(name) >= DFS_MAX_PATH)
+		return -DER_INVAL;
+	if (parent == NULL)
+		parent = &dfs->root;
+	else if (!S_ISDIR(parent->mode))
+		return -DER_NOTDIR;
+
+	daos_mode = get_daos_obj_mode(flags);
+	if (daos_mode == -1) {
+		D_ERROR("Invalid access mode.\n");
+		return -DER_INVAL;
+	}
+
+	rc = lookup_entry(dfs, parent, name, &exists, &entry);
+	if (rc)
+		return rc;
+
+	if (!exists)
+		return -DER_NONEXIST;
+
+	D_ALLOC_PTR(obj);
+	if (obj == NULL)
+		D_GOTO(err_entry, rc = -DER_NOMEM);
+
+	strcpy(obj->name, name);
+	obj->mode = entry.mode;
+	oid_cp(&obj->oid, entry.oid);
+	oid_cp(&obj->parent_oid, parent->oid);
+
+	switch (entry.mode & S_IFMT) {
+	case S_IFREG:
+	{
+		daos_size_t elem_size, dkey_size;
+
+		rc = daos_array_open(dfs->coh, entry.oid, dfs->epoch,
+				     daos_mode, &elem_size, &dkey_size,
+				     &obj->oh, NULL);
+		if (rc != 0) {
+			D_ERROR("daos_array_open() failed (%d)\n", rc);
+			D_GOTO(err_obj, rc);
+		}
+		if (elem_size != 1) {
+			D_ERROR("Invalid Byte array elem size (%zu)\n",
+				elem_size);
+			daos_array_close(obj->oh, NULL);
+			D_GOTO(err_obj, rc = -DER_INVAL);
+		}
+		wb_init(dfs, obj);
+		break;
+	}
+	case S_IFDIR:
+		rc = daos_obj_open(dfs->coh, entry.oid, dfs->epoch, daos_mode,
+				   &obj->oh, NULL);
+		if (rc) {
+			D_ERROR("daos_obj_open() Failed (%d)\n", rc);
+			D_GOTO(err_obj, rc);
+		}
+		break;
+	case S_IFLNK:
+		obj->value = entry.value;
+		entry.value = NULL;
+		break;
+	default:
+		D_ERROR("Invalid entry type (not a dir, file, symlink).\n");
+		D_GOTO(err_obj, rc = -DER_INVAL);
+	}
+
+	if (mode)
+		*mode = obj->mode;
+	*_obj = obj;
+	return 0;
+
+err_obj:
+	D_FREE_PTR(obj);
+err_entry:
+	if (entry.value)
+		free(entry.value);
+	return rc;
+}
+
+int
+dfs_obj2id(dfs_obj_t *obj, daos_obj_id_t *oid)
+{
+	if (obj == NULL || oid == NULL)
+		return -DER_INVAL;
+
+	oid_cp(oid, obj->oid);
+	return 0;
+}
+
 int
 dfs_nlinks(dfs_t *dfs, dfs_obj_t *obj, uint32_t *nlinks)
 {
@@ -1586,6 +2138,168 @@ out:
 	return rc;
 }
 
+/** bits of the entry members unpacked by entry_unpack_val() */
+enum {
+	ENTRY_MODE	= (1 << 0),
+	ENTRY_OID	= (1 << 1),
+	ENTRY_ATIME	= (1 << 2),
+	ENTRY_MTIME	= (1 << 3),
+	ENTRY_CTIME	= (1 << 4),
+	ENTRY_ALL	= ENTRY_MODE | ENTRY_OID | ENTRY_ATIME | ENTRY_MTIME |
+			  ENTRY_CTIME,
+};
+
+static bool
+akey_match(const char *akey, size_t len, const char *name)
+{
+	return len == strlen(name) && strncmp(akey, name, len) == 0;
+}
+
+/** Unpack the value \a val of the akey \a akey of an entry into \a entry */
+static int
+entry_unpack_val(const char *akey, size_t akey_len, const char *val,
+		 size_t val_len, struct dfs_entry *entry, unsigned int *found)
+{
+	if (akey_match(akey, akey_len, MODE_NAME) &&
+	    val_len == sizeof(mode_t)) {
+		memcpy(&entry->mode, val, val_len);
+		*found |= ENTRY_MODE;
+	} else if (akey_match(akey, akey_len, OID_NAME) &&
+		   val_len == sizeof(daos_obj_id_t)) {
+		memcpy(&entry->oid, val, val_len);
+		*found |= ENTRY_OID;
+	} else if (akey_match(akey, akey_len, ATIME_NAME) &&
+		   val_len == sizeof(time_t)) {
+		memcpy(&entry->atime, val, val_len);
+		*found |= ENTRY_ATIME;
+	} else if (akey_match(akey, akey_len, MTIME_NAME) &&
+		   val_len == sizeof(time_t)) {
+		memcpy(&entry->mtime, val, val_len);
+		*found |= ENTRY_MTIME;
+	} else if (akey_match(akey, akey_len, CTIME_NAME) &&
+		   val_len == sizeof(time_t)) {
+		memcpy(&entry->ctime, val, val_len);
+		*found |= ENTRY_CTIME;
+	} else if (akey_match(akey, akey_len, SYML_NAME) && val_len > 0) {
+		/** the value is stored with its terminating '\0' */
+		D_ALLOC(entry->value, val_len);
+		if (entry->value == NULL)
+			return -DER_NOMEM;
+		memcpy(entry->value, val, val_len - 1);
+	}
+
+	return 0;
+}
+
+int
+dfs_readdirplus(dfs_t *dfs, dfs_obj_t *obj, daos_anchor_t *anchor,
+		uint32_t *nr, struct dirent *dirs, struct stat *stbufs)
+{
+	daos_key_desc_t *kds;
+	char *enum_buf;
+	uint32_t number, key_nr, i;
+	daos_sg_list_t sgl;
+	uint64_t gen;
+	int rc = 0;
+
+	if (dfs == NULL || !dfs->mounted)
+		return -DER_INVAL;
+	if (obj == NULL || !S_ISDIR(obj->mode))
+		return -DER_NOTDIR;
+	if (*nr == 0)
+		return 0;
+	if (dirs == NULL || stbufs == NULL || anchor == NULL)
+		return -DER_INVAL;
+
+	/*
+	 * A valid entry takes at least ENUM_ENTRY_DESC descriptors, so the
+	 * enumeration never returns more than *nr entries.
+	 */
+	D_ALLOC_ARRAY(kds, *nr * ENUM_ENTRY_DESC);
+	if (kds == NULL)
+		return -DER_NOMEM;
+
+	D_ALLOC_ARRAY(enum_buf, *nr * ENUM_ENTRY_BUF);
+	if (enum_buf == NULL) {
+		D_FREE(kds);
+		return -DER_NOMEM;
+	}
+
+	/** the entries are cached, as the caller is likely to look them up */
+	gen = dcache_gen(&dfs->dcache);
+	key_nr = 0;
+	number = *nr * ENUM_ENTRY_DESC;
+	while (!daos_anchor_is_eof(anchor)) {
+		daos_iov_t iov;
+		char *ptr;
+
+		sgl.sg_nr = 1;
+		sgl.sg_nr_out = 0;
+		daos_iov_set(&iov, enum_buf, (*nr - key_nr) * ENUM_ENTRY_BUF);
+		sgl.sg_iovs = &iov;
+
+		rc = daos_obj_list_dkey_val(obj->oh, dfs->epoch, &number, kds,
+					    &sgl, anchor, NULL);
+		if (rc)
+			D_GOTO(out, rc);
+
+		ptr = enum_buf;
+		i = 0;
+		while (i < number) {
+			struct dfs_entry	entry = {0};
+			unsigned int		found = 0;
+			char			*name = ptr;
+			uint32_t		name_len = kds[i].kd_key_len;
+
+			ptr += name_len;
+			i++;
+
+			/** akey and value pairs of the entry */
+			while (i + 1 < number &&
+			       kds[i + 1].kd_val_types == DAOS_IOD_SINGLE) {
+				rc = entry_unpack_val(ptr, kds[i].kd_key_len,
+						      ptr + kds[i].kd_key_len,
+						      kds[i + 1].kd_key_len,
+						      &entry, &found);
+				if (rc) {
+					D_FREE(entry.value);
+					D_GOTO(out, rc);
+				}
+				ptr += kds[i].kd_key_len;
+				ptr += kds[i + 1].kd_key_len;
+				i += 2;
+			}
+
+			if (found != ENTRY_ALL) {
+				D_DEBUG(DB_TRACE, "Skip incomplete entry %.*s\n",
+					(int)name_len, name);
+				D_FREE(entry.value);
+				continue;
+			}
+
+			D_ASSERT(key_nr < *nr);
+			memcpy(dirs[key_nr].d_name, name, name_len);
+			dirs[key_nr].d_name[name_len] = '\0';
+			memset(&stbufs[key_nr], 0, sizeof(struct stat));
+			entry2stat(dfs, &entry, &stbufs[key_nr]);
+			dcache_insert(&dfs->dcache, obj->oid,
+				      dirs[key_nr].d_name, &entry, gen);
+			D_FREE(entry.value);
+			key_nr++;
+		}
+
+		if (key_nr == *nr)
+			break;
+		number = (*nr - key_nr) * ENUM_ENTRY_DESC;
+	}
+	*nr = key_nr;
+
+out:
+	D_FREE(enum_buf);
+	D_FREE(kds);
+	return rc;
+}
+
 int
 dfs_open(dfs_t *dfs, dfs_obj_t *parent, const char *name, mode_t mode,
 	 int flags, daos_oclass_id_t cid, const char *value, dfs_obj_t **_obj)
@@ -1651,30 +2365,36 @@ dfs_open(dfs_t *dfs, dfs_obj_t *parent, const char *name, mode_t mode,
 	return rc;
 }
 
-int
-dfs_release(dfs_obj_t *obj)
+/**
+ * Pick the epoch to write [\a off, \a off + \a len) of \a obj in. Each
+ * update normally moves the mount to a new epoch. With write-back on, writes
+ * of a file that land past everything the file got in the current epoch keep
+ * sharing that epoch instead, because they can not overlap the earlier ones
+ * (VOS rejects partial overwrites in the same epoch). Any other update moves
+ * the mount to a new epoch, which ends the batch, so only the handle that
+ * moved the mount to its epoch can share it, even among handles of a file.
+ */
+static daos_epoch_t
+write_epoch(dfs_t *dfs, dfs_obj_t *obj, daos_off_t off, daos_size_t len,
+	    bool *shared)
 {
-	int rc = 0;
-
-	if (obj == NULL)
-		return -DER_INVAL;
+	struct dfs_wb	*wb = obj->wb;
+	daos_epoch_t	epoch;
 
-	if (S_ISDIR(obj->mode))
-		rc = daos_obj_close(obj->oh, NULL);
-	else if (S_ISREG(obj->mode))
-		rc = daos_array_close(obj->oh, NULL);
-	else if (S_ISLNK(obj->mode))
-		; /** nothing to do */
-	else
-		D_ASSERT(0);
+	D_MUTEX_LOCK(&dfs->lock);
+	*shared = wb != NULL && wb->wb_epoch == dfs->epoch &&
+		  off >= wb->wb_epoch_end;
+	if (!*shared)
+		dfs->epoch++;
+	dfs->gen++;
+	epoch = dfs->epoch;
+	D_MUTEX_UNLOCK(&dfs->lock);
 
-	if (rc) {
-		D_ERROR("daos_obj_close() Failed (%d)\n", rc);
-		return rc;
+	if (wb != NULL) {
+		wb->wb_epoch = epoch;
+		wb->wb_epoch_end = off + len;
 	}
-
-	D_FREE_PTR(obj);
-	return 0;
+	return epoch;
 }
 
 static int
@@ -1684,6 +2404,8 @@ io_internal(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off,
 	daos_array_iod_t	iod;
 	daos_range_t		rg;
 	daos_size_t		buf_size;
+	daos_epoch_t		epoch;
+	bool			shared;
 	int			i;
 	int			rc;
 
@@ -1701,12 +2423,21 @@ io_internal(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off,
 		dfs->epoch, flag, off, buf_size);
 
 	if (flag == DFS_WRITE) {
-		incr_epoch(dfs);
-		rc = daos_array_write(obj->oh, dfs->epoch, &iod, &sgl,
-				      NULL, NULL);
+		epoch = write_epoch(dfs, obj, off, buf_size, &shared);
+		rc = daos_array_write(obj->oh, epoch, &iod, &sgl, NULL, NULL);
 		if (rc) {
-			daos_epoch_discard(dfs->coh, dfs->epoch, NULL, NULL);
 			D_ERROR("daos_array_write() failed (%d)\n", rc);
+			/*
+			 * Drop whatever the write left in its epoch. A shared
+			 * epoch only holds earlier writes of this file, they
+			 * are lost too and the next sync of the file fails.
+			 */
+			daos_epoch_discard(dfs->coh, epoch, NULL, NULL);
+			if (obj->wb != NULL) {
+				obj->wb->wb_epoch = 0;
+				if (shared)
+					obj->wb->wb_err = rc;
+			}
 		}
 	} else if (flag == DFS_READ) {
 		rc = daos_array_read(obj->oh, dfs->epoch, &iod, &sgl, NULL,
@@ -1720,6 +2451,243 @@ io_internal(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off,
 	return rc;
 }
 
+/** Write the buffered data of \a obj out, with wb_lock held */
+static int
+wb_flush(dfs_t *dfs, dfs_obj_t *obj)
+{
+	struct dfs_wb	*wb = obj->wb;
+	daos_sg_list_t	sgl;
+	daos_iov_t	iov;
+	int		rc;
+
+	if (wb->wb_len == 0)
+		return 0;
+
+	D_DEBUG(DB_TRACE, "flush %zu bytes at %"PRIu64" of %s\n",
+		wb->wb_len, wb->wb_off, obj->name);
+
+	daos_iov_set(&iov, wb->wb_buf, wb->wb_len);
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 0;
+	sgl.sg_iovs = &iov;
+
+	/** the data is dropped on failure, the error is reported instead */
+	rc = io_internal(dfs, obj, sgl, wb->wb_off, DFS_WRITE);
+	wb->wb_len = 0;
+	return rc;
+}
+
+/**
+ * Write the buffered data of \a wb out. With \a report, also return the
+ * error of an earlier write that lost data, see io_internal().
+ */
+static int
+wb_sync_one(struct dfs_wb *wb, bool report)
+{
+	int rc;
+
+	D_MUTEX_LOCK(&wb->wb_lock);
+	rc = wb_flush(wb->wb_dfs, wb->wb_obj);
+	if (report) {
+		if (rc == 0)
+			rc = wb->wb_err;
+		wb->wb_err = 0;
+	}
+	D_MUTEX_UNLOCK(&wb->wb_lock);
+	return rc;
+}
+
+/**
+ * Write the buffered data of all open handles of the file \a oid out, so
+ * that reads and size lookups through any handle or path see all the writes.
+ */
+static int
+wb_sync_oid(dfs_t *dfs, daos_obj_id_t oid)
+{
+	struct dfs_wb	*wb;
+	int		rc = 0;
+	int		ret;
+
+	if (dfs->wb_size == 0)
+		return 0;
+
+	D_MUTEX_LOCK(&dfs->wb_lock);
+	d_list_for_each_entry(wb, &dfs->wb_list, wb_link) {
+		if (wb->wb_obj->oid.lo != oid.lo ||
+		    wb->wb_obj->oid.hi != oid.hi)
+			continue;
+		ret = wb_sync_one(wb, false);
+		if (ret && rc == 0)
+			rc = ret;
+	}
+	D_MUTEX_UNLOCK(&dfs->wb_lock);
+	return rc;
+}
+
+/** Write the buffered data of \a obj, and of the other handles of it, out */
+static int
+wb_sync(dfs_t *dfs, dfs_obj_t *obj)
+{
+	return wb_sync_oid(dfs, obj->oid);
+}
+
+/** Write the buffered data of all open files of \a dfs out */
+static int
+wb_sync_all(dfs_t *dfs)
+{
+	struct dfs_wb	*wb;
+	int		rc = 0;
+	int		ret;
+
+	D_MUTEX_LOCK(&dfs->wb_lock);
+	d_list_for_each_entry(wb, &dfs->wb_list, wb_link) {
+		ret = wb_sync_one(wb, true);
+		if (ret && rc == 0)
+			rc = ret;
+	}
+	D_MUTEX_UNLOCK(&dfs->wb_lock);
+	return rc;
+}
+
+/** Flush and free the write-back state of \a obj at release */
+static int
+wb_fini(dfs_obj_t *obj)
+{
+	struct dfs_wb	*wb = obj->wb;
+	dfs_t		*dfs = wb->wb_dfs;
+	int		rc;
+
+	rc = wb_sync_one(wb, true);
+
+	D_MUTEX_LOCK(&dfs->wb_lock);
+	d_list_del(&wb->wb_link);
+	D_MUTEX_UNLOCK(&dfs->wb_lock);
+
+	obj->wb = NULL;
+	D_MUTEX_DESTROY(&wb->wb_lock);
+	if (wb->wb_buf)
+		D_FREE(wb->wb_buf);
+	D_FREE_PTR(wb);
+	return rc;
+}
+
+/**
+ * Buffer a write of \a obj. Writes that continue the buffered data are
+ * appended to it until the buffer is full; anything else first writes the
+ * buffer out. Writes as large as the buffer are not buffered.
+ */
+static int
+wb_write(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off)
+{
+	struct dfs_wb	*wb = obj->wb;
+	daos_size_t	len = 0;
+	int		i;
+	int		rc = 0;
+
+	for (i = 0; i < sgl.sg_nr; i++)
+		len += sgl.sg_iovs[i].iov_len;
+
+	D_MUTEX_LOCK(&wb->wb_lock);
+
+	if (wb->wb_len > 0 && (off != wb->wb_off + wb->wb_len ||
+			       wb->wb_len + len > dfs->wb_size)) {
+		rc = wb_flush(dfs, obj);
+		if (rc)
+			D_GOTO(out, rc);
+	}
+
+	if (len >= dfs->wb_size) {
+		rc = io_internal(dfs, obj, sgl, off, DFS_WRITE);
+		D_GOTO(out, rc);
+	}
+
+	if (wb->wb_buf == NULL) {
+		D_ALLOC(wb->wb_buf, dfs->wb_size);
+		if (wb->wb_buf == NULL) {
+			rc = io_internal(dfs, obj, sgl, off, DFS_WRITE);
+			D_GOTO(out, rc);
+		}
+	}
+
+	if (wb->wb_len == 0)
+		wb->wb_off = off;
+	for (i = 0; i < sgl.sg_nr; i++) {
+		memcpy(wb->wb_buf + wb->wb_len, sgl.sg_iovs[i].iov_buf,
+		       sgl.sg_iovs[i].iov_len);
+		wb->wb_len += sgl.sg_iovs[i].iov_len;
+	}
+
+	if (wb->wb_len == dfs->wb_size)
+		rc = wb_flush(dfs, obj);
+out:
+	D_MUTEX_UNLOCK(&wb->wb_lock);
+	return rc;
+}
+
+int
+dfs_release(dfs_obj_t *obj)
+{
+	int rc = 0;
+	int wb_rc = 0;
+
+	if (obj == NULL)
+		return -DER_INVAL;
+
+	if (S_ISDIR(obj->mode)) {
+		rc = daos_obj_close(obj->oh, NULL);
+	} else if (S_ISREG(obj->mode)) {
+		if (obj->wb != NULL)
+			wb_rc = wb_fini(obj);
+		rc = daos_array_close(obj->oh, NULL);
+	} else if (S_ISLNK(obj->mode)) {
+		free(obj->value);
+	} else {
+		D_ASSERT(0);
+	}
+
+	if (rc) {
+		D_ERROR("daos_obj_close() Failed (%d)\n", rc);
+		return rc;
+	}
+
+	D_FREE_PTR(obj);
+	return wb_rc;
+}
+
+/**
+ * Get the size of a regular file. The size is cached in the object until the
+ * next update through the mount or dfs_sync(), which bump dfs::gen.
+ */
+static int
+file_get_size(dfs_t *dfs, dfs_obj_t *obj, daos_size_t *size)
+{
+	daos_epoch_t	epoch;
+	uint64_t	gen;
+	int		rc;
+
+	D_MUTEX_LOCK(&dfs->lock);
+	epoch = dfs->epoch;
+	gen = dfs->gen;
+	if (obj->size_gen == gen) {
+		*size = obj->size;
+		D_MUTEX_UNLOCK(&dfs->lock);
+		return 0;
+	}
+	D_MUTEX_UNLOCK(&dfs->lock);
+
+	rc = daos_array_get_size(obj->oh, epoch, size, NULL);
+	if (rc) {
+		D_ERROR("daos_array_get_size() failed (%d)\n", rc);
+		return rc;
+	}
+
+	D_MUTEX_LOCK(&dfs->lock);
+	obj->size = *size;
+	obj->size_gen = gen;
+	D_MUTEX_UNLOCK(&dfs->lock);
+	return 0;
+}
+
 int
 dfs_read(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off,
 	 daos_size_t *read_size)
@@ -1734,11 +2702,13 @@ dfs_read(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off,
 	if (obj == NULL || !S_ISREG(obj->mode))
 		return -DER_INVAL;
 
-	rc = daos_array_get_size(obj->oh, dfs->epoch, &array_size, NULL);
-	if (rc) {
-		D_ERROR("daos_array_get_size() failed (%d)\n", rc);
+	rc = wb_sync(dfs, obj);
+	if (rc)
+		return rc;
+
+	rc = file_get_size(dfs, obj, &array_size);
+	if (rc)
 		return rc;
-	}
 
 	if (off >= array_size) {
 		*read_size = 0;
@@ -1783,6 +2753,9 @@ dfs_write(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off)
 	if (obj == NULL || !S_ISREG(obj->mode))
 		return -DER_INVAL;
 
+	if (obj->wb != NULL)
+		return wb_write(dfs, obj, sgl, off);
+
 	return io_internal(dfs, obj, sgl, off, DFS_WRITE);
 }
 
@@ -1840,12 +2813,18 @@ out:
 int
 dfs_get_size(dfs_t *dfs, dfs_obj_t *obj, daos_size_t *size)
 {
+	int rc;
+
 	if (dfs == NULL || !dfs->mounted)
 		return -DER_INVAL;
 	if (obj == NULL || !S_ISREG(obj->mode))
 		return -DER_INVAL;
 
-	return daos_array_get_size(obj->oh, dfs->epoch, size, NULL);
+	rc = wb_sync(dfs, obj);
+	if (rc)
+		return rc;
+
+	return file_get_size(dfs, obj, size);
 }
 
 int
@@ -1863,6 +2842,10 @@ dfs_punch(dfs_t *dfs, dfs_obj_t *obj, daos_off_t offset, daos_size_t len)
 	if (obj == NULL || !S_ISREG(obj->mode))
 		return -DER_INVAL;
 
+	rc = wb_sync(dfs, obj);
+	if (rc)
+		return rc;
+
 	incr_epoch(dfs);
 
 	/** simple truncate */
@@ -2047,6 +3030,8 @@ dfs_move(dfs_t *dfs, dfs_obj_t *parent, char *name, dfs_obj_t *new_parent,
 	}
 
 out:
+	dcache_invalidate(&dfs->dcache, parent->oid, name);
+	dcache_invalidate(&dfs->dcache, new_parent->oid, new_name);
 	if (entry.value) {
 		D_ASSERT(S_ISLNK(entry.mode));
 		free(entry.value);
@@ -2140,6 +3125,10 @@ dfs_exchange(dfs_t *dfs, dfs_obj_t *parent1, char *name1, dfs_obj_t *parent2,
 	}
 
 out:
+	dcache_invalidate(&dfs->dcache, parent1->oid, name1);
+	dcache_invalidate(&dfs->dcache, parent2->oid, name2);
+	dcache_invalidate(&dfs->dcache, parent2->oid, name1);
+	dcache_invalidate(&dfs->dcache, parent1->oid, name2);
 	if (entry1.value) {
 		D_ASSERT(S_ISLNK(entry1.mode));
 		free(entry1.value);
@@ -2158,11 +3147,15 @@ out:
 int
 dfs_sync(dfs_t *dfs)
 {
+	int wb_rc;
 	int rc;
 
 	if (dfs == NULL || !dfs->mounted)
 		return -DER_INVAL;
 
+	/** buffered writes are part of what gets committed */
+	wb_rc = wb_sync_all(dfs);
+
 	D_MUTEX_LOCK(&dfs->lock);
 
 	if (dfs->amode == O_RDWR) {
@@ -2189,9 +3182,12 @@ dfs_sync(dfs_t *dfs)
 		dfs->epoch = state.es_ghce;
 	}
 
+	/** updates by other mounts may be visible in the new epoch */
+	dcache_set_epoch(&dfs->dcache, dfs->epoch);
+	dfs->gen++;
 out:
 	D_MUTEX_UNLOCK(&dfs->lock);
-	return rc;
+	return rc == 0 ? wb_rc : rc;
 }
 static char *
 concat(const char *s1, const char *s2)
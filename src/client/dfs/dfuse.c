@@ -37,6 +37,7 @@
 #include <daos/common.h>
 #include "daos_fs.h"
 #include "daos_api.h"
+#include "dfuse.h"
 
 #define FUNC_ENTER(fmt, ...) \
 	fprintf(stderr, "%s [%d]: "fmt, __func__, __LINE__, ##__VA_ARGS__)
@@ -47,12 +48,14 @@ struct dfuse_data {
 	int		debug;
 	int		foreground;
 	int		singlethread;
+	int		lowlevel;
 	bool		destroy;
 	char		*mountpoint;
 	char		*pool;
 	char		*svcl;
 	char		*group;
 	struct fuse	*fuse;
+	struct dfuse_ll_opts ll_opts;
 };
 
 static struct dfuse_data dfuse_fs;
@@ -225,8 +228,8 @@ duuid_hash128(const char *name, void *hash, uint64_t *hi, uint64_t *lo)
 		*lo = hash_lo;
 } /* end duuid_hash128() */
 
-static int
-error_convert(int error)
+int
+dfuse_error_convert(int error)
 {
 	switch (error) {
 	case 0:
@@ -380,7 +383,7 @@ dfuse_getattr(const char *path, struct stat *stbuf, struct fuse_file_info *fi)
 
 	if (fi != NULL) {
 		rc = dfs_ostat(dfs, (dfs_obj_t *)fi->fh, stbuf);
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 	}
 
 	if (path == NULL)
@@ -407,7 +410,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -420,7 +423,7 @@ dfuse_truncate(const char *path, off_t size, struct fuse_file_info *fi)
 
 	if (fi != NULL) {
 		rc = dfs_punch(dfs, (dfs_obj_t *)fi->fh, size, DFS_MAX_FSIZE);
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 	}
 
 	if (path == NULL)
@@ -437,7 +440,7 @@ dfuse_truncate(const char *path, off_t size, struct fuse_file_info *fi)
 out:
 	if (obj)
 		dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 #define NUM_DIRENTS 10
@@ -466,7 +469,7 @@ dfuse_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
 		if (rc) {
 			fprintf(stderr, "Failed to lookup path %s (%d)\n",
 				path, rc);
-			return error_convert(rc);
+			return dfuse_error_convert(rc);
 		}
 		release = true;
 	}
@@ -491,7 +494,7 @@ dfuse_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
 out:
 	if (release && obj)
 		dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -534,7 +537,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -575,7 +578,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -619,7 +622,7 @@ out:
 		free(dir_name);
 	if (free_parent && parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -645,7 +648,7 @@ dfuse_read(const char *path, char *buf, size_t size, off_t offset,
 
 	rc = dfs_read(dfs, obj, sgl, offset, &actual);
 	if (rc)
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 
 	return actual;
 }
@@ -672,7 +675,7 @@ dfuse_write(const char *path, const char *buf, size_t size, off_t offset,
 
 	rc = dfs_write(dfs, obj, sgl, offset);
 	if (rc)
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 
 	return size;
 }
@@ -712,7 +715,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -753,7 +756,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -778,7 +781,7 @@ dfuse_readlink(const char *path, char *buf, size_t size)
 out:
 	if (obj)
 		dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -818,7 +821,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -858,7 +861,7 @@ out:
 		free(dir_name);
 	if (parent)
 		dfs_release(parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -870,7 +873,7 @@ dfuse_release(const char *path, struct fuse_file_info *fi)
 
 	if (fi != NULL) {
 		rc = dfs_release((dfs_obj_t *)fi->fh);
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 	}
 
 	return 0;
@@ -969,7 +972,7 @@ out:
 		dfs_release(parent);
 	if (new_parent)
 		dfs_release(new_parent);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -980,7 +983,7 @@ dfuse_sync(const char *path, int isdatasync, struct fuse_file_info *fi)
 	FUNC_ENTER("path = %s\n", path);
 
 	rc = dfs_sync(dfs);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -994,11 +997,11 @@ dfuse_setxattr(const char *path, const char *name, const char *val,
 
 	rc = dfs_lookup(dfs, path, O_RDWR, &obj, NULL);
 	if (rc)
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 
 	rc = dfs_setxattr(dfs, obj, name, val, size, flags);
 	dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -1011,7 +1014,7 @@ dfuse_getxattr(const char *path, const char *name, char *val, size_t size)
 
 	rc = dfs_lookup(dfs, path, O_RDONLY, &obj, NULL);
 	if (rc)
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 
 	rc = dfs_getxattr(dfs, obj, name, val, &size);
 	if (rc)
@@ -1020,7 +1023,7 @@ dfuse_getxattr(const char *path, const char *name, char *val, size_t size)
 	rc = (int)size;
 out:
 	dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -1033,7 +1036,7 @@ dfuse_listxattr(const char *path, char *list, size_t size)
 
 	rc = dfs_lookup(dfs, path, O_RDONLY, &obj, NULL);
 	if (rc)
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 
 	rc = dfs_listxattr(dfs, obj, list, &size);
 	if (rc)
@@ -1042,7 +1045,7 @@ dfuse_listxattr(const char *path, char *list, size_t size)
 	rc = (int)size;
 out:
 	dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static int
@@ -1055,11 +1058,11 @@ dfuse_removexattr(const char *path, const char *name)
 
 	rc = dfs_lookup(dfs, path, O_RDWR, &obj, NULL);
 	if (rc)
-		return error_convert(rc);
+		return dfuse_error_convert(rc);
 
 	rc = dfs_removexattr(dfs, obj, name);
 	dfs_release(obj);
-	return error_convert(rc);
+	return dfuse_error_convert(rc);
 }
 
 static void *
@@ -1113,6 +1116,16 @@ static void usage(const char *progname)
 "	-l		rank list of DAOS pool service ranks\n"
 "	-g		DAOS server group name to connect to\n"
 "	-r		Remove/Destroy the DAOS container when unmounted\n"
+"	-L, --lowlevel	use the inode based FUSE API (multi-threaded)\n"
+"\n"
+"Lowlevel Options:\n"
+"	--attr-timeout=SECS	kernel attribute cache timeout (default 1.0)\n"
+"	--entry-timeout=SECS	kernel dentry cache timeout (default 1.0)\n"
+"	--max-read=BYTES	largest read request\n"
+"	--max-write=BYTES	largest write request\n"
+"	--splice		move data with splice\n"
+"	--writeback-cache	cache writes in the kernel page cache\n"
+"	--no-readdirplus	do not return attributes with directory entries\n"
 "\n"
 "FUSE Options:\n",
 progname);
@@ -1133,6 +1146,15 @@ static struct fuse_opt dfuse_opts[] = {
 	DFUSE_OPT("-l %s", svcl, 0),
 	DFUSE_OPT("-g %s", group, 0),
 	DFUSE_OPT("-r", destroy, 1),
+	DFUSE_OPT("-L", lowlevel, 1),
+	DFUSE_OPT("--lowlevel", lowlevel, 1),
+	DFUSE_OPT("--attr-timeout=%lf", ll_opts.attr_timeout, 0),
+	DFUSE_OPT("--entry-timeout=%lf", ll_opts.entry_timeout, 0),
+	DFUSE_OPT("--max-read=%u", ll_opts.max_read, 0),
+	DFUSE_OPT("--max-write=%u", ll_opts.max_write, 0),
+	DFUSE_OPT("--splice", ll_opts.splice, 1),
+	DFUSE_OPT("--writeback-cache", ll_opts.writeback_cache, 1),
+	DFUSE_OPT("--no-readdirplus", ll_opts.no_readdirplus, 1),
 	FUSE_OPT_END
 };
 
@@ -1162,6 +1184,8 @@ int main(int argc, char *argv[])
 	int			rc;
 
 	memset(&dfuse_fs, 0, sizeof(dfuse_fs));
+	dfuse_fs.ll_opts.attr_timeout = 1.0;
+	dfuse_fs.ll_opts.entry_timeout = 1.0;
 	fuse_opt_parse(&args, &dfuse_fs, dfuse_opts, dfuse_opt_proc);
 
 	if (dfuse_fs.show_version) {
@@ -1173,9 +1197,10 @@ int main(int argc, char *argv[])
 		fuse_lib_help(&args);
 		exit(0);
 	}
-	if (!dfuse_fs.singlethread) {
+	if (!dfuse_fs.singlethread && !dfuse_fs.lowlevel) {
 		fprintf(stderr, "multi-threaded execution is not supported\n");
-		fprintf(stderr, "try `%s -s' for single threaded\n", argv[0]);
+		fprintf(stderr, "try `%s -s' for single threaded, or `%s -L'\n",
+			argv[0], argv[0]);
 		exit(1);
 	}
 
@@ -1276,6 +1301,17 @@ int main(int argc, char *argv[])
 		D_GOTO(out_cont, rc = 1);
 	}
 
+	if (dfuse_fs.lowlevel) {
+		if (dfuse_fs.debug)
+			fuse_opt_add_arg(&args, "-odebug");
+		rc = dfuse_ll_run(dfs, &args, dfuse_fs.mountpoint,
+				  &dfuse_fs.ll_opts,
+				  dfuse_fs.foreground || dfuse_fs.debug,
+				  dfuse_fs.singlethread);
+		fuse_opt_free_args(&args);
+		D_GOTO(out_dmount, rc);
+	}
+
 	dfuse_fs.fuse = fuse_new(&args, &dfuse_ops, sizeof(dfuse_ops), NULL);
 	if (dfuse_fs.fuse == NULL) {
 		fprintf(stderr, "Could not initialize dfuse fs");
@@ -1301,6 +1337,14 @@ out_fmount:
 out_fdest:
 	fuse_destroy(dfuse_fs.fuse);
 out_dmount:
+	if (dfuse_fs.debug) {
+		dfs_cache_stats_t stats;
+
+		if (dfs_cache_stats(dfs, &stats) == 0)
+			fprintf(stderr, "DFS lookup cache: "DF_U64" hits, "
+				DF_U64" misses, %u entries\n", stats.dcs_hits,
+				stats.dcs_misses, stats.dcs_entries);
+	}
 	dfs_umount(dfs, true);
 out_cont:
 	daos_cont_close(coh, NULL);
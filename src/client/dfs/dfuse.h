@@ -0,0 +1,71 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Definitions shared by the path based (dfuse.c) and the inode based
+ * (dfuse_ll.c) FUSE file systems of dfuse.
+ */
+#ifndef __DFUSE_H__
+#define __DFUSE_H__
+
+#include <fuse3/fuse.h>
+#include "daos_fs.h"
+
+/** tunables of the inode based (lowlevel) FUSE file system */
+struct dfuse_ll_opts {
+	/** seconds the kernel caches the attributes of an inode */
+	double		attr_timeout;
+	/** seconds the kernel caches a name to inode mapping */
+	double		entry_timeout;
+	/** largest read/write request, 0 for the FUSE default */
+	unsigned int	max_read;
+	unsigned int	max_write;
+	/** move data between the kernel and dfuse with splice */
+	int		splice;
+	/** let the kernel cache writes in the page cache */
+	int		writeback_cache;
+	/** disable READDIRPLUS, which returns attributes with the entries */
+	int		no_readdirplus;
+};
+
+/** Convert a DAOS error to a negative errno */
+int
+dfuse_error_convert(int error);
+
+/**
+ * Mount \a dfs on \a mountpoint with the inode based FUSE API and serve
+ * requests until the file system is unmounted.
+ *
+ * \param[in]	dfs		Mounted DFS namespace.
+ * \param[in]	args		FUSE command line arguments.
+ * \param[in]	mountpoint	Directory to mount on.
+ * \param[in]	opts		Lowlevel tunables.
+ * \param[in]	foreground	Do not daemonize.
+ * \param[in]	singlethread	Serve requests from a single thread.
+ *
+ * \return			0 on success, 1 on failure.
+ */
+int
+dfuse_ll_run(dfs_t *dfs, struct fuse_args *args, const char *mountpoint,
+	     struct dfuse_ll_opts *opts, bool foreground, bool singlethread);
+
+#endif /* __DFUSE_H__ */
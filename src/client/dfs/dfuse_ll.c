@@ -0,0 +1,1281 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Inode based (lowlevel FUSE API) file system of dfuse.
+ *
+ * The kernel resolves paths one component at a time and caches the dentries
+ * and attributes it is handed for entry_timeout/attr_timeout seconds, so a
+ * request for a cached path costs no lookup at all, and an uncached one costs
+ * a single lookup relative to the already open parent directory instead of a
+ * walk from the root.
+ *
+ * Every inode the kernel knows about is an entry of the inode table, keyed by
+ * the DAOS object ID and holding the open DFS object. The inode number handed
+ * to the kernel is the address of the entry (FUSE_ROOT_ID for the root), which
+ * stays valid until the kernel forgets the last lookup of the inode and the
+ * last open handle of it is released.
+ */
+#define D_LOGFAC	DD_FAC(dfs)
+
+#include <fuse3/fuse_lowlevel.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include <daos/common.h>
+#include <gurt/hash.h>
+#include "daos_api.h"
+#include "dfuse.h"
+
+/** inode number of directory entries returned by a plain readdir */
+#define DFUSE_UNKNOWN_INO	0xffffffff
+/** number of names fetched from DFS per dfs_readdir() call */
+#define DFUSE_READDIR_NR	64
+/** size of the buffer used to query the size of the xattr list */
+#define DFUSE_XATTR_LIST_MAX	(64 * 1024)
+
+struct dfuse_inode {
+	/** link in the inode table */
+	d_list_t		ie_link;
+	/** key in the inode table, a synthetic unique ID for symlinks */
+	daos_obj_id_t		ie_oid;
+	/** references of the inode table and of the open handles */
+	int			ie_ref;
+	/** kernel lookups not forgotten yet, protected by dl_lock */
+	uint64_t		ie_nlookup;
+	/** protects ie_obj, which is replaced when the entry moves */
+	pthread_rwlock_t	ie_lock;
+	dfs_obj_t		*ie_obj;
+	/** attributes cached for attr_timeout seconds */
+	pthread_mutex_t		ie_stat_lock;
+	struct stat		ie_stat;
+	struct timespec		ie_stat_time;
+	bool			ie_stat_valid;
+};
+
+struct dfuse_dir_handle {
+	/** directory inode, referenced while the directory is open */
+	struct dfuse_inode	*dh_ie;
+	daos_anchor_t		dh_anchor;
+	/** offset of the next entry, "." and ".." are offsets 0 and 1 */
+	off_t			dh_offset;
+	/** names fetched from DFS and not returned yet */
+	struct dirent		dh_ents[DFUSE_READDIR_NR];
+	/** attributes of dh_ents, valid if dh_plus */
+	struct stat		dh_stbufs[DFUSE_READDIR_NR];
+	uint32_t		dh_nr;
+	uint32_t		dh_idx;
+	/** dh_ents were fetched by dfs_readdirplus() */
+	bool			dh_plus;
+};
+
+struct dfuse_ll {
+	dfs_t			*dl_dfs;
+	struct dfuse_ll_opts	*dl_opts;
+	/** inode table, keyed by object ID */
+	struct d_hash_table	*dl_inodes;
+	/** serializes lookups with forgets of the same inode */
+	pthread_mutex_t		dl_lock;
+	struct dfuse_inode	*dl_root;
+	/** last synthetic key handed out to a symlink */
+	uint64_t		dl_symlink_key;
+};
+
+static struct dfuse_ll dfuse_ll;
+
+static inline struct dfuse_inode *
+dfuse_inode_obj(d_list_t *rlink)
+{
+	return container_of(rlink, struct dfuse_inode, ie_link);
+}
+
+static bool
+dfuse_inode_key_cmp(struct d_hash_table *htable, d_list_t *rlink,
+		    const void *key, unsigned int ksize)
+{
+	struct dfuse_inode *ie = dfuse_inode_obj(rlink);
+
+	D_ASSERTF(ksize == sizeof(daos_obj_id_t), "%u\n", ksize);
+	return memcmp(&ie->ie_oid, key, ksize) == 0;
+}
+
+static void
+dfuse_inode_rec_addref(struct d_hash_table *htable, d_list_t *rlink)
+{
+	dfuse_inode_obj(rlink)->ie_ref++;
+}
+
+static bool
+dfuse_inode_rec_decref(struct d_hash_table *htable, d_list_t *rlink)
+{
+	struct dfuse_inode *ie = dfuse_inode_obj(rlink);
+
+	D_ASSERTF(ie->ie_ref > 0, "%d\n", ie->ie_ref);
+	ie->ie_ref--;
+	return ie->ie_ref == 0;
+}
+
+static void
+dfuse_inode_rec_free(struct d_hash_table *htable, d_list_t *rlink)
+{
+	struct dfuse_inode *ie = dfuse_inode_obj(rlink);
+
+	D_ASSERT(d_hash_rec_unlinked(&ie->ie_link));
+	D_ASSERTF(ie->ie_ref == 0, "%d\n", ie->ie_ref);
+	dfs_release(ie->ie_obj);
+	D_RWLOCK_DESTROY(&ie->ie_lock);
+	D_MUTEX_DESTROY(&ie->ie_stat_lock);
+	D_FREE_PTR(ie);
+}
+
+static d_hash_table_ops_t dfuse_inode_hash_ops = {
+	.hop_key_cmp	= dfuse_inode_key_cmp,
+	.hop_rec_addref	= dfuse_inode_rec_addref,
+	.hop_rec_decref	= dfuse_inode_rec_decref,
+	.hop_rec_free	= dfuse_inode_rec_free
+};
+
+static inline fuse_ino_t
+dfuse_inode2ino(struct dfuse_inode *ie)
+{
+	if (ie == dfuse_ll.dl_root)
+		return FUSE_ROOT_ID;
+	return (fuse_ino_t)(uintptr_t)ie;
+}
+
+static inline struct dfuse_inode *
+dfuse_ino2inode(fuse_ino_t ino)
+{
+	if (ino == FUSE_ROOT_ID)
+		return dfuse_ll.dl_root;
+	return (struct dfuse_inode *)(uintptr_t)ino;
+}
+
+static void
+dfuse_inode_put(struct dfuse_inode *ie)
+{
+	d_hash_rec_decref(dfuse_ll.dl_inodes, &ie->ie_link);
+}
+
+/** Replace the DFS object of \a ie by \a obj, looked up more recently */
+static void
+dfuse_inode_swap(struct dfuse_inode *ie, dfs_obj_t *obj)
+{
+	dfs_obj_t *old;
+
+	D_RWLOCK_WRLOCK(&ie->ie_lock);
+	old = ie->ie_obj;
+	ie->ie_obj = obj;
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	dfs_release(old);
+}
+
+static int
+dfuse_inode_key(dfs_obj_t *obj, mode_t mode, daos_obj_id_t *oid)
+{
+	/** symlinks have no object, never share their inodes */
+	if (S_ISLNK(mode)) {
+		oid->hi = ~0ULL;
+		oid->lo = ++dfuse_ll.dl_symlink_key;
+		return 0;
+	}
+	return dfs_obj2id(obj, oid);
+}
+
+/**
+ * Take a kernel lookup reference on the inode of \a obj, adding it to the
+ * inode table if it is not there yet. \a obj is consumed: it either becomes
+ * the object of a new inode, or replaces the object of the cached inode so
+ * that the latter follows renames done through other mounts.
+ */
+static int
+dfuse_inode_get(dfs_obj_t *obj, mode_t mode, struct dfuse_inode **iep)
+{
+	struct dfuse_inode	*ie;
+	daos_obj_id_t		oid;
+	d_list_t		*rlink;
+	int			rc;
+
+	D_MUTEX_LOCK(&dfuse_ll.dl_lock);
+	rc = dfuse_inode_key(obj, mode, &oid);
+	if (rc)
+		D_GOTO(err, rc);
+
+	rlink = d_hash_rec_find(dfuse_ll.dl_inodes, &oid, sizeof(oid));
+	if (rlink != NULL) {
+		ie = dfuse_inode_obj(rlink);
+		ie->ie_nlookup++;
+		D_MUTEX_UNLOCK(&dfuse_ll.dl_lock);
+		dfuse_inode_swap(ie, obj);
+		/** the lookup is covered by the reference of the table */
+		dfuse_inode_put(ie);
+		*iep = ie;
+		return 0;
+	}
+
+	D_ALLOC_PTR(ie);
+	if (ie == NULL)
+		D_GOTO(err, rc = -DER_NOMEM);
+
+	rc = D_RWLOCK_INIT(&ie->ie_lock, NULL);
+	if (rc)
+		D_GOTO(err_ie, rc = -DER_NOMEM);
+	rc = D_MUTEX_INIT(&ie->ie_stat_lock, NULL);
+	if (rc)
+		D_GOTO(err_rwlock, rc = -DER_NOMEM);
+
+	ie->ie_oid = oid;
+	ie->ie_obj = obj;
+	ie->ie_nlookup = 1;
+
+	rc = d_hash_rec_insert(dfuse_ll.dl_inodes, &ie->ie_oid,
+			       sizeof(ie->ie_oid), &ie->ie_link, true);
+	if (rc)
+		D_GOTO(err_mutex, rc);
+	D_MUTEX_UNLOCK(&dfuse_ll.dl_lock);
+
+	*iep = ie;
+	return 0;
+
+err_mutex:
+	D_MUTEX_DESTROY(&ie->ie_stat_lock);
+err_rwlock:
+	D_RWLOCK_DESTROY(&ie->ie_lock);
+err_ie:
+	D_FREE_PTR(ie);
+err:
+	D_MUTEX_UNLOCK(&dfuse_ll.dl_lock);
+	dfs_release(obj);
+	return rc;
+}
+
+/** Drop \a nlookup kernel lookups of \a ie */
+static void
+dfuse_inode_forget(struct dfuse_inode *ie, uint64_t nlookup)
+{
+	if (ie == dfuse_ll.dl_root)
+		return;
+
+	D_MUTEX_LOCK(&dfuse_ll.dl_lock);
+	D_ASSERTF(ie->ie_nlookup >= nlookup, DF_U64" < "DF_U64"\n",
+		  ie->ie_nlookup, nlookup);
+	ie->ie_nlookup -= nlookup;
+	if (ie->ie_nlookup == 0)
+		d_hash_rec_delete_at(dfuse_ll.dl_inodes, &ie->ie_link);
+	D_MUTEX_UNLOCK(&dfuse_ll.dl_lock);
+}
+
+static void
+dfuse_inode_invalidate(struct dfuse_inode *ie)
+{
+	D_MUTEX_LOCK(&ie->ie_stat_lock);
+	ie->ie_stat_valid = false;
+	D_MUTEX_UNLOCK(&ie->ie_stat_lock);
+}
+
+static double
+dfuse_time_diff(struct timespec *end, struct timespec *start)
+{
+	return (end->tv_sec - start->tv_sec) +
+	       (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Stat \a ie, from the attributes cached in the inode if they are younger
+ * than attr_timeout.
+ */
+static int
+dfuse_inode_stat(struct dfuse_inode *ie, struct stat *stbuf)
+{
+	struct timespec	now;
+	int		rc;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	D_MUTEX_LOCK(&ie->ie_stat_lock);
+	if (ie->ie_stat_valid &&
+	    dfuse_time_diff(&now, &ie->ie_stat_time) <
+	    dfuse_ll.dl_opts->attr_timeout) {
+		*stbuf = ie->ie_stat;
+		D_MUTEX_UNLOCK(&ie->ie_stat_lock);
+		return 0;
+	}
+	D_MUTEX_UNLOCK(&ie->ie_stat_lock);
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_ostat(dfuse_ll.dl_dfs, ie->ie_obj, stbuf);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	if (rc)
+		return rc;
+	stbuf->st_ino = dfuse_inode2ino(ie);
+
+	D_MUTEX_LOCK(&ie->ie_stat_lock);
+	ie->ie_stat = *stbuf;
+	ie->ie_stat_time = now;
+	ie->ie_stat_valid = true;
+	D_MUTEX_UNLOCK(&ie->ie_stat_lock);
+	return 0;
+}
+
+/** Look \a name up in \a parent, and take a kernel lookup on its inode */
+static int
+dfuse_ll_lookup_inode(struct dfuse_inode *parent, const char *name,
+		      struct dfuse_inode **iep)
+{
+	dfs_obj_t	*obj;
+	mode_t		mode;
+	int		rc;
+
+	D_RWLOCK_RDLOCK(&parent->ie_lock);
+	rc = dfs_lookup_rel(dfuse_ll.dl_dfs, parent->ie_obj, name, O_RDWR,
+			    &obj, &mode);
+	D_RWLOCK_UNLOCK(&parent->ie_lock);
+	if (rc)
+		return rc;
+
+	return dfuse_inode_get(obj, mode, iep);
+}
+
+/**
+ * Look \a name up in \a parent and fill \a e for the kernel. On success the
+ * inode of the entry holds one more kernel lookup.
+ */
+static int
+dfuse_ll_entry(struct dfuse_inode *parent, const char *name,
+	       struct fuse_entry_param *e)
+{
+	struct dfuse_inode	*ie;
+	int			rc;
+
+	rc = dfuse_ll_lookup_inode(parent, name, &ie);
+	if (rc)
+		return rc;
+
+	memset(e, 0, sizeof(*e));
+	rc = dfuse_inode_stat(ie, &e->attr);
+	if (rc) {
+		dfuse_inode_forget(ie, 1);
+		return rc;
+	}
+
+	e->ino = dfuse_inode2ino(ie);
+	e->attr_timeout = dfuse_ll.dl_opts->attr_timeout;
+	e->entry_timeout = dfuse_ll.dl_opts->entry_timeout;
+	return 0;
+}
+
+/**
+ * Same as dfuse_ll_entry(), but with the attributes \a stbuf returned by
+ * dfs_readdirplus() instead of a stat of the entry. The lookup is served by
+ * the DFS lookup cache, which dfs_readdirplus() has just filled.
+ */
+static int
+dfuse_ll_entry_plus(struct dfuse_inode *parent, const char *name,
+		    struct stat *stbuf, struct fuse_entry_param *e)
+{
+	struct dfuse_inode	*ie;
+	int			rc;
+
+	rc = dfuse_ll_lookup_inode(parent, name, &ie);
+	if (rc)
+		return rc;
+
+	memset(e, 0, sizeof(*e));
+	e->attr = *stbuf;
+	e->ino = dfuse_inode2ino(ie);
+	e->attr.st_ino = e->ino;
+	e->entry_timeout = dfuse_ll.dl_opts->entry_timeout;
+	/** file size is not returned, let the kernel get it before using it */
+	if (!S_ISREG(stbuf->st_mode))
+		e->attr_timeout = dfuse_ll.dl_opts->attr_timeout;
+	return 0;
+}
+
+/**
+ * Make the cached inode of \a name in \a parent, if any, follow the entry
+ * after it was moved there.
+ */
+static void
+dfuse_ll_refresh(struct dfuse_inode *parent, const char *name)
+{
+	struct dfuse_inode	*ie;
+	daos_obj_id_t		oid;
+	d_list_t		*rlink;
+	dfs_obj_t		*obj;
+	mode_t			mode;
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&parent->ie_lock);
+	rc = dfs_lookup_rel(dfuse_ll.dl_dfs, parent->ie_obj, name, O_RDWR,
+			    &obj, &mode);
+	D_RWLOCK_UNLOCK(&parent->ie_lock);
+	if (rc)
+		return;
+
+	/** a symlink object only carries its value, no need to refresh */
+	if (S_ISLNK(mode) || dfs_obj2id(obj, &oid) != 0) {
+		dfs_release(obj);
+		return;
+	}
+
+	rlink = d_hash_rec_find(dfuse_ll.dl_inodes, &oid, sizeof(oid));
+	if (rlink == NULL) {
+		dfs_release(obj);
+		return;
+	}
+
+	ie = dfuse_inode_obj(rlink);
+	dfuse_inode_swap(ie, obj);
+	dfuse_inode_invalidate(ie);
+	dfuse_inode_put(ie);
+}
+
+static void
+dfuse_ll_reply_err(fuse_req_t req, int rc)
+{
+	int err;
+
+	if (rc == 0) {
+		fuse_reply_err(req, 0);
+		return;
+	}
+
+	err = -dfuse_error_convert(rc);
+	/** DAOS errors without an errno equivalent */
+	if (err <= 0 || err >= 1000)
+		err = EIO;
+	fuse_reply_err(req, err);
+}
+
+static void
+dfuse_ll_init(void *userdata, struct fuse_conn_info *conn)
+{
+	struct dfuse_ll_opts *opts = dfuse_ll.dl_opts;
+
+	if (opts->max_write)
+		conn->max_write = opts->max_write;
+	if (opts->max_read)
+		conn->max_read = opts->max_read;
+
+	if (opts->splice)
+		conn->want |= conn->capable & (FUSE_CAP_SPLICE_READ |
+					       FUSE_CAP_SPLICE_WRITE |
+					       FUSE_CAP_SPLICE_MOVE);
+	else
+		conn->want &= ~(FUSE_CAP_SPLICE_READ | FUSE_CAP_SPLICE_WRITE |
+				FUSE_CAP_SPLICE_MOVE);
+
+	if (opts->writeback_cache &&
+	    (conn->capable & FUSE_CAP_WRITEBACK_CACHE))
+		conn->want |= FUSE_CAP_WRITEBACK_CACHE;
+	else
+		opts->writeback_cache = 0;
+
+	if (opts->no_readdirplus)
+		conn->want &= ~(FUSE_CAP_READDIRPLUS |
+				FUSE_CAP_READDIRPLUS_AUTO);
+	else
+		conn->want |= conn->capable & FUSE_CAP_READDIRPLUS;
+}
+
+static void
+dfuse_ll_lookup(fuse_req_t req, fuse_ino_t parent, const char *name)
+{
+	struct fuse_entry_param	e;
+	int			rc;
+
+	rc = dfuse_ll_entry(dfuse_ino2inode(parent), name, &e);
+	if (rc == -DER_NONEXIST) {
+		/** let the kernel cache the miss as a negative dentry */
+		memset(&e, 0, sizeof(e));
+		e.entry_timeout = dfuse_ll.dl_opts->entry_timeout;
+		fuse_reply_entry(req, &e);
+		return;
+	}
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	fuse_reply_entry(req, &e);
+}
+
+static void
+dfuse_ll_forget(fuse_req_t req, fuse_ino_t ino, uint64_t nlookup)
+{
+	dfuse_inode_forget(dfuse_ino2inode(ino), nlookup);
+	fuse_reply_none(req);
+}
+
+static void
+dfuse_ll_forget_multi(fuse_req_t req, size_t count,
+		      struct fuse_forget_data *forgets)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		dfuse_inode_forget(dfuse_ino2inode(forgets[i].ino),
+				   forgets[i].nlookup);
+	fuse_reply_none(req);
+}
+
+static void
+dfuse_ll_getattr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+{
+	struct stat	stbuf;
+	int		rc;
+
+	rc = dfuse_inode_stat(dfuse_ino2inode(ino), &stbuf);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	fuse_reply_attr(req, &stbuf, dfuse_ll.dl_opts->attr_timeout);
+}
+
+static void
+dfuse_ll_setattr(fuse_req_t req, fuse_ino_t ino, struct stat *attr,
+		 int to_set, struct fuse_file_info *fi)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	struct stat		stbuf;
+	int			rc;
+
+	/** DFS has no way to change the mode or the owner of an entry */
+	if (to_set & (FUSE_SET_ATTR_MODE | FUSE_SET_ATTR_UID |
+		      FUSE_SET_ATTR_GID)) {
+		fuse_reply_err(req, ENOSYS);
+		return;
+	}
+
+	if (to_set & FUSE_SET_ATTR_SIZE) {
+		D_RWLOCK_RDLOCK(&ie->ie_lock);
+		rc = dfs_punch(dfuse_ll.dl_dfs, ie->ie_obj, attr->st_size,
+			       DFS_MAX_FSIZE);
+		D_RWLOCK_UNLOCK(&ie->ie_lock);
+		if (rc) {
+			dfuse_ll_reply_err(req, rc);
+			return;
+		}
+		dfuse_inode_invalidate(ie);
+	}
+
+	rc = dfuse_inode_stat(ie, &stbuf);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	fuse_reply_attr(req, &stbuf, dfuse_ll.dl_opts->attr_timeout);
+}
+
+static void
+dfuse_ll_readlink(fuse_req_t req, fuse_ino_t ino)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	char			buf[PATH_MAX];
+	daos_size_t		size = sizeof(buf);
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_get_symlink_value(ie->ie_obj, buf, &size);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	if (size > sizeof(buf)) {
+		fuse_reply_err(req, ENAMETOOLONG);
+		return;
+	}
+	fuse_reply_readlink(req, buf);
+}
+
+/** Reply to a request that created \a name in \a parent */
+static void
+dfuse_ll_reply_new(fuse_req_t req, struct dfuse_inode *parent,
+		   const char *name)
+{
+	struct fuse_entry_param	e;
+	int			rc;
+
+	dfuse_inode_invalidate(parent);
+	rc = dfuse_ll_entry(parent, name, &e);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	fuse_reply_entry(req, &e);
+}
+
+static void
+dfuse_ll_mkdir(fuse_req_t req, fuse_ino_t parent, const char *name,
+	       mode_t mode)
+{
+	struct dfuse_inode	*pie = dfuse_ino2inode(parent);
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&pie->ie_lock);
+	rc = dfs_mkdir(dfuse_ll.dl_dfs, pie->ie_obj, name, mode);
+	D_RWLOCK_UNLOCK(&pie->ie_lock);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	dfuse_ll_reply_new(req, pie, name);
+}
+
+static void
+dfuse_ll_symlink(fuse_req_t req, const char *link, fuse_ino_t parent,
+		 const char *name)
+{
+	struct dfuse_inode	*pie = dfuse_ino2inode(parent);
+	dfs_obj_t		*sym;
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&pie->ie_lock);
+	rc = dfs_open(dfuse_ll.dl_dfs, pie->ie_obj, name, S_IFLNK, O_CREAT, 0,
+		      link, &sym);
+	D_RWLOCK_UNLOCK(&pie->ie_lock);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	dfs_release(sym);
+	dfuse_ll_reply_new(req, pie, name);
+}
+
+static void
+dfuse_ll_remove(fuse_req_t req, fuse_ino_t parent, const char *name)
+{
+	struct dfuse_inode	*pie = dfuse_ino2inode(parent);
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&pie->ie_lock);
+	rc = dfs_remove(dfuse_ll.dl_dfs, pie->ie_obj, name, false);
+	D_RWLOCK_UNLOCK(&pie->ie_lock);
+	dfuse_inode_invalidate(pie);
+	dfuse_ll_reply_err(req, rc);
+}
+
+static void
+dfuse_ll_rename(fuse_req_t req, fuse_ino_t parent, const char *name,
+		fuse_ino_t newparent, const char *newname, unsigned int flags)
+{
+	struct dfuse_inode	*pie = dfuse_ino2inode(parent);
+	struct dfuse_inode	*npie = dfuse_ino2inode(newparent);
+	dfs_obj_t		*obj;
+	int			rc;
+
+	if (flags & ~(RENAME_NOREPLACE | RENAME_EXCHANGE)) {
+		fuse_reply_err(req, EINVAL);
+		return;
+	}
+
+	D_RWLOCK_RDLOCK(&pie->ie_lock);
+	if (npie != pie)
+		D_RWLOCK_RDLOCK(&npie->ie_lock);
+
+	if (flags & RENAME_EXCHANGE) {
+		rc = dfs_exchange(dfuse_ll.dl_dfs, pie->ie_obj, (char *)name,
+				  npie->ie_obj, (char *)newname);
+		D_GOTO(out, rc);
+	}
+
+	if (flags & RENAME_NOREPLACE) {
+		rc = dfs_lookup_rel(dfuse_ll.dl_dfs, npie->ie_obj, newname,
+				    O_RDONLY, &obj, NULL);
+		if (rc == 0) {
+			dfs_release(obj);
+			D_GOTO(out, rc = -DER_EXIST);
+		}
+		if (rc != -DER_NONEXIST)
+			D_GOTO(out, rc);
+	}
+
+	rc = dfs_move(dfuse_ll.dl_dfs, pie->ie_obj, (char *)name, npie->ie_obj,
+		      (char *)newname);
+
+out:
+	if (npie != pie)
+		D_RWLOCK_UNLOCK(&npie->ie_lock);
+	D_RWLOCK_UNLOCK(&pie->ie_lock);
+
+	if (rc == 0) {
+		/** open DFS objects locate their entry by parent and name */
+		dfuse_ll_refresh(npie, newname);
+		if (flags & RENAME_EXCHANGE)
+			dfuse_ll_refresh(pie, name);
+	}
+	dfuse_inode_invalidate(pie);
+	dfuse_inode_invalidate(npie);
+	dfuse_ll_reply_err(req, rc);
+}
+
+static void
+dfuse_ll_open(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+{
+	struct dfuse_inode *ie = dfuse_ino2inode(ino);
+
+	d_hash_rec_addref(dfuse_ll.dl_inodes, &ie->ie_link);
+	fi->fh = (uint64_t)(uintptr_t)ie;
+	fuse_reply_open(req, fi);
+}
+
+static void
+dfuse_ll_create(fuse_req_t req, fuse_ino_t parent, const char *name,
+		mode_t mode, struct fuse_file_info *fi)
+{
+	struct dfuse_inode	*pie = dfuse_ino2inode(parent);
+	struct fuse_entry_param	e;
+	dfs_obj_t		*obj;
+	int			rc;
+
+	/** the inode object is shared by all handles, always open it RW */
+	D_RWLOCK_RDLOCK(&pie->ie_lock);
+	rc = dfs_open(dfuse_ll.dl_dfs, pie->ie_obj, name, S_IFREG | mode,
+		      (fi->flags & ~O_ACCMODE) | O_RDWR, DAOS_OC_LARGE_RW,
+		      NULL, &obj);
+	D_RWLOCK_UNLOCK(&pie->ie_lock);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+	dfs_release(obj);
+
+	dfuse_inode_invalidate(pie);
+	rc = dfuse_ll_entry(pie, name, &e);
+	if (rc) {
+		dfuse_ll_reply_err(req, rc);
+		return;
+	}
+
+	d_hash_rec_addref(dfuse_ll.dl_inodes,
+			  &dfuse_ino2inode(e.ino)->ie_link);
+	fi->fh = (uint64_t)(uintptr_t)dfuse_ino2inode(e.ino);
+	fuse_reply_create(req, &e, fi);
+}
+
+static void
+dfuse_ll_release(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+{
+	dfuse_inode_put((struct dfuse_inode *)(uintptr_t)fi->fh);
+	fuse_reply_err(req, 0);
+}
+
+static void
+dfuse_ll_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
+	      struct fuse_file_info *fi)
+{
+	struct dfuse_inode	*ie = (struct dfuse_inode *)(uintptr_t)fi->fh;
+	daos_sg_list_t		sgl;
+	daos_iov_t		iov;
+	daos_size_t		read_size = 0;
+	char			*buf;
+	int			rc;
+
+	D_ALLOC(buf, size);
+	if (buf == NULL) {
+		fuse_reply_err(req, ENOMEM);
+		return;
+	}
+
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 0;
+	daos_iov_set(&iov, buf, size);
+	sgl.sg_iovs = &iov;
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_read(dfuse_ll.dl_dfs, ie->ie_obj, sgl, off, &read_size);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	if (rc)
+		dfuse_ll_reply_err(req, rc);
+	else
+		fuse_reply_buf(req, buf, read_size);
+	D_FREE(buf);
+}
+
+static void
+dfuse_ll_write_buf(fuse_req_t req, fuse_ino_t ino, struct fuse_bufvec *bufv,
+		   off_t off, struct fuse_file_info *fi)
+{
+	struct dfuse_inode	*ie = (struct dfuse_inode *)(uintptr_t)fi->fh;
+	size_t			size = fuse_buf_size(bufv);
+	struct fuse_bufvec	dst = FUSE_BUFVEC_INIT(size);
+	daos_sg_list_t		sgl;
+	daos_iov_t		iov;
+	char			*buf = NULL;
+	ssize_t			copied;
+	int			rc;
+
+	/** write straight from the request buffer when it is in memory */
+	if (bufv->count == 1 && bufv->idx == 0 &&
+	    !(bufv->buf[0].flags & FUSE_BUF_IS_FD)) {
+		daos_iov_set(&iov, (char *)bufv->buf[0].mem + bufv->off,
+			     size);
+	} else {
+		D_ALLOC(buf, size);
+		if (buf == NULL) {
+			fuse_reply_err(req, ENOMEM);
+			return;
+		}
+		dst.buf[0].mem = buf;
+		copied = fuse_buf_copy(&dst, bufv, 0);
+		if (copied < 0) {
+			fuse_reply_err(req, -copied);
+			D_FREE(buf);
+			return;
+		}
+		size = copied;
+		daos_iov_set(&iov, buf, size);
+	}
+
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 0;
+	sgl.sg_iovs = &iov;
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_write(dfuse_ll.dl_dfs, ie->ie_obj, sgl, off);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	dfuse_inode_invalidate(ie);
+	if (rc)
+		dfuse_ll_reply_err(req, rc);
+	else
+		fuse_reply_write(req, size);
+	if (buf)
+		D_FREE(buf);
+}
+
+static void
+dfuse_ll_fsync(fuse_req_t req, fuse_ino_t ino, int datasync,
+	       struct fuse_file_info *fi)
+{
+	dfuse_ll_reply_err(req, dfs_sync(dfuse_ll.dl_dfs));
+}
+
+static void
+dfuse_ll_opendir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	struct dfuse_dir_handle	*dh;
+
+	D_ALLOC_PTR(dh);
+	if (dh == NULL) {
+		fuse_reply_err(req, ENOMEM);
+		return;
+	}
+
+	d_hash_rec_addref(dfuse_ll.dl_inodes, &ie->ie_link);
+	dh->dh_ie = ie;
+	fi->fh = (uint64_t)(uintptr_t)dh;
+	fuse_reply_open(req, fi);
+}
+
+static void
+dfuse_dir_rewind(struct dfuse_dir_handle *dh)
+{
+	memset(&dh->dh_anchor, 0, sizeof(dh->dh_anchor));
+	dh->dh_offset = 0;
+	dh->dh_nr = 0;
+	dh->dh_idx = 0;
+}
+
+/**
+ * Return the name at the current offset of \a dh, NULL at the end. A new
+ * batch of names is fetched with their attributes if \a plus is true.
+ */
+static int
+dfuse_dir_peek(struct dfuse_dir_handle *dh, bool plus, const char **name)
+{
+	struct dfuse_inode	*ie = dh->dh_ie;
+	int			rc;
+
+	if (dh->dh_offset < 2) {
+		*name = dh->dh_offset == 0 ? "." : "..";
+		return 0;
+	}
+
+	while (dh->dh_idx == dh->dh_nr) {
+		if (daos_anchor_is_eof(&dh->dh_anchor)) {
+			*name = NULL;
+			return 0;
+		}
+
+		dh->dh_idx = 0;
+		dh->dh_nr = DFUSE_READDIR_NR;
+		dh->dh_plus = plus;
+		D_RWLOCK_RDLOCK(&ie->ie_lock);
+		if (plus)
+			rc = dfs_readdirplus(dfuse_ll.dl_dfs, ie->ie_obj,
+					     &dh->dh_anchor, &dh->dh_nr,
+					     dh->dh_ents, dh->dh_stbufs);
+		else
+			rc = dfs_readdir(dfuse_ll.dl_dfs, ie->ie_obj,
+					 &dh->dh_anchor, &dh->dh_nr,
+					 dh->dh_ents);
+		D_RWLOCK_UNLOCK(&ie->ie_lock);
+		if (rc) {
+			dh->dh_nr = 0;
+			return rc;
+		}
+	}
+
+	*name = dh->dh_ents[dh->dh_idx].d_name;
+	return 0;
+}
+
+static void
+dfuse_dir_advance(struct dfuse_dir_handle *dh)
+{
+	if (dh->dh_offset >= 2)
+		dh->dh_idx++;
+	dh->dh_offset++;
+}
+
+static void
+dfuse_ll_readdir_common(fuse_req_t req, size_t size, off_t off,
+			struct fuse_file_info *fi, bool plus)
+{
+	struct dfuse_dir_handle	*dh = (struct dfuse_dir_handle *)fi->fh;
+	struct fuse_entry_param	e;
+	const char		*name;
+	size_t			pos = 0;
+	size_t			len;
+	char			*buf;
+	int			rc = 0;
+
+	/** the anchor only moves forward, restart for any other offset */
+	if (off != dh->dh_offset) {
+		dfuse_dir_rewind(dh);
+		while (dh->dh_offset < off) {
+			rc = dfuse_dir_peek(dh, plus, &name);
+			if (rc || name == NULL)
+				break;
+			dfuse_dir_advance(dh);
+		}
+		if (rc) {
+			dfuse_ll_reply_err(req, rc);
+			return;
+		}
+	}
+
+	D_ALLOC(buf, size);
+	if (buf == NULL) {
+		fuse_reply_err(req, ENOMEM);
+		return;
+	}
+
+	while (pos < size) {
+		rc = dfuse_dir_peek(dh, plus, &name);
+		if (rc || name == NULL)
+			break;
+
+		memset(&e, 0, sizeof(e));
+		if (!plus) {
+			e.attr.st_ino = DFUSE_UNKNOWN_INO;
+			len = fuse_add_direntry(req, buf + pos, size - pos,
+						name, &e.attr,
+						dh->dh_offset + 1);
+			if (len > size - pos)
+				break;
+		} else if (dh->dh_offset < 2) {
+			/** the kernel does not instantiate "." and ".." */
+			e.attr.st_ino = dfuse_inode2ino(dh->dh_ie);
+			e.attr.st_mode = S_IFDIR;
+			len = fuse_add_direntry_plus(req, buf + pos,
+						     size - pos, name, &e,
+						     dh->dh_offset + 1);
+			if (len > size - pos)
+				break;
+		} else {
+			struct stat *stbuf = &dh->dh_stbufs[dh->dh_idx];
+
+			/** the batch may have been fetched by readdir */
+			if (dh->dh_plus)
+				rc = dfuse_ll_entry_plus(dh->dh_ie, name, stbuf,
+							 &e);
+			else
+				rc = dfuse_ll_entry(dh->dh_ie, name, &e);
+			if (rc == -DER_NONEXIST) {
+				/** removed since it was listed */
+				rc = 0;
+				dfuse_dir_advance(dh);
+				continue;
+			}
+			if (rc)
+				break;
+			len = fuse_add_direntry_plus(req, buf + pos,
+						     size - pos, name, &e,
+						     dh->dh_offset + 1);
+			if (len > size - pos) {
+				dfuse_inode_forget(dfuse_ino2inode(e.ino), 1);
+				break;
+			}
+		}
+		pos += len;
+		dfuse_dir_advance(dh);
+	}
+
+	if (rc && pos == 0)
+		dfuse_ll_reply_err(req, rc);
+	else
+		fuse_reply_buf(req, buf, pos);
+	D_FREE(buf);
+}
+
+static void
+dfuse_ll_readdir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
+		 struct fuse_file_info *fi)
+{
+	dfuse_ll_readdir_common(req, size, off, fi, false);
+}
+
+static void
+dfuse_ll_readdirplus(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
+		     struct fuse_file_info *fi)
+{
+	dfuse_ll_readdir_common(req, size, off, fi, true);
+}
+
+static void
+dfuse_ll_releasedir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
+{
+	struct dfuse_dir_handle *dh = (struct dfuse_dir_handle *)fi->fh;
+
+	dfuse_inode_put(dh->dh_ie);
+	D_FREE_PTR(dh);
+	fuse_reply_err(req, 0);
+}
+
+static void
+dfuse_ll_setxattr(fuse_req_t req, fuse_ino_t ino, const char *name,
+		  const char *value, size_t size, int flags)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_setxattr(dfuse_ll.dl_dfs, ie->ie_obj, name, value, size,
+			  flags);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	dfuse_ll_reply_err(req, rc);
+}
+
+static void
+dfuse_ll_getxattr(fuse_req_t req, fuse_ino_t ino, const char *name,
+		  size_t size)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	daos_size_t		val_size = size;
+	char			*buf = NULL;
+	int			rc;
+
+	if (size) {
+		D_ALLOC(buf, size);
+		if (buf == NULL) {
+			fuse_reply_err(req, ENOMEM);
+			return;
+		}
+	}
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_getxattr(dfuse_ll.dl_dfs, ie->ie_obj, name, buf, &val_size);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+
+	if (rc == -DER_REC2BIG)
+		fuse_reply_err(req, ERANGE);
+	else if (rc == -DER_NONEXIST || (rc == 0 && val_size == 0))
+		fuse_reply_err(req, ENODATA);
+	else if (rc)
+		dfuse_ll_reply_err(req, rc);
+	else if (size == 0)
+		fuse_reply_xattr(req, val_size);
+	else
+		fuse_reply_buf(req, buf, val_size);
+
+	if (buf)
+		D_FREE(buf);
+}
+
+static void
+dfuse_ll_listxattr(fuse_req_t req, fuse_ino_t ino, size_t size)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	daos_size_t		list_size;
+	char			*buf;
+	int			rc;
+
+	/** dfs_listxattr() has no size query, list into a large buffer */
+	list_size = size ? size : DFUSE_XATTR_LIST_MAX;
+	D_ALLOC(buf, list_size);
+	if (buf == NULL) {
+		fuse_reply_err(req, ENOMEM);
+		return;
+	}
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_listxattr(dfuse_ll.dl_dfs, ie->ie_obj, buf, &list_size);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+
+	if (rc)
+		dfuse_ll_reply_err(req, rc);
+	else if (size == 0)
+		fuse_reply_xattr(req, list_size);
+	else
+		fuse_reply_buf(req, buf, list_size);
+	D_FREE(buf);
+}
+
+static void
+dfuse_ll_removexattr(fuse_req_t req, fuse_ino_t ino, const char *name)
+{
+	struct dfuse_inode	*ie = dfuse_ino2inode(ino);
+	int			rc;
+
+	D_RWLOCK_RDLOCK(&ie->ie_lock);
+	rc = dfs_removexattr(dfuse_ll.dl_dfs, ie->ie_obj, name);
+	D_RWLOCK_UNLOCK(&ie->ie_lock);
+	dfuse_ll_reply_err(req, rc);
+}
+
+static struct fuse_lowlevel_ops dfuse_ll_ops = {
+	.init		= dfuse_ll_init,
+	.lookup		= dfuse_ll_lookup,
+	.forget		= dfuse_ll_forget,
+	.forget_multi	= dfuse_ll_forget_multi,
+	.getattr	= dfuse_ll_getattr,
+	.setattr	= dfuse_ll_setattr,
+	.readlink	= dfuse_ll_readlink,
+	.mkdir		= dfuse_ll_mkdir,
+	.unlink		= dfuse_ll_remove,
+	.rmdir		= dfuse_ll_remove,
+	.symlink	= dfuse_ll_symlink,
+	.rename		= dfuse_ll_rename,
+	.open		= dfuse_ll_open,
+	.create		= dfuse_ll_create,
+	.read		= dfuse_ll_read,
+	.write_buf	= dfuse_ll_write_buf,
+	.release	= dfuse_ll_release,
+	.fsync		= dfuse_ll_fsync,
+	.opendir	= dfuse_ll_opendir,
+	.readdir	= dfuse_ll_readdir,
+	.readdirplus	= dfuse_ll_readdirplus,
+	.releasedir	= dfuse_ll_releasedir,
+	.fsyncdir	= dfuse_ll_fsync,
+	.setxattr	= dfuse_ll_setxattr,
+	.getxattr	= dfuse_ll_getxattr,
+	.listxattr	= dfuse_ll_listxattr,
+	.removexattr	= dfuse_ll_removexattr,
+};
+
+int
+dfuse_ll_run(dfs_t *dfs, struct fuse_args *args, const char *mountpoint,
+	     struct dfuse_ll_opts *opts, bool foreground, bool singlethread)
+{
+	struct fuse_session	*se;
+	dfs_obj_t		*root;
+	mode_t			mode;
+	char			opt[32];
+	int			rc;
+
+	memset(&dfuse_ll, 0, sizeof(dfuse_ll));
+	dfuse_ll.dl_dfs = dfs;
+	dfuse_ll.dl_opts = opts;
+
+	rc = D_MUTEX_INIT(&dfuse_ll.dl_lock, NULL);
+	if (rc)
+		return 1;
+
+	rc = d_hash_table_create(0 /* feats */, 16 /* bits */, NULL /* priv */,
+				 &dfuse_inode_hash_ops, &dfuse_ll.dl_inodes);
+	if (rc) {
+		fprintf(stderr, "Failed to create the inode table (%d)\n", rc);
+		D_GOTO(out_lock, rc = 1);
+	}
+
+	rc = dfs_lookup(dfs, "/", O_RDWR, &root, &mode);
+	if (rc) {
+		fprintf(stderr, "Failed to lookup the root directory (%d)\n",
+			rc);
+		D_GOTO(out_hash, rc = 1);
+	}
+	rc = dfuse_inode_get(root, mode, &dfuse_ll.dl_root);
+	if (rc) {
+		fprintf(stderr, "Failed to add the root inode (%d)\n", rc);
+		D_GOTO(out_hash, rc = 1);
+	}
+
+	if (opts->max_read) {
+		snprintf(opt, sizeof(opt), "-omax_read=%u", opts->max_read);
+		fuse_opt_add_arg(args, opt);
+	}
+
+	se = fuse_session_new(args, &dfuse_ll_ops, sizeof(dfuse_ll_ops), NULL);
+	if (se == NULL) {
+		fprintf(stderr, "Could not initialize dfuse fs\n");
+		D_GOTO(out_root, rc = 1);
+	}
+
+	if (fuse_set_signal_handlers(se) != 0)
+		D_GOTO(out_se, rc = 1);
+
+	if (fuse_session_mount(se, mountpoint) != 0) {
+		fprintf(stderr, "Could not mount dfuse fs\n");
+		D_GOTO(out_signal, rc = 1);
+	}
+
+	rc = fuse_daemonize(foreground);
+	if (rc == -1)
+		D_GOTO(out_mount, rc = 1);
+
+	if (singlethread) {
+		rc = fuse_session_loop(se);
+	} else {
+		struct fuse_loop_config config = {
+			.clone_fd		= 0,
+			.max_idle_threads	= 10,
+		};
+
+		rc = fuse_session_loop_mt(se, &config);
+	}
+	rc = rc ? 1 : 0;
+
+out_mount:
+	fuse_session_unmount(se);
+out_signal:
+	fuse_remove_signal_handlers(se);
+out_se:
+	fuse_session_destroy(se);
+out_root:
+	d_hash_rec_delete_at(dfuse_ll.dl_inodes, &dfuse_ll.dl_root->ie_link);
+out_hash:
+	d_hash_table_destroy(dfuse_ll.dl_inodes, true /* force */);
+out_lock:
+	D_MUTEX_DESTROY(&dfuse_ll.dl_lock);
+	return rc;
+}
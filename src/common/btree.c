@@ -31,6 +31,9 @@
 
 #include <daos_errno.h>
 #include <daos/btree.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 /**
  * Tree node types.
@@ -183,6 +186,12 @@ btr_is_int_key(struct btr_context *tcx)
 	return (tcx->tc_feats & BTR_FEAT_UINT_KEY);
 }
 
+static bool
+btr_has_key_array(struct btr_context *tcx)
+{
+	return (tcx->tc_feats & BTR_FEAT_KEY_ARRAY);
+}
+
 static bool
 btr_has_collision(struct btr_context *tcx)
 {
@@ -435,6 +444,23 @@ btr_hkey_cmp(struct btr_context *tcx, struct btr_record *rec, void *hkey)
 			memcmp(&rec->rec_hkey[0], hkey, btr_hkey_size(tcx)));
 }
 
+/** Whether the key array stores images of hkeys, see to_hkey_image */
+static bool
+btr_has_hkey_image(struct btr_context *tcx)
+{
+	return !btr_is_int_key(tcx) && btr_ops(tcx)->to_hkey_image != NULL;
+}
+
+/** Generate the key array image of \a hkey */
+static void
+btr_hkey_image(struct btr_context *tcx, char *hkey, char *image)
+{
+	if (btr_has_hkey_image(tcx))
+		btr_ops(tcx)->to_hkey_image(&tcx->tc_tins, hkey, image);
+	else
+		btr_hkey_copy(tcx, image, hkey);
+}
+
 static int
 btr_key_cmp(struct btr_context *tcx, struct btr_record *rec, daos_iov_t *key)
 {
@@ -540,10 +566,24 @@ btr_rec_copy_hkey(struct btr_context *tcx, struct btr_record *dst_rec,
 	btr_hkey_copy(tcx, &dst_rec->rec_hkey[0], &src_rec->rec_hkey[0]);
 }
 
+/**
+ * Size of the contiguous key array in front of the records, see
+ * BTR_FEAT_KEY_ARRAY. It is rounded up to keep records 8-byte aligned.
+ */
+static inline int
+btr_key_array_size(struct btr_context *tcx)
+{
+	if (!btr_has_key_array(tcx))
+		return 0;
+
+	return (tcx->tc_order * btr_hkey_size(tcx) + 7) & ~7;
+}
+
 static inline int
 btr_node_size(struct btr_context *tcx)
 {
-	return sizeof(struct btr_node) + tcx->tc_order * btr_rec_size(tcx);
+	return sizeof(struct btr_node) + btr_key_array_size(tcx) +
+	       tcx->tc_order * btr_rec_size(tcx);
 }
 
 static int
@@ -602,11 +642,81 @@ btr_node_rec_at(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
 		unsigned int at)
 {
 	struct btr_node *nd = btr_mmid2ptr(tcx, nd_mmid);
-	char		*addr = (char *)&nd[1];
+	char		*addr = (char *)&nd[1] + btr_key_array_size(tcx);
 
 	return (struct btr_record *)&addr[btr_rec_size(tcx) * at];
 }
 
+/** address of the \a at-th key in the key array of a node */
+static char *
+btr_node_key_at(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+		unsigned int at)
+{
+	struct btr_node *nd = btr_mmid2ptr(tcx, nd_mmid);
+	char		*addr = (char *)&nd[1];
+
+	D_ASSERT(btr_has_key_array(tcx));
+	return &addr[btr_hkey_size(tcx) * at];
+}
+
+/**
+ * Copy \a nr records from \a src_at of the source node to \a dst_at of the
+ * destination node, the key array is updated as well if the tree has one.
+ */
+static void
+btr_node_rec_copy(struct btr_context *tcx,
+		  TMMID(struct btr_node) dst_mmid, unsigned int dst_at,
+		  TMMID(struct btr_node) src_mmid, unsigned int src_at, int nr)
+{
+	btr_rec_copy(tcx, btr_node_rec_at(tcx, dst_mmid, dst_at),
+		     btr_node_rec_at(tcx, src_mmid, src_at), nr);
+
+	if (btr_has_key_array(tcx))
+		memcpy(btr_node_key_at(tcx, dst_mmid, dst_at),
+		       btr_node_key_at(tcx, src_mmid, src_at),
+		       nr * btr_hkey_size(tcx));
+}
+
+/** Move \a nr records within a node, see btr_node_rec_copy */
+static void
+btr_node_rec_move(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+		  unsigned int dst_at, unsigned int src_at, int nr)
+{
+	btr_rec_move(tcx, btr_node_rec_at(tcx, nd_mmid, dst_at),
+		     btr_node_rec_at(tcx, nd_mmid, src_at), nr);
+
+	if (btr_has_key_array(tcx))
+		memmove(btr_node_key_at(tcx, nd_mmid, dst_at),
+			btr_node_key_at(tcx, nd_mmid, src_at),
+			nr * btr_hkey_size(tcx));
+}
+
+/** Store the scratch record \a rec at position \a at of a node */
+static void
+btr_node_rec_set(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+		 unsigned int at, struct btr_record *rec)
+{
+	btr_rec_copy(tcx, btr_node_rec_at(tcx, nd_mmid, at), rec, 1);
+
+	if (btr_has_key_array(tcx))
+		btr_hkey_image(tcx, &rec->rec_hkey[0],
+			       btr_node_key_at(tcx, nd_mmid, at));
+}
+
+/** Copy the hashed key of a record to another record in the tree */
+static void
+btr_node_hkey_copy(struct btr_context *tcx,
+		   TMMID(struct btr_node) dst_mmid, unsigned int dst_at,
+		   TMMID(struct btr_node) src_mmid, unsigned int src_at)
+{
+	btr_rec_copy_hkey(tcx, btr_node_rec_at(tcx, dst_mmid, dst_at),
+			  btr_node_rec_at(tcx, src_mmid, src_at));
+
+	if (btr_has_key_array(tcx))
+		btr_hkey_copy(tcx, btr_node_key_at(tcx, dst_mmid, dst_at),
+			      btr_node_key_at(tcx, src_mmid, src_at));
+}
+
 static TMMID(struct btr_node)
 btr_node_child_at(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
 		  unsigned int at)
@@ -787,7 +897,6 @@ int
 btr_root_start(struct btr_context *tcx, struct btr_record *rec)
 {
 	struct btr_root		*root;
-	struct btr_record	*rec_dst;
 	TMMID(struct btr_node)	 nd_mmid;
 	int			 rc;
 
@@ -806,8 +915,7 @@ btr_root_start(struct btr_context *tcx, struct btr_record *rec)
 	btr_node_set(tcx, nd_mmid, BTR_NODE_ROOT | BTR_NODE_LEAF);
 	btr_mmid2ptr(tcx, nd_mmid)->tn_keyn = 1;
 
-	rec_dst = btr_node_rec_at(tcx, nd_mmid, 0);
-	btr_rec_copy(tcx, rec_dst, rec, 1);
+	btr_node_rec_set(tcx, nd_mmid, 0, rec);
 
 	if (btr_has_tx(tcx))
 		btr_root_tx_add(tcx); /* XXX check error */
@@ -834,7 +942,6 @@ btr_root_grow(struct btr_context *tcx, TMMID(struct btr_node) mmid_left,
 {
 	struct btr_root		*root;
 	struct btr_node		*nd;
-	struct btr_record	*rec_dst;
 	TMMID(struct btr_node)	 nd_mmid;
 	int			 at;
 	int			 rc;
@@ -855,8 +962,7 @@ btr_root_grow(struct btr_context *tcx, TMMID(struct btr_node) mmid_left,
 	btr_node_unset(tcx, mmid_left, BTR_NODE_ROOT);
 
 	btr_node_set(tcx, nd_mmid, BTR_NODE_ROOT);
-	rec_dst = btr_node_rec_at(tcx, nd_mmid, 0);
-	btr_rec_copy(tcx, rec_dst, rec, 1);
+	btr_node_rec_set(tcx, nd_mmid, 0, rec);
 
 	nd = btr_mmid2ptr(tcx, nd_mmid);
 	nd->tn_child	= mmid_left;
@@ -880,8 +986,6 @@ static void
 btr_node_insert_rec_only(struct btr_context *tcx, struct btr_trace *trace,
 			 struct btr_record *rec)
 {
-	struct btr_record *rec_a;
-	struct btr_record *rec_b;
 	struct btr_node   *nd;
 	bool		   leaf;
 	char		   sbuf[BTR_PRINT_BUF];
@@ -894,14 +998,13 @@ btr_node_insert_rec_only(struct btr_context *tcx, struct btr_trace *trace,
 			btr_rec_string(tcx, rec, leaf, sbuf, BTR_PRINT_BUF),
 			btr_rec_size(tcx));
 
-	rec_a = btr_node_rec_at(tcx, trace->tr_node, trace->tr_at);
-	rec_b = btr_node_rec_at(tcx, trace->tr_node, trace->tr_at + 1);
-
 	nd = btr_mmid2ptr(tcx, trace->tr_node);
-	if (trace->tr_at != nd->tn_keyn)
-		btr_rec_move(tcx, rec_b, rec_a, nd->tn_keyn - trace->tr_at);
+	if (trace->tr_at != nd->tn_keyn) {
+		btr_node_rec_move(tcx, trace->tr_node, trace->tr_at + 1,
+				  trace->tr_at, nd->tn_keyn - trace->tr_at);
+	}
 
-	btr_rec_copy(tcx, rec_a, rec, 1);
+	btr_node_rec_set(tcx, trace->tr_node, trace->tr_at, rec);
 	nd->tn_keyn++;
 }
 
@@ -980,7 +1083,8 @@ btr_node_split_and_insert(struct btr_context *tcx, struct btr_trace *trace,
 	if (leaf) {
 		D_DEBUG(DB_TRACE, "Splitting leaf node\n");
 
-		btr_rec_copy(tcx, rec_dst, rec_src, nd_right->tn_keyn);
+		btr_node_rec_copy(tcx, mmid_right, 0, mmid_left, split_at,
+				  nd_right->tn_keyn);
 		btr_node_insert_rec_only(tcx, trace, rec);
 
 		/* insert the right node and the first key of the right
@@ -1000,7 +1104,8 @@ btr_node_split_and_insert(struct btr_context *tcx, struct btr_trace *trace,
 		D_DEBUG(DB_TRACE, "Bubble up the new key\n");
 		nd_right->tn_child = umem_id_u2t(rec->rec_mmid,
 						 struct btr_node);
-		btr_rec_copy(tcx, rec_dst, rec_src, nd_right->tn_keyn);
+		btr_node_rec_copy(tcx, mmid_right, 0, mmid_left, split_at,
+				  nd_right->tn_keyn);
 		goto bubble_up;
 	}
 
@@ -1018,11 +1123,9 @@ btr_node_split_and_insert(struct btr_context *tcx, struct btr_trace *trace,
 	 */
 	trace->tr_at -= right;
 
-	/* Copy from @rec_src[1] because @rec_src[0] will bubble up.
-	 * NB: call btr_rec_at instead of using array index, see btr_record.
-	 */
-	btr_rec_copy(tcx, rec_dst, btr_rec_at(tcx, rec_src, 1),
-		     nd_right->tn_keyn);
+	/* Copy from @rec_src[1] because @rec_src[0] will bubble up. */
+	btr_node_rec_copy(tcx, mmid_right, 0, mmid_left, split_at + 1,
+			  nd_right->tn_keyn);
 
 	/* backup it because the below btr_node_insert_rec_only may
 	 * overwrite it.
@@ -1097,6 +1200,136 @@ btr_cmp(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
 	return cmp;
 }
 
+/**
+ * Number of keys in the window which is scanned linearly by the key array
+ * search, larger arrays are bisected down to this size first.
+ */
+#define BTR_KEY_SCAN_MAX	32
+
+#if defined(__x86_64__)
+static int __attribute__((target("avx2")))
+btr_ukey_count_lt_avx2(const uint64_t *keys, int nr, uint64_t key)
+{
+	/* AVX2 only has signed compare, flip the sign bit of both sides */
+	const __m256i	bias = _mm256_set1_epi64x(INT64_MIN);
+	const __m256i	kv = _mm256_xor_si256(_mm256_set1_epi64x(key), bias);
+	int		cnt = 0;
+	int		i;
+
+	for (i = 0; i + 4 <= nr; i += 4) {
+		__m256i	v;
+
+		v = _mm256_loadu_si256((const __m256i *)&keys[i]);
+		v = _mm256_cmpgt_epi64(kv, _mm256_xor_si256(v, bias));
+		cnt += __builtin_popcount(
+			_mm256_movemask_pd(_mm256_castsi256_pd(v)));
+	}
+
+	for (; i < nr; i++)
+		cnt += (keys[i] < key);
+	return cnt;
+}
+#endif
+
+/** Count keys which are smaller than \a key, it is branch free */
+static inline int
+btr_ukey_count_lt(const uint64_t *keys, int nr, uint64_t key)
+{
+	int	cnt = 0;
+	int	i;
+
+#if defined(__x86_64__)
+	if (__builtin_cpu_supports("avx2"))
+		return btr_ukey_count_lt_avx2(keys, nr, key);
+#endif
+	for (i = 0; i < nr; i++)
+		cnt += (keys[i] < key);
+	return cnt;
+}
+
+/**
+ * Return position of the first key which is not smaller than \a key in the
+ * sorted integer key array, or \a nr if there is no such key.
+ */
+static int
+btr_ukey_search(const uint64_t *keys, int nr, uint64_t key)
+{
+	const uint64_t	*base = keys;
+
+	while (nr > BTR_KEY_SCAN_MAX) {
+		int	half = nr / 2;
+
+		base = (base[half] < key) ? &base[half] : base;
+		nr -= half;
+	}
+	return (base - keys) + btr_ukey_count_lt(base, nr, key);
+}
+
+/** Same as btr_ukey_search, but for hashed keys in memcmp order */
+static int
+btr_hkey_search(const char *keys, int nr, int size, const char *hkey)
+{
+	const char	*base = keys;
+	int		 i;
+
+	while (nr > BTR_KEY_SCAN_MAX) {
+		int	half = nr / 2;
+
+		base = memcmp(&base[half * size], hkey, size) < 0 ?
+		       &base[half * size] : base;
+		nr -= half;
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (memcmp(&base[i * size], hkey, size) >= 0)
+			break;
+	}
+	return (base - keys) / size + i;
+}
+
+/**
+ * Search \a hkey in the key array of a node, see BTR_FEAT_KEY_ARRAY.
+ * \a image is the key array image of \a hkey, see btr_hkey_image.
+ * Same as the binary search in btr_probe, the returned position \a at_p is
+ * either the matched record, or a neighbour of the insertion point, and the
+ * returned value is the comparison result of the record at this position.
+ */
+static int
+btr_node_search(struct btr_context *tcx, TMMID(struct btr_node) nd_mmid,
+		char *hkey, char *image, int *at_p)
+{
+	struct btr_node	*nd = btr_mmid2ptr(tcx, nd_mmid);
+	char		*keys = btr_node_key_at(tcx, nd_mmid, 0);
+	int		 size = btr_hkey_size(tcx);
+	int		 cmp;
+	int		 at;
+
+	if (btr_is_int_key(tcx))
+		at = btr_ukey_search((uint64_t *)keys, nd->tn_keyn,
+				     *(uint64_t *)image);
+	else
+		at = btr_hkey_search(keys, nd->tn_keyn, size, image);
+
+	if (at == nd->tn_keyn) { /* all keys are smaller */
+		at--;
+		cmp = BTR_CMP_LT;
+	} else {
+		cmp = memcmp(&keys[at * size], image, size) == 0 ?
+		      BTR_CMP_EQ : BTR_CMP_GT;
+	}
+
+	/* the customized comparison can tell more than the order, e.g.
+	 * BTR_CMP_MATCHED, it is called once for the found record.
+	 */
+	if (btr_has_hkey_image(tcx) && btr_ops(tcx)->to_hkey_cmp)
+		cmp = btr_hkey_cmp(tcx, btr_node_rec_at(tcx, nd_mmid, at),
+				   hkey);
+
+	D_DEBUG(DB_TRACE, "searched key array, at %d, cmp %d\n", at, cmp);
+	*at_p = at;
+	return cmp;
+}
+
 bool
 btr_probe_valid(dbtree_probe_opc_t opc)
 {
@@ -1127,6 +1360,7 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 	int			 level;
 	bool			 next_level;
 	char			 hkey[DAOS_HKEY_MAX];
+	char			 image[DAOS_HKEY_MAX];
 	struct btr_trace	 traces[BTR_TRACE_MAX];
 	struct btr_trace	*trace = NULL;
 	TMMID(struct btr_node)	 nd_mmid;
@@ -1161,6 +1395,8 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 
 			btr_hkey_copy(tcx, hkey, &anchor->da_hkey[0]);
 		}
+		if (btr_has_key_array(tcx))
+			btr_hkey_image(tcx, hkey, image);
 	}
 
 	nd_mmid = tcx->tc_tins.ti_root->tr_node;
@@ -1183,6 +1419,12 @@ btr_probe(struct btr_context *tcx, dbtree_probe_opc_t probe_opc,
 		} else if (probe_opc == BTR_PROBE_LAST) {
 			at = start = end;
 			cmp = BTR_CMP_LT;
+
+		} else if (btr_has_key_array(tcx)) {
+			D_ASSERT(probe_opc & BTR_PROBE_SPEC);
+			/* search the whole key array of the node at once */
+			cmp = btr_node_search(tcx, nd_mmid, hkey, image, &at);
+			start = end = at;
 		} else {
 			D_ASSERT(probe_opc & BTR_PROBE_SPEC);
 			/* binary search */
@@ -1724,6 +1966,447 @@ dbtree_upsert(daos_handle_t toh, dbtree_probe_opc_t opc,
 	return rc;
 }
 
+/**
+ * Check if hashed keys of \a keys are in strictly ascending order.
+ */
+static bool
+btr_batch_sorted(struct btr_context *tcx, daos_iov_t *keys, unsigned int nr)
+{
+	union btr_rec_buf	rec_bufs[2];
+	unsigned int		i;
+
+	btr_hkey_gen(tcx, &keys[0], &rec_bufs[0].rb_rec.rec_hkey[0]);
+	for (i = 1; i < nr; i++) {
+		struct btr_record *prev = &rec_bufs[(i - 1) & 1].rb_rec;
+		char		  *hkey = &rec_bufs[i & 1].rb_rec.rec_hkey[0];
+
+		btr_hkey_gen(tcx, &keys[i], hkey);
+		/* BTR_CMP_MATCHED is fine, e.g. the same key in epoch order */
+		if (!(btr_hkey_cmp(tcx, prev, hkey) & BTR_CMP_LT))
+			return false;
+	}
+	return true;
+}
+
+/** arrays of dbtree_sort_batch, and the hashed keys to sort them by */
+struct btr_batch_sort {
+	struct btr_context	*bs_tcx;
+	daos_iov_t		*bs_keys;
+	daos_iov_t		*bs_vals;
+	union btr_rec_buf	*bs_recs;
+};
+
+static void
+btr_batch_swap(void *array, int a, int b)
+{
+	struct btr_batch_sort	*bs = array;
+	union btr_rec_buf	 rec;
+	daos_iov_t		 iov;
+
+	iov = bs->bs_keys[a];
+	bs->bs_keys[a] = bs->bs_keys[b];
+	bs->bs_keys[b] = iov;
+
+	iov = bs->bs_vals[a];
+	bs->bs_vals[a] = bs->bs_vals[b];
+	bs->bs_vals[b] = iov;
+
+	rec = bs->bs_recs[a];
+	bs->bs_recs[a] = bs->bs_recs[b];
+	bs->bs_recs[b] = rec;
+}
+
+static int
+btr_batch_cmp(void *array, int a, int b)
+{
+	struct btr_batch_sort	*bs = array;
+	int			 cmp;
+
+	cmp = btr_hkey_cmp(bs->bs_tcx, &bs->bs_recs[a].rb_rec,
+			   &bs->bs_recs[b].rb_rec.rec_hkey[0]);
+	if (cmp & BTR_CMP_LT)
+		return -1;
+	if (cmp & BTR_CMP_GT)
+		return 1;
+	return 0;
+}
+
+static daos_sort_ops_t btr_batch_sort_ops = {
+	.so_swap	= btr_batch_swap,
+	.so_cmp		= btr_batch_cmp,
+};
+
+/**
+ * Sort a batch of records for dbtree_update_batch() in ascending order of the
+ * tree, i.e. the order of the hashed keys, so that an empty tree can be built
+ * from bottom up. \a keys and \a vals are reordered together.
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param keys		[IN/OUT]	Array of \a nr keys.
+ * \param vals		[IN/OUT]	Array of \a nr values.
+ * \param nr		[IN]	Number of records.
+ *
+ * \return		0	success
+ *			-ve	error code
+ */
+int
+dbtree_sort_batch(daos_handle_t toh, daos_iov_t *keys, daos_iov_t *vals,
+		  unsigned int nr)
+{
+	struct btr_batch_sort	 bs;
+	struct btr_context	*tcx;
+	unsigned int		 i;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	/* keys of a direct-key tree are not hashed, nothing to sort by */
+	if (nr < 2 || btr_is_direct_key(tcx))
+		return 0;
+
+	D_ALLOC(bs.bs_recs, nr * sizeof(*bs.bs_recs));
+	if (bs.bs_recs == NULL)
+		return -DER_NOMEM;
+
+	for (i = 0; i < nr; i++)
+		btr_hkey_gen(tcx, &keys[i], &bs.bs_recs[i].rb_rec.rec_hkey[0]);
+
+	bs.bs_tcx = tcx;
+	bs.bs_keys = keys;
+	bs.bs_vals = vals;
+	daos_array_sort(&bs, nr, false, &btr_batch_sort_ops);
+
+	D_FREE(bs.bs_recs);
+	return 0;
+}
+
+/** a subtree built by btr_bulk_build */
+struct btr_bulk_node {
+	/** root node of the subtree */
+	TMMID(struct btr_node)		bn_node;
+	/** the leftmost leaf, its first key separates the subtree */
+	TMMID(struct btr_node)		bn_leaf;
+};
+
+static void
+btr_bulk_free(struct btr_context *tcx, struct btr_bulk_node *bns,
+	      unsigned int start, unsigned int end)
+{
+	for (; start < end; start++) {
+		bool	leaf = btr_node_is_leaf(tcx, bns[start].bn_node);
+
+		btr_node_destroy(tcx, bns[start].bn_node, NULL);
+		/* NB: btr_node_destroy does not release leaf node */
+		if (leaf)
+			btr_node_free(tcx, bns[start].bn_node);
+	}
+}
+
+/**
+ * Build the tree from bottom up for sorted \a keys, the tree must be empty.
+ * All leaves are filled up, then each level of non-leaf nodes is built over
+ * the level below it, until there is only one node which becomes the root.
+ * Splits are deferred to follow-on insertions.
+ */
+static int
+btr_bulk_build(struct btr_context *tcx, daos_iov_t *keys, daos_iov_t *vals,
+	       unsigned int nr)
+{
+	struct btr_root		*root = tcx->tc_tins.ti_root;
+	struct btr_bulk_node	*bns;
+	struct btr_record	*rec;
+	union btr_rec_buf	 rec_buf;
+	unsigned int		 order = tcx->tc_order;
+	unsigned int		 cnt;
+	unsigned int		 depth;
+	unsigned int		 i;
+	unsigned int		 j;
+	unsigned int		 k;
+	int			 rc;
+
+	D_ASSERT(btr_root_empty(tcx));
+	D_ASSERT(nr > 0);
+
+	/* the root is changed at the end, nothing to undo if it fails here */
+	if (btr_has_tx(tcx)) {
+		rc = btr_root_tx_add(tcx);
+		if (rc != 0)
+			return rc;
+	}
+
+	/* spread records evenly over the minimum number of leaves */
+	cnt = (nr + order - 2) / (order - 1);
+	D_ALLOC(bns, cnt * sizeof(*bns));
+	if (bns == NULL)
+		return -DER_NOMEM;
+
+	D_DEBUG(DB_TRACE, "Bulk build %u records into %u leaves\n", nr, cnt);
+	rec = &rec_buf.rb_rec;
+	for (i = j = 0; j < cnt; j++) {
+		struct btr_node	*nd;
+		unsigned int	 rec_nr = nr / cnt + (j < nr % cnt);
+
+		rc = btr_node_alloc(tcx, &bns[j].bn_node);
+		if (rc != 0) {
+			btr_bulk_free(tcx, bns, 0, j);
+			D_GOTO(out, rc);
+		}
+
+		btr_node_set(tcx, bns[j].bn_node, BTR_NODE_LEAF);
+		bns[j].bn_leaf = bns[j].bn_node;
+
+		nd = btr_mmid2ptr(tcx, bns[j].bn_node);
+		for (k = 0; k < rec_nr; k++, i++) {
+			btr_hkey_gen(tcx, &keys[i], &rec->rec_hkey[0]);
+			rc = btr_rec_alloc(tcx, &keys[i], &vals[i], rec);
+			if (rc != 0) {
+				btr_bulk_free(tcx, bns, 0, j + 1);
+				D_GOTO(out, rc);
+			}
+			btr_node_rec_set(tcx, bns[j].bn_node, k, rec);
+			nd->tn_keyn++;
+		}
+	}
+
+	for (depth = 1; cnt > 1; depth++) {
+		unsigned int	pcnt = (cnt + order - 1) / order;
+		unsigned int	first = 0;
+
+		/* NB: parents are stored in the same array, the j-th parent
+		 * never overwrites a child which has not been consumed.
+		 */
+		for (j = 0; j < pcnt; j++) {
+			TMMID(struct btr_node)	 nd_mmid;
+			struct btr_node		*nd;
+			unsigned int		 child_nr;
+
+			child_nr = cnt / pcnt + (j < cnt % pcnt);
+			D_ASSERT(child_nr > 1 && child_nr <= order);
+
+			rc = btr_node_alloc(tcx, &nd_mmid);
+			if (rc != 0) {
+				btr_bulk_free(tcx, bns, 0, j);
+				btr_bulk_free(tcx, bns, first, cnt);
+				D_GOTO(out, rc);
+			}
+
+			nd = btr_mmid2ptr(tcx, nd_mmid);
+			nd->tn_child = bns[first].bn_node;
+			for (k = 1; k < child_nr; k++) {
+				rec = btr_node_rec_at(tcx, nd_mmid, k - 1);
+				rec->rec_mmid =
+					umem_id_t2u(bns[first + k].bn_node);
+				btr_node_hkey_copy(tcx, nd_mmid, k - 1,
+						   bns[first + k].bn_leaf, 0);
+			}
+			nd->tn_keyn = child_nr - 1;
+
+			bns[j].bn_leaf = bns[first].bn_leaf;
+			bns[j].bn_node = nd_mmid;
+			first += child_nr;
+		}
+		cnt = pcnt;
+	}
+
+	btr_node_set(tcx, bns[0].bn_node, BTR_NODE_ROOT);
+	root->tr_node = bns[0].bn_node;
+	root->tr_depth = depth;
+	btr_context_set_depth(tcx, depth);
+	rc = 0;
+ out:
+	D_FREE(bns);
+	return rc;
+}
+
+/**
+ * Try to find the insertion point of \a key in the leaf of the current
+ * trace, which points at the record updated or inserted for the previous key
+ * of the batch. It returns false if \a key is not in the range of this leaf,
+ * or it matches an existing record, in which case caller should probe it
+ * from the root.
+ */
+static bool
+btr_batch_locate(struct btr_context *tcx, daos_iov_t *key)
+{
+	struct btr_trace	*trace = &tcx->tc_trace[tcx->tc_depth - 1];
+	struct btr_node		*nd = btr_mmid2ptr(tcx, trace->tr_node);
+	char			 hkey[DAOS_HKEY_MAX];
+	int			 level;
+	int			 cmp;
+	int			 at;
+
+	btr_hkey_gen(tcx, key, hkey);
+	if (btr_cmp(tcx, trace->tr_node, trace->tr_at, hkey, key) !=
+	    BTR_CMP_LT)
+		return false;
+
+	at = nd->tn_keyn - 1;
+	cmp = btr_cmp(tcx, trace->tr_node, at, hkey, key);
+	if (cmp == BTR_CMP_GT) {
+		int	start = trace->tr_at + 1;
+
+		/* binary search between the previous key and the last one */
+		while (start < at) {
+			int	mid = (start + at) / 2;
+
+			cmp = btr_cmp(tcx, trace->tr_node, mid, hkey, key);
+			if (cmp == BTR_CMP_LT)
+				start = mid + 1;
+			else if (cmp == BTR_CMP_GT)
+				at = mid;
+			else
+				return false;
+		}
+	} else if (cmp != BTR_CMP_LT) {
+		return false;
+	} else {
+		at = nd->tn_keyn;
+		/* after the last record, the key of the parent record on the
+		 * right side of this leaf is the upper bound.
+		 */
+		for (level = tcx->tc_depth - 2; level >= 0; level--) {
+			struct btr_trace *par = &tcx->tc_trace[level];
+
+			nd = btr_mmid2ptr(tcx, par->tr_node);
+			if (par->tr_at < nd->tn_keyn)
+				break;
+		}
+
+		if (level >= 0) {
+			struct btr_trace *par = &tcx->tc_trace[level];
+
+			cmp = btr_cmp(tcx, par->tr_node, par->tr_at, hkey, key);
+			if (cmp != BTR_CMP_GT)
+				return false;
+		}
+	}
+
+	trace->tr_at = at;
+	return true;
+}
+
+static int
+btr_batch_upsert(struct btr_context *tcx, daos_iov_t *keys, daos_iov_t *vals,
+		 unsigned int nr)
+{
+	unsigned int	i;
+	bool		cursor;
+	int		rc;
+
+	if (btr_root_empty(tcx) && !btr_is_direct_key(tcx) &&
+	    btr_batch_sorted(tcx, keys, nr)) {
+		rc = btr_bulk_build(tcx, keys, vals, nr);
+		tcx->tc_probe_rc = PROBE_RC_UNKNOWN;
+		return rc;
+	}
+
+	/* for tests which expect a bulk build */
+	if (btr_root_empty(tcx) && DAOS_FAIL_CHECK(DAOS_BTR_BATCH_NO_BULK))
+		return -DER_IO;
+
+	for (i = 0, cursor = false; i < nr; i++) {
+		struct btr_trace *trace;
+		bool		  split;
+
+		if (cursor && btr_batch_locate(tcx, &keys[i])) {
+			trace = &tcx->tc_trace[tcx->tc_depth - 1];
+			split = btr_node_is_full(tcx, trace->tr_node);
+
+			rc = btr_insert(tcx, &keys[i], &vals[i]);
+		} else {
+			rc = btr_probe(tcx, BTR_PROBE_EQ, &keys[i], NULL);
+			trace = &tcx->tc_trace[tcx->tc_depth - 1];
+			split = (rc == PROBE_RC_NONE && tcx->tc_depth != 0 &&
+				 btr_node_is_full(tcx, trace->tr_node));
+
+			rc = btr_upsert(tcx, BTR_PROBE_BYPASS, &keys[i],
+					&vals[i]);
+		}
+		if (rc != 0)
+			break;
+
+		/* split does not maintain the trace of upper levels, the
+		 * next key has to be probed from the root.
+		 */
+		cursor = !split;
+	}
+
+	tcx->tc_probe_rc = PROBE_RC_UNKNOWN;
+	return rc;
+}
+
+static int
+btr_tx_batch_upsert(struct btr_context *tcx, daos_iov_t *keys,
+		    daos_iov_t *vals, unsigned int nr)
+{
+#if DAOS_HAS_PMDK
+	struct umem_instance *umm = btr_umm(tcx);
+	int		      rc = 0;
+
+	TX_BEGIN(umm->umm_u.pmem_pool) {
+		rc = btr_batch_upsert(tcx, keys, vals, nr);
+		if (rc != 0)
+			pmemobj_tx_abort(rc);
+	} TX_ONABORT {
+		rc = umem_tx_errno(rc);
+		D_DEBUG(DB_TRACE, "dbtree_update_batch tx aborted: %d\n", rc);
+
+	} TX_FINALLY {
+		D_DEBUG(DB_TRACE, "dbtree_update_batch tx exited\n");
+	} TX_END
+
+	return rc;
+#else
+	D_ASSERT(0);
+	return -DER_NO_PERM;
+#endif
+}
+
+/**
+ * Update or insert a batch of records with a single pass over the tree.
+ *
+ * If the tree is empty and \a keys are in ascending order of the tree (the
+ * order of the hashed keys), the tree is built from bottom up with full
+ * leaves. Otherwise each key is searched from the leaf of the previous key,
+ * and only probed from the root if it is out of range of that leaf, or a
+ * split happened. Sorted input is not required but it is much faster.
+ *
+ * The whole batch is one transaction if the tree is in persistent memory.
+ *
+ * \param toh		[IN]	Tree open handle.
+ * \param keys		[IN]	Array of \a nr keys.
+ * \param vals		[IN]	Array of \a nr values.
+ * \param nr		[IN]	Number of records.
+ *
+ * \return		0	success
+ *			-ve	error code
+ */
+int
+dbtree_update_batch(daos_handle_t toh, daos_iov_t *keys, daos_iov_t *vals,
+		    unsigned int nr)
+{
+	struct btr_context *tcx;
+	int		    rc;
+
+	tcx = btr_hdl2tcx(toh);
+	if (tcx == NULL)
+		return -DER_NO_HDL;
+
+	if (nr == 0)
+		return 0;
+
+	/* depth could be changed by a different btr_context */
+	btr_context_set_depth(tcx, tcx->tc_tins.ti_root->tr_depth);
+
+	if (btr_has_tx(tcx))
+		rc = btr_tx_batch_upsert(tcx, keys, vals, nr);
+	else
+		rc = btr_batch_upsert(tcx, keys, vals, nr);
+
+	return rc;
+}
+
 /**
  * Delete the leaf record pointed by @cur_tr from the current node, then fill
  * the deletion gap by shifting remainded records on the specified direction.
@@ -1749,16 +2432,14 @@ btr_node_del_leaf_only(struct btr_context *tcx, struct btr_trace *trace,
 		/* shift left records which are on the right side of the
 		 * deleted record.
 		 */
-		btr_rec_move(tcx, rec, btr_rec_at(tcx, rec, 1),
-			     nd->tn_keyn - trace->tr_at);
+		btr_node_rec_move(tcx, trace->tr_node, trace->tr_at,
+				  trace->tr_at + 1, nd->tn_keyn - trace->tr_at);
 
 	} else if (!shift_left && trace->tr_at != 0) {
 		/* shift right records which are on the left side of the
 		 * deleted record.
 		 */
-		rec = btr_node_rec_at(tcx, trace->tr_node, 0);
-		btr_rec_move(tcx, btr_rec_at(tcx, rec, 1), rec,
-			     trace->tr_at);
+		btr_node_rec_move(tcx, trace->tr_node, 1, 0, trace->tr_at);
 	}
 }
 
@@ -1791,9 +2472,6 @@ btr_node_del_leaf_rebal(struct btr_context *tcx,
 {
 	struct btr_node		*cur_nd;
 	struct btr_node		*sib_nd;
-	struct btr_record	*par_rec;
-	struct btr_record	*src_rec;
-	struct btr_record	*dst_rec;
 
 	cur_nd = btr_mmid2ptr(tcx, cur_tr->tr_node);
 	sib_nd = btr_mmid2ptr(tcx, sib_mmid);
@@ -1806,35 +2484,30 @@ btr_node_del_leaf_rebal(struct btr_context *tcx,
 
 	if (sib_on_right) {
 		/* grab the first record from the right sibling */
-		src_rec = btr_node_rec_at(tcx, sib_mmid, 0);
-		dst_rec = btr_node_rec_at(tcx, cur_tr->tr_node,
-					  cur_nd->tn_keyn);
-		btr_rec_copy(tcx, dst_rec, src_rec, 1);
+		btr_node_rec_copy(tcx, cur_tr->tr_node, cur_nd->tn_keyn,
+				  sib_mmid, 0, 1);
 		/* shift left remainded record on the sibling */
-		btr_rec_move(tcx, src_rec, btr_rec_at(tcx, src_rec, 1),
-			     sib_nd->tn_keyn - 1);
+		btr_node_rec_move(tcx, sib_mmid, 0, 1, sib_nd->tn_keyn - 1);
 
 		/* copy the first hkey of the right sibling node to the
 		 * parent node.
+		 * NB: Direct key of parent already points here
 		 */
-		par_rec = btr_node_rec_at(tcx, par_tr->tr_node, par_tr->tr_at);
-
-		/* NB: Direct key of parent already points here */
 		if (!btr_is_direct_key(tcx))
-			btr_rec_copy_hkey(tcx, par_rec, src_rec);
+			btr_node_hkey_copy(tcx, par_tr->tr_node, par_tr->tr_at,
+					   sib_mmid, 0);
 	} else {
 		/* grab the last record from the left sibling */
-		src_rec = btr_node_rec_at(tcx, sib_mmid, sib_nd->tn_keyn - 1);
-		dst_rec = btr_node_rec_at(tcx, cur_tr->tr_node, 0);
-		btr_rec_copy(tcx, dst_rec, src_rec, 1);
+		btr_node_rec_copy(tcx, cur_tr->tr_node, 0, sib_mmid,
+				  sib_nd->tn_keyn - 1, 1);
 		/* copy the first record key of the current node to the
 		 * parent node.
+		 * NB: Direct key of parent already points to this leaf
 		 */
-		par_rec = btr_node_rec_at(tcx, par_tr->tr_node,
-					  par_tr->tr_at - 1);
-		/* NB: Direct key of parent already points to this leaf */
 		if (!btr_is_direct_key(tcx))
-			btr_rec_copy_hkey(tcx, par_rec, dst_rec);
+			btr_node_hkey_copy(tcx, par_tr->tr_node,
+					   par_tr->tr_at - 1,
+					   cur_tr->tr_node, 0);
 	}
 	cur_nd->tn_keyn++;
 	sib_nd->tn_keyn--;
@@ -1859,8 +2532,8 @@ btr_node_del_leaf_merge(struct btr_context *tcx,
 {
 	struct btr_node		*src_nd;
 	struct btr_node		*dst_nd;
-	struct btr_record	*src_rec;
-	struct btr_record	*dst_rec;
+	TMMID(struct btr_node)	 src_mmid;
+	TMMID(struct btr_node)	 dst_mmid;
 
 	/* NB: always left shift because it is easier for the following
 	 * operations.
@@ -1870,40 +2543,31 @@ btr_node_del_leaf_merge(struct btr_context *tcx,
 		/* move all records from the right sibling node to the
 		 * current node.
 		 */
-
-		src_nd = btr_mmid2ptr(tcx, sib_mmid);
-		dst_nd = btr_mmid2ptr(tcx, cur_tr->tr_node);
+		src_mmid = sib_mmid;
+		dst_mmid = cur_tr->tr_node;
+		src_nd = btr_mmid2ptr(tcx, src_mmid);
+		dst_nd = btr_mmid2ptr(tcx, dst_mmid);
 
 		D_DEBUG(DB_TRACE,
 			"Merge the right sibling to current node, "
 			"cur:sib=%d:%d\n", dst_nd->tn_keyn, src_nd->tn_keyn);
-
-		src_rec = btr_node_rec_at(tcx, sib_mmid, 0);
-		dst_rec = btr_node_rec_at(tcx, cur_tr->tr_node,
-					  dst_nd->tn_keyn);
-
 	} else {
 		/* move all records from the current node to the left
 		 * sibling node.
 		 */
-		src_nd = btr_mmid2ptr(tcx, cur_tr->tr_node);
-		dst_nd = btr_mmid2ptr(tcx, sib_mmid);
+		src_mmid = cur_tr->tr_node;
+		dst_mmid = sib_mmid;
+		src_nd = btr_mmid2ptr(tcx, src_mmid);
+		dst_nd = btr_mmid2ptr(tcx, dst_mmid);
 
 		D_DEBUG(DB_TRACE,
 			"Merge the current node to left sibling, "
 			"cur:sib=%d:%d\n", src_nd->tn_keyn, dst_nd->tn_keyn);
-
-		if (src_nd->tn_keyn != 0) {
-			src_rec = btr_node_rec_at(tcx, cur_tr->tr_node, 0);
-			dst_rec = btr_node_rec_at(tcx, sib_mmid,
-						  dst_nd->tn_keyn);
-		} else { /* current node is empty */
-			src_rec = dst_rec = NULL;
-		}
 	}
 
-	if (src_rec != NULL) {
-		btr_rec_copy(tcx, dst_rec, src_rec, src_nd->tn_keyn);
+	if (src_nd->tn_keyn != 0) {
+		btr_node_rec_copy(tcx, dst_mmid, dst_nd->tn_keyn, src_mmid, 0,
+				  src_nd->tn_keyn);
 
 		dst_nd->tn_keyn += src_nd->tn_keyn;
 		D_ASSERT(dst_nd->tn_keyn < tcx->tc_order);
@@ -1992,17 +2656,17 @@ btr_node_del_child_only(struct btr_context *tcx, struct btr_trace *trace,
 		 * deleted record.
 		 */
 		if (trace->tr_at == 0) {
-			nd->tn_child = umem_id_u2t(nd->tn_recs[0].rec_mmid,
+			rec = btr_node_rec_at(tcx, trace->tr_node, 0);
+			nd->tn_child = umem_id_u2t(rec->rec_mmid,
 						   struct btr_node);
 		} else {
 			trace->tr_at -= 1;
 		}
 
 		if (trace->tr_at != nd->tn_keyn) {
-			rec = btr_node_rec_at(tcx, trace->tr_node,
-					      trace->tr_at);
-			btr_rec_move(tcx, rec, btr_rec_at(tcx, rec, 1),
-				     nd->tn_keyn - trace->tr_at);
+			btr_node_rec_move(tcx, trace->tr_node, trace->tr_at,
+					  trace->tr_at + 1,
+					  nd->tn_keyn - trace->tr_at);
 		}
 
 	} else {
@@ -2010,11 +2674,11 @@ btr_node_del_child_only(struct btr_context *tcx, struct btr_trace *trace,
 		 * deleted record.
 		 */
 		if (trace->tr_at != 0) {
-			rec = btr_node_rec_at(tcx, trace->tr_node, 0);
 			if (trace->tr_at > 1) {
-				btr_rec_move(tcx, btr_rec_at(tcx, rec, 1), rec,
-					     trace->tr_at - 1);
+				btr_node_rec_move(tcx, trace->tr_node, 1, 0,
+						  trace->tr_at - 1);
 			}
+			rec = btr_node_rec_at(tcx, trace->tr_node, 0);
 			rec->rec_mmid = umem_id_t2u(nd->tn_child);
 		}
 	}
@@ -2038,7 +2702,6 @@ btr_node_del_child_rebal(struct btr_context *tcx,
 {
 	struct btr_node		*cur_nd;
 	struct btr_node		*sib_nd;
-	struct btr_record	*par_rec;
 	struct btr_record	*src_rec;
 	struct btr_record	*dst_rec;
 
@@ -2056,27 +2719,26 @@ btr_node_del_child_rebal(struct btr_context *tcx,
 		src_rec = btr_node_rec_at(tcx, sib_mmid, 0);
 		dst_rec = btr_node_rec_at(tcx, cur_tr->tr_node,
 					  cur_nd->tn_keyn);
-		par_rec = btr_node_rec_at(tcx, par_tr->tr_node, par_tr->tr_at);
 
 		dst_rec->rec_mmid = umem_id_t2u(sib_nd->tn_child);
 
-		btr_rec_copy_hkey(tcx, dst_rec, par_rec);
-		btr_rec_copy_hkey(tcx, par_rec, src_rec);
+		btr_node_hkey_copy(tcx, cur_tr->tr_node, cur_nd->tn_keyn,
+				   par_tr->tr_node, par_tr->tr_at);
+		btr_node_hkey_copy(tcx, par_tr->tr_node, par_tr->tr_at,
+				   sib_mmid, 0);
 
 		sib_nd->tn_child = umem_id_u2t(src_rec->rec_mmid,
 					       struct btr_node);
-		btr_rec_move(tcx, src_rec, btr_rec_at(tcx, src_rec, 1),
-			     sib_nd->tn_keyn - 1);
+		btr_node_rec_move(tcx, sib_mmid, 0, 1, sib_nd->tn_keyn - 1);
 
 	} else {
 		/* grab the last child from the left sibling */
 		src_rec = btr_node_rec_at(tcx, sib_mmid, sib_nd->tn_keyn - 1);
-		dst_rec = btr_node_rec_at(tcx, cur_tr->tr_node, 0);
-		par_rec = btr_node_rec_at(tcx, par_tr->tr_node,
-					  par_tr->tr_at - 1);
 
-		btr_rec_copy_hkey(tcx, dst_rec, par_rec);
-		btr_rec_copy_hkey(tcx, par_rec, src_rec);
+		btr_node_hkey_copy(tcx, cur_tr->tr_node, 0,
+				   par_tr->tr_node, par_tr->tr_at - 1);
+		btr_node_hkey_copy(tcx, par_tr->tr_node, par_tr->tr_at - 1,
+				   sib_mmid, sib_nd->tn_keyn - 1);
 
 		cur_nd->tn_child = umem_id_u2t(src_rec->rec_mmid,
 					       struct btr_node);
@@ -2102,9 +2764,10 @@ btr_node_del_child_merge(struct btr_context *tcx,
 {
 	struct btr_node		*src_nd;
 	struct btr_node		*dst_nd;
-	struct btr_record	*par_rec;
-	struct btr_record	*src_rec;
 	struct btr_record	*dst_rec;
+	TMMID(struct btr_node)	 src_mmid;
+	TMMID(struct btr_node)	 dst_mmid;
+	unsigned int		 par_at;
 
 	/* NB: always left shift because it is easier for the following
 	 * operations.
@@ -2112,42 +2775,36 @@ btr_node_del_child_merge(struct btr_context *tcx,
 	btr_node_del_child_only(tcx, cur_tr, true);
 	if (sib_on_right) {
 		/* move children from the right sibling to the current node. */
-		src_nd = btr_mmid2ptr(tcx, sib_mmid);
-		dst_nd = btr_mmid2ptr(tcx, cur_tr->tr_node);
+		src_mmid = sib_mmid;
+		dst_mmid = cur_tr->tr_node;
+		par_at	 = par_tr->tr_at;
+		src_nd = btr_mmid2ptr(tcx, src_mmid);
+		dst_nd = btr_mmid2ptr(tcx, dst_mmid);
 
 		D_DEBUG(DB_TRACE,
 			"Merge the right sibling to current node, "
 			"cur:sib=%d:%d\n", dst_nd->tn_keyn, src_nd->tn_keyn);
-
-		src_rec = btr_node_rec_at(tcx, sib_mmid, 0);
-		dst_rec = btr_node_rec_at(tcx, cur_tr->tr_node,
-					  dst_nd->tn_keyn);
-		par_rec = btr_node_rec_at(tcx, par_tr->tr_node, par_tr->tr_at);
-
-		dst_rec->rec_mmid = umem_id_t2u(src_nd->tn_child);
-
 	} else {
 		/* move children of the current node to the left sibling. */
-		src_nd = btr_mmid2ptr(tcx, cur_tr->tr_node);
-		dst_nd = btr_mmid2ptr(tcx, sib_mmid);
+		src_mmid = cur_tr->tr_node;
+		dst_mmid = sib_mmid;
+		par_at	 = par_tr->tr_at - 1;
+		src_nd = btr_mmid2ptr(tcx, src_mmid);
+		dst_nd = btr_mmid2ptr(tcx, dst_mmid);
 
 		D_DEBUG(DB_TRACE,
 			"Merge the current node to left sibling, "
 			"cur:sib=%d:%d\n", src_nd->tn_keyn, dst_nd->tn_keyn);
-
-		dst_rec = btr_node_rec_at(tcx, sib_mmid, dst_nd->tn_keyn);
-		par_rec = btr_node_rec_at(tcx, par_tr->tr_node,
-					  par_tr->tr_at - 1);
-
-		dst_rec->rec_mmid = umem_id_t2u(src_nd->tn_child);
-		src_rec = src_nd->tn_keyn == 0 ?
-			  NULL : btr_node_rec_at(tcx, cur_tr->tr_node, 0);
 	}
-	btr_rec_copy_hkey(tcx, dst_rec, par_rec);
+	dst_rec = btr_node_rec_at(tcx, dst_mmid, dst_nd->tn_keyn);
+	dst_rec->rec_mmid = umem_id_t2u(src_nd->tn_child);
+	btr_node_hkey_copy(tcx, dst_mmid, dst_nd->tn_keyn,
+			   par_tr->tr_node, par_at);
 
-	if (src_rec != NULL) {
-		dst_rec = btr_rec_at(tcx, dst_rec, 1); /* the next record */
-		btr_rec_copy(tcx, dst_rec, src_rec, src_nd->tn_keyn);
+	if (src_nd->tn_keyn != 0) {
+		/* the next record */
+		btr_node_rec_copy(tcx, dst_mmid, dst_nd->tn_keyn + 1,
+				  src_mmid, 0, src_nd->tn_keyn);
 	}
 
 	/* NB: destination got an extra key from the parent, and an extra
@@ -3344,6 +4001,13 @@ btr_class_init(TMMID(struct btr_root) root_mmid, struct btr_root *root,
 		return -DER_PROTO;
 	}
 
+	if ((*tree_feats & BTR_FEAT_KEY_ARRAY) &&
+	    (*tree_feats & BTR_FEAT_DIRECT_KEY)) {
+		D_ERROR("Key array cannot be used with direct key, tree "
+			"class %d\n", tree_class);
+		return -DER_INVAL;
+	}
+
 	tins->ti_ops = tc->tc_ops;
 	return rc;
 }
@@ -3374,6 +4038,14 @@ dbtree_class_register(unsigned int tree_class, uint64_t tree_feats,
 	}
 	if (tree_feats & BTR_FEAT_DIRECT_KEY)
 		D_ASSERT(ops->to_key_cmp != NULL);
+
+	/* key array search is only for integer keys or memcmp'able hkeys,
+	 * customized hkeys should be converted to memcmp'able images.
+	 */
+	if ((tree_feats & BTR_FEAT_KEY_ARRAY) &&
+	    !(tree_feats & BTR_FEAT_UINT_KEY) &&
+	    ops->to_hkey_cmp != NULL && ops->to_hkey_image == NULL)
+		return -DER_INVAL;
 	D_ASSERT(ops->to_rec_fetch != NULL);
 	D_ASSERT(ops->to_rec_alloc != NULL);
 	D_ASSERT(ops->to_rec_free != NULL);
@@ -0,0 +1,355 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Reed-Solomon erasure codec.
+ *
+ * Matrix generation and inversion are done by portable GF(2^8) code, the
+ * per-byte multiply/accumulate kernel is ISA-L's ec_encode_data() on x86_64,
+ * which dispatches at runtime to the widest SIMD implementation available
+ * (SSE/AVX2/AVX512). Other platforms fall back to a table driven kernel using
+ * the same split-nibble tables.
+ *
+ * src/common/ec.c
+ */
+#define D_LOGFAC	DD_FAC(common)
+
+#include <daos/ec.h>
+#if defined(__x86_64__)
+#include <isa-l.h>
+#endif
+
+/** ISA-L expands each coefficient into a 32-byte split-nibble table */
+#define EC_GFTBL_SIZE	32
+
+/** GF(2^8) generator polynomial, x^8 + x^4 + x^3 + x^2 + 1 */
+#define EC_GF_POLY	0x11d
+
+static unsigned char	ec_gf_log[256];
+static unsigned char	ec_gf_exp[512];
+static pthread_once_t	ec_gf_once = PTHREAD_ONCE_INIT;
+
+static void
+ec_gf_init(void)
+{
+	unsigned int	x = 1;
+	int		i;
+
+	for (i = 0; i < 255; i++) {
+		ec_gf_exp[i] = x;
+		ec_gf_log[x] = i;
+		x <<= 1;
+		if (x & 0x100)
+			x ^= EC_GF_POLY;
+	}
+	for (i = 255; i < 512; i++)
+		ec_gf_exp[i] = ec_gf_exp[i - 255];
+}
+
+static inline unsigned char
+ec_gf_mul(unsigned char a, unsigned char b)
+{
+	if (a == 0 || b == 0)
+		return 0;
+	return ec_gf_exp[ec_gf_log[a] + ec_gf_log[b]];
+}
+
+static inline unsigned char
+ec_gf_inv(unsigned char a)
+{
+	D_ASSERT(a != 0);
+	return ec_gf_exp[255 - ec_gf_log[a]];
+}
+
+/**
+ * Cauchy matrix, identical to gf_gen_cauchy1_matrix() of ISA-L. Any k rows of
+ * it form an invertible matrix, which is not true for the Vandermonde based
+ * matrix.
+ */
+static void
+ec_gen_matrix(unsigned char *a, unsigned int m, unsigned int k)
+{
+	unsigned char	*p;
+	unsigned int	 i;
+	unsigned int	 j;
+
+	memset(a, 0, k * m);
+	for (i = 0; i < k; i++)
+		a[k * i + i] = 1;
+
+	p = &a[k * k];
+	for (i = k; i < m; i++)
+		for (j = 0; j < k; j++)
+			*p++ = ec_gf_inv(i ^ j);
+}
+
+/** Gauss-Jordan inversion of the n x n matrix @in, @in is destroyed */
+static int
+ec_invert_matrix(unsigned char *in, unsigned char *out, unsigned int n)
+{
+	unsigned char	tmp;
+	unsigned int	i;
+	unsigned int	j;
+	unsigned int	k;
+
+	memset(out, 0, n * n);
+	for (i = 0; i < n; i++)
+		out[i * n + i] = 1;
+
+	for (i = 0; i < n; i++) {
+		/* find a pivot */
+		if (in[i * n + i] == 0) {
+			for (j = i + 1; j < n; j++) {
+				if (in[j * n + i] != 0)
+					break;
+			}
+			if (j == n)
+				return -DER_INVAL;
+
+			for (k = 0; k < n; k++) {
+				tmp = in[i * n + k];
+				in[i * n + k] = in[j * n + k];
+				in[j * n + k] = tmp;
+
+				tmp = out[i * n + k];
+				out[i * n + k] = out[j * n + k];
+				out[j * n + k] = tmp;
+			}
+		}
+
+		tmp = ec_gf_inv(in[i * n + i]);
+		for (j = 0; j < n; j++) {
+			in[i * n + j] = ec_gf_mul(in[i * n + j], tmp);
+			out[i * n + j] = ec_gf_mul(out[i * n + j], tmp);
+		}
+
+		for (j = 0; j < n; j++) {
+			if (j == i)
+				continue;
+
+			tmp = in[j * n + i];
+			if (tmp == 0)
+				continue;
+
+			for (k = 0; k < n; k++) {
+				out[j * n + k] ^= ec_gf_mul(tmp, out[i * n + k]);
+				in[j * n + k] ^= ec_gf_mul(tmp, in[i * n + k]);
+			}
+		}
+	}
+	return 0;
+}
+
+#if defined(__x86_64__)
+
+static void
+ec_init_gftbls(unsigned int k, unsigned int rows, unsigned char *matrix,
+	       unsigned char *gftbls)
+{
+	ec_init_tables(k, rows, matrix, gftbls);
+}
+
+static void
+ec_encode_rows(unsigned int len, unsigned int k, unsigned int rows,
+	       unsigned char *gftbls, unsigned char **src,
+	       unsigned char **dst)
+{
+	ec_encode_data(len, k, rows, gftbls, src, dst);
+}
+
+#else /* !__x86_64__ */
+
+/**
+ * Same layout as ISA-L: for coefficient c, tbl[0..15] = c * (0..15) and
+ * tbl[16..31] = c * ((0..15) << 4), so c * x is the xor of two lookups.
+ */
+static void
+ec_init_gftbls(unsigned int k, unsigned int rows, unsigned char *matrix,
+	       unsigned char *gftbls)
+{
+	unsigned char	*tbl;
+	unsigned char	 c;
+	unsigned int	 i;
+	unsigned int	 j;
+
+	for (i = 0; i < rows * k; i++) {
+		c = matrix[i];
+		tbl = &gftbls[i * EC_GFTBL_SIZE];
+		for (j = 0; j < 16; j++) {
+			tbl[j] = ec_gf_mul(c, j);
+			tbl[16 + j] = ec_gf_mul(c, j << 4);
+		}
+	}
+}
+
+static void
+ec_encode_rows(unsigned int len, unsigned int k, unsigned int rows,
+	       unsigned char *gftbls, unsigned char **src,
+	       unsigned char **dst)
+{
+	unsigned char	*tbl;
+	unsigned char	*s;
+	unsigned char	*d;
+	unsigned int	 r;
+	unsigned int	 i;
+	unsigned int	 b;
+
+	for (r = 0; r < rows; r++) {
+		d = dst[r];
+		memset(d, 0, len);
+		for (i = 0; i < k; i++) {
+			tbl = &gftbls[(r * k + i) * EC_GFTBL_SIZE];
+			s = src[i];
+			for (b = 0; b < len; b++)
+				d[b] ^= tbl[s[b] & 0xf] ^ tbl[16 + (s[b] >> 4)];
+		}
+	}
+}
+
+#endif /* __x86_64__ */
+
+int
+daos_ec_codec_init(struct daos_ec_codec *codec, unsigned int k,
+		   unsigned int p)
+{
+	if (k == 0 || p == 0 || k + p > DAOS_EC_CELLS_MAX) {
+		D_ERROR("Invalid EC parameters k=%u, p=%u\n", k, p);
+		return -DER_INVAL;
+	}
+
+	pthread_once(&ec_gf_once, ec_gf_init);
+
+	memset(codec, 0, sizeof(*codec));
+	D_ALLOC(codec->ec_matrix, (k + p) * k);
+	if (codec->ec_matrix == NULL)
+		return -DER_NOMEM;
+
+	D_ALLOC(codec->ec_gftbls, k * p * EC_GFTBL_SIZE);
+	if (codec->ec_gftbls == NULL) {
+		D_FREE(codec->ec_matrix);
+		return -DER_NOMEM;
+	}
+
+	codec->ec_k = k;
+	codec->ec_p = p;
+	ec_gen_matrix(codec->ec_matrix, k + p, k);
+	ec_init_gftbls(k, p, &codec->ec_matrix[k * k], codec->ec_gftbls);
+
+	D_DEBUG(DB_TRACE, "Initialized EC codec k=%u, p=%u\n", k, p);
+	return 0;
+}
+
+void
+daos_ec_codec_fini(struct daos_ec_codec *codec)
+{
+	if (codec->ec_matrix != NULL)
+		D_FREE(codec->ec_matrix);
+	if (codec->ec_gftbls != NULL)
+		D_FREE(codec->ec_gftbls);
+	codec->ec_k = codec->ec_p = 0;
+}
+
+void
+daos_ec_encode(struct daos_ec_codec *codec, unsigned int len,
+	       unsigned char **data, unsigned char **parity)
+{
+	ec_encode_rows(len, codec->ec_k, codec->ec_p, codec->ec_gftbls,
+		       data, parity);
+}
+
+int
+daos_ec_decode(struct daos_ec_codec *codec, unsigned int len,
+	       unsigned char **cells, uint32_t lost)
+{
+	unsigned int	 k = codec->ec_k;
+	unsigned int	 m = codec->ec_k + codec->ec_p;
+	unsigned char	 matrix[DAOS_EC_CELLS_MAX * DAOS_EC_CELLS_MAX];
+	unsigned char	 invert[DAOS_EC_CELLS_MAX * DAOS_EC_CELLS_MAX];
+	unsigned char	 decode[DAOS_EC_CELLS_MAX * DAOS_EC_CELLS_MAX];
+	unsigned char	*gftbls;
+	unsigned char	*src[DAOS_EC_CELLS_MAX];
+	unsigned char	*dst[DAOS_EC_CELLS_MAX];
+	unsigned char	 s;
+	unsigned int	 nlost = 0;
+	unsigned int	 i;
+	unsigned int	 j;
+	unsigned int	 l;
+	unsigned int	 r;
+	int		 rc;
+
+	if (lost == 0)
+		return 0;
+
+	for (i = 0; i < m; i++) {
+		if (lost & (1U << i))
+			dst[nlost++] = cells[i];
+	}
+
+	/* m can be 32, shift a 64-bit value */
+	if (nlost > codec->ec_p || ((uint64_t)lost >> m) != 0) {
+		D_ERROR("Cannot recover %u lost cells with k=%u, p=%u\n",
+			nlost, k, codec->ec_p);
+		return -DER_INVAL;
+	}
+
+	/* rows of the encode matrix for the first k surviving cells */
+	for (i = 0, r = 0; i < k; i++, r++) {
+		while (lost & (1U << r))
+			r++;
+		memcpy(&matrix[k * i], &codec->ec_matrix[k * r], k);
+		src[i] = cells[r];
+	}
+
+	rc = ec_invert_matrix(matrix, invert, k);
+	if (rc != 0) {
+		D_ERROR("Singular EC decode matrix\n");
+		return rc;
+	}
+
+	/* rows which regenerate the lost cells from the surviving ones */
+	for (i = 0, l = 0; i < m; i++) {
+		if (!(lost & (1U << i)))
+			continue;
+
+		if (i < k) {
+			memcpy(&decode[k * l], &invert[k * i], k);
+		} else {
+			for (j = 0; j < k; j++) {
+				s = 0;
+				for (r = 0; r < k; r++)
+					s ^= ec_gf_mul(invert[r * k + j],
+						codec->ec_matrix[k * i + r]);
+				decode[k * l + j] = s;
+			}
+		}
+		l++;
+	}
+
+	D_ALLOC(gftbls, k * nlost * EC_GFTBL_SIZE);
+	if (gftbls == NULL)
+		return -DER_NOMEM;
+
+	ec_init_gftbls(k, nlost, decode, gftbls);
+	ec_encode_rows(len, k, nlost, gftbls, src, dst);
+	D_FREE(gftbls);
+	return 0;
+}
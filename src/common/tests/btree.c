@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <getopt.h>
+#include <endian.h>
 
 #include <daos/btree.h>
 #include <daos/tests_lib.h>
@@ -52,6 +53,8 @@ struct ik_rec {
 };
 
 #define IK_TREE_CLASS	100
+/** same as IK_TREE_CLASS, but with customized hkey compare */
+#define IK_IMG_TREE_CLASS	101
 #define POOL_NAME "/mnt/daos/btree-test"
 #define POOL_SIZE ((1024 * 1024  * 1024ULL))
 
@@ -75,6 +78,30 @@ ik_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
 	memcpy(hkey, ikey, sizeof(*ikey));
 }
 
+/** compare hashed keys as integers, so iteration is in integer order */
+static int
+ik_hkey_cmp(struct btr_instance *tins, struct btr_record *rec, void *hkey)
+{
+	uint64_t	a;
+	uint64_t	b;
+
+	memcpy(&a, &rec->rec_hkey[0], sizeof(a));
+	memcpy(&b, hkey, sizeof(b));
+
+	return (a < b) ? BTR_CMP_LT : ((a > b) ? BTR_CMP_GT : BTR_CMP_EQ);
+}
+
+/** big endian integer has the same memcmp order as ik_hkey_cmp */
+static void
+ik_hkey_image(struct btr_instance *tins, void *hkey, void *image)
+{
+	uint64_t	ikey;
+
+	memcpy(&ikey, hkey, sizeof(ikey));
+	ikey = htobe64(ikey);
+	memcpy(image, &ikey, sizeof(ikey));
+}
+
 static int
 ik_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 	      daos_iov_t *val_iov, struct btr_record *rec)
@@ -245,6 +272,19 @@ static btr_ops_t ik_ops = {
 	.to_rec_stat	= ik_rec_stat,
 };
 
+static btr_ops_t ik_img_ops = {
+	.to_hkey_size	= ik_hkey_size,
+	.to_hkey_gen	= ik_hkey_gen,
+	.to_hkey_cmp	= ik_hkey_cmp,
+	.to_hkey_image	= ik_hkey_image,
+	.to_rec_alloc	= ik_rec_alloc,
+	.to_rec_free	= ik_rec_free,
+	.to_rec_fetch	= ik_rec_fetch,
+	.to_rec_update	= ik_rec_update,
+	.to_rec_string	= ik_rec_string,
+	.to_rec_stat	= ik_rec_stat,
+};
+
 #define IK_ORDER_DEF	16
 
 static int ik_order = IK_ORDER_DEF;
@@ -260,6 +300,7 @@ static int
 ik_btr_open_create(bool create, char *args)
 {
 	bool		inplace = false;
+	unsigned int	class = IK_TREE_CLASS;
 	uint64_t	feats = 0;
 	int		rc;
 
@@ -273,6 +314,14 @@ ik_btr_open_create(bool create, char *args)
 			feats = BTR_FEAT_UINT_KEY;
 			args += 1;
 		}
+		if (args[0] == '@') { /* separated key array */
+			feats |= BTR_FEAT_KEY_ARRAY;
+			args += 1;
+		}
+		if (args[0] == '#') { /* customized hkey compare */
+			class = IK_IMG_TREE_CLASS;
+			args += 1;
+		}
 		if (args[0] == 'i') { /* inplace create/open */
 			inplace = true;
 			if (args[1] != IK_SEP) {
@@ -301,14 +350,13 @@ ik_btr_open_create(bool create, char *args)
 	}
 
 	if (create) {
-		D_PRINT("Create btree with order %d%s feats "DF_X64"\n",
-			ik_order, inplace ? " inplace" : "", feats);
+		D_PRINT("Create btree with order %d%s class %u feats "DF_X64"\n",
+			ik_order, inplace ? " inplace" : "", class, feats);
 		if (inplace) {
-			rc = dbtree_create_inplace(IK_TREE_CLASS, feats,
-						   ik_order, &ik_uma, &ik_root,
-						   &ik_toh);
+			rc = dbtree_create_inplace(class, feats, ik_order,
+						   &ik_uma, &ik_root, &ik_toh);
 		} else {
-			rc = dbtree_create(IK_TREE_CLASS, feats, ik_order,
+			rc = dbtree_create(class, feats, ik_order,
 					   &ik_uma, &ik_root_mmid, &ik_toh);
 		}
 	} else {
@@ -775,7 +823,8 @@ ik_btr_perf(unsigned int key_nr)
 		}
 	}
 	now = dts_time_now();
-	D_PRINT("insert = %10.2f/sec\n", key_nr / (now - then));
+	D_PRINT("insert = %10.2f/sec, %8.1f ns/op\n", key_nr / (now - then),
+		(now - then) * 1e9 / key_nr);
 
 	/* step-2: lookup performance */
 	ik_btr_gen_keys(arr, key_nr);
@@ -791,7 +840,8 @@ ik_btr_perf(unsigned int key_nr)
 		}
 	}
 	now = dts_time_now();
-	D_PRINT("lookup = %10.2f/sec\n", key_nr / (now - then));
+	D_PRINT("lookup = %10.2f/sec, %8.1f ns/op\n", key_nr / (now - then),
+		(now - then) * 1e9 / key_nr);
 
 	/* step-3: delete performance */
 	ik_btr_gen_keys(arr, key_nr);
@@ -807,13 +857,165 @@ ik_btr_perf(unsigned int key_nr)
 		}
 	}
 	now = dts_time_now();
-	D_PRINT("delete = %10.2f/sec\n", key_nr / (now - then));
+	D_PRINT("delete = %10.2f/sec, %8.1f ns/op\n", key_nr / (now - then),
+		(now - then) * 1e9 / key_nr);
 
 out:
 	free(arr);
 	return rc;
 }
 
+/** check all \a keys can be found in the tree, and nothing else */
+static int
+ik_btr_bulk_check(daos_handle_t toh, daos_iov_t *keys, unsigned int key_nr)
+{
+	struct btr_stat	stat;
+	daos_iov_t	val;
+	int		i;
+	int		rc;
+
+	for (i = 0; i < key_nr; i++) {
+		daos_iov_set(&val, NULL, 0);
+		rc = dbtree_lookup(toh, &keys[i], &val);
+		if (rc != 0) {
+			D_PRINT("lookup "DF_U64" failed: %d\n",
+				*(uint64_t *)keys[i].iov_buf, rc);
+			return -1;
+		}
+	}
+
+	rc = dbtree_query(toh, NULL, &stat);
+	if (rc != 0 || stat.bs_rec_nr != key_nr) {
+		D_PRINT("wrong number of records: "DF_U64"/%u\n",
+			stat.bs_rec_nr, key_nr);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Compare dbtree_update() and dbtree_update_batch() with sorted keys:
+ * - load even keys to the tree by dbtree_update(), and to another empty tree
+ *   by dbtree_update_batch(), which builds the tree from bottom up.
+ * - insert odd keys to the first tree by dbtree_update_batch(), and to the
+ *   bulk loaded tree by dbtree_update().
+ */
+static int
+ik_btr_bulk(unsigned int key_nr)
+{
+	TMMID(struct btr_root)	 root_mmid;
+	daos_handle_t		 toh = DAOS_HDL_INVAL;
+	struct btr_attr		 attr;
+	uint64_t		*ikeys = NULL;
+	daos_iov_t		*keys = NULL;
+	double			 then;
+	double			 upd[2];
+	double			 bulk;
+	double			 batch;
+	unsigned int		 half;
+	int			 i;
+	int			 rc;
+
+	if (key_nr < 2 || key_nr > (1U << 28)) {
+		D_PRINT("Invalid key number: %d\n", key_nr);
+		return -1;
+	}
+
+	rc = dbtree_query(ik_toh, &attr, NULL);
+	if (rc != 0) {
+		D_PRINT("Please create tree first\n");
+		return -1;
+	}
+
+	D_PRINT("Btree bulk load test, order=%u, keys=%u\n",
+		attr.ba_order, key_nr);
+
+	ikeys = malloc(key_nr * sizeof(*ikeys));
+	keys = malloc(key_nr * sizeof(*keys));
+	D_ASSERT(ikeys != NULL && keys != NULL);
+
+	/* even keys go first, then odd keys, value is the same as key */
+	half = (key_nr + 1) / 2;
+	for (i = 0; i < key_nr; i++) {
+		ikeys[i] = i < half ? 2 * i : 2 * (i - half) + 1;
+		daos_iov_set(&keys[i], &ikeys[i], sizeof(ikeys[i]));
+	}
+
+	rc = dbtree_create(attr.ba_class, attr.ba_feats, attr.ba_order,
+			   &ik_uma, &root_mmid, &toh);
+	if (rc != 0) {
+		D_PRINT("create failed: %d\n", rc);
+		D_GOTO(out, rc = -1);
+	}
+
+	/* step-1: load even keys */
+	then = dts_time_now();
+	for (i = 0; i < half; i++) {
+		rc = dbtree_update(ik_toh, &keys[i], &keys[i]);
+		if (rc != 0) {
+			D_PRINT("update failed: %d\n", rc);
+			D_GOTO(out, rc = -1);
+		}
+	}
+	upd[0] = dts_time_now() - then;
+
+	then = dts_time_now();
+	rc = dbtree_update_batch(toh, keys, keys, half);
+	if (rc != 0) {
+		D_PRINT("bulk load failed: %d\n", rc);
+		D_GOTO(out, rc = -1);
+	}
+	bulk = dts_time_now() - then;
+
+	/* step-2: insert odd keys */
+	then = dts_time_now();
+	rc = dbtree_update_batch(ik_toh, &keys[half], &keys[half],
+				 key_nr - half);
+	if (rc != 0) {
+		D_PRINT("batch update failed: %d\n", rc);
+		D_GOTO(out, rc = -1);
+	}
+	batch = dts_time_now() - then;
+
+	then = dts_time_now();
+	for (i = half; i < key_nr; i++) {
+		rc = dbtree_update(toh, &keys[i], &keys[i]);
+		if (rc != 0) {
+			D_PRINT("update failed: %d\n", rc);
+			D_GOTO(out, rc = -1);
+		}
+	}
+	upd[1] = dts_time_now() - then;
+
+	rc = ik_btr_bulk_check(ik_toh, keys, key_nr);
+	if (rc == 0)
+		rc = ik_btr_bulk_check(toh, keys, key_nr);
+	if (rc != 0)
+		D_GOTO(out, rc = -1);
+
+	/* the bulk loaded tree should be able to rebalance */
+	for (i = 0; i < key_nr; i++) {
+		rc = dbtree_delete(toh, &keys[i], NULL);
+		if (rc != 0) {
+			D_PRINT("delete failed: %d\n", rc);
+			D_GOTO(out, rc = -1);
+		}
+	}
+
+	D_PRINT("load:   update = %8.1f ns/op, bulk  = %8.1f ns/op, "
+		"speedup = %.2f\n", upd[0] * 1e9 / half, bulk * 1e9 / half,
+		upd[0] / bulk);
+	D_PRINT("insert: update = %8.1f ns/op, batch = %8.1f ns/op, "
+		"speedup = %.2f\n", upd[1] * 1e9 / (key_nr - half),
+		batch * 1e9 / (key_nr - half), upd[1] / batch);
+out:
+	if (!daos_handle_is_inval(toh))
+		dbtree_destroy(toh);
+	free(keys);
+	free(ikeys);
+	return rc;
+}
+
 static struct option btr_ops[] = {
 	{ "create",	required_argument,	NULL,	'C'	},
 	{ "destroy",	no_argument,		NULL,	'D'	},
@@ -827,6 +1029,7 @@ static struct option btr_ops[] = {
 	{ "iterate",	required_argument,	NULL,	'i'	},
 	{ "batch",	required_argument,	NULL,	'b'	},
 	{ "perf",	required_argument,	NULL,	'p'	},
+	{ "bulk",	required_argument,	NULL,	'B'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -843,12 +1046,19 @@ main(int argc, char **argv)
 	if (rc != 0)
 		return rc;
 
-	rc = dbtree_class_register(IK_TREE_CLASS, BTR_FEAT_UINT_KEY, &ik_ops);
+	rc = dbtree_class_register(IK_TREE_CLASS,
+				   BTR_FEAT_UINT_KEY | BTR_FEAT_KEY_ARRAY,
+				   &ik_ops);
+	D_ASSERT(rc == 0);
+
+	rc = dbtree_class_register(IK_IMG_TREE_CLASS,
+				   BTR_FEAT_UINT_KEY | BTR_FEAT_KEY_ARRAY,
+				   &ik_img_ops);
 	D_ASSERT(rc == 0);
 
 	optind = 0;
 	ik_uma.uma_id = UMEM_CLASS_VMEM;
-	while ((rc = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:",
+	while ((rc = getopt_long(argc, argv, "mC:Docqu:d:r:f:i:b:p:B:",
 				 btr_ops, NULL)) != -1) {
 		switch (rc) {
 		case 'C':
@@ -888,6 +1098,9 @@ main(int argc, char **argv)
 		case 'p':
 			rc = ik_btr_perf(atoi(optarg));
 			break;
+		case 'B':
+			rc = ik_btr_bulk(atoi(optarg));
+			break;
 		case 'm':
 			ik_uma.uma_id = UMEM_CLASS_PMEM;
 			ik_uma.uma_u.pmem_pool = pmemobj_create(POOL_NAME,
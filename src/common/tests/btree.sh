@@ -30,14 +30,20 @@ Usage: btree.sh [OPTIONS]
     Options:
         -s [num]  Run with num keys
         ukey      Use integer keys
+        karr      Use the separated key array node layout
+        hcmp      Use customized hkey compare (and key array image)
         perf      Run performance tests
+        bulk      Run bulk load tests with integer keys, 1M keys by default
         direct    Use direct string key
 EOF
     exit 1
 }
 
 PERF=""
+BULK=""
 UINT=""
+KARR=""
+HCMP=""
 while [ $# -gt 0 ]; do
     case "$1" in
     -s)
@@ -53,10 +59,23 @@ while [ $# -gt 0 ]; do
         shift
         PERF="on"
         ;;
+    bulk)
+        shift
+        BULK="on"
+        BAT_NUM=${BULK_NUM:-"1000000"}
+        ;;
     ukey)
         shift
         UINT="+"
         ;;
+    karr)
+        shift
+        KARR="@"
+        ;;
+    hcmp)
+        shift
+        HCMP="#"
+        ;;
     direct)
         BTR=$DAOS_DIR/build/src/common/tests/btree_direct
         KEYS=${KEYS:-"delta,lambda,kappa,omega,beta,alpha,epsilon"}
@@ -71,13 +90,22 @@ while [ $# -gt 0 ]; do
     esac
 done
 
+FEAT="${UINT}${KARR}${HCMP}"
+
 set -x
 
-if [ -z ${PERF} ]; then
+if [ -n "${BULK}" ]; then
+
+    echo "B+tree bulk load test..."
+    "$BTR" -C "+${KARR}${HCMP}${IPL}o:$ORDER" \
+    -B "$BAT_NUM"                             \
+    -D
+
+elif [ -z ${PERF} ]; then
 
     echo "B+tree functional test..."
     DAOS_DEBUG="$DDEBUG"              \
-    "$BTR" -C "${UINT}${IPL}o:$ORDER" \
+    "$BTR" -C "${FEAT}${IPL}o:$ORDER" \
     -c                                \
     -o                                \
     -u "$RECORDS"                     \
@@ -95,20 +123,25 @@ if [ -z ${PERF} ]; then
     -D
 
     echo "B+tree batch operations test..."
-    "$BTR" -C "${UINT}${IPL}o:$ORDER" \
+    "$BTR" -C "${FEAT}${IPL}o:$ORDER" \
     -c                                \
     -o                                \
     -b "$BAT_NUM"                     \
     -D
 else
     echo "B+tree performance test..."
-    "$BTR" -C "${UINT}${IPL}o:$ORDER" \
+    "$BTR" -C "${FEAT}${IPL}o:$ORDER" \
     -p "$BAT_NUM"                     \
     -D
 
+    echo "B+tree performance test with key array..."
+    "$BTR" -C "${UINT}@${HCMP}${IPL}o:$ORDER" \
+    -p "$BAT_NUM"                             \
+    -D
+
     echo "B+tree performance test using pmemobj"
     "$BTR" -m                  \
-    -C "${UINT}${IPL}o:$ORDER" \
+    -C "${FEAT}${IPL}o:$ORDER" \
     -p "$BAT_NUM"              \
     -D
 fi
@@ -0,0 +1,251 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Microbenchmark of the erasure codec, it reports encode and decode
+ * bandwidth of a single core, the bandwidth is counted on data cells.
+ *
+ * src/common/tests/ec_perf.c
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <daos/common.h>
+#include <daos/ec.h>
+#include <daos/tests_lib.h>
+
+static unsigned int	opt_k = 4;
+static unsigned int	opt_p = 2;
+static unsigned int	opt_cell = 64 << 10;
+static unsigned int	opt_secs = 2;
+static unsigned int	opt_lost = 1;
+
+static unsigned char	*ec_cells[DAOS_EC_CELLS_MAX];
+static unsigned char	*ec_copy[DAOS_EC_CELLS_MAX];
+
+static int
+ec_perf_alloc(void)
+{
+	int	i;
+	int	j;
+
+	for (i = 0; i < opt_k + opt_p; i++) {
+		D_ALLOC(ec_cells[i], opt_cell);
+		D_ALLOC(ec_copy[i], opt_cell);
+		if (ec_cells[i] == NULL || ec_copy[i] == NULL)
+			return -DER_NOMEM;
+
+		if (i >= opt_k)
+			continue;
+
+		for (j = 0; j < opt_cell; j++)
+			ec_cells[i][j] = rand();
+	}
+	return 0;
+}
+
+static void
+ec_perf_free(void)
+{
+	int	i;
+
+	for (i = 0; i < opt_k + opt_p; i++) {
+		if (ec_cells[i] != NULL)
+			D_FREE(ec_cells[i]);
+		if (ec_copy[i] != NULL)
+			D_FREE(ec_copy[i]);
+	}
+}
+
+static void
+ec_perf_report(const char *name, unsigned long loops, double secs)
+{
+	double	bytes = (double)loops * opt_k * opt_cell;
+
+	D_PRINT("%s: k=%u p=%u cell=%u loops=%lu bw=%.2f GB/s/core\n",
+		name, opt_k, opt_p, opt_cell, loops,
+		bytes / secs / (1024.0 * 1024 * 1024));
+}
+
+static int
+ec_perf_encode(struct daos_ec_codec *codec)
+{
+	unsigned long	loops = 0;
+	double		then;
+	double		now;
+
+	then = now = dts_time_now();
+	while (now - then < opt_secs) {
+		daos_ec_encode(codec, opt_cell, ec_cells, &ec_cells[opt_k]);
+		loops++;
+		if ((loops & 0xff) == 0)
+			now = dts_time_now();
+	}
+	now = dts_time_now();
+	ec_perf_report("encode", loops, now - then);
+	return 0;
+}
+
+static int
+ec_perf_decode(struct daos_ec_codec *codec)
+{
+	unsigned long	loops = 0;
+	uint32_t	lost = 0;
+	double		then;
+	double		now;
+	int		i;
+	int		rc;
+
+	if (opt_lost > opt_p) {
+		D_PRINT("Cannot lose %u cells with p=%u\n", opt_lost, opt_p);
+		return -DER_INVAL;
+	}
+
+	daos_ec_encode(codec, opt_cell, ec_cells, &ec_cells[opt_k]);
+	for (i = 0; i < opt_k + opt_p; i++)
+		memcpy(ec_copy[i], ec_cells[i], opt_cell);
+
+	/* lose the leading data cells, which is the most expensive case */
+	for (i = 0; i < opt_lost; i++)
+		lost |= 1U << i;
+
+	then = now = dts_time_now();
+	while (now - then < opt_secs) {
+		rc = daos_ec_decode(codec, opt_cell, ec_cells, lost);
+		if (rc != 0) {
+			D_PRINT("decode failed: %d\n", rc);
+			return rc;
+		}
+		loops++;
+		if ((loops & 0xff) == 0)
+			now = dts_time_now();
+	}
+	now = dts_time_now();
+
+	/* clear the lost cells, so that the check fails if nothing is done */
+	for (i = 0; i < opt_lost; i++)
+		memset(ec_cells[i], 0, opt_cell);
+	rc = daos_ec_decode(codec, opt_cell, ec_cells, lost);
+	if (rc != 0) {
+		D_PRINT("decode failed: %d\n", rc);
+		return rc;
+	}
+
+	for (i = 0; i < opt_k + opt_p; i++) {
+		if (memcmp(ec_copy[i], ec_cells[i], opt_cell) != 0) {
+			D_PRINT("cell %d mismatch after decode\n", i);
+			return -DER_IO;
+		}
+	}
+	ec_perf_report("decode", loops, now - then);
+	return 0;
+}
+
+static struct option ec_ops[] = {
+	/**
+	 * test-id:
+	 * e = encode
+	 * d = decode
+	 */
+	{ "test",	required_argument,	NULL,	't'	},
+	{ "data",	required_argument,	NULL,	'k'	},
+	{ "parity",	required_argument,	NULL,	'p'	},
+	/** cell size in bytes */
+	{ "cell",	required_argument,	NULL,	'c'	},
+	/** number of lost cells for decode */
+	{ "lost",	required_argument,	NULL,	'l'	},
+	/** test duration in seconds */
+	{ "sec",	required_argument,	NULL,	's'	},
+	{ NULL,		0,			NULL,	0	},
+};
+
+int
+main(int argc, char **argv)
+{
+	struct daos_ec_codec	codec;
+	char			*tests = "ed";
+	int			 rc;
+
+	while ((rc = getopt_long(argc, argv, "t:k:p:c:l:s:",
+				 ec_ops, NULL)) != -1) {
+		switch (rc) {
+		default:
+			fprintf(stderr, "unknown opc=%c\n", rc);
+			exit(-1);
+		case 't':
+			tests = optarg;
+			break;
+		case 'k':
+			opt_k = atoi(optarg);
+			break;
+		case 'p':
+			opt_p = atoi(optarg);
+			break;
+		case 'c':
+			opt_cell = atoi(optarg);
+			break;
+		case 'l':
+			opt_lost = atoi(optarg);
+			break;
+		case 's':
+			opt_secs = atoi(optarg);
+			break;
+		}
+	}
+
+	if (opt_cell == 0 || opt_secs == 0) {
+		D_PRINT("invalid cell size %u or duration %u\n",
+			opt_cell, opt_secs);
+		return -1;
+	}
+
+	rc = daos_debug_init(NULL);
+	if (rc != 0)
+		return rc;
+
+	rc = daos_ec_codec_init(&codec, opt_k, opt_p);
+	if (rc != 0)
+		goto out_debug;
+
+	rc = ec_perf_alloc();
+	if (rc != 0)
+		goto out_codec;
+
+	for (; *tests != '\0' && rc == 0; tests++) {
+		switch (*tests) {
+		default:
+			D_PRINT("unknown test %c\n", *tests);
+			break;
+		case 'e':
+			rc = ec_perf_encode(&codec);
+			break;
+		case 'd':
+			rc = ec_perf_decode(&codec);
+			break;
+		}
+	}
+out_codec:
+	ec_perf_free();
+	daos_ec_codec_fini(&codec);
+out_debug:
+	daos_debug_fini();
+	return rc == 0 ? 0 : -1;
+}
@@ -28,6 +28,7 @@
 #define D_LOGFAC	DD_FAC(tests)
 
 #include <stdarg.h>
+#include <time.h>
 #include <stdlib.h>
 #include <setjmp.h>
 #include <cmocka.h>
@@ -815,6 +816,107 @@ out:
 	return rc;
 }
 
+#define NUM_PERF_TASKS		100000
+#define PERF_BATCH		1000
+
+static int
+complete_func(tse_task_t *task)
+{
+	tse_task_complete(task, 0);
+	return 0;
+}
+
+static int
+count_comp_cb(tse_task_t *task, void *data)
+{
+	int *counter = *(int **)data;
+
+	*counter = *counter + 1;
+	return 0;
+}
+
+static int
+sched_test_7()
+{
+	tse_sched_t	sched;
+	tse_task_t	*task;
+	struct timespec	start;
+	struct timespec	end;
+	double		secs;
+	int		*counter = NULL;
+	bool		flag;
+	int		i, rc;
+
+	TSE_TEST_ENTRY("7", "Task create/schedule/complete rate");
+
+	print_message("Init Scheduler\n");
+	rc = tse_sched_init(&sched, NULL, 0);
+	if (rc != 0) {
+		print_error("Failed to init scheduler: %d\n", rc);
+		D_GOTO(out, rc);
+	}
+
+	D_ALLOC_PTR(counter);
+	if (counter == NULL) {
+		print_error("Failed to allocate counter\n");
+		D_GOTO(out, rc = -DER_NOMEM);
+	}
+
+	print_message("Run %d tasks with a completion callback each\n",
+		      NUM_PERF_TASKS);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < NUM_PERF_TASKS; i++) {
+		rc = tse_task_create(complete_func, &sched, NULL, &task);
+		if (rc != 0) {
+			print_error("Failed to create task: %d\n", rc);
+			D_GOTO(out, rc);
+		}
+
+		rc = tse_task_register_comp_cb(task, count_comp_cb, &counter,
+					       sizeof(counter));
+		if (rc != 0) {
+			print_error("Failed to register task CB: %d\n", rc);
+			D_GOTO(out, rc);
+		}
+
+		rc = tse_task_schedule(task, false);
+		if (rc != 0) {
+			print_error("Failed to insert task in scheduler: %d\n",
+				    rc);
+			D_GOTO(out, rc);
+		}
+
+		if ((i + 1) % PERF_BATCH == 0)
+			tse_sched_progress(&sched);
+	}
+	tse_sched_progress(&sched);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	secs = (end.tv_sec - start.tv_sec) +
+	       (end.tv_nsec - start.tv_nsec) / 1e9;
+	print_message("%d tasks in %.3f sec, %.0f tasks/sec\n",
+		      NUM_PERF_TASKS, secs, NUM_PERF_TASKS / secs);
+
+	if (*counter != NUM_PERF_TASKS) {
+		print_error("Completion CB ran %d times, expected %d\n",
+			    *counter, NUM_PERF_TASKS);
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+	print_message("Check scheduler is empty\n");
+	flag = tse_sched_check_complete(&sched);
+	if (!flag) {
+		print_error("Scheduler should not have in-flight tasks\n");
+		D_GOTO(out, rc = -DER_INVAL);
+	}
+
+out:
+	if (counter)
+		D_FREE_PTR(counter);
+	TSE_TEST_EXIT(rc);
+	return rc;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -861,6 +963,12 @@ main(int argc, char **argv)
 		test_fail++;
 	}
 
+	rc = sched_test_7();
+	if (rc != 0) {
+		print_error("SCHED TEST 7 failed: %d\n", rc);
+		test_fail++;
+	}
+
 	if (test_fail)
 		print_error("ERROR, %d test(s) failed\n", test_fail);
 	else
@@ -33,7 +33,8 @@
 #define DTS_OCLASS_DEF		DAOS_OC_REPL_MAX_RW
 
 static uint32_t obj_id_gen	= 1;
-static uint64_t int_key_gen	= 1;
+/* per thread, so that threads can generate and reset keys independently */
+static __thread uint64_t int_key_gen = 1;
 
 daos_obj_id_t
 dts_oid_gen(uint16_t oclass, uint8_t ofeats, unsigned seed)
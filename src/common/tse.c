@@ -45,6 +45,173 @@ struct tse_task_link {
 
 static void tse_sched_decref(struct tse_sched_private *dsp);
 
+/*
+ * Per-thread caches of freed tasks and callbacks, so that creating a task or
+ * registering a callback doesn't go to the heap in the common case. Objects
+ * are returned to the cache of the thread that frees them.
+ */
+#define TSE_CACHE_MAX		1024
+/* Callbacks with arguments up to this size are cached */
+#define TSE_TASK_CB_ARG_MAX	64
+
+struct tse_cache {
+	d_list_t	tc_tasks;	/* tse_task_t linked by dtp_list */
+	int		tc_task_cnt;
+	d_list_t	tc_cbs;		/* tse_task_cb linked by dtc_list */
+	int		tc_cb_cnt;
+};
+
+static __thread struct tse_cache	*tse_cache;
+static pthread_key_t			 tse_cache_key;
+static pthread_once_t			 tse_cache_once = PTHREAD_ONCE_INIT;
+static int				 tse_cache_key_rc;
+
+static void
+tse_cache_destroy(void *arg)
+{
+	struct tse_cache	*tc = arg;
+	struct tse_task_private	*dtp;
+	struct tse_task_cb	*dtc;
+	tse_task_t		*task;
+
+	while (!d_list_empty(&tc->tc_tasks)) {
+		dtp = d_list_entry(tc->tc_tasks.next, struct tse_task_private,
+				   dtp_list);
+		d_list_del(&dtp->dtp_list);
+		task = tse_priv2task(dtp);
+		D_FREE_PTR(task);
+	}
+	while (!d_list_empty(&tc->tc_cbs)) {
+		dtc = d_list_entry(tc->tc_cbs.next, struct tse_task_cb,
+				   dtc_list);
+		d_list_del(&dtc->dtc_list);
+		D_FREE(dtc);
+	}
+	D_FREE_PTR(tc);
+	tse_cache = NULL;
+}
+
+static void
+tse_cache_key_create(void)
+{
+	tse_cache_key_rc = pthread_key_create(&tse_cache_key,
+					      tse_cache_destroy);
+}
+
+/* Get the cache of this thread, NULL if it can't be set up. */
+static struct tse_cache *
+tse_cache_get(void)
+{
+	struct tse_cache *tc;
+
+	if (tse_cache != NULL)
+		return tse_cache;
+
+	pthread_once(&tse_cache_once, tse_cache_key_create);
+	if (tse_cache_key_rc != 0)
+		return NULL;
+
+	D_ALLOC_PTR(tc);
+	if (tc == NULL)
+		return NULL;
+	D_INIT_LIST_HEAD(&tc->tc_tasks);
+	D_INIT_LIST_HEAD(&tc->tc_cbs);
+	if (pthread_setspecific(tse_cache_key, tc) != 0) {
+		D_FREE_PTR(tc);
+		return NULL;
+	}
+
+	tse_cache = tc;
+	return tc;
+}
+
+static tse_task_t *
+tse_task_alloc(void)
+{
+	struct tse_cache	*tc = tse_cache_get();
+	struct tse_task_private	*dtp;
+	tse_task_t		*task;
+
+	if (tc == NULL || d_list_empty(&tc->tc_tasks)) {
+		D_ALLOC_PTR(task);
+		return task;
+	}
+
+	dtp = d_list_entry(tc->tc_tasks.next, struct tse_task_private,
+			   dtp_list);
+	d_list_del(&dtp->dtp_list);
+	tc->tc_task_cnt--;
+
+	task = tse_priv2task(dtp);
+	memset(task, 0, sizeof(*task));
+	return task;
+}
+
+static void
+tse_task_free(tse_task_t *task)
+{
+	struct tse_cache	*tc = tse_cache_get();
+	struct tse_task_private	*dtp = tse_task2priv(task);
+
+	if (tc == NULL || tc->tc_task_cnt >= TSE_CACHE_MAX) {
+		D_FREE_PTR(task);
+		return;
+	}
+
+	d_list_add(&dtp->dtp_list, &tc->tc_tasks);
+	tc->tc_task_cnt++;
+}
+
+/*
+ * Allocate a callback with arg_size bytes of argument from the cache, the
+ * inline space of the task is claimed by register_cb().
+ */
+static struct tse_task_cb *
+tse_task_cb_alloc(daos_size_t arg_size)
+{
+	struct tse_cache	*tc;
+	struct tse_task_cb	*dtc;
+
+	if (arg_size > TSE_TASK_CB_ARG_MAX) {
+		D_ALLOC(dtc, sizeof(*dtc) + arg_size);
+		return dtc;
+	}
+
+	tc = tse_cache_get();
+	if (tc == NULL || d_list_empty(&tc->tc_cbs)) {
+		D_ALLOC(dtc, sizeof(*dtc) + TSE_TASK_CB_ARG_MAX);
+		return dtc;
+	}
+
+	dtc = d_list_entry(tc->tc_cbs.next, struct tse_task_cb, dtc_list);
+	d_list_del(&dtc->dtc_list);
+	tc->tc_cb_cnt--;
+	return dtc;
+}
+
+static void
+tse_task_cb_free(struct tse_task_private *dtp, struct tse_task_cb *dtc)
+{
+	struct tse_cache *tc;
+
+	/* No lock, the callback has been executed and unlinked. A register_cb()
+	 * racing with this just sees the inline space in use, and allocates.
+	 */
+	if (dtc == (struct tse_task_cb *)dtp->dtp_cb_buf) {
+		dtc->dtc_cb = NULL;
+		return;
+	}
+
+	tc = dtc->dtc_arg_size > TSE_TASK_CB_ARG_MAX ? NULL : tse_cache_get();
+	if (tc == NULL || tc->tc_cb_cnt >= TSE_CACHE_MAX) {
+		D_FREE(dtc);
+		return;
+	}
+
+	d_list_add(&dtc->dtc_list, &tc->tc_cbs);
+	tc->tc_cb_cnt++;
+}
+
 int
 tse_sched_init(tse_sched_t *sched, tse_sched_comp_cb_t comp_cb,
 	       void *udata)
@@ -242,7 +409,7 @@ tse_task_decref(tse_task_t *task)
 	 * user also free it. This now requires task to be on the heap all the
 	 * time.
 	 */
-	D_FREE_PTR(task);
+	tse_task_free(task);
 }
 
 void
@@ -335,30 +502,58 @@ tse_task_complete_locked(struct tse_task_private *dtp,
 	d_list_move_tail(&dtp->dtp_list, &dsp->dsp_complete_list);
 }
 
+static inline void
+tse_task_cb_init(struct tse_task_cb *dtc, tse_task_cb_t cb, void *arg,
+		 daos_size_t arg_size)
+{
+	dtc->dtc_arg_size = arg_size;
+	dtc->dtc_cb = cb;
+	if (arg)
+		memcpy(dtc->dtc_arg, arg, arg_size);
+}
+
 static int
 register_cb(tse_task_t *task, bool is_comp, tse_task_cb_t cb,
 	    void *arg, daos_size_t arg_size)
 {
 	struct tse_task_private *dtp = tse_task2priv(task);
-	struct tse_task_cb *dtc;
+	struct tse_task_cb *dtc = (struct tse_task_cb *)dtp->dtp_cb_buf;
+	bool inline_cb;
 
 	if (dtp->dtp_completed) {
 		D_ERROR("Can't add a callback for a completed task\n");
 		return -DER_NO_PERM;
 	}
 
-	D_ALLOC(dtc, sizeof(*dtc) + arg_size);
-	if (dtc == NULL)
-		return -DER_NOMEM;
-
-	dtc->dtc_arg_size = arg_size;
-	dtc->dtc_cb = cb;
-	if (arg)
-		memcpy(dtc->dtc_arg, arg, arg_size);
-
 	D_ASSERT(dtp->dtp_sched != NULL);
 
+	D_CASSERT(sizeof(dtp->dtp_cb_buf) > sizeof(*dtc));
+	inline_cb = (sizeof(*dtc) + arg_size <= sizeof(dtp->dtp_cb_buf));
+	if (!inline_cb) {
+		dtc = tse_task_cb_alloc(arg_size);
+		if (dtc == NULL)
+			return -DER_NOMEM;
+		tse_task_cb_init(dtc, cb, arg, arg_size);
+	}
+
 	D_MUTEX_LOCK(&dtp->dtp_sched->dsp_lock);
+	/* The inline space is claimed within the same critical section of
+	 * adding it to the list, as several threads may register callbacks
+	 * on the same task. The argument is small enough to copy here.
+	 */
+	if (inline_cb) {
+		if (dtc->dtc_cb == NULL) {
+			tse_task_cb_init(dtc, cb, arg, arg_size);
+		} else {
+			D_MUTEX_UNLOCK(&dtp->dtp_sched->dsp_lock);
+			dtc = tse_task_cb_alloc(arg_size);
+			if (dtc == NULL)
+				return -DER_NOMEM;
+			tse_task_cb_init(dtc, cb, arg, arg_size);
+			D_MUTEX_LOCK(&dtp->dtp_sched->dsp_lock);
+		}
+	}
+
 	if (is_comp)
 		d_list_add(&dtc->dtc_list, &dtp->dtp_comp_cb_list);
 	else /** MSC - don't see a need for more than 1 prep cb */
@@ -413,7 +608,7 @@ tse_task_prep_callback(tse_task_t *task)
 				task->dt_result = rc;
 		}
 
-		D_FREE(dtc);
+		tse_task_cb_free(dtp, dtc);
 
 		/** Task was re-initialized; break */
 		if (!dtp->dtp_running && !dtp->dtp_completing)
@@ -446,7 +641,7 @@ tse_task_complete_callback(tse_task_t *task)
 		if (task->dt_result == 0)
 			task->dt_result = ret;
 
-		D_FREE(dtc);
+		tse_task_cb_free(dtp, dtc);
 
 		/** Task was re-initialized; break */
 		if (!dtp->dtp_completing) {
@@ -868,7 +1063,7 @@ tse_task_create(tse_task_func_t task_func, tse_sched_t *sched, void *priv,
 	struct tse_task_private	 *dtp;
 	tse_task_t		 *task;
 
-	D_ALLOC_PTR(task);
+	task = tse_task_alloc();
 	if (task == NULL)
 		return -DER_NOMEM;
 
@@ -33,8 +33,10 @@
  * Author: Di Wang  <di.wang@intel.com>
  */
 
-/* NB: tse_task_private is TSE_PRIV_SIZE = 504 bytes for now */
+/* NB: tse_task_private is TSE_PRIV_SIZE = 568 bytes for now */
 #define TSE_TASK_ARG_LEN		376
+/* Inline space for one small callback, including struct tse_task_cb */
+#define TSE_TASK_CB_INLINE_LEN		64
 
 struct tse_task_private {
 	struct tse_sched_private	*dtp_sched;
@@ -92,6 +94,13 @@ struct tse_task_private {
 	uint32_t			 dtp_stack_top;
 	uint32_t			 dtp_embed_top;
 	char				 dtp_buf[TSE_TASK_ARG_LEN];
+	/**
+	 * storage of the first registered callback whose argument fits, to
+	 * avoid allocating a tse_task_cb for it. It is free if dtc_cb of the
+	 * tse_task_cb in it is NULL.
+	 */
+	uint64_t			 dtp_cb_buf[TSE_TASK_CB_INLINE_LEN /
+						    sizeof(uint64_t)];
 };
 
 struct tse_task_cb {
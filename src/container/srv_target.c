@@ -872,7 +872,7 @@ ds_cont_tgt_epoch_discard_handler(crt_rpc_t *rpc)
 	else if (in->tii_epoch >= DAOS_EPOCH_MAX)
 		D_GOTO(out, rc = -DER_OVERFLOW);
 
-	rc = dss_task_collective(cont_epoch_discard_one, in);
+	rc = dss_task_collective_pool(cont_epoch_discard_one, in, DSS_POOL_GC);
 
 out:
 	out->tio_rc = (rc == 0 ? 0 : 1);
@@ -1116,7 +1116,8 @@ out:
 	if (out->tao_rc != 0)
 		return;
 
-	rc = dss_thread_collective(cont_epoch_aggregate_one, &in_copy);
+	rc = dss_thread_collective_pool(cont_epoch_aggregate_one, &in_copy,
+					DSS_POOL_AGGREGATE);
 	if (rc != 0)
 		D_ERROR(DF_CONT": Aggregation failed: %d\n",
 			DP_CONT(in->tai_pool_uuid, in->tai_cont_uuid), rc);
@@ -26,12 +26,48 @@
 #include <spdk/blob.h>
 #include "eio_internal.h"
 
+/* Chunk size of the size class in pages */
+static inline unsigned int
+dma_chk_pgs(int cls)
+{
+	switch (cls) {
+	case EIO_CHK_CLASS_4K:
+		return max(eio_chk_sz >> 4, 1U);
+	case EIO_CHK_CLASS_64K:
+		return min(max(eio_chk_sz >> 2, 16U), eio_chk_sz);
+	default:
+		return eio_chk_sz;
+	}
+}
+
+/*
+ * Maximum pages of the size class. The large class can take the whole
+ * per-xstream DMA buffer (eio_chk_cnt_max chunks), the small classes can
+ * take another 1/8 and 1/4 of it, so that small IODs can neither pin down
+ * the large chunks nor exhaust the DMA buffer.
+ */
+static inline unsigned int
+dma_cls_max_pgs(int cls)
+{
+	unsigned int max_pgs = eio_chk_sz * eio_chk_cnt_max;
+
+	switch (cls) {
+	case EIO_CHK_CLASS_4K:
+		return max(max_pgs >> 3, dma_chk_pgs(cls));
+	case EIO_CHK_CLASS_64K:
+		return max(max_pgs >> 2, dma_chk_pgs(cls));
+	default:
+		return max_pgs;
+	}
+}
+
 static void
-dma_buffer_shrink(struct eio_dma_buffer *buf, unsigned int cnt)
+dma_buffer_shrink(struct eio_dma_buffer *buf, int cls, unsigned int cnt)
 {
 	struct eio_dma_chunk *chunk, *tmp;
 
-	d_list_for_each_entry_safe(chunk, tmp, &buf->edb_idle_list, edc_link) {
+	d_list_for_each_entry_safe(chunk, tmp, &buf->edb_idle_list[cls],
+				   edc_link) {
 		if (cnt == 0)
 			break;
 
@@ -40,24 +76,27 @@ dma_buffer_shrink(struct eio_dma_buffer *buf, unsigned int cnt)
 		D_ASSERT(chunk->edc_ptr != NULL);
 		D_ASSERT(chunk->edc_pg_idx == 0);
 		D_ASSERT(chunk->edc_ref == 0);
+		D_ASSERT(chunk->edc_cls == cls);
+
+		D_ASSERT(buf->edb_cls_pgs[cls] >= chunk->edc_pg_cnt);
+		buf->edb_cls_pgs[cls] -= chunk->edc_pg_cnt;
+		buf->edb_tot_pgs -= chunk->edc_pg_cnt;
 
 		spdk_dma_free(chunk->edc_ptr);
 		D_FREE_PTR(chunk);
-
-		D_ASSERT(buf->edb_tot_cnt > 0);
-		buf->edb_tot_cnt--;
 		cnt--;
 	}
 }
 
 static int
-dma_buffer_grow(struct eio_dma_buffer *buf, unsigned int cnt)
+dma_buffer_grow(struct eio_dma_buffer *buf, int cls, unsigned int cnt)
 {
 	struct eio_dma_chunk *chunk;
-	ssize_t chk_bytes = eio_chk_sz << EIO_DMA_PAGE_SHIFT;
+	unsigned int pg_cnt = dma_chk_pgs(cls);
+	ssize_t chk_bytes = pg_cnt << EIO_DMA_PAGE_SHIFT;
 	int i, rc = 0;
 
-	if ((buf->edb_tot_cnt + cnt) > eio_chk_cnt_max) {
+	if ((buf->edb_cls_pgs[cls] + cnt * pg_cnt) > dma_cls_max_pgs(cls)) {
 		D_ERROR("Exceeding per-xstream DMA buffer size\n");
 		return -DER_OVERFLOW;
 	}
@@ -70,17 +109,21 @@ dma_buffer_grow(struct eio_dma_buffer *buf, unsigned int cnt)
 			break;
 		}
 
-		chunk->edc_ptr = spdk_dma_malloc(chk_bytes, EIO_DMA_PAGE_SZ,
-						 NULL);
+		chunk->edc_ptr = spdk_dma_malloc_socket(chk_bytes,
+							EIO_DMA_PAGE_SZ, NULL,
+							buf->edb_socket);
 		if (chunk->edc_ptr == NULL) {
 			D_ERROR("Failed to allocate DMA buffer\n");
 			D_FREE_PTR(chunk);
 			rc = -DER_NOMEM;
 			break;
 		}
+		chunk->edc_pg_cnt = pg_cnt;
+		chunk->edc_cls = cls;
 
-		d_list_add_tail(&chunk->edc_link, &buf->edb_idle_list);
-		buf->edb_tot_cnt++;
+		d_list_add_tail(&chunk->edc_link, &buf->edb_idle_list[cls]);
+		buf->edb_cls_pgs[cls] += pg_cnt;
+		buf->edb_tot_pgs += pg_cnt;
 	}
 
 	return rc;
@@ -89,48 +132,45 @@ dma_buffer_grow(struct eio_dma_buffer *buf, unsigned int cnt)
 void
 dma_buffer_destroy(struct eio_dma_buffer *buf)
 {
+	int i;
+
 	D_ASSERT(d_list_empty(&buf->edb_used_list));
+	D_ASSERT(d_list_empty(&buf->edb_waitq));
 	D_ASSERT(buf->edb_active_iods == 0);
-	dma_buffer_shrink(buf, buf->edb_tot_cnt);
+	for (i = 0; i < EIO_CHK_CLASS_MAX; i++)
+		dma_buffer_shrink(buf, i, UINT_MAX);
 
-	D_ASSERT(buf->edb_tot_cnt == 0);
-	buf->edb_cur_chk = NULL;
-	ABT_mutex_free(&buf->edb_mutex);
-	ABT_cond_free(&buf->edb_wait_iods);
+	D_ASSERT(buf->edb_tot_pgs == 0);
+	memset(buf->edb_cur_chk, 0, sizeof(buf->edb_cur_chk));
 
 	D_FREE_PTR(buf);
 }
 
+/*
+ * The DMA chunks are never freed before the buffer is destroyed, since the
+ * network registration of the chunks is cached by chunk address.
+ */
 struct eio_dma_buffer *
-dma_buffer_create(unsigned int init_cnt)
+dma_buffer_create(unsigned int init_cnt, int socket)
 {
 	struct eio_dma_buffer *buf;
-	int rc;
+	int i, rc;
 
 	D_ALLOC_PTR(buf);
 	if (buf == NULL)
 		return NULL;
 
-	D_INIT_LIST_HEAD(&buf->edb_idle_list);
+	for (i = 0; i < EIO_CHK_CLASS_MAX; i++)
+		D_INIT_LIST_HEAD(&buf->edb_idle_list[i]);
 	D_INIT_LIST_HEAD(&buf->edb_used_list);
-	buf->edb_cur_chk = NULL;
-	buf->edb_tot_cnt = 0;
+	D_INIT_LIST_HEAD(&buf->edb_waitq);
+	memset(buf->edb_cur_chk, 0, sizeof(buf->edb_cur_chk));
+	memset(buf->edb_cls_pgs, 0, sizeof(buf->edb_cls_pgs));
+	buf->edb_socket = socket;
+	buf->edb_tot_pgs = 0;
 	buf->edb_active_iods = 0;
 
-	rc = ABT_mutex_create(&buf->edb_mutex);
-	if (rc != ABT_SUCCESS) {
-		D_FREE_PTR(buf);
-		return NULL;
-	}
-
-	rc = ABT_cond_create(&buf->edb_wait_iods);
-	if (rc != ABT_SUCCESS) {
-		ABT_mutex_free(&buf->edb_mutex);
-		D_FREE_PTR(buf);
-		return NULL;
-	}
-
-	rc = dma_buffer_grow(buf, init_cnt);
+	rc = dma_buffer_grow(buf, EIO_CHK_CLASS_1M, init_cnt);
 	if (rc != 0) {
 		dma_buffer_destroy(buf);
 		return NULL;
@@ -224,7 +264,7 @@ iod_release_buffer(struct eio_desc *eiod)
 {
 	struct eio_dma_buffer *edb;
 	struct eio_rsrvd_dma *rsrvd_dma = &eiod->ed_rsrvd;
-	int i;
+	int i, j;
 
 	if (rsrvd_dma->erd_chk_max == 0) {
 		D_ASSERT(rsrvd_dma->erd_rg_max == 0);
@@ -252,9 +292,12 @@ iod_release_buffer(struct eio_desc *eiod)
 
 		if (chunk->edc_ref == 0) {
 			chunk->edc_pg_idx = 0;
-			if (chunk == edb->edb_cur_chk)
-				edb->edb_cur_chk = NULL;
-			d_list_move_tail(&chunk->edc_link, &edb->edb_idle_list);
+			for (j = 0; j < EIO_CHK_CLASS_MAX; j++) {
+				if (chunk == edb->edb_cur_chk[j])
+					edb->edb_cur_chk[j] = NULL;
+			}
+			d_list_move_tail(&chunk->edc_link,
+					 &edb->edb_idle_list[chunk->edc_cls]);
 		}
 		rsrvd_dma->erd_dma_chks[i] = NULL;
 	}
@@ -321,15 +364,15 @@ chunk_reserve(struct eio_dma_chunk *chk, unsigned int chk_pg_idx,
 	      unsigned int pg_cnt, unsigned int pg_off)
 {
 	D_ASSERT(chk != NULL);
-	D_ASSERTF(chk->edc_pg_idx <= eio_chk_sz, "%u > %u\n",
-		  chk->edc_pg_idx, eio_chk_sz);
+	D_ASSERTF(chk->edc_pg_idx <= chk->edc_pg_cnt, "%u > %u\n",
+		  chk->edc_pg_idx, chk->edc_pg_cnt);
 
 	D_ASSERTF(chk_pg_idx == chk->edc_pg_idx ||
 		  (chk_pg_idx + 1) == chk->edc_pg_idx, "%u, %u\n",
 		  chk_pg_idx, chk->edc_pg_idx);
 
 	/* The chunk doesn't have enough unused pages */
-	if (chk_pg_idx + pg_cnt > eio_chk_sz)
+	if (chk_pg_idx + pg_cnt > chk->edc_pg_cnt)
 		return NULL;
 
 	D_DEBUG(DB_IO, "Reserved on chunk:%p[%p], idx:%u, cnt:%u, off:%u\n",
@@ -348,34 +391,34 @@ iod_last_region(struct eio_desc *eiod)
 	return (cnt != 0) ? &eiod->ed_rsrvd.erd_regions[cnt - 1] : NULL;
 }
 
-static struct eio_dma_chunk *
-chunk_get_idle(struct eio_dma_buffer *edb, struct eio_desc *eiod)
+/*
+ * Get an idle chunk of the size class, grow the buffer if there isn't any
+ * idle chunk. Return -DER_OVERFLOW when the class has reached its maximum.
+ */
+static int
+chunk_get_idle(struct eio_dma_buffer *edb, int cls,
+	       struct eio_dma_chunk **chk_ptr)
 {
 	struct eio_dma_chunk *chk;
 	int rc;
 
-	if (d_list_empty(&edb->edb_idle_list)) {
-		if (edb->edb_tot_cnt == eio_chk_cnt_max) {
-			D_CRIT("Maximum per-xstream DMA buffer isn't big "
-			       "enough (chk_sz:%u chk_cnt:%u iods:%u) to "
-			       "sustain the workload.\n", eio_chk_sz,
-			       eio_chk_cnt_max, edb->edb_active_iods);
-
-			eiod->ed_retry = 1;
-			return NULL;
-		}
+	if (d_list_empty(&edb->edb_idle_list[cls])) {
+		if (edb->edb_cls_pgs[cls] + dma_chk_pgs(cls) >
+		    dma_cls_max_pgs(cls))
+			return -DER_OVERFLOW;
 
-		rc = dma_buffer_grow(edb, 1);
+		rc = dma_buffer_grow(edb, cls, 1);
 		if (rc != 0)
-			return NULL;
+			return rc;
 	}
 
-	D_ASSERT(!d_list_empty(&edb->edb_idle_list));
-	chk = d_list_entry(edb->edb_idle_list.next, struct eio_dma_chunk,
+	D_ASSERT(!d_list_empty(&edb->edb_idle_list[cls]));
+	chk = d_list_entry(edb->edb_idle_list[cls].next, struct eio_dma_chunk,
 			   edc_link);
 	d_list_move_tail(&chk->edc_link, &edb->edb_used_list);
 
-	return chk;
+	*chk_ptr = chk;
+	return 0;
 }
 
 static int
@@ -454,10 +497,10 @@ dma_map_one(struct eio_desc *eiod, struct eio_iov *eiov,
 {
 	struct eio_rsrvd_region *last_rg;
 	struct eio_dma_buffer *edb;
-	struct eio_dma_chunk *chk = NULL;
+	struct eio_dma_chunk *chk = NULL, *last_chk;
 	uint64_t off, end;
 	unsigned int pg_cnt, pg_off, chk_pg_idx;
-	int rc;
+	int cls, rc;
 
 	D_ASSERT(arg == NULL);
 	D_ASSERT(eiov && eiov->ei_data_len != 0);
@@ -540,36 +583,53 @@ dma_map_one(struct eio_desc *eiod, struct eio_iov *eiov,
 	 * Try to reserve the DMA buffer from the 'current chunk' of the
 	 * per-xstream DMA buffer. It could be different with the last chunk
 	 * in io descripotr, because dma_map_one() may yield in the future.
+	 * Each size class has its own chunks, so that the pages of a chunk
+	 * being pinned by long running small IODs won't stop the large IODs
+	 * from reusing the chunks. When a class has reached its maximum, the
+	 * reservation falls back to the larger classes.
 	 */
-	if (edb->edb_cur_chk != NULL && edb->edb_cur_chk != chk) {
-		chk = edb->edb_cur_chk;
-		chk_pg_idx = chk->edc_pg_idx;
-		eiov->ei_buf = chunk_reserve(chk, chk_pg_idx, pg_cnt, pg_off);
-		if (eiov->ei_buf != NULL) {
-			D_DEBUG(DB_IO, "Current chunk reserve %p.\n",
-				eiov->ei_buf);
-			goto add_chunk;
+	last_chk = chk;
+	cls = pg_cnt <= 1 ? EIO_CHK_CLASS_4K :
+	      pg_cnt <= 16 ? EIO_CHK_CLASS_64K : EIO_CHK_CLASS_1M;
+	for (; cls < EIO_CHK_CLASS_MAX; cls++) {
+		chk = edb->edb_cur_chk[cls];
+		if (chk != NULL && chk != last_chk) {
+			chk_pg_idx = chk->edc_pg_idx;
+			eiov->ei_buf = chunk_reserve(chk, chk_pg_idx, pg_cnt,
+						     pg_off);
+			if (eiov->ei_buf != NULL) {
+				D_DEBUG(DB_IO, "Current chunk reserve %p.\n",
+					eiov->ei_buf);
+				goto add_chunk;
+			}
 		}
-	}
 
-	/*
-	 * Switch to another idle chunk, if there isn't any idle chunk
-	 * available, grow buffer.
-	 */
-	chk = chunk_get_idle(edb, eiod);
-	if (chk == NULL)
-		return -DER_OVERFLOW;
+		/*
+		 * Switch to another idle chunk, if there isn't any idle chunk
+		 * available, grow buffer.
+		 */
+		rc = chunk_get_idle(edb, cls, &chk);
+		if (rc == -DER_OVERFLOW)
+			continue;
+		else if (rc != 0)
+			return rc;
 
-	edb->edb_cur_chk = chk;
-	chk_pg_idx = chk->edc_pg_idx;
+		edb->edb_cur_chk[cls] = chk;
+		chk_pg_idx = chk->edc_pg_idx;
 
-	D_ASSERT(chk_pg_idx == 0);
-	eiov->ei_buf = chunk_reserve(chk, chk_pg_idx, pg_cnt, pg_off);
-	if (eiov->ei_buf != NULL) {
+		D_ASSERT(chk_pg_idx == 0);
+		eiov->ei_buf = chunk_reserve(chk, chk_pg_idx, pg_cnt, pg_off);
+		D_ASSERT(eiov->ei_buf != NULL);
 		D_DEBUG(DB_IO, "New chunk reserve %p.\n", eiov->ei_buf);
 		goto add_chunk;
 	}
 
+	D_CRIT("Maximum per-xstream DMA buffer isn't big enough (chk_sz:%u "
+	       "chk_cnt:%u pgs:%u iods:%u) to sustain the workload.\n",
+	       eio_chk_sz, eio_chk_cnt_max, edb->edb_tot_pgs,
+	       edb->edb_active_iods);
+
+	eiod->ed_retry = 1;
 	return -DER_OVERFLOW;
 
 add_chunk:
@@ -584,6 +644,11 @@ static void
 rw_completion(void *cb_arg, int err)
 {
 	struct eio_desc *eiod = cb_arg;
+	struct eio_xs_context *xs_ctxt = eiod->ed_ctxt->eic_xs_ctxt;
+
+	D_ASSERT(xs_ctxt->exc_io_inflights > 0);
+	xs_ctxt->exc_io_inflights--;
+	xs_ctxt->exc_io_completed++;
 
 	ABT_mutex_lock(eiod->ed_mutex);
 
@@ -598,6 +663,227 @@ rw_completion(void *cb_arg, int err)
 	ABT_mutex_unlock(eiod->ed_mutex);
 }
 
+/* Max pages of a combined NVMe write */
+#define EIO_WC_PG_MAX	256
+/* Max queued writes combined into one NVMe write */
+#define EIO_WC_IOV_MAX	32
+
+/* A combined NVMe write, issued for several blob-contiguous queued writes */
+struct eio_wc_batch {
+	/* Queued writes completed by this combined write */
+	d_list_t	ewb_ios;
+	struct iovec	ewb_iovs[EIO_WC_IOV_MAX];
+};
+
+static void
+wc_completion(void *cb_arg, int err)
+{
+	struct eio_wc_batch	*batch = cb_arg;
+	struct eio_wc_io	*io, *tmp;
+
+	d_list_for_each_entry_safe(io, tmp, &batch->ewb_ios, ewi_link) {
+		d_list_del(&io->ewi_link);
+		rw_completion(io->ewi_iod, err);
+		D_FREE_PTR(io);
+	}
+	D_FREE_PTR(batch);
+}
+
+static int
+wc_io_cmp(const void *a, const void *b)
+{
+	const struct eio_wc_io *io_a = *(struct eio_wc_io * const *)a;
+	const struct eio_wc_io *io_b = *(struct eio_wc_io * const *)b;
+
+	if (io_a->ewi_blob != io_b->ewi_blob)
+		return io_a->ewi_blob < io_b->ewi_blob ? -1 : 1;
+	if (io_a->ewi_pg_idx != io_b->ewi_pg_idx)
+		return io_a->ewi_pg_idx < io_b->ewi_pg_idx ? -1 : 1;
+	return 0;
+}
+
+static void
+wc_issue_one(struct spdk_io_channel *channel, struct eio_wc_io *io)
+{
+	D_DEBUG(DB_IO, "Write blob:%p payload:%p, pg_idx:"DF_U64", "
+		"pg_cnt:"DF_U64"\n", io->ewi_blob, io->ewi_payload,
+		io->ewi_pg_idx, io->ewi_pg_cnt);
+
+	spdk_blob_io_write(io->ewi_blob, channel, io->ewi_payload,
+			   io->ewi_pg_idx, io->ewi_pg_cnt, rw_completion,
+			   io->ewi_iod);
+	D_FREE_PTR(io);
+}
+
+/*
+ * Issue all writes in the per-xstream write combining queue. The writes are
+ * sorted by blob offset, and the ones being contiguous on the blob (which
+ * is common for concurrent updates, since VEA allocates adjacent extents
+ * for them by the allocation hint) are issued as one vectored write.
+ */
+static void
+wc_flush(struct eio_xs_context *xs_ctxt)
+{
+	struct eio_wc_queue	 *wcq = &xs_ctxt->exc_wc_queue;
+	struct spdk_io_channel	 *channel = xs_ctxt->exc_io_channel;
+	struct eio_wc_io	**ios, *io, *prev, *tmp;
+	struct eio_wc_batch	 *batch;
+	uint64_t		  pg_cnt;
+	unsigned int		  cnt, i, j, k;
+
+	cnt = wcq->ewq_cnt;
+	if (cnt == 0)
+		return;
+
+	wcq->ewq_cnt = 0;
+	wcq->ewq_pg_cnt = 0;
+
+	D_ALLOC(ios, sizeof(*ios) * cnt);
+	if (ios == NULL) {
+		/* Can't sort the writes, issue them one by one */
+		d_list_for_each_entry_safe(io, tmp, &wcq->ewq_list, ewi_link) {
+			d_list_del(&io->ewi_link);
+			wc_issue_one(channel, io);
+		}
+		return;
+	}
+
+	i = 0;
+	d_list_for_each_entry_safe(io, tmp, &wcq->ewq_list, ewi_link) {
+		d_list_del_init(&io->ewi_link);
+		ios[i++] = io;
+	}
+	D_ASSERT(i == cnt);
+	qsort(ios, cnt, sizeof(*ios), wc_io_cmp);
+
+	for (i = 0; i < cnt; i = j) {
+		pg_cnt = ios[i]->ewi_pg_cnt;
+		for (j = i + 1; j < cnt && j - i < EIO_WC_IOV_MAX; j++) {
+			prev = ios[j - 1];
+			io = ios[j];
+			if (io->ewi_blob != prev->ewi_blob ||
+			    io->ewi_pg_idx != prev->ewi_pg_idx +
+					      prev->ewi_pg_cnt ||
+			    pg_cnt + io->ewi_pg_cnt > EIO_WC_PG_MAX)
+				break;
+			pg_cnt += io->ewi_pg_cnt;
+		}
+
+		if (j - i == 1) {
+			wc_issue_one(channel, ios[i]);
+			continue;
+		}
+
+		D_ALLOC_PTR(batch);
+		if (batch == NULL) {
+			for (k = i; k < j; k++)
+				wc_issue_one(channel, ios[k]);
+			continue;
+		}
+
+		D_INIT_LIST_HEAD(&batch->ewb_ios);
+		for (k = i; k < j; k++) {
+			batch->ewb_iovs[k - i].iov_base = ios[k]->ewi_payload;
+			batch->ewb_iovs[k - i].iov_len =
+				ios[k]->ewi_pg_cnt << EIO_DMA_PAGE_SHIFT;
+			d_list_add_tail(&ios[k]->ewi_link, &batch->ewb_ios);
+		}
+
+		D_DEBUG(DB_IO, "Combined %u writes, blob:%p, pg_idx:"DF_U64", "
+			"pg_cnt:"DF_U64"\n", j - i, ios[i]->ewi_blob,
+			ios[i]->ewi_pg_idx, pg_cnt);
+
+		spdk_blob_io_writev(ios[i]->ewi_blob, channel, batch->ewb_iovs,
+				    j - i, ios[i]->ewi_pg_idx, pg_cnt,
+				    wc_completion, batch);
+	}
+
+	D_FREE(ios);
+}
+
+/* Queue a write for combining, return false if it can't be queued */
+static bool
+wc_queue(struct eio_desc *eiod, struct spdk_blob *blob, void *payload,
+	 uint64_t pg_idx, uint64_t pg_cnt)
+{
+	struct eio_xs_context	*xs_ctxt = eiod->ed_ctxt->eic_xs_ctxt;
+	struct eio_wc_queue	*wcq = &xs_ctxt->exc_wc_queue;
+	struct eio_wc_io	*io;
+
+	/* Self polling xstream can't yield for other ULTs */
+	if (eio_wc_depth == 0 || xs_ctxt->exc_xs_id == -1)
+		return false;
+
+	D_ALLOC_PTR(io);
+	if (io == NULL)
+		return false;
+
+	io->ewi_iod = eiod;
+	io->ewi_blob = blob;
+	io->ewi_payload = payload;
+	io->ewi_pg_idx = pg_idx;
+	io->ewi_pg_cnt = pg_cnt;
+	d_list_add_tail(&io->ewi_link, &wcq->ewq_list);
+	wcq->ewq_cnt++;
+	wcq->ewq_pg_cnt += pg_cnt;
+
+	return true;
+}
+
+/*
+ * Get the writes queued by current ULT issued. The first ULT that finds no
+ * leader becomes the leader, it yields (up to eio_wc_yield times) to let
+ * other ULTs on the same xstream queue their writes, then issues all of
+ * them. A ULT filling the queue up to eio_wc_depth issues it immediately,
+ * so the queue depth and the latency added to each update are both bounded.
+ */
+static void
+wc_submit(struct eio_xs_context *xs_ctxt)
+{
+	struct eio_wc_queue	*wcq = &xs_ctxt->exc_wc_queue;
+	unsigned int		 i;
+
+	if (wcq->ewq_leader) {
+		if (wcq->ewq_cnt >= eio_wc_depth ||
+		    wcq->ewq_pg_cnt >= EIO_WC_PG_MAX)
+			wc_flush(xs_ctxt);
+		return;
+	}
+
+	wcq->ewq_leader = 1;
+	for (i = 0; i < eio_wc_yield; i++) {
+		if (wcq->ewq_cnt >= eio_wc_depth ||
+		    wcq->ewq_pg_cnt >= EIO_WC_PG_MAX)
+			break;
+		ABT_thread_yield();
+	}
+	wcq->ewq_leader = 0;
+
+	wc_flush(xs_ctxt);
+}
+
+/* Add the pages just read by an io descriptor into the page cache */
+static void
+dma_cache_fill(struct eio_desc *eiod)
+{
+	struct eio_rsrvd_dma	*rsrvd_dma = &eiod->ed_rsrvd;
+	struct eio_rsrvd_region	*rg;
+	uint64_t		 pg_idx, pg_cnt;
+	int			 i;
+
+	for (i = 0; i < rsrvd_dma->erd_rg_cnt; i++) {
+		rg = &rsrvd_dma->erd_regions[i];
+		pg_idx = rg->err_off >> EIO_DMA_PAGE_SHIFT;
+		pg_cnt = ((rg->err_end + EIO_DMA_PAGE_SZ - 1) >>
+				EIO_DMA_PAGE_SHIFT) - pg_idx;
+
+		page_cache_fill(eiod->ed_ctxt->eic_xs_ctxt->exc_page_cache,
+				eiod->ed_ctxt->eic_blob, pg_idx, pg_cnt,
+				rg->err_chk->edc_ptr +
+				(rg->err_pg_idx << EIO_DMA_PAGE_SHIFT));
+	}
+}
+
 static void
 dma_rw(struct eio_desc *eiod, bool prep)
 {
@@ -609,6 +895,7 @@ dma_rw(struct eio_desc *eiod, bool prep)
 	uint64_t		 pg_idx, pg_cnt, pg_end;
 	void			*payload, *pg_rmw = NULL;
 	bool			 rmw_read = (prep && eiod->ed_update);
+	bool			 wc_queued = false;
 	unsigned int		 pg_off;
 	int			 i;
 
@@ -639,15 +926,34 @@ dma_rw(struct eio_desc *eiod, bool prep)
 			D_ASSERT(pg_cnt > pg_idx);
 			pg_cnt -= pg_idx;
 
+			if (eiod->ed_update) {
+				page_cache_evict(xs_ctxt->exc_page_cache, blob,
+						 pg_idx, pg_cnt);
+			} else if (page_cache_read(xs_ctxt->exc_page_cache,
+						   blob, pg_idx, pg_cnt,
+						   payload)) {
+				D_DEBUG(DB_IO, "Cached blob:%p payload:%p, "
+					"pg_idx:"DF_U64", pg_cnt:"DF_U64"\n",
+					blob, payload, pg_idx, pg_cnt);
+				continue;
+			}
+
 			ABT_mutex_lock(eiod->ed_mutex);
 			eiod->ed_inflights++;
 			ABT_mutex_unlock(eiod->ed_mutex);
+			xs_ctxt->exc_io_inflights++;
 
 			D_DEBUG(DB_IO, "%s blob:%p payload:%p, "
 				"pg_idx:"DF_U64", pg_cnt:"DF_U64"\n",
 				eiod->ed_update ? "Write" : "Read",
 				blob, payload, pg_idx, pg_cnt);
 
+			if (eiod->ed_update &&
+			    wc_queue(eiod, blob, payload, pg_idx, pg_cnt)) {
+				wc_queued = true;
+				continue;
+			}
+
 			if (eiod->ed_update)
 				spdk_blob_io_write(blob, channel, payload,
 						   pg_idx, pg_cnt,
@@ -689,6 +995,9 @@ dma_rw(struct eio_desc *eiod, bool prep)
 		}
 	}
 
+	if (wc_queued)
+		wc_submit(xs_ctxt);
+
 	if (xs_ctxt->exc_xs_id == -1) {
 		D_DEBUG(DB_IO, "Self poll completion, blob:%p\n", blob);
 		xs_poll_completion(xs_ctxt, &eiod->ed_inflights);
@@ -700,6 +1009,10 @@ dma_rw(struct eio_desc *eiod, bool prep)
 		ABT_mutex_unlock(eiod->ed_mutex);
 	}
 
+	if (!eiod->ed_update && eiod->ed_result == 0 &&
+	    xs_ctxt->exc_page_cache != NULL)
+		dma_cache_fill(eiod);
+
 	D_DEBUG(DB_IO, "DMA done, blob:%p, update:%d, rmw:%d\n",
 		blob, eiod->ed_update, rmw_read);
 }
@@ -789,26 +1102,111 @@ copy_one(struct eio_desc *eiod, struct eio_iov *eiov,
 	return -DER_INVAL;
 }
 
+/* Wake up the first IOD waiting for DMA buffer */
+static void
+edb_wake(struct eio_dma_buffer *edb)
+{
+	struct eio_dma_waiter *waiter;
+
+	if (d_list_empty(&edb->edb_waitq))
+		return;
+
+	waiter = d_list_entry(edb->edb_waitq.next, struct eio_dma_waiter,
+			      edw_link);
+	if (waiter->edw_woken)
+		return;
+
+	waiter->edw_woken = true;
+	ABT_eventual_set(waiter->edw_eventual, NULL, 0);
+}
+
 static void
 dma_drop_iod(struct eio_dma_buffer *edb)
 {
 	D_ASSERT(edb->edb_active_iods > 0);
 	edb->edb_active_iods--;
+	edb_wake(edb);
+}
+
+static bool
+iod_need_dma(struct eio_desc *eiod)
+{
+	struct eio_iov	*eiov;
+	int		 i, j;
 
-	ABT_mutex_lock(edb->edb_mutex);
-	ABT_cond_broadcast(edb->edb_wait_iods);
-	ABT_mutex_unlock(edb->edb_mutex);
+	for (i = 0; i < eiod->ed_sgl_cnt; i++) {
+		for (j = 0; j < eiod->ed_sgls[i].es_nr_out; j++) {
+			eiov = &eiod->ed_sgls[i].es_iovs[j];
+			if (eiov->ei_addr.ea_type == EIO_ADDR_NVME &&
+			    !eio_addr_is_hole(&eiov->ei_addr))
+				return true;
+		}
+	}
+	return false;
 }
 
-int
-eio_iod_prep(struct eio_desc *eiod)
+static int
+edb_enqueue(struct eio_dma_buffer *edb, struct eio_dma_waiter *waiter)
 {
-	struct eio_dma_buffer *edb;
-	int rc, retry_cnt = 0;
+	int rc;
 
-	if (eiod->ed_buffer_prep)
-		return -EINVAL;
+	rc = ABT_eventual_create(0, &waiter->edw_eventual);
+	if (rc != ABT_SUCCESS)
+		return -DER_NOMEM;
+
+	waiter->edw_woken = false;
+	d_list_add_tail(&waiter->edw_link, &edb->edb_waitq);
+	return 0;
+}
+
+/* Leave the wait queue, and pass the turn to the next waiter */
+static void
+edb_dequeue(struct eio_dma_buffer *edb, struct eio_dma_waiter *waiter)
+{
+	d_list_del(&waiter->edw_link);
+	ABT_eventual_free(&waiter->edw_eventual);
+	edb_wake(edb);
+}
 
+/* Wait for the turn to reserve DMA buffer, see edb_wake() */
+static void
+edb_wait(struct eio_dma_waiter *waiter)
+{
+	ABT_eventual_wait(waiter->edw_eventual, NULL);
+	ABT_eventual_reset(waiter->edw_eventual);
+	waiter->edw_woken = false;
+}
+
+/*
+ * Map the SCM IOVs and reserve DMA buffer for the NVMe IOVs of @eiod.
+ *
+ * When the per-xstream DMA buffer is exhausted, the IOD waits for active
+ * IODs releasing their DMA buffer in a FIFO queue, only the first waiter
+ * is woken up on each release. The new IODs needing DMA buffer queue
+ * behind the waiters (back-pressure) instead of taking the pages just
+ * released, so the large waiting IODs won't be starved by small ones.
+ */
+int
+iod_map_buffer(struct eio_desc *eiod)
+{
+	struct eio_dma_buffer	*edb = NULL;
+	struct eio_dma_waiter	 waiter;
+	bool			 queued = false;
+	int			 rc, retry_cnt = 0;
+
+	if (eiod->ed_ctxt->eic_xs_ctxt != NULL)
+		edb = eiod->ed_ctxt->eic_xs_ctxt->exc_dma_buf;
+
+	if (edb != NULL && !d_list_empty(&edb->edb_waitq) &&
+	    edb->edb_active_iods && iod_need_dma(eiod)) {
+		rc = edb_enqueue(edb, &waiter);
+		if (rc)
+			return rc;
+		queued = true;
+
+		D_DEBUG(DB_IO, "IOD %p queues behind waiters.\n", eiod);
+		edb_wait(&waiter);
+	}
 retry:
 	rc = iterate_eiov(eiod, dma_map_one, NULL);
 	if (rc) {
@@ -819,22 +1217,28 @@ retry:
 		iod_release_buffer(eiod);
 
 		if (!eiod->ed_retry)
-			return rc;
+			goto out;
 
 		eiod->ed_retry = 0;
 		edb = iod_dma_buf(eiod);
 		if (!edb->edb_active_iods) {
 			D_ERROR("Per-xstream DMA buffer isn't large enough "
 				"to satisfy large IOD %p\n", eiod);
-			return rc;
+			goto out;
+		}
+
+		/* A woken waiter stays at the head of the queue */
+		if (!queued) {
+			rc = edb_enqueue(edb, &waiter);
+			if (rc)
+				return rc;
+			queued = true;
 		}
 
 		D_DEBUG(DB_IO, "IOD %p waits for active IODs. %d\n",
 			eiod, retry_cnt++);
 
-		ABT_mutex_lock(edb->edb_mutex);
-		ABT_cond_wait(edb->edb_wait_iods, edb->edb_mutex);
-		ABT_mutex_unlock(edb->edb_mutex);
+		edb_wait(&waiter);
 
 		D_DEBUG(DB_IO, "IOD %p finished waiting. %d\n",
 			eiod, retry_cnt);
@@ -843,18 +1247,46 @@ retry:
 	}
 	eiod->ed_buffer_prep = 1;
 
+	if (eiod->ed_rsrvd.erd_rg_cnt != 0) {
+		edb = iod_dma_buf(eiod);
+		edb->edb_active_iods++;
+	}
+out:
+	if (queued)
+		edb_dequeue(edb, &waiter);
+	return rc;
+}
+
+/* Release the DMA buffer reserved by iod_map_buffer() */
+void
+iod_unmap_buffer(struct eio_desc *eiod)
+{
+	bool dma = (eiod->ed_rsrvd.erd_rg_cnt != 0);
+
+	iod_release_buffer(eiod);
+	if (dma)
+		dma_drop_iod(iod_dma_buf(eiod));
+}
+
+int
+eio_iod_prep(struct eio_desc *eiod)
+{
+	int rc;
+
+	if (eiod->ed_buffer_prep)
+		return -EINVAL;
+
+	rc = iod_map_buffer(eiod);
+	if (rc)
+		return rc;
+
 	/* All SCM IOVs, no DMA transfer prepared */
 	if (eiod->ed_rsrvd.erd_rg_cnt == 0)
 		return 0;
 
-	edb = iod_dma_buf(eiod);
-	edb->edb_active_iods++;
-
 	dma_rw(eiod, true);
-	if (eiod->ed_result) {
-		iod_release_buffer(eiod);
-		dma_drop_iod(edb);
-	}
+	if (eiod->ed_result)
+		iod_unmap_buffer(eiod);
 
 	return eiod->ed_result;
 }
@@ -862,8 +1294,6 @@ retry:
 int
 eio_iod_post(struct eio_desc *eiod)
 {
-	struct eio_dma_buffer *edb;
-
 	if (!eiod->ed_buffer_prep)
 		return -DER_INVAL;
 
@@ -878,13 +1308,38 @@ eio_iod_post(struct eio_desc *eiod)
 	else
 		eiod->ed_result = 0;
 
-	iod_release_buffer(eiod);
-	edb = iod_dma_buf(eiod);
-	dma_drop_iod(edb);
-
+	iod_unmap_buffer(eiod);
 	return eiod->ed_result;
 }
 
+int
+eio_iov2dma_chunk(struct eio_desc *eiod, struct eio_iov *eiov,
+		  void **chk_ptr, size_t *chk_sz)
+{
+	struct eio_rsrvd_dma	*rsrvd_dma = &eiod->ed_rsrvd;
+	struct eio_dma_chunk	*chk;
+	size_t			 chk_bytes;
+	int			 i;
+
+	if (!eiod->ed_buffer_prep || eiov->ei_buf == NULL ||
+	    eiov->ei_addr.ea_type != EIO_ADDR_NVME)
+		return -DER_INVAL;
+
+	for (i = 0; i < rsrvd_dma->erd_chk_cnt; i++) {
+		chk = rsrvd_dma->erd_dma_chks[i];
+		chk_bytes = (size_t)chk->edc_pg_cnt << EIO_DMA_PAGE_SHIFT;
+		if (eiov->ei_buf >= chk->edc_ptr &&
+		    eiov->ei_buf + eiov->ei_data_len <=
+		    chk->edc_ptr + chk_bytes) {
+			*chk_ptr = chk->edc_ptr;
+			*chk_sz = chk_bytes;
+			return 0;
+		}
+	}
+
+	return -DER_INVAL;
+}
+
 int
 eio_iod_copy(struct eio_desc *eiod, d_sg_list_t *sgls, unsigned int nr_sgl)
 {
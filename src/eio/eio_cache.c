@@ -0,0 +1,250 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B620873.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/*
+ * Per-xstream DRAM cache of NVMe pages. Pages read from the SPDK blob are
+ * kept in a fixed size page array indexed by a hash table keyed by blob
+ * page offset, victims are chosen by the CLOCK algorithm. Pages are evicted
+ * when they are overwritten or when the extent is freed by VEA.
+ *
+ * The cache is only accessed by the ULTs of the owning xstream, so it needs
+ * no locking.
+ */
+#define D_LOGFAC	DD_FAC(eio)
+
+#include <spdk/blob.h>
+#include "eio_internal.h"
+
+/* Per-xstream cache size in pages, 0 means the cache is disabled */
+unsigned int eio_cache_pg_max;
+
+/* Don't fill the cache with reads larger than 1/8 of it */
+#define EIO_CACHE_FILL_SHIFT	3
+
+static inline d_list_t *
+cache_bucket(struct eio_page_cache *epc, struct spdk_blob *blob,
+	     uint64_t pg_idx)
+{
+	uint64_t key;
+
+	key = (pg_idx ^ ((uintptr_t)blob >> 6)) * 0x9E3779B97F4A7C15ULL;
+	return &epc->epc_buckets[(key >> 32) % epc->epc_pg_cnt];
+}
+
+static inline void *
+cache_page_data(struct eio_page_cache *epc, struct eio_cache_page *page)
+{
+	return epc->epc_data + ((page - epc->epc_pages) << EIO_DMA_PAGE_SHIFT);
+}
+
+static struct eio_cache_page *
+cache_lookup(struct eio_page_cache *epc, struct spdk_blob *blob,
+	     uint64_t pg_idx)
+{
+	struct eio_cache_page *page;
+
+	d_list_for_each_entry(page, cache_bucket(epc, blob, pg_idx),
+			      ecp_link) {
+		if (page->ecp_blob == blob && page->ecp_pg_idx == pg_idx)
+			return page;
+	}
+	return NULL;
+}
+
+static void
+cache_page_drop(struct eio_page_cache *epc, struct eio_cache_page *page)
+{
+	D_ASSERT(page->ecp_blob != NULL);
+	d_list_del_init(&page->ecp_link);
+	page->ecp_blob = NULL;
+	page->ecp_referenced = 0;
+	epc->epc_evicts++;
+}
+
+/* Get a free page, evict the first unreferenced page found by the hand */
+static struct eio_cache_page *
+cache_page_get(struct eio_page_cache *epc)
+{
+	struct eio_cache_page *page;
+
+	while (1) {
+		page = &epc->epc_pages[epc->epc_hand];
+		epc->epc_hand = (epc->epc_hand + 1) % epc->epc_pg_cnt;
+
+		if (page->ecp_blob == NULL)
+			return page;
+
+		if (page->ecp_referenced) {
+			page->ecp_referenced = 0;
+			continue;
+		}
+
+		cache_page_drop(epc, page);
+		return page;
+	}
+}
+
+bool
+page_cache_read(struct eio_page_cache *epc, struct spdk_blob *blob,
+		uint64_t pg_idx, uint64_t pg_cnt, void *payload)
+{
+	struct eio_cache_page	*page;
+	uint64_t		 i;
+
+	if (epc == NULL)
+		return false;
+
+	for (i = 0; i < pg_cnt; i++) {
+		if (cache_lookup(epc, blob, pg_idx + i) == NULL) {
+			epc->epc_misses += pg_cnt;
+			return false;
+		}
+	}
+
+	for (i = 0; i < pg_cnt; i++) {
+		page = cache_lookup(epc, blob, pg_idx + i);
+		D_ASSERT(page != NULL);
+		page->ecp_referenced = 1;
+		memcpy(payload + (i << EIO_DMA_PAGE_SHIFT),
+		       cache_page_data(epc, page), EIO_DMA_PAGE_SZ);
+	}
+	epc->epc_hits += pg_cnt;
+
+	return true;
+}
+
+void
+page_cache_fill(struct eio_page_cache *epc, struct spdk_blob *blob,
+		uint64_t pg_idx, uint64_t pg_cnt, void *payload)
+{
+	struct eio_cache_page	*page;
+	uint64_t		 i;
+
+	if (epc == NULL || pg_cnt > (epc->epc_pg_cnt >> EIO_CACHE_FILL_SHIFT))
+		return;
+
+	for (i = 0; i < pg_cnt; i++) {
+		page = cache_lookup(epc, blob, pg_idx + i);
+		if (page != NULL) {
+			page->ecp_referenced = 1;
+			continue;
+		}
+
+		page = cache_page_get(epc);
+		page->ecp_blob = blob;
+		page->ecp_pg_idx = pg_idx + i;
+		d_list_add(&page->ecp_link,
+			   cache_bucket(epc, blob, pg_idx + i));
+		memcpy(cache_page_data(epc, page),
+		       payload + (i << EIO_DMA_PAGE_SHIFT), EIO_DMA_PAGE_SZ);
+	}
+}
+
+void
+page_cache_evict(struct eio_page_cache *epc, struct spdk_blob *blob,
+		 uint64_t pg_idx, uint64_t pg_cnt)
+{
+	struct eio_cache_page	*page;
+	uint64_t		 i;
+
+	if (epc == NULL)
+		return;
+
+	/* Scan the whole cache rather than looking up each page */
+	if (pg_cnt > epc->epc_pg_cnt) {
+		for (i = 0; i < epc->epc_pg_cnt; i++) {
+			page = &epc->epc_pages[i];
+			if (page->ecp_blob == blob &&
+			    page->ecp_pg_idx >= pg_idx &&
+			    page->ecp_pg_idx < pg_idx + pg_cnt)
+				cache_page_drop(epc, page);
+		}
+		return;
+	}
+
+	for (i = 0; i < pg_cnt; i++) {
+		page = cache_lookup(epc, blob, pg_idx + i);
+		if (page != NULL)
+			cache_page_drop(epc, page);
+	}
+}
+
+void
+page_cache_destroy(struct eio_page_cache *epc)
+{
+	if (epc->epc_buckets != NULL)
+		D_FREE(epc->epc_buckets);
+	if (epc->epc_pages != NULL)
+		D_FREE(epc->epc_pages);
+	if (epc->epc_data != NULL)
+		D_FREE(epc->epc_data);
+	D_FREE_PTR(epc);
+}
+
+struct eio_page_cache *
+page_cache_create(unsigned int pg_cnt)
+{
+	struct eio_page_cache	*epc;
+	unsigned int		 i;
+
+	D_ASSERT(pg_cnt > 0);
+	D_ALLOC_PTR(epc);
+	if (epc == NULL)
+		return NULL;
+
+	epc->epc_pg_cnt = pg_cnt;
+	D_ALLOC(epc->epc_data, (size_t)pg_cnt << EIO_DMA_PAGE_SHIFT);
+	if (epc->epc_data == NULL)
+		goto failed;
+
+	D_ALLOC(epc->epc_pages, sizeof(*epc->epc_pages) * pg_cnt);
+	if (epc->epc_pages == NULL)
+		goto failed;
+
+	D_ALLOC(epc->epc_buckets, sizeof(*epc->epc_buckets) * pg_cnt);
+	if (epc->epc_buckets == NULL)
+		goto failed;
+
+	for (i = 0; i < pg_cnt; i++) {
+		D_INIT_LIST_HEAD(&epc->epc_buckets[i]);
+		D_INIT_LIST_HEAD(&epc->epc_pages[i].ecp_link);
+	}
+
+	return epc;
+failed:
+	page_cache_destroy(epc);
+	return NULL;
+}
+
+void
+eio_cache_evict(struct eio_io_context *ctxt, uint64_t off, uint64_t len)
+{
+	uint64_t pg_idx, pg_end;
+
+	if (ctxt->eic_blob == NULL || ctxt->eic_xs_ctxt == NULL)
+		return;
+
+	pg_idx = off >> EIO_DMA_PAGE_SHIFT;
+	pg_end = (off + len + EIO_DMA_PAGE_SZ - 1) >> EIO_DMA_PAGE_SHIFT;
+	page_cache_evict(ctxt->eic_xs_ctxt->exc_page_cache, ctxt->eic_blob,
+			 pg_idx, pg_end - pg_idx);
+}
@@ -322,6 +322,10 @@ eio_ioctxt_close(struct eio_io_context *ctxt)
 	ebs = ctxt->eic_xs_ctxt->exc_blobstore;
 	D_ASSERT(ebs != NULL);
 
+	/* The blob pointer could be reused by another opened blob */
+	page_cache_evict(ctxt->eic_xs_ctxt->exc_page_cache, ctxt->eic_blob, 0,
+			 UINT64_MAX);
+
 	ba->bca_inflights = 1;
 	ABT_mutex_lock(ebs->eb_mutex);
 	if (ebs->eb_bs != NULL)
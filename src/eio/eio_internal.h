@@ -38,8 +38,33 @@ struct eio_dma_chunk {
 	void		*edc_ptr;
 	/* Page offset (4K page) to unused fraction */
 	unsigned int	 edc_pg_idx;
+	/* Size of the chunk in pages, see dma_chk_pgs() */
+	unsigned int	 edc_pg_cnt;
 	/* Being used by how many I/O descriptors */
 	unsigned int	 edc_ref;
+	/* Size class of the chunk */
+	int		 edc_cls;
+};
+
+/*
+ * Size classes of DMA buffer reservation, each class has its own chunk size,
+ * idle chunks and current chunk, so that small reservations neither fragment
+ * nor pin the large chunks used by large ones.
+ */
+enum {
+	EIO_CHK_CLASS_4K	= 0,	/* Single page */
+	EIO_CHK_CLASS_64K,		/* Up to 16 pages */
+	EIO_CHK_CLASS_1M,		/* Larger ones */
+	EIO_CHK_CLASS_MAX,
+};
+
+/* An IOD waiting for DMA buffer, see edb_wait() */
+struct eio_dma_waiter {
+	/* Link to edb_waitq */
+	d_list_t		 edw_link;
+	ABT_eventual		 edw_eventual;
+	/* The eventual is set and not yet waited */
+	bool			 edw_woken;
 };
 
 /*
@@ -47,13 +72,17 @@ struct eio_dma_chunk {
  * RDMA buffer for ZC fetch/update over NVMe devices.
  */
 struct eio_dma_buffer {
-	d_list_t		 edb_idle_list;
+	d_list_t		 edb_idle_list[EIO_CHK_CLASS_MAX];
 	d_list_t		 edb_used_list;
-	struct eio_dma_chunk	*edb_cur_chk;
-	unsigned int		 edb_tot_cnt;
+	struct eio_dma_chunk	*edb_cur_chk[EIO_CHK_CLASS_MAX];
+	/* NUMA node where the DMA chunks are allocated */
+	int			 edb_socket;
+	/* Total pages of the chunks, of each class and of all */
+	unsigned int		 edb_cls_pgs[EIO_CHK_CLASS_MAX];
+	unsigned int		 edb_tot_pgs;
 	unsigned int		 edb_active_iods;
-	ABT_cond		 edb_wait_iods;
-	ABT_mutex		 edb_mutex;
+	/* FIFO of the IODs waiting for active IODs to release DMA buffer */
+	d_list_t		 edb_waitq;
 };
 
 /*
@@ -67,6 +96,62 @@ struct eio_blobstore {
 	int			 eb_ref;
 };
 
+/* An NVMe write region queued for write combining */
+struct eio_wc_io {
+	/* Link to ewq_list, or to the batch it's issued with */
+	d_list_t		 ewi_link;
+	struct eio_desc		*ewi_iod;
+	struct spdk_blob	*ewi_blob;
+	void			*ewi_payload;
+	uint64_t		 ewi_pg_idx;
+	uint64_t		 ewi_pg_cnt;
+};
+
+/*
+ * Per-xstream write combining queue. NVMe writes of concurrent updates are
+ * queued here, the first ULT queuing a write becomes the leader, it yields
+ * for a bounded number of times to let other ULTs queue their writes, then
+ * issues the queued writes with blob-contiguous ones merged.
+ */
+struct eio_wc_queue {
+	d_list_t		 ewq_list;
+	/* Total number of queued writes */
+	unsigned int		 ewq_cnt;
+	/* Total pages of queued writes */
+	uint64_t		 ewq_pg_cnt;
+	/* Some ULT is gathering writes to issue */
+	unsigned int		 ewq_leader:1;
+};
+
+/* A page in the per-xstream DRAM cache of NVMe pages */
+struct eio_cache_page {
+	/* Link to the hash bucket */
+	d_list_t		 ecp_link;
+	/* SPDK blob the page belongs to, NULL for an unused page */
+	struct spdk_blob	*ecp_blob;
+	/* Page offset within the blob */
+	uint64_t		 ecp_pg_idx;
+	/* Referenced since last swept by the CLOCK hand */
+	unsigned int		 ecp_referenced:1;
+};
+
+/* Per-xstream DRAM cache of NVMe pages */
+struct eio_page_cache {
+	struct eio_cache_page	*epc_pages;
+	/* Data of all pages, in the order of epc_pages */
+	void			*epc_data;
+	/* Hash buckets, the bucket count equals to the page count */
+	d_list_t		*epc_buckets;
+	unsigned int		 epc_pg_cnt;
+	/* CLOCK hand */
+	unsigned int		 epc_hand;
+	/* Statistics, in pages */
+	uint64_t		 epc_hits;
+	uint64_t		 epc_misses;
+	uint64_t		 epc_evicts;
+	uint64_t		 epc_stat_age;
+};
+
 /* Per-xstream NVMe context */
 struct eio_xs_context {
 	int			 exc_xs_id;
@@ -76,6 +161,12 @@ struct eio_xs_context {
 	struct spdk_io_channel	*exc_io_channel;
 	d_list_t		 exc_pollers;
 	struct eio_dma_buffer	*exc_dma_buf;
+	struct eio_wc_queue	 exc_wc_queue;
+	struct eio_page_cache	*exc_page_cache;
+	/* NVMe I/Os in flight */
+	unsigned int		 exc_io_inflights;
+	/* NVMe I/O completions reaped by the current poll */
+	unsigned int		 exc_io_completed;
 };
 
 /* Per VOS instance I/O context */
@@ -141,10 +232,25 @@ struct eio_desc {
 /* eio_xstream.c */
 extern unsigned int	eio_chk_sz;
 extern unsigned int	eio_chk_cnt_max;
+extern unsigned int	eio_wc_depth;
+extern unsigned int	eio_wc_yield;
 void xs_poll_completion(struct eio_xs_context *ctxt, unsigned int *inflights);
 
 /* eio_buffer.c */
 void dma_buffer_destroy(struct eio_dma_buffer *buf);
-struct eio_dma_buffer *dma_buffer_create(unsigned int init_cnt);
+struct eio_dma_buffer *dma_buffer_create(unsigned int init_cnt, int socket);
+int iod_map_buffer(struct eio_desc *eiod);
+void iod_unmap_buffer(struct eio_desc *eiod);
+
+/* eio_cache.c */
+extern unsigned int	eio_cache_pg_max;
+struct eio_page_cache *page_cache_create(unsigned int pg_cnt);
+void page_cache_destroy(struct eio_page_cache *epc);
+bool page_cache_read(struct eio_page_cache *epc, struct spdk_blob *blob,
+		     uint64_t pg_idx, uint64_t pg_cnt, void *payload);
+void page_cache_fill(struct eio_page_cache *epc, struct spdk_blob *blob,
+		     uint64_t pg_idx, uint64_t pg_cnt, void *payload);
+void page_cache_evict(struct eio_page_cache *epc, struct spdk_blob *blob,
+		      uint64_t pg_idx, uint64_t pg_cnt);
 
 #endif /* __EIO_INTERNAL_H__ */
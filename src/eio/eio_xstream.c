@@ -25,6 +25,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sched.h>
+#include <numa.h>
 #include <uuid/uuid.h>
 #include <abt.h>
 #include <spdk/env.h>
@@ -57,6 +59,10 @@ unsigned int eio_chk_sz;
 unsigned int eio_chk_cnt_max;
 /* Per-xstream initial DMA buffer size (in chunk count) */
 static unsigned int eio_chk_cnt_init;
+/* Max queued writes to be combined per xstream, 0 disables combining */
+unsigned int eio_wc_depth;
+/* How many times the write combining leader yields before issuing */
+unsigned int eio_wc_yield;
 
 struct eio_bdev {
 	d_list_t		 eb_link;
@@ -122,6 +128,29 @@ print_io_stat(uint64_t now)
 	stat_age = now;
 }
 
+/* Print the page cache stat of current xstream every few seconds */
+static void
+print_cache_stat(struct eio_xs_context *ctxt, uint64_t now)
+{
+	struct eio_page_cache	*epc = ctxt->exc_page_cache;
+	uint64_t		 total;
+
+	if (io_stat_period == 0 || epc == NULL)
+		return;
+
+	if (epc->epc_stat_age + io_stat_period >= now)
+		return;
+
+	total = epc->epc_hits + epc->epc_misses;
+	D_PRINT("EIO CACHE STAT: xs[%d] hits["DF_U64"], misses["DF_U64"], "
+		"hit_rate[%u%%], evicts["DF_U64"]\n", ctxt->exc_xs_id,
+		epc->epc_hits, epc->epc_misses,
+		total ? (unsigned int)(epc->epc_hits * 100 / total) : 0,
+		epc->epc_evicts);
+
+	epc->epc_stat_age = now;
+}
+
 int
 eio_nvme_init(const char *storage_path)
 {
@@ -180,6 +209,15 @@ eio_nvme_init(const char *storage_path)
 
 	eio_chk_sz = (size_mb << 20) >> EIO_DMA_PAGE_SHIFT;
 
+	env = getenv("VOS_BDEV_WC_DEPTH");
+	eio_wc_depth = env ? atoi(env) : 16;
+	env = getenv("VOS_BDEV_WC_YIELD");
+	eio_wc_yield = env ? atoi(env) : 2;
+
+	env = getenv("VOS_BDEV_CACHE_MB");
+	size_mb = env ? atoi(env) : 0;
+	eio_cache_pg_max = ((uint64_t)size_mb << 20) >> EIO_DMA_PAGE_SHIFT;
+
 	env = getenv("IO_STAT_PERIOD");
 	io_stat_period = env ? atoi(env) : 0;
 	io_stat_period *= (NSEC_PER_SEC / NSEC_PER_USEC);
@@ -287,7 +325,8 @@ stop_poller(struct spdk_poller *poller, void *ctxt)
  *
  * \param[IN] ctxt	Per-xstream NVMe context
  *
- * \returns		Executed message count
+ * \returns		Executed message count plus reaped I/O completion
+ *			count
  */
 size_t
 eio_nvme_poll(struct eio_xs_context *ctxt)
@@ -301,6 +340,9 @@ eio_nvme_poll(struct eio_xs_context *ctxt)
 	if (ctxt == NULL)
 		return 0;
 
+	/* Counted by the I/O completion callbacks */
+	ctxt->exc_io_completed = 0;
+
 	/* Process one msg on the msg ring */
 	count = spdk_ring_dequeue(ctxt->exc_msg_ring, (void **)&msg, 1);
 	if (count > 0) {
@@ -321,8 +363,15 @@ eio_nvme_poll(struct eio_xs_context *ctxt)
 
 	if (nvme_glb.ed_init_thread == ctxt->exc_thread)
 		print_io_stat(now);
+	print_cache_stat(ctxt, now);
+
+	return count + ctxt->exc_io_completed;
+}
 
-	return count;
+bool
+eio_nvme_inflight(struct eio_xs_context *ctxt)
+{
+	return ctxt != NULL && ctxt->exc_io_inflights != 0;
 }
 
 struct common_cp_arg {
@@ -855,6 +904,12 @@ eio_xsctxt_free(struct eio_xs_context *ctxt)
 		ctxt->exc_msg_ring = NULL;
 	}
 	D_ASSERT(d_list_empty(&ctxt->exc_pollers));
+	D_ASSERT(d_list_empty(&ctxt->exc_wc_queue.ewq_list));
+
+	if (ctxt->exc_page_cache != NULL) {
+		page_cache_destroy(ctxt->exc_page_cache);
+		ctxt->exc_page_cache = NULL;
+	}
 
 	if (ctxt->exc_dma_buf != NULL) {
 		dma_buffer_destroy(ctxt->exc_dma_buf);
@@ -870,7 +925,7 @@ eio_xsctxt_alloc(struct eio_xs_context **pctxt, int xs_id)
 	struct spdk_conf *config = NULL;
 	struct eio_xs_context *ctxt;
 	char name[32];
-	int rc;
+	int socket, rc;
 
 	/* Skip NVMe context setup if the daos_nvme.conf isn't present */
 	if (nvme_glb.ed_skip_setup) {
@@ -883,6 +938,7 @@ eio_xsctxt_alloc(struct eio_xs_context **pctxt, int xs_id)
 		return -DER_NOMEM;
 
 	D_INIT_LIST_HEAD(&ctxt->exc_pollers);
+	D_INIT_LIST_HEAD(&ctxt->exc_wc_queue.ewq_list);
 	ctxt->exc_xs_id = xs_id;
 
 	ABT_mutex_lock(nvme_glb.ed_mutex);
@@ -996,7 +1052,22 @@ eio_xsctxt_alloc(struct eio_xs_context **pctxt, int xs_id)
 	if (rc)
 		goto out;
 
-	ctxt->exc_dma_buf = dma_buffer_create(eio_chk_cnt_init);
+	/* Allocate DMA buffer from the NUMA node of current xstream */
+	socket = SPDK_ENV_SOCKET_ID_ANY;
+	if (numa_available() != -1) {
+		rc = numa_node_of_cpu(sched_getcpu());
+		if (rc >= 0)
+			socket = rc;
+		rc = 0;
+	}
+	ctxt->exc_dma_buf = dma_buffer_create(eio_chk_cnt_init, socket);
+
+	if (eio_cache_pg_max != 0) {
+		ctxt->exc_page_cache = page_cache_create(eio_cache_pg_max);
+		if (ctxt->exc_page_cache == NULL)
+			D_WARN("Failed to create page cache, xs_id:%d\n",
+			       xs_id);
+	}
 out:
 	ABT_mutex_unlock(nvme_glb.ed_mutex);
 	spdk_conf_free(config);
@@ -0,0 +1,282 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B620873.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Microbenchmark of the per-xstream DMA buffer, ULTs on one xstream keep
+ * reserving and releasing DMA buffer for a mix of 4K, 64K and 1M IODs,
+ * the reservation rate and the wait time of each size are reported.
+ */
+#define D_LOGFAC	DD_FAC(tests)
+
+#include <abt.h>
+#include <getopt.h>
+#include <spdk/env.h>
+#include <daos/common.h>
+#include "../eio_internal.h"
+
+/* Size of the IODs in pages, and the percentage of each */
+static const unsigned int	dp_pgs[EIO_CHK_CLASS_MAX] = { 1, 16, 256 };
+static const unsigned int	dp_pct[EIO_CHK_CLASS_MAX] = { 70, 20, 10 };
+
+struct dp_stat {
+	unsigned long	ds_ops;
+	double		ds_wait;
+	double		ds_wait_max;
+};
+
+static struct dp_stat		dp_stats[EIO_CHK_CLASS_MAX];
+static unsigned long		dp_created;
+static unsigned long		dp_failed;
+static bool			dp_exiting;
+
+static struct umem_instance	dp_umem;
+static struct eio_xs_context	dp_xs_ctxt;
+static struct eio_io_context	dp_io_ctxt;
+static ABT_pool			dp_pool;
+
+static int			opt_secs = 5;
+static int			opt_threads = 64;
+static int			opt_hold = 8;
+
+static int
+dp_pick_size(void)
+{
+	int	pct = rand() % 100;
+	int	i;
+
+	for (i = 0; i < EIO_CHK_CLASS_MAX - 1; i++) {
+		if (pct < dp_pct[i])
+			break;
+		pct -= dp_pct[i];
+	}
+	return i;
+}
+
+static void
+dp_thread(void *arg)
+{
+	struct eio_desc		*eiod;
+	struct eio_sglist	*esgl;
+	struct eio_iov		*eiov;
+	struct dp_stat		*stat;
+	double			 then, wait;
+	uint64_t		 off = 0;
+	int			 size, i, rc;
+
+	while (!dp_exiting) {
+		size = dp_pick_size();
+		stat = &dp_stats[size];
+
+		eiod = eio_iod_alloc(&dp_io_ctxt, 1, true);
+		if (eiod == NULL) {
+			dp_failed++;
+			break;
+		}
+
+		esgl = eio_iod_sgl(eiod, 0);
+		rc = eio_sgl_init(esgl, 1);
+		if (rc) {
+			eio_iod_free(eiod);
+			dp_failed++;
+			break;
+		}
+
+		eiov = &esgl->es_iovs[0];
+		eio_addr_set(&eiov->ei_addr, EIO_ADDR_NVME, off);
+		eiov->ei_data_len = dp_pgs[size] << EIO_DMA_PAGE_SHIFT;
+		esgl->es_nr_out = 1;
+		off += eiov->ei_data_len;
+
+		then = ABT_get_wtime();
+		rc = iod_map_buffer(eiod);
+		if (rc) {
+			eio_iod_free(eiod);
+			dp_failed++;
+			break;
+		}
+
+		wait = ABT_get_wtime() - then;
+		stat->ds_ops++;
+		stat->ds_wait += wait;
+		if (wait > stat->ds_wait_max)
+			stat->ds_wait_max = wait;
+
+		/* Hold the DMA buffer like a long running RDMA or NVMe I/O */
+		for (i = rand() % (opt_hold + 1); i > 0; i--)
+			ABT_thread_yield();
+
+		iod_unmap_buffer(eiod);
+		eio_iod_free(eiod);
+	}
+	dp_created--;
+}
+
+static void
+dp_run(void)
+{
+	double	then;
+	int	i, rc;
+
+	for (i = 0; i < opt_threads; i++) {
+		rc = ABT_thread_create(dp_pool, dp_thread, NULL,
+				       ABT_THREAD_ATTR_NULL, NULL);
+		if (rc != ABT_SUCCESS) {
+			printf("ABT thread create failed: %d\n", rc);
+			break;
+		}
+		dp_created++;
+	}
+
+	then = ABT_get_wtime();
+	while (ABT_get_wtime() - then < opt_secs && dp_failed == 0)
+		ABT_thread_yield();
+
+	dp_exiting = true;
+	while (dp_created != 0)
+		ABT_thread_yield();
+
+	printf("%-6s %12s %12s %12s\n", "size", "ops/sec", "avg_wait(us)",
+	       "max_wait(us)");
+	for (i = 0; i < EIO_CHK_CLASS_MAX; i++) {
+		struct dp_stat *stat = &dp_stats[i];
+
+		printf("%4uK  %12lu %12.2f %12.2f\n",
+		       dp_pgs[i] << (EIO_DMA_PAGE_SHIFT - 10),
+		       stat->ds_ops / opt_secs,
+		       stat->ds_ops ? stat->ds_wait * 1e6 / stat->ds_ops : 0,
+		       stat->ds_wait_max * 1e6);
+	}
+	if (dp_failed)
+		printf("%lu ULTs failed to reserve DMA buffer\n", dp_failed);
+}
+
+static struct option dp_ops[] = {
+	/**
+	 * number of ULTs doing I/O
+	 */
+	{ "num",	required_argument,	NULL,	'n'	},
+	/**
+	 * test duration in seconds.
+	 */
+	{ "sec",	required_argument,	NULL,	's'	},
+	/**
+	 * max yields of holding the DMA buffer
+	 */
+	{ "hold",	required_argument,	NULL,	'y'	},
+	/**
+	 * DMA chunk size in MB, and max chunk count per xstream
+	 */
+	{ "chk_mb",	required_argument,	NULL,	'm'	},
+	{ "chk_cnt",	required_argument,	NULL,	'c'	},
+	{ NULL,		0,			NULL,	0	},
+};
+
+int
+main(int argc, char **argv)
+{
+	struct spdk_env_opts	opts;
+	ABT_xstream		xstream;
+	unsigned int		chk_mb = 1;
+	int			rc;
+
+	eio_chk_cnt_max = 16;
+	while ((rc = getopt_long(argc, argv, "n:s:y:m:c:",
+				 dp_ops, NULL)) != -1) {
+		switch (rc) {
+		default:
+			fprintf(stderr, "unknown opc=%c\n", rc);
+			exit(-1);
+		case 'n':
+			opt_threads = atoi(optarg);
+			break;
+		case 's':
+			opt_secs = atoi(optarg);
+			break;
+		case 'y':
+			opt_hold = atoi(optarg);
+			break;
+		case 'm':
+			chk_mb = atoi(optarg);
+			break;
+		case 'c':
+			eio_chk_cnt_max = atoi(optarg);
+			break;
+		}
+	}
+
+	if (opt_secs <= 0 || opt_threads <= 0 || chk_mb == 0 ||
+	    eio_chk_cnt_max == 0) {
+		printf("invalid arguments\n");
+		return -1;
+	}
+	eio_chk_sz = (chk_mb << 20) >> EIO_DMA_PAGE_SHIFT;
+
+	printf("DMA buffer test (ULTs=%d, secs=%d, hold=%d, chunk=%uMB x %u)\n",
+	       opt_threads, opt_secs, opt_hold, chk_mb, eio_chk_cnt_max);
+
+	rc = daos_debug_init(NULL);
+	if (rc) {
+		printf("debug init failed: %d\n", rc);
+		return -1;
+	}
+
+	spdk_env_opts_init(&opts);
+	opts.name = "eio_dma_perf";
+	rc = spdk_env_init(&opts);
+	if (rc) {
+		printf("SPDK env init failed: %d\n", rc);
+		goto out_debug;
+	}
+
+	rc = ABT_init(0, NULL);
+	if (rc != ABT_SUCCESS) {
+		printf("ABT init failed: %d\n", rc);
+		goto out_debug;
+	}
+
+	rc = ABT_xstream_self(&xstream);
+	if (rc == ABT_SUCCESS)
+		rc = ABT_xstream_get_main_pools(xstream, 1, &dp_pool);
+	if (rc != ABT_SUCCESS) {
+		printf("ABT pool get failed: %d\n", rc);
+		goto out_abt;
+	}
+
+	dp_xs_ctxt.exc_xs_id = 0;
+	dp_xs_ctxt.exc_dma_buf = dma_buffer_create(1, SPDK_ENV_SOCKET_ID_ANY);
+	if (dp_xs_ctxt.exc_dma_buf == NULL) {
+		printf("DMA buffer create failed\n");
+		rc = -DER_NOMEM;
+		goto out_abt;
+	}
+	dp_io_ctxt.eic_umem = &dp_umem;
+	dp_io_ctxt.eic_xs_ctxt = &dp_xs_ctxt;
+
+	dp_run();
+
+	dma_buffer_destroy(dp_xs_ctxt.exc_dma_buf);
+out_abt:
+	ABT_finalize();
+out_debug:
+	daos_debug_fini();
+	return rc;
+}
@@ -94,7 +94,9 @@ struct btr_node {
 	uint64_t			tn_gen;
 	/** the first child, it is unused on leaf node */
 	TMMID(struct btr_node)		tn_child;
-	/** records in this node */
+	/** records in this node, they are placed after the key array if
+	 * the tree has BTR_FEAT_KEY_ARRAY.
+	 */
 	struct btr_record		tn_recs[0];
 };
 
@@ -265,6 +267,21 @@ typedef struct {
 	 */
 	int		(*to_hkey_cmp)(struct btr_instance *tins,
 				       struct btr_record *rec, void *hkey);
+	/**
+	 * Optional:
+	 * Convert \a hkey to an image of the same size, memcmp of two images
+	 * must have the same order as \a to_hkey_cmp of the two hkeys (the
+	 * BTR_CMP_MATCHED bit is ignored). The images are stored in the key
+	 * array of BTR_FEAT_KEY_ARRAY, so it is mandatory for a tree class
+	 * which has both \a to_hkey_cmp and BTR_FEAT_KEY_ARRAY.
+	 *
+	 * \param tins	[IN]	Tree instance which contains the root mmid
+	 *			and memory class etc.
+	 * \param hkey	[IN]	Hashed key.
+	 * \param image	[OUT]	Image of \a hkey.
+	 */
+	void		(*to_hkey_image)(struct btr_instance *tins, void *hkey,
+					 void *image);
 	/**
 	 * Optional:
 	 * Comparison of real key. It can be ignored if there is no hash
@@ -487,6 +504,14 @@ enum btr_feats {
 	 * to_key_cmp callback
 	 */
 	BTR_FEAT_DIRECT_KEY		= (1 << 1),
+	/** Besides records, each node stores a copy of the hashed keys in a
+	 * contiguous array which is searched without calling any callback.
+	 * It can be used for BTR_FEAT_UINT_KEY, or hashed keys which are
+	 * compared by memcmp, or converted by to_hkey_image to images which
+	 * can be compared by memcmp. It cannot be used with
+	 * BTR_FEAT_DIRECT_KEY by a tree, but a class can have both of them.
+	 */
+	BTR_FEAT_KEY_ARRAY		= (1 << 2),
 };
 
 /**
@@ -522,6 +547,10 @@ int  dbtree_close(daos_handle_t toh);
 int  dbtree_destroy(daos_handle_t toh);
 int  dbtree_lookup(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val_out);
 int  dbtree_update(daos_handle_t toh, daos_iov_t *key, daos_iov_t *val);
+int  dbtree_update_batch(daos_handle_t toh, daos_iov_t *keys,
+			 daos_iov_t *vals, unsigned int nr);
+int  dbtree_sort_batch(daos_handle_t toh, daos_iov_t *keys,
+		       daos_iov_t *vals, unsigned int nr);
 int  dbtree_fetch(daos_handle_t toh, dbtree_probe_opc_t opc,
 		  daos_iov_t *key, daos_iov_t *key_out, daos_iov_t *val_out);
 int  dbtree_upsert(daos_handle_t toh, dbtree_probe_opc_t opc,
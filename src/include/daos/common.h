@@ -260,7 +260,21 @@ daos_crt_network_error(int err)
  */
 enum {
 	DSS_KEY_FAIL_LOC = 0,
+	/**
+	 * percentage of the scheduling rounds given to rebuild ULTs while
+	 * there are any, 0 to stop scheduling them
+	 */
 	DSS_REBUILD_RES_PERCENTAGE,
+	/** max blocking time (usec) of idle xstreams, 0 to always poll */
+	DSS_IDLE_MAX_US,
+	/**
+	 * scheduling weights of foreground I/O, metadata, aggregation and
+	 * GC ULTs, the rebuild weight is set by DSS_REBUILD_RES_PERCENTAGE.
+	 */
+	DSS_SCHED_WEIGHT_IO,
+	DSS_SCHED_WEIGHT_META,
+	DSS_SCHED_WEIGHT_AGGREGATE,
+	DSS_SCHED_WEIGHT_GC,
 	DSS_KEY_NUM,
 };
 
@@ -299,6 +313,7 @@ daos_fail_value_get(void);
 #define DAOS_OBJ_FAIL_MOD	0x00000000
 #define DAOS_REBUILD_FAIL_MOD	0x00000100
 #define DAOS_RDB_FAIL_MOD	0x00000200
+#define DAOS_BTR_FAIL_MOD	0x00000300
 
 /* failure for DAOS_OBJ_MODULE */
 #define DAOS_SHARD_OBJ_UPDATE_TIMEOUT	(DAOS_OBJ_FAIL_MOD | 0x01)
@@ -310,6 +325,7 @@ daos_fail_value_get(void);
 #define DAOS_SHARD_OBJ_UPDATE_TIMEOUT_SINGLE	(DAOS_OBJ_FAIL_MOD | 0x07)
 #define DAOS_OBJ_SPECIAL_SHARD		(DAOS_OBJ_FAIL_MOD | 0x08)
 #define DAOS_OBJ_TGT_IDX_CHANGE		(DAOS_OBJ_FAIL_MOD | 0x09)
+#define DAOS_OBJ_EC_LOST_SHARDS		(DAOS_OBJ_FAIL_MOD | 0x0a)
 
 /* failure for DAOS_REBUILD_MODULE */
 #define DAOS_REBUILD_DROP_SCAN	(DAOS_REBUILD_FAIL_MOD | 0x001)
@@ -331,6 +347,9 @@ daos_fail_value_get(void);
 /* failure for DAOS_RDB_MODULE */
 #define DAOS_RDB_SKIP_APPENDENTRIES_FAIL (DAOS_RDB_FAIL_MOD | 0x001)
 
+/* failure for the btree library */
+#define DAOS_BTR_BATCH_NO_BULK	(DAOS_BTR_FAIL_MOD | 0x001)
+
 #define DAOS_FAIL_CHECK(id) daos_fail_check(id)
 
 static inline int __is_po2(unsigned long long val)
@@ -0,0 +1,88 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Reed-Solomon erasure codec for DAOS object classes.
+ *
+ * The code works over GF(2^8) with the same generator polynomial and Cauchy
+ * encode matrix as ISA-L, so parity produced by the ISA-L kernels and by the
+ * portable fallback is interchangeable.
+ *
+ * src/include/daos/ec.h
+ */
+#ifndef __DAOS_EC_H__
+#define __DAOS_EC_H__
+
+#include <daos/common.h>
+
+/** Maximum number of cells (data + parity) of one stripe */
+#define DAOS_EC_CELLS_MAX	32
+
+/** Encoding/decoding context for a k + p erasure code */
+struct daos_ec_codec {
+	/** number of data cells per stripe */
+	unsigned int	 ec_k;
+	/** number of parity cells per stripe */
+	unsigned int	 ec_p;
+	/** (k + p) x k encode matrix, the first k rows are the identity */
+	unsigned char	*ec_matrix;
+	/** expanded GF multiply tables of the p parity rows */
+	unsigned char	*ec_gftbls;
+};
+
+/**
+ * Initialize a codec for \a k data cells and \a p parity cells.
+ */
+int daos_ec_codec_init(struct daos_ec_codec *codec, unsigned int k,
+		       unsigned int p);
+
+/** Release resources of a codec initialized by daos_ec_codec_init() */
+void daos_ec_codec_fini(struct daos_ec_codec *codec);
+
+/**
+ * Generate the p parity cells of a stripe.
+ *
+ * \param codec	[IN]	codec of the stripe
+ * \param len	[IN]	length of each cell in bytes
+ * \param data	[IN]	k data cells
+ * \param parity [OUT]	p parity cells
+ */
+void daos_ec_encode(struct daos_ec_codec *codec, unsigned int len,
+		    unsigned char **data, unsigned char **parity);
+
+/**
+ * Reconstruct lost cells of a stripe.
+ *
+ * \param codec	[IN]	codec of the stripe
+ * \param len	[IN]	length of each cell in bytes
+ * \param cells	[IN/OUT]
+ *			k + p cells, data cells first. Cells flagged in
+ *			\a lost are regenerated from the others.
+ * \param lost	[IN]	bitmap of the unavailable cells, bit i stands for
+ *			cells[i]. At most p bits can be set.
+ *
+ * \return		0 on success, -DER_INVAL if too many cells are lost.
+ */
+int daos_ec_decode(struct daos_ec_codec *codec, unsigned int len,
+		   unsigned char **cells, uint32_t lost);
+
+#endif /* __DAOS_EC_H__ */
@@ -107,6 +107,7 @@ int dc_obj_query(tse_task_t *task);
 int dc_obj_fetch(tse_task_t *task);
 int dc_obj_update(tse_task_t *task);
 int dc_obj_list_dkey(tse_task_t *task);
+int dc_obj_list_dkey_val(tse_task_t *task);
 int dc_obj_list_akey(tse_task_t *task);
 int dc_obj_list_rec(tse_task_t *task);
 int dc_obj_list_obj(tse_task_t *task);
@@ -89,6 +89,12 @@ dc_obj_list_dkey_task_create(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nr,
 			     daos_anchor_t *anchor, daos_event_t *ev,
 			     tse_sched_t *tse, tse_task_t **task);
 int
+dc_obj_list_dkey_val_task_create(daos_handle_t oh, daos_epoch_t epoch,
+				 uint32_t *nr, daos_key_desc_t *kds,
+				 daos_sg_list_t *sgl, daos_anchor_t *anchor,
+				 daos_event_t *ev, tse_sched_t *tse,
+				 tse_task_t **task);
+int
 dc_obj_list_akey_task_create(daos_handle_t oh, daos_epoch_t epoch,
 			     daos_key_t *dkey, uint32_t *nr,
 			     daos_key_desc_t *kds, daos_sg_list_t *sgl,
@@ -48,7 +48,7 @@ void  dts_freeline(char *line);
 /** Fill in readable random bytes into the buffer */
 void dts_buf_render(char *buf, unsigned int buf_len);
 
-/** generate a unique key */
+/** generate a key unique in the calling thread, see dts_reset_key */
 void dts_key_gen(char *key, unsigned int key_len, const char *prefix);
 
 /** generate a random and unique object ID */
@@ -86,6 +86,7 @@ dts_time_now(void)
 int dts_cmd_parser(struct option *opts, const char *prompt,
 		   int (*cmd_func)(char opc, char *args));
 
+/** restart the key sequence of dts_key_gen in the calling thread */
 void dts_reset_key(void);
 
 #endif /* __DAOS_TESTS_LIB_H__ */
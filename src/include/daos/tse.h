@@ -32,11 +32,11 @@
 #include <gurt/list.h>
 /**
  * tse_task is used to track single asynchronous operation.
- * 512 bytes all together.
+ * 576 bytes all together.
  */
-#define TSE_TASK_SIZE		512
+#define TSE_TASK_SIZE		576
 /* 8 bytes for public members */
-#define TSE_PRIV_SIZE		504
+#define TSE_PRIV_SIZE		568
 
 typedef struct tse_task {
 	int			dt_result;
@@ -210,6 +210,12 @@ typedef struct {
  * can force an error in this case by checking for object existence by reading
  * the metadata. But this adds extra overhead).
  *
+ * If \a oid has the DAOS_OF_DKEY_UINT64 feature, the chunks of the array are
+ * keyed by their number as an 8-byte integer instead of a decimal string, so
+ * they are stored in order and sequential accesses stay local. Both kinds of
+ * arrays can be used side by side, the format follows the object ID. Object
+ * IDs with DAOS_OF_AKEY_UINT64 are not supported.
+ *
  * \param[in]	coh	Container open handle.
  * \param[in]	oid	Object ID.
  * \param[in]	epoch	Epoch to open object.
@@ -1104,6 +1104,55 @@ daos_obj_list_dkey(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nr,
 		   daos_key_desc_t *kds, daos_sg_list_t *sgl,
 		   daos_anchor_t *anchor, daos_event_t *ev);
 
+/**
+ * Distribution key enumeration returning, with each dkey, the latest single
+ * values of its akeys visible at \a epoch, so that the content of many small
+ * dkeys can be read with one round trip.
+ *
+ * Each dkey is described by a descriptor of type DAOS_IOD_NONE, followed by
+ * one pair of descriptors per akey: the akey (DAOS_IOD_NONE) and its value
+ * (DAOS_IOD_SINGLE). Keys and values are written contiguously to \a sgl in
+ * the same order. Array akeys, punched values and values larger than 4KB are
+ * not returned. A dkey is always returned with all of its values.
+ *
+ * \param[in]	oh	Object open handle.
+ *
+ * \param[in]	epoch	Epoch for the enumeration.
+ *
+ * \param[in,out]
+ *		nr	[in]: number of key descriptors in \a kds. [out]: number
+ *			of returned descriptors (dkeys, akeys and values).
+ *
+ * \param[in,out]
+ *		kds	[in]: preallocated array of \nr key descriptors. [out]:
+ *			size and type of each dkey, akey and value in \a sgl.
+ *
+ * \param[in]	sgl	Scatter/gather list to store the dkeys and values.
+ *
+ * \param[in,out]
+ *		anchor	Hash anchor for the next call, it should be set to
+ *			zeroes for the first call, it should not be changed
+ *			by caller between calls.
+ *
+ * \param[in]	ev	Completion event, it is optional and can be NULL.
+ *			Function will run in blocking mode if \a ev is NULL.
+ *
+ * \return		These values will be returned by \a ev::ev_error in
+ *			non-blocking mode:
+ *			0		Success
+ *			-DER_NO_HDL	Invalid object open handle
+ *			-DER_INVAL	Invalid parameter
+ *			-DER_UNREACH	Network is unreachable
+ *			-DER_KEY2BIG	The first dkey and its values can't be
+ *					fit into \a kds and \a sgl, a lower
+ *					bound of the required length is
+ *					returned by \a kds[0].kd_key_len.
+ */
+int
+daos_obj_list_dkey_val(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nr,
+		       daos_key_desc_t *kds, daos_sg_list_t *sgl,
+		       daos_anchor_t *anchor, daos_event_t *ev);
+
 /**
  * Attribute key enumeration.
  *
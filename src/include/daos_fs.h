@@ -43,6 +43,20 @@ extern "C" {
 typedef struct dfs_obj dfs_obj_t;
 typedef struct dfs dfs_t;
 
+/** Statistics of the path lookup cache of a DFS mount */
+typedef struct {
+	/** lookups of a path component served from the cache */
+	uint64_t	dcs_hits;
+	/** lookups of a path component that fetched the entry */
+	uint64_t	dcs_misses;
+	/** entries dropped to make room for new ones */
+	uint64_t	dcs_evictions;
+	/** entries dropped because they were stale or changed */
+	uint64_t	dcs_invalidations;
+	/** entries currently cached */
+	uint32_t	dcs_entries;
+} dfs_cache_stats_t;
+
 /**
  * Mount a file system over DAOS. The pool and container handle must remain
  * connected/open until after dfs_umount() is called; otherwise access to the
@@ -94,6 +108,25 @@ int
 dfs_lookup(dfs_t *dfs, const char *path, int flags, dfs_obj_t **obj,
 	   mode_t *mode);
 
+/**
+ * Lookup an entry of an open directory and return the associated open object
+ * and mode. Unlike dfs_lookup(), only the entry itself is fetched, so callers
+ * which keep their directories open (e.g. by inode) avoid walking the path from
+ * the root. The object must be released with dfs_release().
+ *
+ * \param[in]	dfs	Pointer to the mounted file system.
+ * \param[in]	parent	Opened parent directory object. If NULL, use root obj.
+ * \param[in]	name	Link name of the object to lookup.
+ * \param[in]	flags	Access flags to open with (O_RDONLY or O_RDWR).
+ * \param[out]	obj	Pointer to the object looked up.
+ * \param[out]	mode	mode_t (permissions + type), optional.
+ *
+ * \return		0 on Success. Negative on Failure.
+ */
+int
+dfs_lookup_rel(dfs_t *dfs, dfs_obj_t *parent, const char *name, int flags,
+	       dfs_obj_t **obj, mode_t *mode);
+
 /**
  * Create/Open a directory, file, or Symlink.
  * The object must be released with dfs_release().
@@ -146,6 +179,15 @@ dfs_read(dfs_t *dfs, dfs_obj_t *obj, daos_sg_list_t sgl, daos_off_t off,
 /**
  * Write data to the file object.
  *
+ * If the DFS_WRITEBACK environment variable is set to a size in bytes (up to
+ * the 1MiB chunk size of files) when the file system is mounted, writes
+ * smaller than that are buffered per open file, and contiguous ones are
+ * written out together, in one epoch. The buffer is written out when a write
+ * does not continue it or fills it, and by dfs_read(), dfs_ostat(),
+ * dfs_get_size(), dfs_punch(), dfs_release() and dfs_sync(), any of which
+ * then reports a failure to write it out. dfs_stat() by name does not see the
+ * buffered data.
+ *
  * \param[in]	dfs	Pointer to the mounted file system.
  * \param[in]	obj	Opened file object.
  * \param[in]	sgl	Scatter/Gather list for data buffer.
@@ -218,6 +260,37 @@ int
 dfs_readdir(dfs_t *dfs, dfs_obj_t *obj, daos_anchor_t *anchor,
 	    uint32_t *nr, struct dirent *dirs);
 
+/**
+ * directory readdir returning the attributes of the entries along with their
+ * names. The attributes come from the directory in the same round trip as the
+ * names, so they are not looked up in the objects of the entries: st_size of
+ * files and directories is 0 and st_nlink of directories is 1. Use dfs_stat()
+ * for those.
+ *
+ * \param[in]	dfs	Pointer to the mounted file system.
+ * \param[in]	obj	Opened directory object.
+ * \param[in,out]
+ *		anchor	Hash anchor for the next call, it should be set to
+ *			zeroes for the first call, it should not be changed
+ *			by caller between calls.
+ * \param[in,out]
+ *		nr	[in]: number of dirents allocated in \a dirs and
+ *			\a stbufs.
+ *			[out]: number of returned dirents.
+ * \param[in,out]
+ *		dirs	[in] preallocated array of dirents.
+ *			[out]: dirents returned with d_name filled only.
+ * \param[in,out]
+ *		stbufs	[in] preallocated array of stat structs.
+ *			[out]: attributes of the entry of the same index in
+ *			\a dirs.
+ *
+ * \return		0 on Success. Negative on Failure.
+ */
+int
+dfs_readdirplus(dfs_t *dfs, dfs_obj_t *obj, daos_anchor_t *anchor,
+		uint32_t *nr, struct dirent *dirs, struct stat *stbufs);
+
 /**
  * Create a directory.
  *
@@ -287,6 +360,18 @@ dfs_exchange(dfs_t *dfs, dfs_obj_t *parent1, char *name1,
 int
 dfs_get_obj_type(dfs_obj_t *obj, mode_t *mode);
 
+/**
+ * Retrieve the DAOS object ID of an open object. Symbolic links have no object
+ * of their own and return a zero object ID.
+ *
+ * \param[in]	obj	Open object.
+ * \param[out]	oid	DAOS object ID.
+ *
+ * \return		0 on Success. Negative on Failure.
+ */
+int
+dfs_obj2id(dfs_obj_t *obj, daos_obj_id_t *oid);
+
 /**
  * Retrieve the DAOS open handle of a DFS file object. User should not close
  * this handle. This is used in cases like MPI-IO where 1 rank creates the file
@@ -377,6 +462,23 @@ dfs_sync(dfs_t *dfs);
 int
 dfs_get_epoch(dfs_t *dfs, daos_epoch_t *epoch);
 
+/**
+ * Retrieve the statistics of the path lookup cache of the mount.
+ *
+ * dfs_lookup() and dfs_lookup_rel() cache the entries they resolve, keyed by
+ * parent object and name, so that resolving a path again does not fetch every
+ * component of it. The cache holds up to DFS_DCACHE_SIZE entries (environment
+ * variable, 0 disables it), which stay valid until an update through this
+ * mount changes them or dfs_sync() moves the mount to a newer epoch.
+ *
+ * \param[in]	dfs	Pointer to the mounted file system.
+ * \param[out]	stats	Cache statistics.
+ *
+ * \return		0 on Success. Negative on Failure.
+ */
+int
+dfs_cache_stats(dfs_t *dfs, dfs_cache_stats_t *stats);
+
 /**
  * Set extended attribute on an open object (File, dir, syml).
  *
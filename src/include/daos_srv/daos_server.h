@@ -49,6 +49,12 @@ extern hwloc_topology_t	dss_topo;
 /** Storage path (hack) */
 extern const char      *dss_storage_path;
 
+/**
+ * Upper bound (in usec) of blocking of idle xstreams, zero means xstreams
+ * always busy poll.
+ */
+extern unsigned int	dss_idle_max_us;
+
 /**
  * Stackable Module API
  * Provides a modular interface to load and register server-side code on
@@ -296,6 +302,8 @@ dss_thread_collective_reduce(struct dss_coll_ops *ops,
 
 int dss_task_collective(int (*func)(void *), void *arg);
 int dss_thread_collective(int (*func)(void *), void *arg);
+int dss_task_collective_pool(int (*func)(void *), void *arg, int pool);
+int dss_thread_collective_pool(int (*func)(void *), void *arg, int pool);
 
 int dss_task_run(tse_task_t *task, unsigned int type, tse_task_cb_t cb,
 		 void *arg);
@@ -317,6 +325,24 @@ int dss_group_create(crt_group_id_t id, d_rank_list_t *ranks,
 		     crt_group_t **group);
 int dss_group_destroy(crt_group_t *group);
 void dss_sleep(int ms);
+
+/** Busy/idle accounting of the progress loop of an xstream */
+struct dss_xstream_stats {
+	/** time (nsec) spent in loops which found some work */
+	uint64_t	xs_busy_ns;
+	/** time (nsec) spent in loops which found nothing to do */
+	uint64_t	xs_idle_ns;
+	/** time (nsec) spent in sleeping or blocking while idle */
+	uint64_t	xs_sleep_ns;
+	/** number of loops */
+	uint64_t	xs_loops;
+	/** number of sleeps */
+	uint64_t	xs_sleeps;
+	/** number of blocking network progress */
+	uint64_t	xs_blocks;
+};
+
+int dss_xstream_stats_get(int xs_id, struct dss_xstream_stats *stats);
 int dss_rpc_reply(crt_rpc_t *rpc, unsigned int fail_loc);
 
 enum {
@@ -359,20 +385,57 @@ struct dss_acc_task {
  */
 int dss_acc_offload(struct dss_acc_task *at_args);
 
-/** Different type of ES pools, there are 3 pools for now
+/** Different type of ES pools, each of them is a scheduling class
  *
- *  DSS_POOL_PRIV     Private pool: I/O requests will be added to this pool.
- *  DSS_POOL_SHARE    Shared pool: Other requests and ULT created during
- *                    processing rpc.
- *  DSS_POOL_REBUILD  Private pool: pools specially for rebuild tasks.
+ *  DSS_POOL_PRIV       Private pool: foreground I/O requests will be added
+ *                      to this pool.
+ *  DSS_POOL_SHARE      Shared pool: metadata and other requests, and ULT
+ *                      created during processing rpc.
+ *  DSS_POOL_REBUILD    Shared pool: pools specially for rebuild tasks.
+ *  DSS_POOL_AGGREGATE  Shared pool: epoch aggregation.
+ *  DSS_POOL_GC         Shared pool: background garbage collection, e.g.
+ *                      epoch discard.
+ *
+ * The scheduler of each xstream runs the ULTs of the pools by weighted fair
+ * share, a pool with pending ULTs gets its weight divided by the sum of the
+ * weights of all pools with pending ULTs of the scheduling rounds, see
+ * DSS_SCHED_WEIGHT_*. The rebuild pool instead gets the percentage set by
+ * DSS_REBUILD_RES_PERCENTAGE of the rounds whenever it has pending ULTs.
  */
 enum {
 	DSS_POOL_PRIV,
 	DSS_POOL_SHARE,
 	DSS_POOL_REBUILD,
+	DSS_POOL_AGGREGATE,
+	DSS_POOL_GC,
 	DSS_POOL_CNT,
 };
 
+/** max scheduling weight of an ES pool */
+#define DSS_SCHED_WEIGHT_MAX	1000
+/** number of buckets of the wait time histogram */
+#define DSS_SCHED_WAIT_BUCKETS	16
+
+/** Scheduling statistics of an ES pool of an xstream */
+struct dss_sched_stats {
+	/** current number of runnable ULTs */
+	uint64_t	ss_depth;
+	/** max number of runnable ULTs seen by the scheduler */
+	uint64_t	ss_depth_max;
+	/** number of scheduled ULTs */
+	uint64_t	ss_runs;
+	/** total time (nsec) the scheduled ULTs waited at the pool head */
+	uint64_t	ss_wait_ns;
+	/**
+	 * Histogram of the wait time, bucket 0 counts waits shorter than
+	 * 1 usec, bucket N counts waits of [2^(N-1), 2^N) usec, the last
+	 * bucket also counts all longer waits.
+	 */
+	uint64_t	ss_wait_hist[DSS_SCHED_WAIT_BUCKETS];
+};
+
+int dss_sched_stats_get(int xs_id, int pool, struct dss_sched_stats *stats);
+
 /* DAOS object API on the server side */
 int ds_obj_open(daos_handle_t coh, daos_obj_id_t oid,
 		daos_epoch_t epoch, unsigned int mode,
@@ -407,6 +470,7 @@ struct dss_enum_arg {
 	vos_iter_param_t	param;
 	bool			recursive;	/* enumerate lower levels */
 	bool			fill_recxs;	/* type == S||R */
+	bool			latest_vals;	/* type == DKEY && !recursive */
 	daos_anchor_t		obj_anchor;	/* type == OBJ (<= if recur) */
 	daos_anchor_t		dkey_anchor;	/* type == DKEY (<= if recur) */
 	daos_anchor_t		akey_anchor;	/* type == AKEY (<= if recur) */
@@ -190,10 +190,21 @@ void eio_xsctxt_free(struct eio_xs_context *ctxt);
  *
  * \param[IN] ctxt	Per-xstream NVMe context
  *
- * \return		Executed message count
+ * \return		Executed message count plus reaped NVMe I/O
+ *			completion count
  */
 size_t eio_nvme_poll(struct eio_xs_context *ctxt);
 
+/**
+ * Check if there is any NVMe I/O in flight on the xstream, the completions
+ * can only be reaped by eio_nvme_poll().
+ *
+ * \param[IN] ctxt	Per-xstream NVMe context
+ *
+ * \return		true if any I/O is in flight
+ */
+bool eio_nvme_inflight(struct eio_xs_context *ctxt);
+
 /*
  * Create per VOS instance blob.
  *
@@ -239,6 +250,18 @@ int eio_ioctxt_open(struct eio_io_context **pctxt,
  */
 int eio_ioctxt_close(struct eio_io_context *ctxt);
 
+/*
+ * Evict an NVMe extent from the per-xstream DRAM page cache, it should be
+ * called when the extent is freed.
+ *
+ * \param[IN] ctxt	I/O context
+ * \param[IN] off	Offset within the SPDK blob in bytes
+ * \param[IN] len	Length in bytes
+ *
+ * \returns		N/A
+ */
+void eio_cache_evict(struct eio_io_context *ctxt, uint64_t off, uint64_t len);
+
 /**
  * Allocate & initialize an io descriptor
  *
@@ -299,6 +322,23 @@ int eio_iod_post(struct eio_desc *eiod);
  */
 int eio_iod_copy(struct eio_desc *eiod, d_sg_list_t *sgls, unsigned int nr_sgl);
 
+/*
+ * Get the DMA buffer chunk holding the data of an NVMe IOV of a prepared io
+ * descriptor. DMA chunks are only freed along with the per-xstream NVMe
+ * context, so the caller can register a chunk for RDMA once and reuse the
+ * registration for all the following I/Os.
+ *
+ * \param eiod       [IN]	io descriptor
+ * \param eiov       [IN]	NVMe IOV of the io descriptor
+ * \param chk_ptr    [OUT]	Base address of the DMA chunk
+ * \param chk_sz     [OUT]	Size of the DMA chunk in bytes
+ *
+ * \return			Zero on success, -DER_INVAL if the IOV isn't
+ *				in the DMA buffer
+ */
+int eio_iov2dma_chunk(struct eio_desc *eiod, struct eio_iov *eiov,
+		      void **chk_ptr, size_t *chk_sz);
+
 /*
  * Helper function to get the specified SG list of an io descriptor
  *
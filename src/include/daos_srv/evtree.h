@@ -125,8 +125,11 @@ struct evt_node {
 	uint16_t			tn_flags;
 	/** number of children or leaf records */
 	uint16_t			tn_nr;
-	/** padding for alignment */
-	uint32_t			tn_pad_32;
+	/**
+	 * generation of the node, it is bumped by every change of the node,
+	 * see \a evt_cache_enable.
+	 */
+	uint32_t			tn_gen;
 	/**
 	 * leaf node:
 	 * ptr[0], ptr[1], ..., ptr[order - 1], rect[0], rect[1], ...
@@ -368,6 +371,40 @@ int evt_get_max(daos_handle_t toh, daos_epoch_t epoch, daos_off_t *max_off);
  */
 int evt_debug(daos_handle_t toh, int debug_level);
 
+/** hit/miss counters of the per-xstream node cache */
+struct evt_cache_stats {
+	/** lookups served by the cache */
+	uint64_t			cs_hit;
+	/** lookups which (re)loaded the node from the tree */
+	uint64_t			cs_miss;
+	/** entries dropped because the node has been freed */
+	uint64_t			cs_evict;
+};
+
+/**
+ * Enable or disable the DRAM cache of non-leaf tree nodes for the calling
+ * xstream. The cache keeps the decoded rectangles and children of hot upper
+ * level nodes, it is keyed by node mmid and generation (\a tn_gen), so any
+ * change of a node made by a transaction invalidates the cached copy once
+ * the change is visible. Only \a evt_find consults the cache.
+ *
+ * Disabling the cache releases all its memory.
+ *
+ * \param enable	[IN]	Enable or disable the cache.
+ *
+ * \return		0	Success
+ *			-ve	error code
+ */
+int evt_cache_enable(bool enable);
+
+/**
+ * Return the hit/miss counters of the node cache of the calling xstream.
+ *
+ * \param stats	[OUT]	Returned counters.
+ * \param reset	[IN]	Reset the counters after reading them.
+ */
+void evt_cache_stats_get(struct evt_cache_stats *stats, bool reset);
+
 enum {
 	/**
 	 * Use the embedded iterator of the open handle.
@@ -121,6 +121,17 @@ struct vea_space_df {
 	struct btr_root	vsd_free_tree;
 	/* Allocated extent vector tree, for non-contiguous allocation */
 	struct btr_root	vsd_vec_tree;
+	/*
+	 * Snapshot of the free extent tree (array of vea_free_extent sorted
+	 * by offset) written by vea_unload(), it's used and discarded by the
+	 * next vea_load() to avoid scanning the free extent tree. Only valid
+	 * since layout version 2, see VEA_MAGIC.
+	 */
+	umem_id_t	vsd_snap;
+	/* Total free extents in the snapshot */
+	uint64_t	vsd_snap_cnt;
+	/* Checksum of the snapshot */
+	uint64_t	vsd_snap_csum;
 };
 
 struct vea_space_info;
@@ -170,7 +181,8 @@ int vea_load(struct umem_instance *umem, struct umem_tx_stage_data *txd,
 	     struct vea_space_info **vsip);
 
 /**
- * Free the memory footprint created by vea_load().
+ * Free the memory footprint created by vea_load(). The free extents are
+ * saved in a snapshot on SCM for speeding up the next vea_load().
  *
  * \param vsi	[IN]	In-memory compound free extent index
  *
@@ -458,6 +458,15 @@ typedef enum {
 	DAOS_RES_REPL,		/**< Replication */
 } daos_obj_resil_t;
 
+typedef enum {
+	/** client sends the update to every replica */
+	DAOS_REPL_CLIENT,
+	/** client sends to a leader replica which fans out to the others */
+	DAOS_REPL_FWD_FANOUT,
+	/** client sends to a leader replica, each replica forwards to the next */
+	DAOS_REPL_FWD_CHAIN,
+} daos_repl_method_t;
+
 #define DAOS_OBJ_GRP_MAX	(~0)
 #define DAOS_OBJ_REPL_MAX	(~0)
 
@@ -485,6 +494,13 @@ enum {
 				 * These 3 XX_SPEC are mostly for testing
 				 * purpose.
 				 */
+	DAOS_OC_EC_K2P1_RW,	/* Erasure code, 2 data + 1 parity cells */
+	DAOS_OC_EC_K4P1_RW,	/* Erasure code, 4 data + 1 parity cells */
+	DAOS_OC_EC_K4P2_RW,	/* Erasure code, 4 data + 2 parity cells */
+	DAOS_OC_EC_K8P2_RW,	/* Erasure code, 8 data + 2 parity cells */
+	DAOS_OC_R2_FWD_RW,	/* 2 replicas, forwarded by the leader replica */
+	DAOS_OC_R3_FWD_RW,	/* 3 replicas, forwarded by the leader replica */
+	DAOS_OC_R3_CHAIN_RW,	/* 3 replicas, forwarded along a chain */
 };
 
 /** bits for the specified rank */
@@ -511,7 +527,7 @@ typedef struct daos_oclass_attr {
 	union {
 		/** Replication attributes */
 		struct daos_repl_attr {
-			/** Method of replicating */
+			/** Method of replicating, see daos_repl_method_t */
 			unsigned int	 r_method;
 			/** Number of replicas */
 			unsigned int	 r_num;
@@ -522,12 +538,14 @@ typedef struct daos_oclass_attr {
 		struct daos_ec_attr {
 			/** Type of EC */
 			unsigned int	 e_type;
-			/** EC group size */
+			/** EC group size, it is e_k + e_p */
 			unsigned int	 e_grp_size;
-			/**
-			 * TODO: add members to describe erasure coding
-			 * attributes
-			 */
+			/** number of data cells of a stripe */
+			unsigned int	 e_k;
+			/** number of parity cells of a stripe */
+			unsigned int	 e_p;
+			/** size of a cell in bytes */
+			unsigned int	 e_len;
 		} ec;
 	} u;
 	/** TODO: add more attributes */
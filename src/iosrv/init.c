@@ -310,7 +310,7 @@ usage(char *prog, FILE *out)
 	fprintf(out, "\
 Usage:\n\
   %s -h\n\
-  %s [-m modules] [-c ncores] [-g group] [-s path]\n\
+  %s [-m modules] [-c ncores] [-g group] [-s path] [-i usec]\n\
 Options:\n\
   --modules=modules, -m modules\n\
       List of server modules to load (default \"%s\")\n\
@@ -322,6 +322,8 @@ Options:\n\
       Storage path (default \"%s\")\n\
   --attach_info=path, -apath\n\
       Attach info patch (to support non-PMIx client, default \"/tmp\")\n\
+  --idle=usec, -i usec\n\
+      Block idle xstreams for at most usec (default 0, always poll)\n\
   --help, -h\n\
       Print this description\n",
 		prog, prog, modules, server_group_id, dss_storage_path);
@@ -336,6 +338,7 @@ parse(int argc, char **argv)
 		{ "group",		required_argument,	NULL,	'g' },
 		{ "storage",		required_argument,	NULL,	's' },
 		{ "attach_info",	optional_argument,	NULL,	'a' },
+		{ "idle",		required_argument,	NULL,	'i' },
 		{ "help",		no_argument,		NULL,	'h' },
 		{ NULL,			0,			NULL,	0}
 	};
@@ -344,7 +347,7 @@ parse(int argc, char **argv)
 
 	/* load all of modules by default */
 	sprintf(modules, "%s", MODULE_LIST);
-	while ((c = getopt_long(argc, argv, "c:m:g:s:a::h", opts, NULL)) !=
+	while ((c = getopt_long(argc, argv, "c:m:g:s:a::i:h", opts, NULL)) !=
 		-1) {
 		switch (c) {
 		case 'm':
@@ -380,6 +383,18 @@ parse(int argc, char **argv)
 			save_attach_info = true;
 			attach_info_path = optarg;
 			break;
+		case 'i': {
+			unsigned long	 us;
+			char		*end;
+
+			us = strtoul(optarg, &end, 10);
+			if (end == optarg || us > UINT_MAX) {
+				rc = -DER_INVAL;
+				break;
+			}
+			dss_idle_max_us = us;
+			break;
+		}
 		default:
 			usage(argv[0], stderr);
 			rc = -DER_INVAL;
@@ -42,7 +42,29 @@
 
 /** Number of started xstreams or cores used */
 unsigned int	dss_nxstreams;
-unsigned int	dss_rebuild_res_percentage = REBUILD_DEFAULT_SCHEDULE_RATIO;
+/**
+ * Scheduling weights of the ES pools, zero weight stops scheduling of the
+ * pool. The rebuild entry is not a weight but the percentage of the
+ * scheduling rounds given to rebuild whenever it is busy, its weight is
+ * derived from the weights of the other busy pools in each round.
+ */
+unsigned int	dss_sched_weights[DSS_POOL_CNT] = {
+	[DSS_POOL_PRIV]		= 40,
+	[DSS_POOL_SHARE]	= 20,
+	[DSS_POOL_REBUILD]	= REBUILD_DEFAULT_SCHEDULE_RATIO,
+	[DSS_POOL_AGGREGATE]	= 5,
+	[DSS_POOL_GC]		= 5,
+};
+/**
+ * Upper bound (in usec) of blocking of an idle xstream, zero means the
+ * progress ULT always busy polls.
+ */
+unsigned int	dss_idle_max_us;
+
+/** keep polling for this long (usec) after the last work */
+#define DSS_IDLE_SPIN_US	50
+/** longest sleep (usec) before blocking in crt_progress() */
+#define DSS_IDLE_SLEEP_MAX_US	64
 
 /** Per-xstream configuration data */
 struct dss_xstream {
@@ -54,6 +76,14 @@ struct dss_xstream {
 	ABT_sched	dx_sched;
 	ABT_thread	dx_progress;
 	unsigned int	dx_idx;
+	/** busy/idle accounting of the progress loop */
+	struct dss_xstream_stats dx_stats;
+	/** start time of the current loop */
+	uint64_t	dx_loop_start;
+	/** start time of the current idle period, zero if busy */
+	uint64_t	dx_idle_start;
+	/** current sleep interval (usec) of the idle back off */
+	unsigned int	dx_sleep_us;
 };
 
 struct dss_xstream_data {
@@ -72,8 +102,22 @@ struct dss_xstream_data {
 
 static struct dss_xstream_data	xstream_data;
 
+static inline uint64_t
+dss_get_ntime(void)
+{
+	struct timespec	tv;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+	return tv.tv_sec * 1000000000ULL + tv.tv_nsec;
+}
+
 struct sched_data {
-    uint32_t event_freq;
+	uint32_t		event_freq;
+	/** credits of the weighted round robin */
+	int64_t			sd_credits[DSS_POOL_CNT];
+	/** since when the head ULT of each pool waits, zero if empty */
+	uint64_t		sd_ready[DSS_POOL_CNT];
+	struct dss_sched_stats	sd_stats[DSS_POOL_CNT];
 };
 
 static int
@@ -96,66 +140,104 @@ dss_sched_init(ABT_sched sched, ABT_sched_config config)
 	return ret;
 }
 
-static ABT_unit
-normal_unit_pop(ABT_pool *pools, ABT_pool *pool)
+static void
+dss_sched_wait_account(struct dss_sched_stats *stats, uint64_t wait)
 {
-	ABT_unit unit;
+	uint64_t	usec = wait / 1000;
+	int		bucket;
 
-	/* Let's pop I/O request ULT first */
-	ABT_pool_pop(pools[DSS_POOL_PRIV], &unit);
-	if (unit != ABT_UNIT_NULL) {
-		*pool = pools[DSS_POOL_PRIV];
-		return unit;
-	}
-
-	/* Other request and ollective ULT or created ULT */
-	ABT_pool_pop(pools[DSS_POOL_SHARE], &unit);
-	if (unit != ABT_UNIT_NULL) {
-		*pool = pools[DSS_POOL_SHARE];
-		return unit;
-	}
+	bucket = usec == 0 ? 0 : 64 - __builtin_clzll(usec);
+	if (bucket >= DSS_SCHED_WAIT_BUCKETS)
+		bucket = DSS_SCHED_WAIT_BUCKETS - 1;
 
-	return ABT_UNIT_NULL;
+	stats->ss_wait_hist[bucket]++;
+	stats->ss_wait_ns += wait;
+	stats->ss_runs++;
 }
 
+/**
+ * Choose ULT from the pools by smooth weighted round robin: every pool with
+ * runnable ULTs earns its weight of credits in each round, the pool with
+ * most credits is chosen and pays the weights of all the candidates. So
+ * each busy pool gets its share of the rounds, evenly interleaved and
+ * without randomness, and an idle pool neither gets nor saves any share.
+ *
+ * The rebuild pool is given its percentage of the rounds whenever it is
+ * busy: its weight is scaled so that it is that percentage of the total
+ * weight of all busy pools, weights are multiplied by 100 to keep the
+ * precision of the scaled one.
+ */
 static ABT_unit
-rebuild_unit_pop(ABT_pool *pools, ABT_pool *pool)
+dss_sched_unit_pop(struct sched_data *data, ABT_pool *pools, ABT_pool *pool)
 {
-	ABT_unit unit;
+	struct dss_sched_stats	*stats;
+	ABT_unit		 unit;
+	uint64_t		 now = 0;
+	int64_t			 weights[DSS_POOL_CNT];
+	int64_t			 total = 0;
+	unsigned int		 pct;
+	size_t			 size;
+	int			 best = -1;
+	int			 rc;
+	int			 i;
 
-	ABT_pool_pop(pools[DSS_POOL_REBUILD], &unit);
-	if (unit != ABT_UNIT_NULL) {
-		*pool = pools[DSS_POOL_REBUILD];
-		return unit;
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		weights[i] = 0;
+		rc = ABT_pool_get_size(pools[i], &size);
+		if (rc != ABT_SUCCESS || size == 0) {
+			data->sd_credits[i] = 0;
+			data->sd_ready[i] = 0;
+			continue;
+		}
+
+		stats = &data->sd_stats[i];
+		if (size > stats->ss_depth_max)
+			stats->ss_depth_max = size;
+		if (data->sd_ready[i] == 0) {
+			if (now == 0)
+				now = dss_get_ntime();
+			data->sd_ready[i] = now;
+		}
+
+		if (i != DSS_POOL_REBUILD) {
+			weights[i] = dss_sched_weights[i] * 100;
+			total += weights[i];
+		}
 	}
 
-	return ABT_UNIT_NULL;
-}
+	pct = dss_sched_weights[DSS_POOL_REBUILD];
+	if (data->sd_ready[DSS_POOL_REBUILD] != 0 && pct != 0) {
+		/* the only busy pool gets all rounds anyway */
+		weights[DSS_POOL_REBUILD] = total == 0 ? 100 :
+					    total * pct / (100 - pct);
+		total += weights[DSS_POOL_REBUILD];
+	}
 
-/**
- * Choose ULT from the pool. Note: the rebuild ULT will be
- * be choosen by dss_rebuild_res_percentage.
- *
- * XXX we may change the sequence later once we have more cases.
- */
-static ABT_unit
-dss_sched_unit_pop(ABT_pool *pools, ABT_pool *pool)
-{
-	size_t	 rebuild_cnt;
-	int	 rc;
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		if (weights[i] == 0)
+			continue;
 
-	rc = ABT_pool_get_total_size(pools[DSS_POOL_REBUILD],
-				     &rebuild_cnt);
-	if (rc != ABT_SUCCESS)
+		data->sd_credits[i] += weights[i];
+		if (best < 0 || data->sd_credits[i] > data->sd_credits[best])
+			best = i;
+	}
+
+	if (best < 0)
 		return ABT_UNIT_NULL;
 
-	if (rebuild_cnt == 0 ||
-	    rand() % 100 >= dss_rebuild_res_percentage)
-		return normal_unit_pop(pools, pool);
-	else
-		return rebuild_unit_pop(pools, pool);
+	data->sd_credits[best] -= total;
+	ABT_pool_pop(pools[best], &unit);
+	if (unit == ABT_UNIT_NULL)
+		return ABT_UNIT_NULL;
 
-	return ABT_UNIT_NULL;
+	/* the next ULT starts waiting at the head of the pool from now */
+	now = dss_get_ntime();
+	dss_sched_wait_account(&data->sd_stats[best],
+			       now - data->sd_ready[best]);
+	data->sd_ready[best] = now;
+
+	*pool = pools[best];
+	return unit;
 }
 
 static void
@@ -178,7 +260,7 @@ dss_sched_run(ABT_sched sched)
 
 	while (1) {
 		/* Execute one work unit from the scheduler's pool */
-		unit = dss_sched_unit_pop(pools, &pool);
+		unit = dss_sched_unit_pop(p_data, pools, &pool);
 		if (unit != ABT_UNIT_NULL && pool != ABT_UNIT_NULL)
 			ABT_xstream_run_unit(unit, pool);
 
@@ -278,6 +360,178 @@ dss_process_rpc(crt_context_t *ctx, crt_rpc_t *rpc,
 	return rc;
 }
 
+/** Check if there is any runnable ULT on the xstream */
+static bool
+dss_xstream_runnable(struct dss_xstream *dx)
+{
+	size_t	size;
+	int	i;
+
+	for (i = 0; i < DSS_POOL_CNT; i++) {
+		ABT_pool_get_size(dx->dx_pools[i], &size);
+		if (size != 0)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Wakeup condition of an xstream blocking in crt_progress(), CaRT checks it
+ * between network polls. A ULT becomes runnable when it is created or woken
+ * up by any xstream (pushed into the pool of this xstream), or by a network
+ * event, so checking the pools covers all of them. The shutdown request
+ * also ends the blocking.
+ */
+static int
+dss_xstream_wakeup_cb(void *arg)
+{
+	struct dss_xstream	*dx = arg;
+	ABT_bool		 state;
+
+	if (dss_xstream_runnable(dx))
+		return 1;
+
+	ABT_future_test(dx->dx_shutdown, &state);
+	return state == ABT_TRUE;
+}
+
+/**
+ * Account the last loop of the progress ULT and back off if the xstream has
+ * nothing to do. An idle xstream keeps polling for DSS_IDLE_SPIN_US, then
+ * sleeps for exponentially growing intervals up to DSS_IDLE_SLEEP_MAX_US,
+ * and finally blocks in crt_progress() for up to dss_idle_max_us. Any work
+ * found by the loop switches it back to pure polling.
+ *
+ * NVMe completions can only be reaped by polling, so the xstream keeps
+ * polling while any NVMe I/O is in flight. ULTs blocked on anything else
+ * don't prevent blocking, dss_xstream_wakeup_cb() ends the blocking once
+ * any of them becomes runnable.
+ *
+ * \param[in] dx	the xstream
+ * \param[in] busy	the last loop found some work
+ * \param[in] inflight	NVMe I/O is in flight
+ *
+ * \return		timeout (usec) for blocking in crt_progress(), zero
+ *			if the xstream should keep polling.
+ */
+static int64_t
+dss_xstream_backoff(struct dss_xstream *dx, bool busy, bool inflight)
+{
+	struct dss_xstream_stats *stats = &dx->dx_stats;
+	uint64_t		  now;
+
+	busy |= dss_xstream_runnable(dx);
+
+	now = dss_get_ntime();
+	stats->xs_loops++;
+	if (busy)
+		stats->xs_busy_ns += now - dx->dx_loop_start;
+	else
+		stats->xs_idle_ns += now - dx->dx_loop_start;
+	dx->dx_loop_start = now;
+
+	if (busy || inflight) {
+		dx->dx_idle_start = 0;
+		dx->dx_sleep_us = 0;
+		return 0;
+	}
+
+	if (dss_idle_max_us == 0)
+		return 0;
+
+	if (dx->dx_idle_start == 0)
+		dx->dx_idle_start = now;
+
+	if (now - dx->dx_idle_start < DSS_IDLE_SPIN_US * 1000)
+		return 0;
+
+	if (dx->dx_sleep_us < DSS_IDLE_SLEEP_MAX_US) {
+		dx->dx_sleep_us = dx->dx_sleep_us == 0 ? 1 :
+				  min(dx->dx_sleep_us * 2,
+				      DSS_IDLE_SLEEP_MAX_US);
+		usleep(dx->dx_sleep_us);
+
+		dx->dx_loop_start = dss_get_ntime();
+		stats->xs_sleeps++;
+		stats->xs_sleep_ns += dx->dx_loop_start - now;
+		return 0;
+	}
+
+	stats->xs_blocks++;
+	return dss_idle_max_us;
+}
+
+/**
+ * Get busy/idle accounting of the progress loop of an xstream.
+ *
+ * \param[in] xs_id	xstream index
+ * \param[out] stats	returned counters
+ *
+ * \return		0 on success, -DER_NONEXIST if no such xstream
+ */
+int
+dss_xstream_stats_get(int xs_id, struct dss_xstream_stats *stats)
+{
+	struct dss_xstream	*dx;
+	int			 rc = -DER_NONEXIST;
+
+	ABT_mutex_lock(xstream_data.xd_mutex);
+	d_list_for_each_entry(dx, &xstream_data.xd_list, dx_list) {
+		if (dx->dx_idx == xs_id) {
+			/* NB: no lock for the counters, it is only for
+			 * statistics.
+			 */
+			*stats = dx->dx_stats;
+			rc = 0;
+			break;
+		}
+	}
+	ABT_mutex_unlock(xstream_data.xd_mutex);
+	return rc;
+}
+
+/**
+ * Get the scheduling statistics of an ES pool of an xstream.
+ *
+ * \param[in] xs_id	xstream index
+ * \param[in] pool	ES pool, DSS_POOL_*
+ * \param[out] stats	returned statistics
+ *
+ * \return		0 on success, negative errno if the xstream or the
+ *			pool does not exist.
+ */
+int
+dss_sched_stats_get(int xs_id, int pool, struct dss_sched_stats *stats)
+{
+	struct dss_xstream	*dx;
+	struct sched_data	*data;
+	size_t			 size = 0;
+	int			 rc = -DER_NONEXIST;
+
+	if (pool < 0 || pool >= DSS_POOL_CNT)
+		return -DER_INVAL;
+
+	ABT_mutex_lock(xstream_data.xd_mutex);
+	d_list_for_each_entry(dx, &xstream_data.xd_list, dx_list) {
+		if (dx->dx_idx != xs_id)
+			continue;
+
+		rc = ABT_sched_get_data(dx->dx_sched, (void **)&data);
+		if (rc != ABT_SUCCESS) {
+			rc = dss_abterr2der(rc);
+			break;
+		}
+		/* NB: no lock for the counters, it is only for statistics. */
+		*stats = data->sd_stats[pool];
+		ABT_pool_get_size(dx->dx_pools[pool], &size);
+		stats->ss_depth = size;
+		rc = 0;
+		break;
+	}
+	ABT_mutex_unlock(xstream_data.xd_mutex);
+	return rc;
+}
+
 /**
  *
  * The handling process would like
@@ -366,11 +620,16 @@ dss_srv_handler(void *arg)
 	ABT_mutex_unlock(xstream_data.xd_mutex);
 
 	signal_caller = false;
+	dx->dx_loop_start = dss_get_ntime();
 	/* main service progress loop */
 	for (;;) {
 		ABT_bool state;
+		uint64_t now;
+		int64_t	 timeout;
+		bool	 busy;
 
 		rc = crt_progress(dmi->dmi_ctx, 0 /* no wait */, NULL, NULL);
+		busy = (rc == 0);
 		if (rc != 0 && rc != -DER_TIMEDOUT) {
 			D_ERROR("failed to progress network context: %d\n",
 				rc);
@@ -378,16 +637,41 @@ dss_srv_handler(void *arg)
 			 * Let's still keep for progressing for now.
 			 */
 		}
-		eio_nvme_poll(dmi->dmi_nvme_ctxt);
+		if (eio_nvme_poll(dmi->dmi_nvme_ctxt) != 0)
+			busy = true;
 
 		rc = ABT_future_test(dx->dx_shutdown, &state);
 		D_ASSERTF(rc == ABT_SUCCESS, "%d\n", rc);
 		if (state == ABT_TRUE)
 			break;
 
+		timeout = dss_xstream_backoff(dx, busy,
+				eio_nvme_inflight(dmi->dmi_nvme_ctxt));
+		if (timeout != 0) {
+			/* Idle for a while, block until any ULT becomes
+			 * runnable or the timeout.
+			 */
+			rc = crt_progress(dmi->dmi_ctx, timeout,
+					  dss_xstream_wakeup_cb, dx);
+			if (rc != 0 && rc != -DER_TIMEDOUT)
+				D_ERROR("failed to progress network context: "
+					"%d\n", rc);
+
+			now = dss_get_ntime();
+			dx->dx_stats.xs_sleep_ns += now - dx->dx_loop_start;
+			dx->dx_loop_start = now;
+		}
+
 		ABT_thread_yield();
 	}
 
+	D_DEBUG(DB_TRACE, "xstream %d: busy "DF_U64" ms, idle "DF_U64" ms, "
+		"sleep "DF_U64" ms, loops "DF_U64", sleeps "DF_U64", blocks "
+		DF_U64"\n", dx->dx_idx, dx->dx_stats.xs_busy_ns / 1000000,
+		dx->dx_stats.xs_idle_ns / 1000000,
+		dx->dx_stats.xs_sleep_ns / 1000000, dx->dx_stats.xs_loops,
+		dx->dx_stats.xs_sleeps, dx->dx_stats.xs_blocks);
+
 	/* Let's wait until all of queue ULTs has been executed, in case dmi_ctx
 	 * might be used by some other ULTs.
 	 */
@@ -502,8 +786,8 @@ dss_start_one_xstream(hwloc_cpuset_t cpus, int idx)
 	for (i = 0; i < DSS_POOL_CNT; i++) {
 		ABT_pool_access access;
 
-		access = (i == DSS_POOL_SHARE || i == DSS_POOL_REBUILD) ?
-			 ABT_POOL_ACCESS_MPSC : ABT_POOL_ACCESS_PRIV;
+		access = (i == DSS_POOL_PRIV) ?
+			 ABT_POOL_ACCESS_PRIV : ABT_POOL_ACCESS_MPSC;
 
 		rc = ABT_pool_create_basic(ABT_POOL_FIFO, access, ABT_TRUE,
 					   &dx->dx_pools[i]);
@@ -967,7 +1251,8 @@ collective_reduce(void **arg)
 
 static int
 dss_collective_reduce_internal(struct dss_coll_ops *ops,
-			       struct dss_coll_args *args, bool create_ult)
+			       struct dss_coll_args *args, bool create_ult,
+			       int pool)
 {
 	struct collective_arg		carg;
 	struct dss_coll_stream_args	*stream_args;
@@ -1037,11 +1322,11 @@ dss_collective_reduce_internal(struct dss_coll_ops *ops,
 		stream->st_coll_args	= &carg;
 
 		if (create_ult)
-			rc = ABT_thread_create(dx->dx_pools[DSS_POOL_SHARE],
+			rc = ABT_thread_create(dx->dx_pools[pool],
 					       collective_func, stream,
 					       ABT_THREAD_ATTR_NULL, NULL);
 		else
-			rc = ABT_task_create(dx->dx_pools[DSS_POOL_SHARE],
+			rc = ABT_task_create(dx->dx_pools[pool],
 					     collective_func, stream, NULL);
 
 		if (rc != ABT_SUCCESS) {
@@ -1087,7 +1372,8 @@ int
 dss_task_collective_reduce(struct dss_coll_ops *ops,
 			   struct dss_coll_args *args)
 {
-	return dss_collective_reduce_internal(ops, args, false);
+	return dss_collective_reduce_internal(ops, args, false,
+					      DSS_POOL_SHARE);
 }
 
 /**
@@ -1108,11 +1394,13 @@ int
 dss_thread_collective_reduce(struct dss_coll_ops *ops,
 			     struct dss_coll_args *args)
 {
-	return dss_collective_reduce_internal(ops, args, true);
+	return dss_collective_reduce_internal(ops, args, true,
+					      DSS_POOL_SHARE);
 }
 
 static int
-dss_collective_internal(int (*func)(void *), void *arg, bool thread)
+dss_collective_internal(int (*func)(void *), void *arg, bool thread,
+			int pool)
 {
 	int				rc;
 	struct dss_coll_ops		coll_ops;
@@ -1125,10 +1413,8 @@ dss_collective_internal(int (*func)(void *), void *arg, bool thread)
 	coll_ops.co_func	= func;
 	coll_args.ca_func_args	= arg;
 
-	if (thread)
-		rc = dss_thread_collective_reduce(&coll_ops, &coll_args);
-	else
-		rc = dss_task_collective_reduce(&coll_ops, &coll_args);
+	rc = dss_collective_reduce_internal(&coll_ops, &coll_args, thread,
+					    pool);
 
 	return rc;
 }
@@ -1204,7 +1490,7 @@ dss_acc_offload(struct dss_acc_task *at_args)
 int
 dss_task_collective(int (*func)(void *), void *arg)
 {
-	return dss_collective_internal(func, arg, false);
+	return dss_collective_internal(func, arg, false, DSS_POOL_SHARE);
 }
 
 /**
@@ -1219,7 +1505,29 @@ dss_task_collective(int (*func)(void *), void *arg)
 int
 dss_thread_collective(int (*func)(void *), void *arg)
 {
-	return dss_collective_internal(func, arg, true);
+	return dss_collective_internal(func, arg, true, DSS_POOL_SHARE);
+}
+
+/**
+ * Same as dss_task_collective(), but schedules \a func in the ES pool
+ * \a pool, e.g. DSS_POOL_GC for background work.
+ */
+int
+dss_task_collective_pool(int (*func)(void *), void *arg, int pool)
+{
+	D_ASSERT(pool >= 0 && pool < DSS_POOL_CNT);
+	return dss_collective_internal(func, arg, false, pool);
+}
+
+/**
+ * Same as dss_thread_collective(), but creates the ULTs in the ES pool
+ * \a pool, e.g. DSS_POOL_AGGREGATE for epoch aggregation.
+ */
+int
+dss_thread_collective_pool(int (*func)(void *), void *arg, int pool)
+{
+	D_ASSERT(pool >= 0 && pool < DSS_POOL_CNT);
+	return dss_collective_internal(func, arg, true, pool);
 }
 
 static void
@@ -1317,6 +1625,21 @@ free_eventual:
 	return rc;
 }
 
+static int
+dss_sched_weight_set(int pool, uint64_t value)
+{
+	/* the progress ULT and I/O handlers must always be scheduled */
+	if (value > DSS_SCHED_WEIGHT_MAX ||
+	    (value == 0 && (pool == DSS_POOL_PRIV || pool == DSS_POOL_SHARE))) {
+		D_ERROR("invalid weight "DF_U64" for pool %d\n", value, pool);
+		return -DER_INVAL;
+	}
+
+	D_WARN("set scheduling weight of pool %d to "DF_U64"\n", pool, value);
+	dss_sched_weights[pool] = value;
+	return 0;
+}
+
 /*
  * Set parameters on the server.
  *
@@ -1342,7 +1665,23 @@ dss_parameters_set(unsigned int key_id, uint64_t value)
 			break;
 		}
 		D_WARN("set rebuild percentage to "DF_U64"\n", value);
-		dss_rebuild_res_percentage = value;
+		dss_sched_weights[DSS_POOL_REBUILD] = value;
+		break;
+	case DSS_SCHED_WEIGHT_IO:
+		rc = dss_sched_weight_set(DSS_POOL_PRIV, value);
+		break;
+	case DSS_SCHED_WEIGHT_META:
+		rc = dss_sched_weight_set(DSS_POOL_SHARE, value);
+		break;
+	case DSS_SCHED_WEIGHT_AGGREGATE:
+		rc = dss_sched_weight_set(DSS_POOL_AGGREGATE, value);
+		break;
+	case DSS_SCHED_WEIGHT_GC:
+		rc = dss_sched_weight_set(DSS_POOL_GC, value);
+		break;
+	case DSS_IDLE_MAX_US:
+		D_WARN("set idle blocking time to "DF_U64" usec\n", value);
+		dss_idle_max_us = value;
 		break;
 	default:
 		D_ERROR("invalid key_id %d\n", key_id);
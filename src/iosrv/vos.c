@@ -518,6 +518,141 @@ iter_dkey_cb(daos_handle_t ih, vos_iter_entry_t *key_ent, vos_iter_type_t type,
 	return rc;
 }
 
+/* Remember the first, i.e., the newest, single value; see iter_val_akey_cb. */
+static int
+latest_val_cb(daos_handle_t ih, vos_iter_entry_t *entry, vos_iter_type_t type,
+	      vos_iter_param_t *param, void *varg)
+{
+	vos_iter_entry_t *latest = varg;
+
+	*latest = *entry;
+	return -DER_NONEXIST;
+}
+
+/*
+ * Pack an akey and the value of its newest single value visible at the
+ * enumeration epoch as two descriptors: the akey (DAOS_IOD_NONE) followed by
+ * the raw value (DAOS_IOD_SINGLE). Array akeys, punched values and values
+ * larger than the inline threshold are skipped.
+ */
+static int
+iter_val_akey_cb(daos_handle_t ih, vos_iter_entry_t *key_ent,
+		 vos_iter_type_t type, vos_iter_param_t *param, void *varg)
+{
+	struct dss_enum_arg	*arg = varg;
+	daos_iov_t		*iovs = arg->sgl->sg_iovs;
+	vos_iter_param_t	 val_param;
+	vos_iter_entry_t	 val_ent;
+	daos_anchor_t		 val_anchor = { 0 };
+	daos_size_t		 size;
+	int			 rc;
+
+	val_param = *param;
+	val_param.ip_akey = key_ent->ie_key;
+	val_param.ip_epr.epr_lo = 0;
+	val_param.ip_epc_expr = VOS_IT_EPC_RR;
+
+	memset(&val_ent, 0, sizeof(val_ent));
+	rc = dss_vos_iterate(VOS_ITER_SINGLE, &val_param, &val_anchor,
+			     latest_val_cb, &val_ent);
+	if (rc != 0) {
+		D_ERROR("failed to fetch single value: %d\n", rc);
+		return rc;
+	}
+
+	if (val_ent.ie_rsize == 0 || val_ent.ie_rsize > arg->inline_thres)
+		return 0;
+
+	size = key_ent->ie_key.iov_len + val_ent.ie_rsize;
+	if (is_sgl_kds_full(arg, size) || arg->kds_len + 1 >= arg->kds_cap)
+		return 1;
+
+	arg->kds[arg->kds_len].kd_key_len = key_ent->ie_key.iov_len;
+	arg->kds[arg->kds_len].kd_csum_len = 0;
+	arg->kds[arg->kds_len].kd_val_types = DAOS_IOD_NONE;
+	arg->kds_len++;
+	memcpy(iovs[arg->sgl_idx].iov_buf + iovs[arg->sgl_idx].iov_len,
+	       key_ent->ie_key.iov_buf, key_ent->ie_key.iov_len);
+	iovs[arg->sgl_idx].iov_len += key_ent->ie_key.iov_len;
+
+	arg->kds[arg->kds_len].kd_key_len = val_ent.ie_rsize;
+	arg->kds[arg->kds_len].kd_csum_len = 0;
+	arg->kds[arg->kds_len].kd_val_types = DAOS_IOD_SINGLE;
+	arg->kds_len++;
+	copy_data(VOS_ITER_SINGLE, &val_param, &val_ent,
+		  iovs[arg->sgl_idx].iov_buf + iovs[arg->sgl_idx].iov_len,
+		  val_ent.ie_rsize);
+	iovs[arg->sgl_idx].iov_len += val_ent.ie_rsize;
+
+	D_DEBUG(DB_IO, "Pack akey %.*s value "DF_U64" epoch "DF_U64
+		" kds len %d\n", (int)key_ent->ie_key.iov_len,
+		(char *)key_ent->ie_key.iov_buf, val_ent.ie_rsize,
+		val_ent.ie_epoch, arg->kds_len);
+	return 0;
+}
+
+/*
+ * Pack a dkey followed by the latest single values of its akeys. A dkey is
+ * packed either with all of its values or not at all, so that the dkey anchor
+ * alone is enough to resume the enumeration.
+ */
+static int
+iter_val_dkey_cb(daos_handle_t ih, vos_iter_entry_t *key_ent,
+		 vos_iter_type_t type, vos_iter_param_t *param, void *varg)
+{
+	struct dss_enum_arg	*arg = varg;
+	daos_iov_t		*iovs = arg->sgl->sg_iovs;
+	vos_iter_param_t	 iter_akey_param;
+	daos_anchor_t		 akey_anchor = { 0 };
+	daos_size_t		 iov_len;
+	uint32_t		 nr_out;
+	int			 kds_len;
+	int			 sgl_idx;
+	int			 i;
+	int			 rc;
+
+	sgl_idx = arg->sgl_idx;
+	iov_len = sgl_idx < arg->sgl->sg_nr ? iovs[sgl_idx].iov_len : 0;
+	nr_out = arg->sgl->sg_nr_out;
+	kds_len = arg->kds_len;
+
+	rc = fill_key(ih, key_ent, arg, VOS_ITER_DKEY);
+	if (rc != 0)
+		return rc;
+	arg->kds[arg->kds_len - 1].kd_val_types = DAOS_IOD_NONE;
+
+	iter_akey_param = *param;
+	iter_akey_param.ip_dkey = key_ent->ie_key;
+	rc = dss_vos_iterate(VOS_ITER_AKEY, &iter_akey_param, &akey_anchor,
+			     iter_val_akey_cb, arg);
+	if (rc <= 0) {
+		if (rc < 0)
+			D_ERROR("failed to enumerate akeys: %d\n", rc);
+		return rc;
+	}
+
+	/* The buffers are full, drop the partially packed dkey. */
+	for (i = sgl_idx + 1; i <= arg->sgl_idx && i < arg->sgl->sg_nr; i++)
+		iovs[i].iov_len = 0;
+	if (sgl_idx < arg->sgl->sg_nr)
+		iovs[sgl_idx].iov_len = iov_len;
+	arg->sgl_idx = sgl_idx;
+	arg->sgl->sg_nr_out = nr_out;
+	memset(&arg->kds[kds_len], 0,
+	       sizeof(*arg->kds) * (arg->kds_len - kds_len));
+	arg->kds_len = kds_len;
+
+	if (kds_len == 0) {
+		D_DEBUG(DB_IO, "dkey %.*s and its values exceed the buffers\n",
+			(int)key_ent->ie_key.iov_len,
+			(char *)key_ent->ie_key.iov_buf);
+		/* lower bound of the buffer size the dkey needs */
+		arg->kds[0].kd_key_len = key_ent->ie_key.iov_len + 1;
+		return -DER_KEY2BIG;
+	}
+	return 1;
+}
+
 static int
 iter_obj_cb(daos_handle_t ih, vos_iter_entry_t *entry, vos_iter_type_t type,
 	    vos_iter_param_t *param, void *varg)
@@ -581,7 +716,10 @@ dss_enum_pack(vos_iter_type_t type, struct dss_enum_arg *arg)
 		break;
 	case VOS_ITER_DKEY:
 		anchor = &arg->dkey_anchor;
-		cb = arg->recursive ? iter_dkey_cb : fill_key_cb;
+		if (arg->recursive)
+			cb = iter_dkey_cb;
+		else
+			cb = arg->latest_vals ? iter_val_dkey_cb : fill_key_cb;
 		break;
 	case VOS_ITER_AKEY:
 		anchor = &arg->akey_anchor;
@@ -0,0 +1,1028 @@
+/**
+ * (C) Copyright 2018 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GOVERNMENT LICENSE RIGHTS-OPEN SOURCE SOFTWARE
+ * The Government's rights to use, modify, reproduce, release, perform, display,
+ * or disclose this software are subject to the terms of the Apache License as
+ * provided in Contract No. B609815.
+ * Any reproduction of computer software, computer software documentation, or
+ * portions thereof marked with this legend must also reproduce the markings.
+ */
+/**
+ * Client side I/O planning of erasure coded objects.
+ *
+ * Records of an array akey are grouped in cells of e_len bytes, cell c is
+ * stored on data shard (c % k) of the redundancy group at its original
+ * record index, k consecutive cells form a stripe. The p parity cells of
+ * stripe s are stored on the parity shards under the same akey, at record
+ * index (OBJ_EC_PARITY_BIT | s * cell_records). Non-array values are
+ * replicated to all shards of the group.
+ *
+ * src/object/cli_ec.c
+ */
+#define D_LOGFAC	DD_FAC(object)
+
+#include "obj_internal.h"
+
+/** A stripe touched by an update, or to be recovered by a fetch */
+struct obj_ec_stripe {
+	/** index of the user iod */
+	unsigned int		 st_iod;
+	/** stripe number within the akey */
+	uint64_t		 st_idx;
+	/** number of records of the stripe covered by the request */
+	daos_size_t		 st_recs;
+	/** k + p cells of the stripe */
+	unsigned char		*st_buf;
+};
+
+struct obj_ec_io {
+	struct daos_ec_codec	*eio_codec;
+	unsigned int		 eio_k;
+	unsigned int		 eio_p;
+	/** cell size in bytes */
+	unsigned int		 eio_cell_size;
+	unsigned int		 eio_update:1,
+				 /** only query record sizes */
+				 eio_size_only:1;
+	/** bitmap of available shards of the group (fetch only) */
+	uint32_t		 eio_avail;
+	/** bitmap of shards read to recover lost data cells */
+	uint32_t		 eio_recov;
+	/** user request */
+	unsigned int		 eio_nr;
+	daos_iod_t		*eio_iods;
+	daos_sg_list_t		*eio_sgls;
+	/** stripes sorted by iod and stripe number */
+	unsigned int		 eio_stripe_nr;
+	struct obj_ec_stripe	*eio_stripes;
+	unsigned char		*eio_buf;
+	/** descriptors to read the partially updated stripes */
+	unsigned int		 eio_rmw_nr;
+	daos_iod_t		*eio_rmw_iods;
+	daos_sg_list_t		*eio_rmw_sgls;
+	struct obj_ec_shard_io	 eio_shards[DAOS_EC_CELLS_MAX];
+};
+
+/** recx and iov count of one user iod on one shard */
+struct ec_slot {
+	unsigned int		 sl_recx_nr;
+	unsigned int		 sl_iov_nr;
+	/** replicated value, reuses the user iod and sgl */
+	bool			 sl_single;
+	/** index in obj_ec_shard_io::es_iods */
+	int			 sl_idx;
+};
+
+enum {
+	/** count recxs and iovs of each shard, collect stripes */
+	EC_WALK_COUNT,
+	/** fill recxs and iovs of each shard */
+	EC_WALK_FILL,
+	/** copy user data into the stripe buffers */
+	EC_WALK_GATHER,
+	/** copy recovered data into the user buffers */
+	EC_WALK_SCATTER,
+};
+
+struct ec_walk {
+	struct obj_ec_io	*ew_eio;
+	int			 ew_mode;
+	struct ec_slot		*ew_slots;
+};
+
+struct ec_sgl_cursor {
+	daos_sg_list_t		*sc_sgl;
+	unsigned int		 sc_iov;
+	daos_size_t		 sc_off;
+	bool			 sc_update;
+};
+
+static inline bool
+ec_iod_is_array(daos_iod_t *iod)
+{
+	return iod->iod_type == DAOS_IOD_ARRAY;
+}
+
+/** number of records per cell */
+static inline daos_size_t
+ec_cell_recs(struct obj_ec_io *eio, daos_iod_t *iod)
+{
+	if (iod->iod_size >= eio->eio_cell_size)
+		return 1;
+	return eio->eio_cell_size / iod->iod_size;
+}
+
+static inline struct ec_slot *
+ec_slot_get(struct ec_walk *ew, unsigned int shard, unsigned int iod)
+{
+	return &ew->ew_slots[shard * ew->ew_eio->eio_nr + iod];
+}
+
+static inline bool
+ec_shard_lost(struct obj_ec_io *eio, unsigned int shard)
+{
+	return !eio->eio_update && !(eio->eio_avail & (1U << shard));
+}
+
+/** Return the next piece (at most @len bytes) of the sgl */
+static int
+ec_sgl_next(struct ec_sgl_cursor *cur, daos_size_t len, daos_iov_t *iov)
+{
+	daos_sg_list_t	*sgl = cur->sc_sgl;
+	daos_iov_t	*src;
+	daos_size_t	 avail;
+
+	while (cur->sc_iov < sgl->sg_nr) {
+		src = &sgl->sg_iovs[cur->sc_iov];
+		avail = cur->sc_update ? src->iov_len : src->iov_buf_len;
+		if (cur->sc_off >= avail) {
+			cur->sc_iov++;
+			cur->sc_off = 0;
+			continue;
+		}
+
+		avail -= cur->sc_off;
+		if (len > avail)
+			len = avail;
+
+		iov->iov_buf	 = (char *)src->iov_buf + cur->sc_off;
+		iov->iov_buf_len = len;
+		iov->iov_len	 = len;
+		cur->sc_off	+= len;
+		return 0;
+	}
+
+	D_ERROR("sgl is too short for the iod\n");
+	return cur->sc_update ? -DER_INVAL : -DER_REC2BIG;
+}
+
+static int
+ec_stripe_cmp(const void *a, const void *b)
+{
+	const struct obj_ec_stripe *s1 = a;
+	const struct obj_ec_stripe *s2 = b;
+
+	if (s1->st_iod != s2->st_iod)
+		return s1->st_iod < s2->st_iod ? -1 : 1;
+	if (s1->st_idx != s2->st_idx)
+		return s1->st_idx < s2->st_idx ? -1 : 1;
+	return 0;
+}
+
+static struct obj_ec_stripe *
+ec_stripe_find(struct obj_ec_io *eio, unsigned int iod, uint64_t idx)
+{
+	struct obj_ec_stripe	key;
+
+	key.st_iod = iod;
+	key.st_idx = idx;
+	return bsearch(&key, eio->eio_stripes, eio->eio_stripe_nr,
+		       sizeof(key), ec_stripe_cmp);
+}
+
+/** Walk a piece of a recx which is within a single cell */
+static int
+ec_piece_walk(struct ec_walk *ew, unsigned int i, uint64_t cell, uint64_t idx,
+	      daos_size_t nr, struct ec_sgl_cursor *cur)
+{
+	struct obj_ec_io	*eio = ew->ew_eio;
+	daos_iod_t		*iod = &eio->eio_iods[i];
+	daos_size_t		 recs = ec_cell_recs(eio, iod);
+	unsigned int		 shard = cell % eio->eio_k;
+	bool			 lost = ec_shard_lost(eio, shard);
+	struct ec_slot		*slot = ec_slot_get(ew, shard, i);
+	struct obj_ec_shard_io	*sio = &eio->eio_shards[shard];
+	struct obj_ec_stripe	*st;
+	unsigned char		*buf = NULL;
+	daos_size_t		 len = nr * iod->iod_size;
+	daos_iov_t		 iov;
+	int			 rc;
+
+	switch (ew->ew_mode) {
+	case EC_WALK_COUNT:
+		if (!lost)
+			slot->sl_recx_nr++;
+		if (eio->eio_update || lost) {
+			st = &eio->eio_stripes[eio->eio_stripe_nr++];
+			st->st_iod  = i;
+			st->st_idx  = cell / eio->eio_k;
+			st->st_recs = nr;
+		}
+		break;
+	case EC_WALK_FILL:
+		if (!lost) {
+			iod = &sio->es_iods[slot->sl_idx];
+			iod->iod_recxs[iod->iod_nr].rx_idx = idx;
+			iod->iod_recxs[iod->iod_nr].rx_nr = nr;
+			iod->iod_nr++;
+		}
+		break;
+	case EC_WALK_GATHER:
+	case EC_WALK_SCATTER:
+		st = ec_stripe_find(eio, i, cell / eio->eio_k);
+		if (st != NULL)
+			buf = st->st_buf + shard * recs * iod->iod_size +
+			      (idx - cell * recs) * iod->iod_size;
+		break;
+	}
+
+	while (len > 0) {
+		rc = ec_sgl_next(cur, len, &iov);
+		if (rc != 0)
+			return rc;
+		len -= iov.iov_buf_len;
+
+		switch (ew->ew_mode) {
+		case EC_WALK_COUNT:
+			if (!lost)
+				slot->sl_iov_nr++;
+			break;
+		case EC_WALK_FILL:
+			if (!lost) {
+				daos_sg_list_t *sgl;
+
+				sgl = &sio->es_sgls[slot->sl_idx];
+				sgl->sg_iovs[sgl->sg_nr++] = iov;
+			}
+			break;
+		case EC_WALK_GATHER:
+			D_ASSERT(buf != NULL);
+			memcpy(buf, iov.iov_buf, iov.iov_buf_len);
+			buf += iov.iov_buf_len;
+			break;
+		case EC_WALK_SCATTER:
+			if (lost) {
+				D_ASSERT(buf != NULL);
+				memcpy(iov.iov_buf, buf, iov.iov_buf_len);
+				buf += iov.iov_buf_len;
+			}
+			break;
+		}
+	}
+	return 0;
+}
+
+/** Walk all array iods of the request */
+static int
+ec_iods_walk(struct ec_walk *ew, int mode)
+{
+	struct obj_ec_io	*eio = ew->ew_eio;
+	int			 i;
+	int			 j;
+	int			 rc;
+
+	ew->ew_mode = mode;
+	for (i = 0; i < eio->eio_nr; i++) {
+		daos_iod_t		*iod = &eio->eio_iods[i];
+		struct ec_sgl_cursor	 cur;
+		daos_size_t		 recs;
+
+		if (!ec_iod_is_array(iod))
+			continue;
+
+		memset(&cur, 0, sizeof(cur));
+		cur.sc_sgl = &eio->eio_sgls[i];
+		cur.sc_update = eio->eio_update;
+		recs = ec_cell_recs(eio, iod);
+
+		for (j = 0; j < iod->iod_nr; j++) {
+			uint64_t idx = iod->iod_recxs[j].rx_idx;
+			uint64_t end = idx + iod->iod_recxs[j].rx_nr;
+
+			while (idx < end) {
+				uint64_t	cell = idx / recs;
+				daos_size_t	nr;
+
+				nr = min(end, (cell + 1) * recs) - idx;
+				rc = ec_piece_walk(ew, i, cell, idx, nr, &cur);
+				if (rc != 0)
+					return rc;
+				idx += nr;
+			}
+		}
+	}
+	return 0;
+}
+
+/** Upper bound of the number of pieces of the request, 0 on invalid recx */
+static int
+ec_pieces_count(struct obj_ec_io *eio, daos_size_t *pieces)
+{
+	int	i;
+	int	j;
+
+	*pieces = 0;
+	for (i = 0; i < eio->eio_nr; i++) {
+		daos_iod_t	*iod = &eio->eio_iods[i];
+		daos_size_t	 recs;
+
+		if (!ec_iod_is_array(iod))
+			continue;
+
+		if (iod->iod_size == 0) {
+			D_ERROR("Invalid record size of iod %d\n", i);
+			return -DER_INVAL;
+		}
+
+		recs = ec_cell_recs(eio, iod);
+		for (j = 0; j < iod->iod_nr; j++) {
+			daos_recx_t *recx = &iod->iod_recxs[j];
+
+			if (recx->rx_nr == 0)
+				continue;
+			if (recx->rx_idx + recx->rx_nr >= OBJ_EC_PARITY_BIT ||
+			    recx->rx_idx + recx->rx_nr < recx->rx_idx) {
+				D_ERROR("recx "DF_U64"/"DF_U64" out of range\n",
+					recx->rx_idx, recx->rx_nr);
+				return -DER_INVAL;
+			}
+			*pieces += (recx->rx_idx + recx->rx_nr - 1) / recs -
+				   recx->rx_idx / recs + 1;
+		}
+	}
+	return 0;
+}
+
+/** Sort the collected stripes, merge duplicates and allocate their buffers */
+static int
+ec_stripes_setup(struct obj_ec_io *eio)
+{
+	struct obj_ec_stripe	*stripes = eio->eio_stripes;
+	unsigned int		 cells = eio->eio_k + eio->eio_p;
+	daos_size_t		 size;
+	unsigned char		*buf;
+	int			 i;
+	int			 j;
+
+	if (eio->eio_stripe_nr == 0)
+		return 0;
+
+	qsort(stripes, eio->eio_stripe_nr, sizeof(*stripes), ec_stripe_cmp);
+	for (i = 0, j = 1; j < eio->eio_stripe_nr; j++) {
+		if (ec_stripe_cmp(&stripes[i], &stripes[j]) == 0) {
+			stripes[i].st_recs += stripes[j].st_recs;
+			continue;
+		}
+		stripes[++i] = stripes[j];
+	}
+	eio->eio_stripe_nr = i + 1;
+
+	size = 0;
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		daos_iod_t *iod = &eio->eio_iods[stripes[i].st_iod];
+
+		size += cells * ec_cell_recs(eio, iod) * iod->iod_size;
+	}
+
+	/* holes are read back as zero, parity is generated over them */
+	D_ALLOC(eio->eio_buf, size);
+	if (eio->eio_buf == NULL)
+		return -DER_NOMEM;
+
+	buf = eio->eio_buf;
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		daos_iod_t *iod = &eio->eio_iods[stripes[i].st_iod];
+
+		stripes[i].st_buf = buf;
+		buf += cells * ec_cell_recs(eio, iod) * iod->iod_size;
+	}
+	return 0;
+}
+
+/** Allocate the iods and sgls of each shard according to the counted slots */
+static int
+ec_shards_alloc(struct ec_walk *ew)
+{
+	struct obj_ec_io	*eio = ew->ew_eio;
+	unsigned int		 cells = eio->eio_k + eio->eio_p;
+	unsigned int		 shard;
+	int			 i;
+
+	for (shard = 0; shard < cells; shard++) {
+		struct obj_ec_shard_io	*sio = &eio->eio_shards[shard];
+		unsigned int		 nr = 0;
+		daos_size_t		 recx_nr = 0;
+		daos_size_t		 iov_nr = 0;
+		daos_recx_t		*recxs;
+		daos_iov_t		*iovs;
+		char			*buf;
+
+		for (i = 0; i < eio->eio_nr; i++) {
+			struct ec_slot *slot = ec_slot_get(ew, shard, i);
+
+			if (!slot->sl_single && slot->sl_recx_nr == 0)
+				continue;
+			nr++;
+			recx_nr += slot->sl_recx_nr;
+			iov_nr += slot->sl_iov_nr;
+		}
+		if (nr == 0)
+			continue;
+
+		D_ALLOC(buf, nr * (sizeof(daos_iod_t) + sizeof(daos_sg_list_t) +
+				   sizeof(unsigned int)) +
+			     recx_nr * sizeof(*recxs) + iov_nr * sizeof(*iovs));
+		if (buf == NULL)
+			return -DER_NOMEM;
+
+		sio->es_iods = (daos_iod_t *)buf;
+		buf += nr * sizeof(daos_iod_t);
+		sio->es_sgls = (daos_sg_list_t *)buf;
+		buf += nr * sizeof(daos_sg_list_t);
+		recxs = (daos_recx_t *)buf;
+		buf += recx_nr * sizeof(*recxs);
+		iovs = (daos_iov_t *)buf;
+		buf += iov_nr * sizeof(*iovs);
+		sio->es_iod_map = (unsigned int *)buf;
+
+		for (i = 0; i < eio->eio_nr; i++) {
+			struct ec_slot	*slot = ec_slot_get(ew, shard, i);
+			daos_iod_t	*iod = &sio->es_iods[sio->es_nr];
+			daos_sg_list_t	*sgl = &sio->es_sgls[sio->es_nr];
+
+			if (!slot->sl_single && slot->sl_recx_nr == 0)
+				continue;
+
+			slot->sl_idx = sio->es_nr;
+			sio->es_iod_map[sio->es_nr++] = i;
+			*iod = eio->eio_iods[i];
+			if (eio->eio_sgls != NULL)
+				*sgl = eio->eio_sgls[i];
+			if (slot->sl_single)
+				continue;
+
+			iod->iod_nr	= 0;
+			iod->iod_recxs	= recxs;
+			iod->iod_csums	= NULL;
+			iod->iod_eprs	= NULL;
+			recxs += slot->sl_recx_nr;
+
+			sgl->sg_nr	= 0;
+			sgl->sg_nr_out	= 0;
+			sgl->sg_iovs	= iovs;
+			iovs += slot->sl_iov_nr;
+		}
+	}
+	return 0;
+}
+
+/** Append a whole cell of stripe @st to the iod and sgl of @shard */
+static void
+ec_cell_append(struct ec_walk *ew, struct obj_ec_stripe *st,
+	       unsigned int shard)
+{
+	struct obj_ec_io	*eio = ew->ew_eio;
+	struct obj_ec_shard_io	*sio = &eio->eio_shards[shard];
+	struct ec_slot		*slot = ec_slot_get(ew, shard, st->st_iod);
+	daos_iod_t		*iod = &sio->es_iods[slot->sl_idx];
+	daos_sg_list_t		*sgl = &sio->es_sgls[slot->sl_idx];
+	daos_size_t		 recs;
+	daos_size_t		 len;
+	daos_recx_t		*recx;
+
+	recs = ec_cell_recs(eio, iod);
+	len = recs * iod->iod_size;
+
+	recx = &iod->iod_recxs[iod->iod_nr++];
+	if (shard < eio->eio_k)
+		recx->rx_idx = (st->st_idx * eio->eio_k + shard) * recs;
+	else
+		recx->rx_idx = OBJ_EC_PARITY_BIT | (st->st_idx * recs);
+	recx->rx_nr = recs;
+
+	daos_iov_set(&sgl->sg_iovs[sgl->sg_nr++], st->st_buf + shard * len,
+		     len);
+}
+
+static struct obj_ec_io *
+ec_io_alloc(struct daos_oclass_attr *oca, struct daos_ec_codec *codec,
+	    unsigned int nr, daos_iod_t *iods, daos_sg_list_t *sgls,
+	    bool update)
+{
+	struct obj_ec_io *eio;
+
+	D_ALLOC_PTR(eio);
+	if (eio == NULL)
+		return NULL;
+
+	eio->eio_codec	   = codec;
+	eio->eio_k	   = codec->ec_k;
+	eio->eio_p	   = codec->ec_p;
+	eio->eio_cell_size = oca->u.ec.e_len;
+	eio->eio_update	   = update;
+	eio->eio_nr	   = nr;
+	eio->eio_iods	   = iods;
+	eio->eio_sgls	   = sgls;
+	D_ASSERT(eio->eio_k + eio->eio_p <= DAOS_EC_CELLS_MAX);
+	return eio;
+}
+
+/** Collect stripes and shard pieces of the array iods */
+static int
+ec_io_plan(struct ec_walk *ew)
+{
+	struct obj_ec_io	*eio = ew->ew_eio;
+	unsigned int		 cells = eio->eio_k + eio->eio_p;
+	daos_size_t		 pieces;
+	int			 rc;
+
+	D_ALLOC(ew->ew_slots, cells * eio->eio_nr * sizeof(*ew->ew_slots));
+	if (ew->ew_slots == NULL)
+		return -DER_NOMEM;
+
+	rc = ec_pieces_count(eio, &pieces);
+	if (rc != 0)
+		return rc;
+
+	if (pieces > 0) {
+		D_ALLOC(eio->eio_stripes, pieces * sizeof(*eio->eio_stripes));
+		if (eio->eio_stripes == NULL)
+			return -DER_NOMEM;
+	}
+
+	rc = ec_iods_walk(ew, EC_WALK_COUNT);
+	if (rc != 0)
+		return rc;
+
+	return ec_stripes_setup(eio);
+}
+
+/** Build the descriptors to read the stripes partially covered by update */
+static int
+ec_rmw_prep(struct obj_ec_io *eio)
+{
+	struct obj_ec_stripe	*st;
+	daos_size_t		 recs;
+	daos_recx_t		*recxs;
+	daos_iov_t		*iovs;
+	char			*buf;
+	unsigned int		 stripe_nr = 0;
+	unsigned int		 nr = 0;
+	unsigned int		 last = -1;
+	int			 i;
+
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		st = &eio->eio_stripes[i];
+		recs = ec_cell_recs(eio, &eio->eio_iods[st->st_iod]);
+		if (st->st_recs == recs * eio->eio_k)
+			continue;
+
+		stripe_nr++;
+		if (st->st_iod != last)
+			nr++;
+		last = st->st_iod;
+	}
+	if (stripe_nr == 0)
+		return 0;
+
+	D_ALLOC(buf, nr * (sizeof(daos_iod_t) + sizeof(daos_sg_list_t)) +
+		     stripe_nr * (sizeof(*recxs) + sizeof(*iovs)));
+	if (buf == NULL)
+		return -DER_NOMEM;
+
+	eio->eio_rmw_iods = (daos_iod_t *)buf;
+	buf += nr * sizeof(daos_iod_t);
+	eio->eio_rmw_sgls = (daos_sg_list_t *)buf;
+	buf += nr * sizeof(daos_sg_list_t);
+	recxs = (daos_recx_t *)buf;
+	buf += stripe_nr * sizeof(*recxs);
+	iovs = (daos_iov_t *)buf;
+
+	last = -1;
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		daos_iod_t	*iod;
+		daos_sg_list_t	*sgl;
+
+		st = &eio->eio_stripes[i];
+		recs = ec_cell_recs(eio, &eio->eio_iods[st->st_iod]);
+		if (st->st_recs == recs * eio->eio_k)
+			continue;
+
+		if (st->st_iod != last) {
+			iod = &eio->eio_rmw_iods[eio->eio_rmw_nr];
+			sgl = &eio->eio_rmw_sgls[eio->eio_rmw_nr];
+			eio->eio_rmw_nr++;
+
+			*iod = eio->eio_iods[st->st_iod];
+			iod->iod_nr	= 0;
+			iod->iod_recxs	= recxs;
+			iod->iod_csums	= NULL;
+			iod->iod_eprs	= NULL;
+			sgl->sg_nr	= 0;
+			sgl->sg_nr_out	= 0;
+			sgl->sg_iovs	= iovs;
+		}
+		last = st->st_iod;
+
+		iod = &eio->eio_rmw_iods[eio->eio_rmw_nr - 1];
+		sgl = &eio->eio_rmw_sgls[eio->eio_rmw_nr - 1];
+		iod->iod_recxs[iod->iod_nr].rx_idx = st->st_idx * recs *
+						     eio->eio_k;
+		iod->iod_recxs[iod->iod_nr].rx_nr = recs * eio->eio_k;
+		iod->iod_nr++;
+		daos_iov_set(&sgl->sg_iovs[sgl->sg_nr++], st->st_buf,
+			     recs * iod->iod_size * eio->eio_k);
+		recxs++;
+		iovs++;
+	}
+	return 0;
+}
+
+/**
+ * Plan an update of an erasure coded object. Data records are sent to the
+ * data shards straight from the user buffers, parity cells are generated
+ * by obj_ec_update_encode(). If some stripes are partially covered by the
+ * update, their current content has to be fetched first, see
+ * obj_ec_update_need_rmw().
+ */
+int
+obj_ec_update_prep(struct obj_ec_io **eiop, struct daos_oclass_attr *oca,
+		   struct daos_ec_codec *codec, unsigned int nr,
+		   daos_iod_t *iods, daos_sg_list_t *sgls)
+{
+	struct obj_ec_io	*eio;
+	struct ec_walk		 ew;
+	unsigned int		 cells;
+	unsigned int		 shard;
+	int			 i;
+	int			 rc;
+
+	if (sgls == NULL)
+		return -DER_INVAL;
+
+	eio = ec_io_alloc(oca, codec, nr, iods, sgls, true);
+	if (eio == NULL)
+		return -DER_NOMEM;
+
+	memset(&ew, 0, sizeof(ew));
+	ew.ew_eio = eio;
+	rc = ec_io_plan(&ew);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	cells = eio->eio_k + eio->eio_p;
+	for (i = 0; i < nr; i++) {
+		if (ec_iod_is_array(&iods[i]))
+			continue;
+		for (shard = 0; shard < cells; shard++)
+			ec_slot_get(&ew, shard, i)->sl_single = true;
+	}
+
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		for (shard = eio->eio_k; shard < cells; shard++) {
+			struct ec_slot *slot;
+
+			slot = ec_slot_get(&ew, shard,
+					   eio->eio_stripes[i].st_iod);
+			slot->sl_recx_nr++;
+			slot->sl_iov_nr++;
+		}
+	}
+
+	rc = ec_shards_alloc(&ew);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	rc = ec_iods_walk(&ew, EC_WALK_FILL);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		for (shard = eio->eio_k; shard < cells; shard++)
+			ec_cell_append(&ew, &eio->eio_stripes[i], shard);
+	}
+
+	rc = ec_rmw_prep(eio);
+out:
+	if (ew.ew_slots != NULL)
+		D_FREE(ew.ew_slots);
+	if (rc != 0) {
+		obj_ec_io_free(eio);
+		eio = NULL;
+	}
+	*eiop = eio;
+	return rc;
+}
+
+/**
+ * Return true if some stripes are partially updated, in which case the
+ * caller should fetch @iods/@sgls from the object before calling
+ * obj_ec_update_encode().
+ */
+bool
+obj_ec_update_need_rmw(struct obj_ec_io *eio, unsigned int *nr,
+		       daos_iod_t **iods, daos_sg_list_t **sgls)
+{
+	if (eio->eio_rmw_nr == 0)
+		return false;
+
+	*nr = eio->eio_rmw_nr;
+	*iods = eio->eio_rmw_iods;
+	*sgls = eio->eio_rmw_sgls;
+	return true;
+}
+
+/** Copy the user data into the stripes and generate their parity cells */
+int
+obj_ec_update_encode(struct obj_ec_io *eio)
+{
+	struct ec_walk	 ew;
+	unsigned char	*data[DAOS_EC_CELLS_MAX];
+	unsigned char	*parity[DAOS_EC_CELLS_MAX];
+	int		 i;
+	int		 j;
+	int		 rc;
+
+	D_ASSERT(eio->eio_update);
+	memset(&ew, 0, sizeof(ew));
+	ew.ew_eio = eio;
+	rc = ec_iods_walk(&ew, EC_WALK_GATHER);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		struct obj_ec_stripe	*st = &eio->eio_stripes[i];
+		daos_iod_t		*iod = &eio->eio_iods[st->st_iod];
+		unsigned int		 len;
+
+		len = ec_cell_recs(eio, iod) * iod->iod_size;
+		for (j = 0; j < eio->eio_k; j++)
+			data[j] = st->st_buf + j * len;
+		for (j = 0; j < eio->eio_p; j++)
+			parity[j] = st->st_buf + (eio->eio_k + j) * len;
+
+		daos_ec_encode(eio->eio_codec, len, data, parity);
+	}
+	return 0;
+}
+
+/** Send the whole request to every available data shard to query sizes */
+static int
+ec_fetch_size_prep(struct obj_ec_io *eio)
+{
+	unsigned int	shard;
+	int		i;
+
+	for (shard = 0; shard < eio->eio_k; shard++) {
+		struct obj_ec_shard_io	*sio = &eio->eio_shards[shard];
+		char			*buf;
+
+		if (ec_shard_lost(eio, shard))
+			continue;
+
+		D_ALLOC(buf, eio->eio_nr * (sizeof(daos_iod_t) +
+					    sizeof(unsigned int)));
+		if (buf == NULL)
+			return -DER_NOMEM;
+
+		sio->es_iods = (daos_iod_t *)buf;
+		sio->es_iod_map = (unsigned int *)(sio->es_iods + eio->eio_nr);
+		sio->es_sgls = NULL;
+		sio->es_nr = eio->eio_nr;
+		for (i = 0; i < eio->eio_nr; i++) {
+			sio->es_iods[i] = eio->eio_iods[i];
+			sio->es_iod_map[i] = i;
+		}
+		return 0;
+	}
+
+	D_ERROR("All data shards are unavailable\n");
+	return -DER_IO;
+}
+
+/**
+ * Plan a fetch from an erasure coded object. Records are read from the data
+ * shards straight into the user buffers, stripes of the unavailable data
+ * shards (not set in @avail) are read from k other shards and regenerated
+ * by obj_ec_fetch_complete().
+ *
+ * If the record size of any array iod is unknown, or there is no sgl, then
+ * only the record sizes are returned.
+ */
+int
+obj_ec_fetch_prep(struct obj_ec_io **eiop, struct daos_oclass_attr *oca,
+		  struct daos_ec_codec *codec, unsigned int nr,
+		  daos_iod_t *iods, daos_sg_list_t *sgls, uint32_t avail)
+{
+	struct obj_ec_io	*eio;
+	struct ec_walk		 ew;
+	unsigned int		 cells;
+	unsigned int		 shard;
+	int			 i;
+	int			 rc;
+
+	eio = ec_io_alloc(oca, codec, nr, iods, sgls, false);
+	if (eio == NULL)
+		return -DER_NOMEM;
+
+	eio->eio_avail = avail;
+	eio->eio_size_only = (sgls == NULL);
+	for (i = 0; i < nr; i++) {
+		if (ec_iod_is_array(&iods[i]) &&
+		    iods[i].iod_size == DAOS_REC_ANY)
+			eio->eio_size_only = 1;
+	}
+
+	memset(&ew, 0, sizeof(ew));
+	ew.ew_eio = eio;
+	if (eio->eio_size_only) {
+		rc = ec_fetch_size_prep(eio);
+		D_GOTO(out, rc);
+	}
+
+	rc = ec_io_plan(&ew);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	cells = eio->eio_k + eio->eio_p;
+	/* replicated values are read from the first available shard */
+	for (i = 0; i < nr; i++) {
+		if (ec_iod_is_array(&iods[i]))
+			continue;
+		for (shard = 0; shard < cells; shard++) {
+			if (!ec_shard_lost(eio, shard))
+				break;
+		}
+		if (shard == cells)
+			D_GOTO(out, rc = -DER_IO);
+		ec_slot_get(&ew, shard, i)->sl_single = true;
+	}
+
+	if (eio->eio_stripe_nr > 0) {
+		unsigned int	selected = 0;
+
+		/* read the lost stripes from k shards, data shards first */
+		for (shard = 0; shard < cells && selected < eio->eio_k;
+		     shard++) {
+			if (ec_shard_lost(eio, shard))
+				continue;
+			eio->eio_recov |= 1U << shard;
+			selected++;
+		}
+		if (selected < eio->eio_k) {
+			D_ERROR("Too many lost shards, avail %#x\n", avail);
+			D_GOTO(out, rc = -DER_IO);
+		}
+
+		for (i = 0; i < eio->eio_stripe_nr; i++) {
+			for (shard = 0; shard < cells; shard++) {
+				struct ec_slot *slot;
+
+				if (!(eio->eio_recov & (1U << shard)))
+					continue;
+				slot = ec_slot_get(&ew, shard,
+						   eio->eio_stripes[i].st_iod);
+				slot->sl_recx_nr++;
+				slot->sl_iov_nr++;
+			}
+		}
+	}
+
+	rc = ec_shards_alloc(&ew);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	rc = ec_iods_walk(&ew, EC_WALK_FILL);
+	if (rc != 0)
+		D_GOTO(out, rc);
+
+	for (i = 0; i < eio->eio_stripe_nr; i++) {
+		for (shard = 0; shard < cells; shard++) {
+			if (eio->eio_recov & (1U << shard))
+				ec_cell_append(&ew, &eio->eio_stripes[i],
+					       shard);
+		}
+	}
+out:
+	if (ew.ew_slots != NULL)
+		D_FREE(ew.ew_slots);
+	if (rc != 0) {
+		obj_ec_io_free(eio);
+		eio = NULL;
+	}
+	*eiop = eio;
+	return rc;
+}
+
+/** Merge the record sizes returned by the shards into the user iods */
+static void
+ec_fetch_sizes_merge(struct obj_ec_io *eio)
+{
+	unsigned int	shard;
+	int		i;
+
+	for (i = 0; i < eio->eio_nr; i++)
+		eio->eio_iods[i].iod_size = 0;
+
+	for (shard = 0; shard < eio->eio_k + eio->eio_p; shard++) {
+		struct obj_ec_shard_io *sio = &eio->eio_shards[shard];
+
+		for (i = 0; i < sio->es_nr; i++) {
+			daos_iod_t *iod = &eio->eio_iods[sio->es_iod_map[i]];
+
+			if (iod->iod_size < sio->es_iods[i].iod_size)
+				iod->iod_size = sio->es_iods[i].iod_size;
+		}
+	}
+}
+
+/**
+ * Regenerate the data of the unavailable shards into the user buffers, and
+ * return the record sizes of the shards to the user iods.
+ */
+int
+obj_ec_fetch_complete(struct obj_ec_io *eio)
+{
+	struct ec_walk	 ew;
+	unsigned char	*cells[DAOS_EC_CELLS_MAX];
+	uint32_t	 lost;
+	int		 i;
+	int		 j;
+	int		 rc;
+
+	D_ASSERT(!eio->eio_update);
+	if (eio->eio_size_only) {
+		ec_fetch_sizes_merge(eio);
+		for (i = 0; eio->eio_sgls != NULL && i < eio->eio_nr; i++)
+			eio->eio_sgls[i].sg_nr_out = 0;
+		return 0;
+	}
+
+	/* NB: the stripe geometry depends on the requested record sizes,
+	 * so the sizes can only be merged after recovery.
+	 */
+	if (eio->eio_stripe_nr > 0) {
+		lost = ((1ULL << (eio->eio_k + eio->eio_p)) - 1) &
+		       ~eio->eio_recov;
+		for (i = 0; i < eio->eio_stripe_nr; i++) {
+			struct obj_ec_stripe	*st = &eio->eio_stripes[i];
+			daos_iod_t		*iod = &eio->eio_iods[st->st_iod];
+			unsigned int		 len;
+
+			len = ec_cell_recs(eio, iod) * iod->iod_size;
+			for (j = 0; j < eio->eio_k + eio->eio_p; j++)
+				cells[j] = st->st_buf + j * len;
+
+			rc = daos_ec_decode(eio->eio_codec, len, cells, lost);
+			if (rc != 0)
+				return rc;
+		}
+
+		memset(&ew, 0, sizeof(ew));
+		ew.ew_eio = eio;
+		rc = ec_iods_walk(&ew, EC_WALK_SCATTER);
+		if (rc != 0)
+			return rc;
+	}
+
+	ec_fetch_sizes_merge(eio);
+	for (i = 0; i < eio->eio_nr; i++) {
+		daos_sg_list_t *sgl = &eio->eio_sgls[i];
+
+		sgl->sg_nr_out = eio->eio_iods[i].iod_size == 0 ? 0 :
+				 sgl->sg_nr;
+	}
+	return 0;
+}
+
+/** Return the I/O descriptors of shard @idx of the group, NULL if unused */
+struct obj_ec_shard_io *
+obj_ec_shard_io(struct obj_ec_io *eio, unsigned int idx)
+{
+	if (idx >= eio->eio_k + eio->eio_p || eio->eio_shards[idx].es_nr == 0)
+		return NULL;
+
+	return &eio->eio_shards[idx];
+}
+
+void
+obj_ec_io_free(struct obj_ec_io *eio)
+{
+	int	i;
+
+	for (i = 0; i < eio->eio_k + eio->eio_p; i++) {
+		if (eio->eio_shards[i].es_iods != NULL)
+			D_FREE(eio->eio_shards[i].es_iods);
+	}
+
+	if (eio->eio_rmw_iods != NULL)
+		D_FREE(eio->eio_rmw_iods);
+	if (eio->eio_buf != NULL)
+		D_FREE(eio->eio_buf);
+	if (eio->eio_stripes != NULL)
+		D_FREE(eio->eio_stripes);
+	D_FREE_PTR(eio);
+}
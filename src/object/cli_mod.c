@@ -49,7 +49,13 @@ dc_obj_init(void)
 		cli_bypass_rpc = true;
 	}
 
+	rc = obj_class_init();
+	if (rc != 0)
+		return rc;
+
 	rc = daos_rpc_register(daos_obj_rpcs, NULL, DAOS_OBJ_MODULE);
+	if (rc != 0)
+		obj_class_fini();
 	return rc;
 }
 
@@ -60,4 +66,5 @@ void
 dc_obj_fini(void)
 {
 	daos_rpc_unregister(daos_obj_rpcs);
+	obj_class_fini();
 }
@@ -30,6 +30,7 @@
 #include <daos/object.h>
 #include <daos/container.h>
 #include <daos/pool.h>
+#include <daos/task.h>
 #include <daos_task.h>
 #include <daos_types.h>
 #include "obj_rpc.h"
@@ -417,6 +418,41 @@ obj_dkeyhash2update_grp(struct dc_object *obj, uint64_t hash, uint32_t map_ver,
 	return 0;
 }
 
+/*
+ * Data shards of an erasure coded object only store the keys of the records
+ * they hold, the complete key space is on every parity shard. Return the first
+ * available parity shard of the group of shard @idx.
+ */
+static int
+obj_ec_key_shard_get(struct dc_object *obj, int idx, unsigned int k,
+		     unsigned int map_ver)
+{
+	int	grp_size;
+	int	idx_first;
+	int	i;
+
+	grp_size = obj_get_grp_size(obj);
+	idx_first = (idx / grp_size) * grp_size;
+
+	D_RWLOCK_RDLOCK(&obj->cob_lock);
+	if (obj->cob_layout->ol_ver != map_ver) {
+		D_RWLOCK_UNLOCK(&obj->cob_lock);
+		return -DER_STALE;
+	}
+
+	for (i = idx_first + k; i < idx_first + grp_size; i++) {
+		if (obj->cob_layout->ol_shards[i].po_shard != -1 &&
+		    !obj->cob_layout->ol_shards[i].po_rebuilding)
+			break;
+	}
+	D_RWLOCK_UNLOCK(&obj->cob_lock);
+
+	if (i == idx_first + grp_size)
+		return -DER_NONEXIST;
+
+	return i;
+}
+
 static void
 obj_ptr2shards(struct dc_object *obj, uint32_t *start_shard,
 	       uint32_t *shard_nr)
@@ -750,6 +786,8 @@ struct obj_auxi_args {
 	int		 result;
 	d_list_t	 shard_task_head;
 	tse_task_t	*obj_task;
+	/* shard I/O descriptors of erasure coded object */
+	struct obj_ec_io *ec_io;
 };
 
 /* shard update/punch auxiliary args, must be the first field of
@@ -761,6 +799,11 @@ struct shard_auxi_args {
 	uint32_t		 shard;
 	uint32_t		 target;
 	uint32_t		 map_ver;
+	/**
+	 * group size of an update sent to the leader replica and forwarded
+	 * by the server to the other replicas, zero for a shard I/O.
+	 */
+	uint32_t		 fw_grp_size;
 };
 
 struct obj_list_arg {
@@ -778,6 +821,10 @@ struct shard_update_args {
 	unsigned int		 nr;
 	daos_iod_t		*iods;
 	daos_sg_list_t		*sgls;
+	/* other replicas of a forwarded update, see shard_update_fwd_prep() */
+	uint32_t		 fw_flags;
+	unsigned int		 fw_cnt;
+	struct obj_shard_tgt	*fw_tgts;
 };
 
 static int
@@ -817,6 +864,25 @@ shard_task_remove(tse_task_t *task, void *arg)
 	return 0;
 }
 
+/**
+ * Release shard tasks and I/O descriptors of erasure coded object, unless
+ * they are reused by retried update.
+ */
+static void
+obj_ec_io_cleanup(struct obj_auxi_args *obj_auxi, bool io_retry)
+{
+	d_list_t	*head = &obj_auxi->shard_task_head;
+
+	if (io_retry && obj_auxi->io_retry &&
+	    obj_auxi->opc == DAOS_OBJ_RPC_UPDATE && !d_list_empty(head))
+		return;
+
+	tse_task_list_traverse(head, shard_task_remove, NULL);
+	D_ASSERT(d_list_empty(head));
+	obj_ec_io_free(obj_auxi->ec_io);
+	obj_auxi->ec_io = NULL;
+}
+
 static void
 obj_list_dkey_cb(tse_task_t *task, struct obj_list_arg *arg, unsigned int opc)
 {
@@ -884,7 +950,10 @@ obj_comp_cb(tse_task_t *task, void *data)
 		break;
 	case DAOS_OBJ_RPC_FETCH:
 		obj = *((struct dc_object **)data);
-		break;
+		if (obj_auxi->ec_io == NULL)
+			break;
+		/* erasure coded fetch is sent by shard tasks like update */
+		/* fallthrough */
 	case DAOS_OBJ_RPC_UPDATE:
 	case DAOS_OBJ_RPC_PUNCH:
 	case DAOS_OBJ_RPC_PUNCH_DKEYS:
@@ -906,6 +975,10 @@ obj_comp_cb(tse_task_t *task, void *data)
 				obj_auxi->map_ver_req, obj_auxi->map_ver_reply);
 			obj_auxi->io_retry = 1;
 		}
+		if (obj_auxi->opc == DAOS_OBJ_RPC_FETCH &&
+		    !obj_auxi->io_retry && obj_auxi->result == 0)
+			obj_auxi->result =
+				obj_ec_fetch_complete(obj_auxi->ec_io);
 		break;
 	default:
 		D_ERROR("incorrect opc %#x.\n", obj_auxi->opc);
@@ -923,7 +996,9 @@ obj_comp_cb(tse_task_t *task, void *data)
 	else if (task->dt_result == 0)
 		task->dt_result = obj_auxi->result;
 
-	if (!io_retry && head != NULL) {
+	if (obj_auxi->ec_io != NULL) {
+		obj_ec_io_cleanup(obj_auxi, io_retry);
+	} else if (!io_retry && head != NULL) {
 		tse_task_list_traverse(head, shard_task_remove, NULL);
 		D_ASSERT(d_list_empty(head));
 	}
@@ -1031,64 +1106,79 @@ obj_iod_valid(unsigned int nr, daos_iod_t *iods, bool update)
 	return true;
 }
 
-int
-dc_obj_fetch(tse_task_t *task)
+static int
+shard_update_fwd_cb(tse_task_t *task, void *data)
 {
-	daos_obj_fetch_t	*args = dc_task_get_args(task);
-	struct obj_auxi_args	*obj_auxi;
-	struct dc_object	*obj;
+	struct shard_update_args *args = *((struct shard_update_args **)data);
+
+	if (args->fw_tgts != NULL) {
+		D_FREE(args->fw_tgts);
+		args->fw_cnt = 0;
+	}
+	return 0;
+}
+
+/**
+ * Choose the leader replica of a forwarded update and collect the other
+ * replicas of the redundancy group, the server of the leader forwards the
+ * update to them.
+ */
+static int
+shard_update_fwd_prep(tse_task_t *task, struct shard_update_args *args)
+{
+	struct dc_object	*obj = args->auxi.obj;
 	struct dc_obj_shard	*obj_shard;
-	int			 shard;
-	unsigned int		 map_ver;
-	uint64_t		 dkey_hash;
+	struct obj_shard_tgt	*tgt;
+	int			 grp_size = args->auxi.fw_grp_size;
+	int			 start;
+	int			 leader;
+	int			 i;
 	int			 rc;
 
-	if (args->dkey == NULL || args->dkey->iov_buf == NULL || args->nr == 0
-	    || !obj_iod_valid(args->nr, args->iods, false))
-		D_GOTO(out_task, rc = -DER_INVAL);
+	leader = obj_grp_valid_shard_get(obj, args->auxi.shard,
+					 args->auxi.map_ver,
+					 DAOS_OBJ_RPC_UPDATE);
+	if (leader < 0)
+		return leader;
 
-	obj = obj_hdl2ptr(args->oh);
-	if (obj == NULL)
-		D_GOTO(out_task, rc = -DER_NO_HDL);
+	args->auxi.shard = leader;
+	args->auxi.target = obj_shard2tgt(obj, leader);
 
-	obj_auxi = tse_task_stack_push(task, sizeof(*obj_auxi));
-	obj_auxi->opc = DAOS_OBJ_RPC_FETCH;
-	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
-				       sizeof(obj));
+	D_ALLOC(args->fw_tgts, (grp_size - 1) * sizeof(*args->fw_tgts));
+	if (args->fw_tgts == NULL)
+		return -DER_NOMEM;
+
+	args->fw_cnt = 0;
+	rc = tse_task_register_comp_cb(task, shard_update_fwd_cb, &args,
+				       sizeof(args));
 	if (rc != 0) {
-		/* NB: process_rc_cb() will release refcount in other cases */
-		obj_decref(obj);
-		D_GOTO(out_task, rc);
+		D_FREE(args->fw_tgts);
+		return rc;
 	}
 
-	rc = obj_ptr2pm_ver(obj, &map_ver);
-	if (rc)
-		D_GOTO(out_task, rc);
-
-	dkey_hash = obj_dkey2hash(args->dkey);
-	shard = obj_dkeyhash2shard(obj, dkey_hash, map_ver,
-				   DAOS_OPC_OBJ_UPDATE);
-	if (shard < 0)
-		D_GOTO(out_task, rc = shard);
-
-	rc = obj_shard_open(obj, shard, map_ver, &obj_shard);
-	if (rc != 0)
-		D_GOTO(out_task, rc);
+	start = (leader / grp_size) * grp_size;
+	for (i = start; i < start + grp_size; i++) {
+		if (i == leader)
+			continue;
 
-	obj_auxi->map_ver_req = map_ver;
-	obj_auxi->map_ver_reply = map_ver;
-	D_DEBUG(DB_IO, "fetch "DF_OID" shard %u\n",
-		DP_OID(obj->cob_md.omd_id), shard);
-	tse_task_stack_push_data(task, &dkey_hash, sizeof(dkey_hash));
-	rc = dc_obj_shard_fetch(obj_shard, args->epoch, args->dkey, args->nr,
-				args->iods, args->sgls, args->maps,
-				&obj_auxi->map_ver_reply, task);
-	obj_shard_close(obj_shard);
-	return rc;
+		rc = obj_shard_open(obj, i, args->auxi.map_ver, &obj_shard);
+		if (rc == -DER_NONEXIST) /* skip a failed target */
+			continue;
+		if (rc != 0)
+			return rc;
+
+		tgt = &args->fw_tgts[args->fw_cnt++];
+		tgt->st_rank	= obj_shard->do_rank;
+		tgt->st_shard	= i;
+		tgt->st_tag	= obj_shard_dkeyhash2tag(obj_shard,
+							 args->dkey_hash);
+		tgt->st_pad	= 0;
+		obj_shard_close(obj_shard);
+	}
 
-out_task:
-	tse_task_complete(task, rc);
-	return rc;
+	D_DEBUG(DB_IO, "update "DF_OID" leader %d forward to %u replicas\n",
+		DP_OID(obj->cob_md.omd_id), leader, args->fw_cnt);
+	return 0;
 }
 
 static int
@@ -1124,6 +1214,14 @@ shard_update_task(tse_task_t *task)
 		}
 	}
 
+	if (args->auxi.fw_grp_size != 0) {
+		rc = shard_update_fwd_prep(task, args);
+		if (rc != 0) {
+			tse_task_complete(task, rc);
+			return rc;
+		}
+	}
+
 	rc = obj_shard_open(obj, args->auxi.shard, args->auxi.map_ver,
 			    &obj_shard);
 	if (rc != 0) {
@@ -1138,8 +1236,9 @@ shard_update_task(tse_task_t *task)
 	tse_task_stack_push_data(task, &args->dkey_hash,
 				 sizeof(args->dkey_hash));
 	rc = dc_obj_shard_update(obj_shard, args->epoch, args->dkey, args->nr,
-				 args->iods, args->sgls, &args->auxi.map_ver,
-				 task);
+				 args->iods, args->sgls, args->fw_tgts,
+				 args->fw_cnt, args->fw_flags,
+				 &args->auxi.map_ver, task);
 
 	obj_shard_close(obj_shard);
 	return rc;
@@ -1188,8 +1287,13 @@ shard_task_sched(tse_task_t *task, void *arg)
 		 * Also retry the shard IO if it got retryable error last time.
 		 */
 		target = obj_shard2tgt(shard_auxi->obj, shard_auxi->shard);
+		/* Any replica of a forwarded update may have been moved by
+		 * the new pool map, so it is always resent to the group.
+		 */
 		if (obj_retry_error(task->dt_result) ||
-		    target != shard_auxi->target) {
+		    target != shard_auxi->target ||
+		    (shard_auxi->fw_grp_size != 0 &&
+		     map_ver != shard_auxi->map_ver)) {
 			D_DEBUG(DB_IO, "shard %d, dt_result %d, target %d @ "
 				"map_ver %d, target %d @ last_map_ver %d, "
 				"shard task %p to be re-scheduled.\n",
@@ -1234,17 +1338,397 @@ obj_shard_task_sched(struct obj_auxi_args *obj_auxi)
 		tse_task_complete(obj_auxi->obj_task, 0);
 }
 
+static int
+shard_fetch_task(tse_task_t *task)
+{
+	struct shard_update_args	*args;
+	struct dc_obj_shard		*obj_shard;
+	int				 rc;
+
+	args = tse_task_buf_embedded(task, sizeof(*args));
+	D_ASSERT(args->auxi.obj != NULL);
+
+	rc = obj_shard_open(args->auxi.obj, args->auxi.shard,
+			    args->auxi.map_ver, &obj_shard);
+	if (rc != 0) {
+		tse_task_complete(task, rc);
+		return rc;
+	}
+
+	tse_task_stack_push_data(task, &args->dkey_hash,
+				 sizeof(args->dkey_hash));
+	rc = dc_obj_shard_fetch(obj_shard, args->epoch, args->dkey, args->nr,
+				args->iods, args->sgls, NULL,
+				&args->auxi.map_ver, task);
+
+	obj_shard_close(obj_shard);
+	return rc;
+}
+
+/**
+ * Create a shard task for the object I/O of @obj_auxi and add it to the
+ * shard task list, it will be scheduled by obj_shard_task_sched().
+ */
+static int
+obj_shard_task_create(struct obj_auxi_args *obj_auxi, struct dc_object *obj,
+		      tse_task_func_t func, unsigned int shard,
+		      unsigned int map_ver, daos_epoch_t epoch,
+		      daos_key_t *dkey, uint64_t dkey_hash, unsigned int nr,
+		      daos_iod_t *iods, daos_sg_list_t *sgls,
+		      unsigned int fw_grp_size, uint32_t fw_flags)
+{
+	tse_task_t			*shard_task;
+	struct shard_update_args	*shard_arg;
+	int				 rc;
+
+	rc = tse_task_create(func, tse_task2sched(obj_auxi->obj_task), NULL,
+			     &shard_task);
+	if (rc != 0)
+		return rc;
+
+	shard_arg = tse_task_buf_embedded(shard_task, sizeof(*shard_arg));
+	shard_arg->epoch		= epoch;
+	shard_arg->dkey			= dkey;
+	shard_arg->dkey_hash		= dkey_hash;
+	shard_arg->nr			= nr;
+	shard_arg->iods			= iods;
+	shard_arg->sgls			= sgls;
+	shard_arg->fw_flags		= fw_flags;
+	shard_arg->fw_cnt		= 0;
+	shard_arg->fw_tgts		= NULL;
+	shard_arg->auxi.map_ver		= map_ver;
+	shard_arg->auxi.shard		= shard;
+	shard_arg->auxi.target		= obj_shard2tgt(obj, shard);
+	shard_arg->auxi.obj		= obj;
+	shard_arg->auxi.obj_auxi	= obj_auxi;
+	shard_arg->auxi.fw_grp_size	= fw_grp_size;
+
+	rc = tse_task_register_deps(obj_auxi->obj_task, 1, &shard_task);
+	if (rc != 0) {
+		tse_task_complete(shard_task, rc);
+		return rc;
+	}
+	/* decref and delete from head at shard_task_remove */
+	tse_task_addref(shard_task);
+	tse_task_list_add(shard_task, &obj_auxi->shard_task_head);
+	return 0;
+}
+
+/** Create the shard tasks of an erasure coded object I/O */
+static int
+obj_ec_shard_tasks_create(struct obj_auxi_args *obj_auxi,
+			  struct dc_object *obj, tse_task_func_t func,
+			  uint32_t start_shard, uint32_t grp_size,
+			  unsigned int map_ver, daos_epoch_t epoch,
+			  daos_key_t *dkey, uint64_t dkey_hash)
+{
+	struct obj_ec_shard_io	*sio;
+	int			 i;
+	int			 rc;
+
+	for (i = 0; i < grp_size; i++) {
+		sio = obj_ec_shard_io(obj_auxi->ec_io, i);
+		if (sio == NULL)
+			continue;
+
+		rc = obj_shard_task_create(obj_auxi, obj, func,
+					   start_shard + i, map_ver, epoch,
+					   dkey, dkey_hash, sio->es_nr,
+					   sio->es_iods, sio->es_sgls, 0, 0);
+		if (rc != 0)
+			return rc;
+	}
+	D_ASSERT(!d_list_empty(&obj_auxi->shard_task_head));
+	return 0;
+}
+
+/** Return the bitmap of the readable shards of a redundancy group */
+static int
+obj_ec_grp_avail(struct dc_object *obj, uint32_t start_shard,
+		 uint32_t grp_size, unsigned int map_ver, uint32_t *avail)
+{
+	struct pl_obj_shard	*shards;
+	int			 i;
+
+	D_RWLOCK_RDLOCK(&obj->cob_lock);
+	if (obj->cob_layout->ol_ver != map_ver) {
+		D_RWLOCK_UNLOCK(&obj->cob_lock);
+		return -DER_STALE;
+	}
+
+	*avail = 0;
+	shards = &obj->cob_layout->ol_shards[start_shard];
+	for (i = 0; i < grp_size; i++) {
+		if (shards[i].po_shard != -1 && shards[i].po_target != -1 &&
+		    !shards[i].po_rebuilding)
+			*avail |= 1U << i;
+	}
+	D_RWLOCK_UNLOCK(&obj->cob_lock);
+
+	/* the fail value is the bitmap of the shards to be unavailable */
+	if (DAOS_FAIL_CHECK(DAOS_OBJ_EC_LOST_SHARDS))
+		*avail &= ~(uint32_t)daos_fail_value_get();
+	return 0;
+}
+
+static int
+obj_ec_fetch(tse_task_t *task, struct dc_object *obj,
+	     struct obj_auxi_args *obj_auxi, struct daos_ec_codec *codec,
+	     unsigned int map_ver, uint64_t dkey_hash)
+{
+	daos_obj_fetch_t	*args = dc_task_get_args(task);
+	uint32_t		 start_shard;
+	uint32_t		 grp_size;
+	uint32_t		 avail;
+	int			 rc;
+
+	rc = obj_dkeyhash2update_grp(obj, dkey_hash, map_ver, &start_shard,
+				     &grp_size);
+	if (rc != 0)
+		return rc;
+
+	rc = obj_ec_grp_avail(obj, start_shard, grp_size, map_ver, &avail);
+	if (rc != 0)
+		return rc;
+
+	rc = obj_ec_fetch_prep(&obj_auxi->ec_io,
+			       daos_oclass_attr_find(obj->cob_md.omd_id),
+			       codec, args->nr, args->iods, args->sgls, avail);
+	if (rc != 0)
+		return rc;
+
+	D_DEBUG(DB_IO, "EC fetch "DF_OID" start %u avail %#x\n",
+		DP_OID(obj->cob_md.omd_id), start_shard, avail);
+	rc = obj_ec_shard_tasks_create(obj_auxi, obj, shard_fetch_task,
+				       start_shard, grp_size, map_ver,
+				       args->epoch, args->dkey, dkey_hash);
+	if (rc != 0)
+		return rc;
+
+	obj_shard_task_sched(obj_auxi);
+	return 0;
+}
+
 int
-dc_obj_update(tse_task_t *task)
+dc_obj_fetch(tse_task_t *task)
+{
+	daos_obj_fetch_t	*args = dc_task_get_args(task);
+	struct obj_auxi_args	*obj_auxi;
+	struct dc_object	*obj;
+	struct dc_obj_shard	*obj_shard;
+	struct daos_ec_codec	*codec;
+	d_list_t		*head = NULL;
+	int			 shard;
+	unsigned int		 map_ver;
+	uint64_t		 dkey_hash;
+	int			 rc;
+
+	if (args->dkey == NULL || args->dkey->iov_buf == NULL || args->nr == 0
+	    || !obj_iod_valid(args->nr, args->iods, false))
+		D_GOTO(out_task, rc = -DER_INVAL);
+
+	obj = obj_hdl2ptr(args->oh);
+	if (obj == NULL)
+		D_GOTO(out_task, rc = -DER_NO_HDL);
+
+	obj_auxi = tse_task_stack_push(task, sizeof(*obj_auxi));
+	obj_auxi->opc = DAOS_OBJ_RPC_FETCH;
+	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
+				       sizeof(obj));
+	if (rc != 0) {
+		/* NB: process_rc_cb() will release refcount in other cases */
+		obj_decref(obj);
+		D_GOTO(out_task, rc);
+	}
+
+	rc = obj_ptr2pm_ver(obj, &map_ver);
+	if (rc)
+		D_GOTO(out_task, rc);
+
+	dkey_hash = obj_dkey2hash(args->dkey);
+	codec = obj_ec_codec_get(obj->cob_md.omd_id);
+	if (codec != NULL) {
+		if (args->maps != NULL)
+			D_GOTO(out_task, rc = -DER_NOSYS);
+
+		/* shard tasks of erasure coded fetch are never reused */
+		obj_auxi->io_retry = 0;
+		obj_auxi->map_ver_req = map_ver;
+		obj_auxi->obj_task = task;
+		head = &obj_auxi->shard_task_head;
+		D_INIT_LIST_HEAD(head);
+		rc = obj_ec_fetch(task, obj, obj_auxi, codec, map_ver,
+				  dkey_hash);
+		if (rc != 0)
+			D_GOTO(out_task, rc);
+		return 0;
+	}
+
+	shard = obj_dkeyhash2shard(obj, dkey_hash, map_ver,
+				   DAOS_OPC_OBJ_UPDATE);
+	if (shard < 0)
+		D_GOTO(out_task, rc = shard);
+
+	rc = obj_shard_open(obj, shard, map_ver, &obj_shard);
+	if (rc != 0)
+		D_GOTO(out_task, rc);
+
+	obj_auxi->map_ver_req = map_ver;
+	obj_auxi->map_ver_reply = map_ver;
+	D_DEBUG(DB_IO, "fetch "DF_OID" shard %u\n",
+		DP_OID(obj->cob_md.omd_id), shard);
+	tse_task_stack_push_data(task, &dkey_hash, sizeof(dkey_hash));
+	rc = dc_obj_shard_fetch(obj_shard, args->epoch, args->dkey, args->nr,
+				args->iods, args->sgls, args->maps,
+				&obj_auxi->map_ver_reply, task);
+	obj_shard_close(obj_shard);
+	return rc;
+
+out_task:
+	if (head == NULL || d_list_empty(head))
+		tse_task_complete(task, rc);
+	else
+		tse_task_list_traverse(head, shard_task_abort, &rc);
+	return rc;
+}
+
+/* arguments of the task generating parity of partially updated stripes */
+struct obj_ec_rmw_args {
+	struct obj_auxi_args	*obj_auxi;
+	struct dc_object	*obj;
+	daos_obj_update_t	*api_args;
+	uint64_t		 dkey_hash;
+	uint32_t		 start_shard;
+	uint32_t		 grp_size;
+	uint32_t		 map_ver;
+};
+
+static int
+obj_ec_rmw_task(tse_task_t *task)
+{
+	struct obj_ec_rmw_args	*args;
+	struct obj_auxi_args	*obj_auxi;
+	d_list_t		*head;
+	int			 rc;
+
+	args = tse_task_buf_embedded(task, sizeof(*args));
+	obj_auxi = args->obj_auxi;
+	head = &obj_auxi->shard_task_head;
+
+	/* failure of the stripe fetch */
+	rc = task->dt_result;
+	if (rc == 0)
+		rc = obj_ec_update_encode(obj_auxi->ec_io);
+	if (rc == 0)
+		rc = obj_ec_shard_tasks_create(obj_auxi, args->obj,
+					       shard_update_task,
+					       args->start_shard,
+					       args->grp_size, args->map_ver,
+					       args->api_args->epoch,
+					       args->api_args->dkey,
+					       args->dkey_hash);
+	if (rc == 0)
+		obj_shard_task_sched(obj_auxi);
+	else if (!d_list_empty(head))
+		tse_task_list_traverse(head, shard_task_abort, &rc);
+
+	tse_task_complete(task, rc);
+	return rc;
+}
+
+/**
+ * Split update of erasure coded object into shard tasks. If some stripes are
+ * partially updated, they are fetched first, then parity is generated and
+ * the shard tasks are created by obj_ec_rmw_task().
+ */
+static int
+obj_ec_update(tse_task_t *task, struct dc_object *obj,
+	      struct obj_auxi_args *obj_auxi, struct daos_ec_codec *codec,
+	      uint32_t start_shard, uint32_t grp_size, unsigned int map_ver,
+	      uint64_t dkey_hash)
 {
 	daos_obj_update_t	*args = dc_task_get_args(task);
 	tse_sched_t		*sched = tse_task2sched(task);
+	struct obj_ec_rmw_args	*rmw_args;
+	tse_task_t		*fetch_task;
+	tse_task_t		*rmw_task;
+	unsigned int		 nr;
+	daos_iod_t		*iods;
+	daos_sg_list_t		*sgls;
+	int			 rc;
+
+	rc = obj_ec_update_prep(&obj_auxi->ec_io,
+				daos_oclass_attr_find(obj->cob_md.omd_id),
+				codec, args->nr, args->iods, args->sgls);
+	if (rc != 0)
+		return rc;
+
+	if (!obj_ec_update_need_rmw(obj_auxi->ec_io, &nr, &iods, &sgls)) {
+		rc = obj_ec_update_encode(obj_auxi->ec_io);
+		if (rc != 0)
+			return rc;
+
+		rc = obj_ec_shard_tasks_create(obj_auxi, obj,
+					       shard_update_task, start_shard,
+					       grp_size, map_ver, args->epoch,
+					       args->dkey, dkey_hash);
+		if (rc != 0)
+			return rc;
+
+		obj_shard_task_sched(obj_auxi);
+		return 0;
+	}
+
+	D_DEBUG(DB_IO, "EC update "DF_OID" reads %u akeys for RMW\n",
+		DP_OID(obj->cob_md.omd_id), nr);
+	rc = dc_obj_fetch_task_create(args->oh, args->epoch, args->dkey, nr,
+				      iods, sgls, NULL, NULL, sched,
+				      &fetch_task);
+	if (rc != 0)
+		return rc;
+
+	rc = tse_task_create(obj_ec_rmw_task, sched, NULL, &rmw_task);
+	if (rc != 0) {
+		dc_task_decref(fetch_task);
+		return rc;
+	}
+
+	rmw_args = tse_task_buf_embedded(rmw_task, sizeof(*rmw_args));
+	rmw_args->obj_auxi	= obj_auxi;
+	rmw_args->obj		= obj;
+	rmw_args->api_args	= args;
+	rmw_args->dkey_hash	= dkey_hash;
+	rmw_args->start_shard	= start_shard;
+	rmw_args->grp_size	= grp_size;
+	rmw_args->map_ver	= map_ver;
+
+	rc = tse_task_register_deps(rmw_task, 1, &fetch_task);
+	if (rc == 0)
+		rc = tse_task_register_deps(task, 1, &rmw_task);
+	if (rc != 0) {
+		tse_task_complete(fetch_task, rc);
+		tse_task_complete(rmw_task, rc);
+		return rc;
+	}
+
+	tse_task_schedule(rmw_task, false);
+	/* ignore returned value, error is reported to the RMW task */
+	dc_task_schedule(fetch_task, true);
+	return 0;
+}
+
+int
+dc_obj_update(tse_task_t *task)
+{
+	daos_obj_update_t	*args = dc_task_get_args(task);
 	struct obj_auxi_args	*obj_auxi;
 	struct dc_object	*obj;
+	struct daos_ec_codec	*codec;
 	d_list_t		*head = NULL;
 	unsigned int		shard;
 	unsigned int		shards_cnt;
 	unsigned int		map_ver;
+	unsigned int		method;
 	uint64_t		dkey_hash;
 	int			i;
 	int			rc;
@@ -1259,8 +1743,14 @@ dc_obj_update(tse_task_t *task)
 		goto out_task;
 	}
 
+	codec = obj_ec_codec_get(obj->cob_md.omd_id);
 	obj_auxi = tse_task_stack_push(task, sizeof(*obj_auxi));
 	obj_auxi->opc = DAOS_OBJ_RPC_UPDATE;
+	/* erasure coded update is planned again if the shard tasks have been
+	 * released, see obj_ec_io_cleanup().
+	 */
+	if (codec != NULL && obj_auxi->ec_io == NULL)
+		obj_auxi->io_retry = 0;
 	shard_task_list_init(obj_auxi);
 	rc = tse_task_register_comp_cb(task, obj_comp_cb, &obj,
 				       sizeof(obj));
@@ -1289,37 +1779,39 @@ dc_obj_update(tse_task_t *task)
 	/* for retried obj IO, reuse the previous shard tasks and resched it */
 	if (obj_auxi->io_retry)
 		goto task_sched;
-	for (i = 0; i < shards_cnt; i++, shard++) {
-		tse_task_t			*shard_task;
-		struct shard_update_args	*shard_arg;
+	if (codec != NULL) {
+		rc = obj_ec_update(task, obj, obj_auxi, codec, shard,
+				   shards_cnt, map_ver, dkey_hash);
+		if (rc != 0)
+			goto out_task;
+		return 0;
+	}
 
-		rc = tse_task_create(shard_update_task, sched, NULL,
-				     &shard_task);
+	method = obj_repl_method(obj->cob_md.omd_id);
+	if (method != DAOS_REPL_CLIENT && shards_cnt > 1) {
+		/* Only send the update to one replica (spread by dkey), its
+		 * server forwards the data to the other replicas, so the
+		 * client only sends the payload once.
+		 */
+		rc = obj_shard_task_create(obj_auxi, obj, shard_update_task,
+					   shard + dkey_hash % shards_cnt,
+					   map_ver, args->epoch, args->dkey,
+					   dkey_hash, args->nr, args->iods,
+					   args->sgls, shards_cnt,
+					   method == DAOS_REPL_FWD_CHAIN ?
+					   ORF_FWD_CHAIN : 0);
 		if (rc != 0)
 			goto out_task;
+		goto task_sched;
+	}
 
-		shard_arg = tse_task_buf_embedded(shard_task,
-						  sizeof(*shard_arg));
-		shard_arg->epoch		= args->epoch;
-		shard_arg->dkey			= args->dkey;
-		shard_arg->dkey_hash		= dkey_hash;
-		shard_arg->nr			= args->nr;
-		shard_arg->iods			= args->iods;
-		shard_arg->sgls			= args->sgls;
-		shard_arg->auxi.map_ver		= map_ver;
-		shard_arg->auxi.shard		= shard;
-		shard_arg->auxi.target		= obj_shard2tgt(obj, shard);
-		shard_arg->auxi.obj		= obj;
-		shard_arg->auxi.obj_auxi	= obj_auxi;
-
-		rc = tse_task_register_deps(task, 1, &shard_task);
-		if (rc != 0) {
-			tse_task_complete(shard_task, rc);
+	for (i = 0; i < shards_cnt; i++, shard++) {
+		rc = obj_shard_task_create(obj_auxi, obj, shard_update_task,
+					   shard, map_ver, args->epoch,
+					   args->dkey, dkey_hash, args->nr,
+					   args->iods, args->sgls, 0, 0);
+		if (rc != 0)
 			goto out_task;
-		}
-		/* decref and delete from head at shard_task_remove */
-		tse_task_addref(shard_task);
-		tse_task_list_add(shard_task, head);
 	}
 
 task_sched:
@@ -1337,7 +1829,7 @@ out_task:
 static int
 dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 		     daos_key_t *dkey, daos_key_t *akey,
-		     daos_iod_type_t type, daos_size_t *size,
+		     daos_iod_type_t type, uint32_t flags, daos_size_t *size,
 		     uint32_t *nr, daos_key_desc_t *kds,
 		     daos_sg_list_t *sgl, daos_recx_t *recxs,
 		     daos_epoch_range_t *eprs, daos_anchor_t *anchor,
@@ -1349,6 +1841,7 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 	struct obj_auxi_args	*obj_auxi;
 	unsigned int		 map_ver;
 	struct obj_list_arg	 list_args;
+	struct daos_ec_codec	*codec;
 	uint64_t		 dkey_hash;
 	int			 shard;
 	int			 rc;
@@ -1381,6 +1874,13 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 	if (rc)
 		D_GOTO(out_task, rc);
 
+	codec = obj_ec_codec_get(obj->cob_md.omd_id);
+	if (codec != NULL && (op == DAOS_OBJ_RECX_RPC_ENUMERATE ||
+			      op == DAOS_OBJ_RPC_ENUMERATE)) {
+		D_DEBUG(DB_IO, "Can't enumerate records of EC object\n");
+		D_GOTO(out_task, rc = -DER_NOSYS);
+	}
+
 	if (dkey == NULL) {
 		if (op != DAOS_OBJ_DKEY_RPC_ENUMERATE &&
 		    op != DAOS_OBJ_RPC_ENUMERATE) {
@@ -1389,14 +1889,28 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 		}
 
 		shard = dc_obj_anchor2shard(dkey_anchor);
-		shard = obj_grp_valid_shard_get(obj, shard, map_ver, op);
+		if (codec != NULL)
+			shard = obj_ec_key_shard_get(obj, shard, codec->ec_k,
+						     map_ver);
+		else
+			shard = obj_grp_valid_shard_get(obj, shard, map_ver,
+							op);
 		if (shard < 0)
 			D_GOTO(out_task, rc = shard);
 
 		dc_obj_shard2anchor(dkey_anchor, shard);
 	} else {
 		dkey_hash = obj_dkey2hash(dkey);
-		shard = obj_dkeyhash2shard(obj, dkey_hash, map_ver, op);
+		if (codec != NULL) {
+			shard = obj_dkey2grp(obj, dkey_hash, map_ver);
+			if (shard >= 0)
+				shard = obj_ec_key_shard_get(obj,
+					shard * obj_get_grp_size(obj),
+					codec->ec_k, map_ver);
+		} else {
+			shard = obj_dkeyhash2shard(obj, dkey_hash, map_ver,
+						   op);
+		}
 		if (shard < 0)
 			D_GOTO(out_task, rc = shard);
 
@@ -1411,7 +1925,7 @@ dc_obj_list_internal(daos_handle_t oh, uint32_t op, daos_epoch_t epoch,
 	obj_auxi->map_ver_req = map_ver;
 	obj_auxi->map_ver_reply = map_ver;
 	rc = dc_obj_shard_list(obj_shard, op, epoch, dkey, akey, type,
-			       size, nr, kds, sgl, recxs, eprs, anchor,
+			       flags, size, nr, kds, sgl, recxs, eprs, anchor,
 			       dkey_anchor, akey_anchor,
 			       &obj_auxi->map_ver_reply, task);
 
@@ -1435,12 +1949,27 @@ dc_obj_list_dkey(tse_task_t *task)
 	D_ASSERTF(args != NULL, "Task Argument OPC does not match DC OPC\n");
 
 	return dc_obj_list_internal(args->oh, DAOS_OBJ_DKEY_RPC_ENUMERATE,
-				    args->epoch, NULL, NULL, DAOS_IOD_NONE,
+				    args->epoch, NULL, NULL, DAOS_IOD_NONE, 0,
 				    NULL, args->nr, args->kds, args->sgl,
 				    NULL, NULL, NULL, args->anchor, NULL,
 				    true, task);
 }
 
+int
+dc_obj_list_dkey_val(tse_task_t *task)
+{
+	daos_obj_list_dkey_t	*args;
+
+	args = dc_task_get_args(task);
+	D_ASSERTF(args != NULL, "Task Argument OPC does not match DC OPC\n");
+
+	return dc_obj_list_internal(args->oh, DAOS_OBJ_DKEY_RPC_ENUMERATE,
+				    args->epoch, NULL, NULL, DAOS_IOD_NONE,
+				    OEF_LATEST_VALS, NULL, args->nr, args->kds,
+				    args->sgl, NULL, NULL, NULL, args->anchor,
+				    NULL, true, task);
+}
+
 int
 dc_obj_list_akey(tse_task_t *task)
 {
@@ -1451,9 +1980,9 @@ dc_obj_list_akey(tse_task_t *task)
 
 	return dc_obj_list_internal(args->oh, DAOS_OBJ_AKEY_RPC_ENUMERATE,
 				    args->epoch, args->dkey, NULL,
-				    DAOS_IOD_NONE, NULL, args->nr, args->kds,
-				    args->sgl, NULL, NULL, NULL, NULL,
-				    args->anchor, true, task);
+				    DAOS_IOD_NONE, 0, NULL, args->nr,
+				    args->kds, args->sgl, NULL, NULL, NULL,
+				    NULL, args->anchor, true, task);
 }
 
 int
@@ -1466,7 +1995,7 @@ dc_obj_list_obj(tse_task_t *task)
 
 	return dc_obj_list_internal(args->oh, DAOS_OBJ_RPC_ENUMERATE,
 				    args->epoch, args->dkey, args->akey,
-				    DAOS_IOD_NONE, args->size, args->nr,
+				    DAOS_IOD_NONE, 0, args->size, args->nr,
 				    args->kds, args->sgl, NULL, args->eprs,
 				    args->anchor, args->dkey_anchor,
 				    args->akey_anchor, true, task);
@@ -1482,7 +2011,7 @@ dc_obj_list_rec(tse_task_t *task)
 
 	return dc_obj_list_internal(args->oh, DAOS_OBJ_RECX_RPC_ENUMERATE,
 				    args->epoch, args->dkey, args->akey,
-				    args->type, args->size, args->nr,
+				    args->type, 0, args->size, args->nr,
 				    NULL, NULL, args->recxs, args->eprs,
 				    args->anchor, NULL, NULL, args->incr_order,
 				    task);
@@ -247,18 +247,6 @@ out:
 	return ret;
 }
 
-/**
- * XXX: Only use dkey to distribute the data among targets for
- * now, and eventually, it should use dkey + akey, but then
- * it means the I/O descriptor might needs to be split into
- * mulitple requests in obj_shard_rw()
- */
-static uint32_t
-obj_shard_dkeyhash2tag(struct dc_obj_shard *obj_shard, uint64_t hash)
-{
-	return hash % obj_shard->do_part_nr;
-}
-
 static int
 obj_shard_rw_bulk_prep(crt_rpc_t *rpc, unsigned int nr, daos_sg_list_t *sgls,
 		       tse_task_t *task)
@@ -319,8 +307,9 @@ obj_shard_ptr2pool(struct dc_obj_shard *shard)
 static int
 obj_shard_rw(struct dc_obj_shard *shard, enum obj_rpc_opc opc,
 	     daos_epoch_t epoch, daos_key_t *dkey, unsigned int nr,
-	     daos_iod_t *iods, daos_sg_list_t *sgls, unsigned int *map_ver,
-	     tse_task_t *task)
+	     daos_iod_t *iods, daos_sg_list_t *sgls,
+	     struct obj_shard_tgt *fw_tgts, unsigned int fw_cnt,
+	     uint32_t fw_flags, unsigned int *map_ver, tse_task_t *task)
 {
 	struct dc_pool	       *pool;
 	crt_rpc_t	       *req;
@@ -373,6 +362,11 @@ obj_shard_rw(struct dc_obj_shard *shard, enum obj_rpc_opc opc,
 	orw->orw_iods.ca_count = nr;
 	orw->orw_iods.ca_arrays = iods;
 
+	/* the other replicas of a forwarded update, see ds_obj_rw_fwd() */
+	orw->orw_flags = fw_flags;
+	orw->orw_shard_tgts.ca_count = fw_cnt;
+	orw->orw_shard_tgts.ca_arrays = fw_tgts;
+
 	total_len = daos_iods_len(iods, nr);
 	/* If it is read, let's try to get the size from sg list */
 	if (total_len == -1 && opc == DAOS_OBJ_RPC_FETCH)
@@ -542,11 +536,13 @@ out:
 int
 dc_obj_shard_update(struct dc_obj_shard *shard, daos_epoch_t epoch,
 		    daos_key_t *dkey, unsigned int nr, daos_iod_t *iods,
-		    daos_sg_list_t *sgls, unsigned int *map_ver,
-		    tse_task_t *task)
+		    daos_sg_list_t *sgls, struct obj_shard_tgt *fw_tgts,
+		    unsigned int fw_cnt, uint32_t fw_flags,
+		    unsigned int *map_ver, tse_task_t *task)
 {
 	return obj_shard_rw(shard, DAOS_OBJ_RPC_UPDATE, epoch, dkey,
-			    nr, iods, sgls, map_ver, task);
+			    nr, iods, sgls, fw_tgts, fw_cnt, fw_flags,
+			    map_ver, task);
 }
 
 int
@@ -556,7 +552,7 @@ dc_obj_shard_fetch(struct dc_obj_shard *shard, daos_epoch_t epoch,
 		   unsigned int *map_ver, tse_task_t *task)
 {
 	return obj_shard_rw(shard, DAOS_OBJ_RPC_FETCH, epoch, dkey,
-			    nr, iods, sgls, map_ver, task);
+			    nr, iods, sgls, NULL, 0, 0, map_ver, task);
 }
 
 struct obj_enum_args {
@@ -680,8 +676,8 @@ out:
 int
 dc_obj_shard_list(struct dc_obj_shard *obj_shard, unsigned int opc,
 		  daos_epoch_t epoch, daos_key_t *dkey, daos_key_t *akey,
-		  daos_iod_type_t type, daos_size_t *size, uint32_t *nr,
-		  daos_key_desc_t *kds, daos_sg_list_t *sgl,
+		  daos_iod_type_t type, uint32_t flags, daos_size_t *size,
+		  uint32_t *nr, daos_key_desc_t *kds, daos_sg_list_t *sgl,
 		  daos_recx_t *recxs, daos_epoch_range_t *eprs,
 		  daos_anchor_t *anchor, daos_anchor_t *dkey_anchor,
 		  daos_anchor_t *akey_anchor, unsigned int *map_ver,
@@ -741,6 +737,7 @@ dc_obj_shard_list(struct dc_obj_shard *obj_shard, unsigned int opc,
 	oei->oei_epoch = epoch;
 	oei->oei_nr = *nr;
 	oei->oei_rec_type = type;
+	oei->oei_flags = flags;
 
 	if (anchor != NULL)
 		enum_anchor_copy_hkey(&oei->oei_anchor, anchor);
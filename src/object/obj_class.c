@@ -32,6 +32,8 @@ struct daos_obj_class {
 	/** unique class ID */
 	daos_oclass_id_t		 oc_id;
 	struct daos_oclass_attr		 oc_attr;
+	/** codec of erasure coded class, initialized by obj_class_init */
+	struct daos_ec_codec		 oc_codec;
 };
 
 /** predefined object classes */
@@ -203,15 +205,113 @@ static struct daos_obj_class daos_obj_classes[] = {
 			},
 		},
 	},
+	{
+		.oc_name	= "ec_k2p1_rw",
+		.oc_id		= DAOS_OC_EC_K2P1_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_EC,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.ec			= {
+				.e_grp_size	= 3,
+				.e_k		= 2,
+				.e_p		= 1,
+				.e_len		= OBJ_EC_CELL_SIZE,
+			},
+		},
+	},
+	{
+		.oc_name	= "ec_k4p1_rw",
+		.oc_id		= DAOS_OC_EC_K4P1_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_EC,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.ec			= {
+				.e_grp_size	= 5,
+				.e_k		= 4,
+				.e_p		= 1,
+				.e_len		= OBJ_EC_CELL_SIZE,
+			},
+		},
+	},
+	{
+		.oc_name	= "ec_k4p2_rw",
+		.oc_id		= DAOS_OC_EC_K4P2_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_EC,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.ec			= {
+				.e_grp_size	= 6,
+				.e_k		= 4,
+				.e_p		= 2,
+				.e_len		= OBJ_EC_CELL_SIZE,
+			},
+		},
+	},
+	{
+		.oc_name	= "ec_k8p2_rw",
+		.oc_id		= DAOS_OC_EC_K8P2_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_EC,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.ec			= {
+				.e_grp_size	= 10,
+				.e_k		= 8,
+				.e_p		= 2,
+				.e_len		= OBJ_EC_CELL_SIZE,
+			},
+		},
+	},
+	{
+		.oc_name	= "repl_2_fwd_rw",
+		.oc_id		= DAOS_OC_R2_FWD_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_REPL,
+			.ca_grp_nr		= DAOS_OBJ_GRP_MAX,
+			.u.repl			= {
+				.r_method	= DAOS_REPL_FWD_FANOUT,
+				.r_num		= 2,
+			},
+		},
+	},
+	{
+		.oc_name	= "repl_3_fwd_rw",
+		.oc_id		= DAOS_OC_R3_FWD_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_REPL,
+			.ca_grp_nr		= 2,
+			.u.repl			= {
+				.r_method	= DAOS_REPL_FWD_FANOUT,
+				.r_num		= 3,
+			},
+		},
+	},
+	{
+		.oc_name	= "repl_3_chain_rw",
+		.oc_id		= DAOS_OC_R3_CHAIN_RW,
+		{
+			.ca_schema		= DAOS_OS_STRIPED,
+			.ca_resil		= DAOS_RES_REPL,
+			.ca_grp_nr		= 2,
+			.u.repl			= {
+				.r_method	= DAOS_REPL_FWD_CHAIN,
+				.r_num		= 3,
+			},
+		},
+	},
 	{
 		.oc_name	= NULL,
 		.oc_id		= DAOS_OC_UNKNOWN,
 	},
 };
 
-/** find the object class attributes for the provided @oid */
-struct daos_oclass_attr *
-daos_oclass_attr_find(daos_obj_id_t oid)
+static struct daos_obj_class *
+obj_class_find(daos_obj_id_t oid)
 {
 	struct daos_obj_class	*oc;
 	daos_oclass_id_t	 ocid;
@@ -220,12 +320,21 @@ daos_oclass_attr_find(daos_obj_id_t oid)
 	ocid = daos_obj_id2class(oid);
 	for (oc = &daos_obj_classes[0]; oc->oc_id != DAOS_OC_UNKNOWN; oc++) {
 		if (oc->oc_id == ocid)
-			break;
+			return oc;
 	}
+	return NULL;
+}
 
-	if (oc->oc_id == DAOS_OC_UNKNOWN) {
+/** find the object class attributes for the provided @oid */
+struct daos_oclass_attr *
+daos_oclass_attr_find(daos_obj_id_t oid)
+{
+	struct daos_obj_class	*oc;
+
+	oc = obj_class_find(oid);
+	if (oc == NULL) {
 		D_DEBUG(DB_PL, "Unknown object class %d for "DF_OID"\n",
-			ocid, DP_OID(oid));
+			daos_obj_id2class(oid), DP_OID(oid));
 		return NULL;
 	}
 
@@ -281,3 +390,64 @@ daos_oclass_grp_nr(struct daos_oclass_attr *oc_attr, struct daos_obj_md *md)
 	/* NB: @md is unsupported for now */
 	return oc_attr->ca_grp_nr;
 }
+
+/** Return the erasure codec of object @oid, NULL if it is not erasure coded */
+struct daos_ec_codec *
+obj_ec_codec_get(daos_obj_id_t oid)
+{
+	struct daos_obj_class	*oc;
+
+	oc = obj_class_find(oid);
+	if (oc == NULL || oc->oc_attr.ca_resil != DAOS_RES_EC)
+		return NULL;
+
+	D_ASSERT(oc->oc_codec.ec_k != 0);
+	return &oc->oc_codec;
+}
+
+/** Return the replication method of object @oid, see daos_repl_method_t */
+unsigned int
+obj_repl_method(daos_obj_id_t oid)
+{
+	struct daos_obj_class	*oc;
+
+	oc = obj_class_find(oid);
+	if (oc == NULL || oc->oc_attr.ca_resil != DAOS_RES_REPL)
+		return DAOS_REPL_CLIENT;
+
+	return oc->oc_attr.u.repl.r_method;
+}
+
+void
+obj_class_fini(void)
+{
+	struct daos_obj_class	*oc;
+
+	for (oc = &daos_obj_classes[0]; oc->oc_id != DAOS_OC_UNKNOWN; oc++) {
+		if (oc->oc_attr.ca_resil == DAOS_RES_EC)
+			daos_ec_codec_fini(&oc->oc_codec);
+	}
+}
+
+/** Initialize the codecs of all erasure coded classes */
+int
+obj_class_init(void)
+{
+	struct daos_obj_class	*oc;
+	int			 rc;
+
+	for (oc = &daos_obj_classes[0]; oc->oc_id != DAOS_OC_UNKNOWN; oc++) {
+		if (oc->oc_attr.ca_resil != DAOS_RES_EC)
+			continue;
+
+		rc = daos_ec_codec_init(&oc->oc_codec, oc->oc_attr.u.ec.e_k,
+					oc->oc_attr.u.ec.e_p);
+		if (rc != 0) {
+			D_ERROR("Failed to initialize codec of class %s: %d\n",
+				oc->oc_name, rc);
+			obj_class_fini();
+			return rc;
+		}
+	}
+	return 0;
+}
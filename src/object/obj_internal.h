@@ -35,6 +35,7 @@
 #include <daos/placement.h>
 #include <daos/btree.h>
 #include <daos/btree_class.h>
+#include <daos/ec.h>
 #include <daos_srv/daos_server.h>
 #include <daos_types.h>
 
@@ -167,8 +168,32 @@ enum_anchor_set_tag(daos_anchor_t *anchor, uint32_t tag)
 extern struct dss_module_key obj_module_key;
 struct obj_tls {
 	d_sg_list_t	ot_echo_sgl;
+	/* Bulk handles of the registered DMA chunks, see obj_dma_bulk */
+	d_list_t	ot_dma_bulks;
 };
 
+/* Network registration of a per-xstream DMA chunk, cached in obj_tls */
+struct obj_dma_bulk {
+	d_list_t	 odb_link;
+	void		*odb_ptr;
+	size_t		 odb_sz;
+	crt_bulk_t	 odb_hdl;
+};
+
+/**
+ * XXX: Only use dkey to distribute the data among targets for
+ * now, and eventually, it should use dkey + akey, but then
+ * it means the I/O descriptor might needs to be split into
+ * mulitple requests in obj_shard_rw()
+ */
+static inline uint32_t
+obj_shard_dkeyhash2tag(struct dc_obj_shard *obj_shard, uint64_t hash)
+{
+	return hash % obj_shard->do_part_nr;
+}
+
+struct obj_shard_tgt;
+
 int dc_obj_shard_open(struct dc_object *obj, uint32_t tgt, daos_unit_oid_t id,
 		      unsigned int mode, struct dc_obj_shard **shard);
 void dc_obj_shard_close(struct dc_obj_shard *shard);
@@ -176,7 +201,9 @@ void dc_obj_shard_close(struct dc_obj_shard *shard);
 int dc_obj_shard_update(struct dc_obj_shard *shard, daos_epoch_t epoch,
 			daos_key_t *dkey, unsigned int nr,
 			daos_iod_t *iods, daos_sg_list_t *sgls,
-			unsigned int *map_ver, tse_task_t *task);
+			struct obj_shard_tgt *fw_tgts, unsigned int fw_cnt,
+			uint32_t fw_flags, unsigned int *map_ver,
+			tse_task_t *task);
 int dc_obj_shard_fetch(struct dc_obj_shard *shard, daos_epoch_t epoch,
 		       daos_key_t *dkey, unsigned int nr,
 		       daos_iod_t *iods, daos_sg_list_t *sgls,
@@ -186,8 +213,8 @@ int dc_obj_shard_fetch(struct dc_obj_shard *shard, daos_epoch_t epoch,
 int
 dc_obj_shard_list(struct dc_obj_shard *obj_shard, unsigned int opc,
 		  daos_epoch_t epoch, daos_key_t *dkey, daos_key_t *akey,
-		  daos_iod_type_t type, daos_size_t *size, uint32_t *nr,
-		  daos_key_desc_t *kds, daos_sg_list_t *sgl,
+		  daos_iod_type_t type, uint32_t flags, daos_size_t *size,
+		  uint32_t *nr, daos_key_desc_t *kds, daos_sg_list_t *sgl,
 		  daos_recx_t *recxs, daos_epoch_range_t *eprs,
 		  daos_anchor_t *anchor, daos_anchor_t  *dkey_anchor,
 		  daos_anchor_t  *akey_anchor, unsigned int *map_ver,
@@ -206,6 +233,47 @@ obj_retry_error(int err)
 	       daos_crt_network_error(err);
 }
 
+/* obj_class.c */
+int obj_class_init(void);
+void obj_class_fini(void);
+struct daos_ec_codec *obj_ec_codec_get(daos_obj_id_t oid);
+unsigned int obj_repl_method(daos_obj_id_t oid);
+
+/** Default cell size of the predefined erasure coded classes */
+#define OBJ_EC_CELL_SIZE	(1U << 16)
+/**
+ * Parity cells are stored under the same akey as data, the highest bit of
+ * the record index distinguishes them from data records.
+ */
+#define OBJ_EC_PARITY_BIT	(1ULL << 63)
+
+/* cli_ec.c */
+struct obj_ec_io;
+
+/** per-shard I/O descriptors of an erasure coded request */
+struct obj_ec_shard_io {
+	/** number of iods for this shard, zero if the shard is not involved */
+	unsigned int		 es_nr;
+	daos_iod_t		*es_iods;
+	daos_sg_list_t		*es_sgls;
+	/** index of the user iod each of \a es_iods is derived from */
+	unsigned int		*es_iod_map;
+};
+
+int obj_ec_update_prep(struct obj_ec_io **eiop, struct daos_oclass_attr *oca,
+		       struct daos_ec_codec *codec, unsigned int nr,
+		       daos_iod_t *iods, daos_sg_list_t *sgls);
+bool obj_ec_update_need_rmw(struct obj_ec_io *eio, unsigned int *nr,
+			    daos_iod_t **iods, daos_sg_list_t **sgls);
+int obj_ec_update_encode(struct obj_ec_io *eio);
+int obj_ec_fetch_prep(struct obj_ec_io **eiop, struct daos_oclass_attr *oca,
+		      struct daos_ec_codec *codec, unsigned int nr,
+		      daos_iod_t *iods, daos_sg_list_t *sgls, uint32_t avail);
+int obj_ec_fetch_complete(struct obj_ec_io *eio);
+struct obj_ec_shard_io *obj_ec_shard_io(struct obj_ec_io *eio,
+					unsigned int idx);
+void obj_ec_io_free(struct obj_ec_io *eio);
+
 void obj_shard_decref(struct dc_obj_shard *shard);
 void obj_shard_addref(struct dc_obj_shard *shard);
 void obj_addref(struct dc_object *obj);
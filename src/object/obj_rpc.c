@@ -30,6 +30,34 @@
 #include <daos/rpc.h>
 #include "obj_rpc.h"
 
+static int
+obj_proc_shard_tgt(crt_proc_t proc, struct obj_shard_tgt *st)
+{
+	int rc;
+
+	rc = crt_proc_uint32_t(proc, &st->st_rank);
+	if (rc != 0)
+		return -DER_HG;
+
+	rc = crt_proc_uint32_t(proc, &st->st_shard);
+	if (rc != 0)
+		return -DER_HG;
+
+	rc = crt_proc_uint32_t(proc, &st->st_tag);
+	if (rc != 0)
+		return -DER_HG;
+
+	rc = crt_proc_uint32_t(proc, &st->st_pad);
+	if (rc != 0)
+		return -DER_HG;
+
+	return 0;
+}
+
+static struct crt_msg_field DMF_SHARD_TGT_ARRAY =
+	DEFINE_CRT_MSG("obj_shard_tgt", CMF_ARRAY_FLAG,
+		       sizeof(struct obj_shard_tgt), obj_proc_shard_tgt);
+
 static struct crt_msg_field *obj_rw_in_fields[] = {
 	&DMF_OID,	/* object ID */
 	&CMF_UUID,	/* container handle uuid */
@@ -41,6 +69,9 @@ static struct crt_msg_field *obj_rw_in_fields[] = {
 	&DMF_IOD_ARRAY, /* I/O descriptor array */
 	&DMF_SGL_ARRAY, /* scatter/gather array */
 	&CMF_BULK_ARRAY,    /* BULK ARRAY */
+	&CMF_UINT32,	/* flags */
+	&CMF_UINT32,	/* pad */
+	&DMF_SHARD_TGT_ARRAY, /* forward targets */
 };
 
 static struct crt_msg_field *obj_rw_out_fields[] = {
@@ -60,7 +91,7 @@ static struct crt_msg_field *obj_key_enum_in_fields[] = {
 	&CMF_UINT32,	/* map_version */
 	&CMF_UINT32,	/* number of kds */
 	&CMF_UINT32,	/* list type SINGLE/ARRAY/NONE */
-	&CMF_UINT32,	/* pad  */
+	&CMF_UINT32,	/* flags */
 	&DMF_IOVEC,     /* dkey */
 	&DMF_IOVEC,     /* akey */
 	&DMF_ANCHOR,	/* hash anchor */
@@ -57,6 +57,39 @@ enum obj_rpc_opc {
 	DAOS_OBJ_RPC_PUNCH_AKEYS	= 9,
 };
 
+/** flags of obj_rw_in::orw_flags */
+enum obj_rw_flags {
+	/**
+	 * Forward the update to the first target of orw_shard_tgts only, which
+	 * forwards it to the rest (chain), instead of sending it to all of them
+	 * directly (fan-out).
+	 */
+	ORF_FWD_CHAIN		= (1 << 0),
+};
+
+/** flags of obj_key_enum_in::oei_flags */
+enum obj_enum_flags {
+	/**
+	 * DKEY enumeration only: pack the latest single value of each akey
+	 * after its dkey, see daos_obj_list_dkey_val().
+	 */
+	OEF_LATEST_VALS		= (1 << 0),
+};
+
+/** largest single value packed by an OEF_LATEST_VALS enumeration */
+#define OBJ_ENUM_VAL_MAX	(4 * 1024) /* 4KB bytes */
+
+/** a replica the update is forwarded to by the server */
+struct obj_shard_tgt {
+	/** rank of the replica */
+	uint32_t		st_rank;
+	/** shard index of the replica */
+	uint32_t		st_shard;
+	/** xstream (context tag) serving the dkey on that rank */
+	uint32_t		st_tag;
+	uint32_t		st_pad;
+};
+
 struct obj_rw_in {
 	daos_unit_oid_t		orw_oid;
 	uuid_t			orw_co_hdl;
@@ -68,6 +101,10 @@ struct obj_rw_in {
 	struct crt_array	orw_iods;
 	struct crt_array	orw_sgls;
 	struct crt_array	orw_bulks;
+	uint32_t		orw_flags;
+	uint32_t		orw_pad;
+	/** replicas the update should be forwarded to, see obj_shard_tgt */
+	struct crt_array	orw_shard_tgts;
 };
 
 /* reply for update/fetch */
@@ -89,7 +126,7 @@ struct obj_key_enum_in {
 	uint32_t		oei_map_ver;
 	uint32_t		oei_nr;
 	uint32_t		oei_rec_type;
-	uint32_t		oei_pad;
+	uint32_t		oei_flags;
 	daos_key_t		oei_dkey;
 	daos_key_t		oei_akey;
 	daos_anchor_t		oei_anchor;
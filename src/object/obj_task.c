@@ -221,6 +221,32 @@ dc_obj_list_dkey_task_create(daos_handle_t oh, daos_epoch_t epoch, uint32_t *nr,
 	return 0;
 }
 
+int
+dc_obj_list_dkey_val_task_create(daos_handle_t oh, daos_epoch_t epoch,
+				 uint32_t *nr, daos_key_desc_t *kds,
+				 daos_sg_list_t *sgl, daos_anchor_t *anchor,
+				 daos_event_t *ev, tse_sched_t *tse,
+				 tse_task_t **task)
+{
+	daos_obj_list_dkey_t	*args;
+	int			 rc;
+
+	DAOS_API_ARG_ASSERT(*args, OBJ_LIST_DKEY);
+	rc = dc_task_create(dc_obj_list_dkey_val, tse, ev, task);
+	if (rc)
+		return rc;
+
+	args = dc_task_get_args(*task);
+	args->oh	= oh;
+	args->epoch	= epoch;
+	args->nr	= nr;
+	args->kds	= kds;
+	args->sgl	= sgl;
+	args->anchor	= anchor;
+
+	return 0;
+}
+
 int
 dc_obj_list_akey_task_create(daos_handle_t oh, daos_epoch_t epoch,
 			     daos_key_t *dkey, uint32_t *nr,
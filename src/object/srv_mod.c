@@ -104,6 +104,8 @@ obj_tls_init(const struct dss_thread_local_storage *dtls,
 	struct obj_tls *tls;
 
 	D_ALLOC_PTR(tls);
+	if (tls != NULL)
+		D_INIT_LIST_HEAD(&tls->ot_dma_bulks);
 	return tls;
 }
 
@@ -111,11 +113,18 @@ static void
 obj_tls_fini(const struct dss_thread_local_storage *dtls,
 	     struct dss_module_key *key, void *data)
 {
-	struct obj_tls *tls = data;
+	struct obj_tls		*tls = data;
+	struct obj_dma_bulk	*odb, *tmp;
 
 	if (tls->ot_echo_sgl.sg_iovs != NULL)
 		daos_sgl_fini(&tls->ot_echo_sgl, true);
 
+	d_list_for_each_entry_safe(odb, tmp, &tls->ot_dma_bulks, odb_link) {
+		d_list_del(&odb->odb_link);
+		crt_bulk_free(odb->odb_hdl);
+		D_FREE_PTR(odb);
+	}
+
 	D_FREE_PTR(tls);
 }
 
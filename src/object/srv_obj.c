@@ -116,7 +116,7 @@ struct ds_bulk_async_args {
 };
 
 static int
-bulk_complete_cb(const struct crt_bulk_cb_info *cb_info)
+bulk_complete(const struct crt_bulk_cb_info *cb_info, bool free_local)
 {
 	struct ds_bulk_async_args	*arg;
 	struct crt_bulk_desc		*bulk_desc;
@@ -143,11 +143,79 @@ bulk_complete_cb(const struct crt_bulk_cb_info *cb_info)
 		ABT_eventual_set(arg->eventual, &arg->result,
 				 sizeof(arg->result));
 
-	crt_bulk_free(local_bulk_hdl);
+	if (free_local)
+		crt_bulk_free(local_bulk_hdl);
 	crt_req_decref(rpc);
 	return cb_info->bci_rc;
 }
 
+static int
+bulk_complete_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	return bulk_complete(cb_info, true);
+}
+
+/* The local bulk handle is a cached DMA chunk registration, keep it */
+static int
+bulk_dma_complete_cb(const struct crt_bulk_cb_info *cb_info)
+{
+	return bulk_complete(cb_info, false);
+}
+
+/**
+ * Get the bulk handle of the DMA chunk holding the NVMe IOV, the chunk is
+ * registered with the network on first use and the registration is cached
+ * per xstream, so the RDMA goes straight to the DMA buffer used by SPDK and
+ * large transfers don't register memory for every RPC.
+ */
+static crt_bulk_t
+obj_dma_bulk_get(crt_context_t ctx, struct eio_desc *eiod,
+		 struct eio_iov *eiov, daos_off_t *off)
+{
+	struct obj_tls		*tls = obj_tls_get();
+	struct obj_dma_bulk	*odb;
+	daos_sg_list_t		 sgl;
+	daos_iov_t		 iov;
+	void			*chk_ptr;
+	size_t			 chk_sz;
+	int			 rc;
+
+	rc = eio_iov2dma_chunk(eiod, eiov, &chk_ptr, &chk_sz);
+	if (rc)
+		return NULL;
+
+	d_list_for_each_entry(odb, &tls->ot_dma_bulks, odb_link) {
+		if (odb->odb_ptr == chk_ptr)
+			goto found;
+	}
+
+	D_ALLOC_PTR(odb);
+	if (odb == NULL)
+		return NULL;
+
+	daos_iov_set(&iov, chk_ptr, chk_sz);
+	sgl.sg_nr = 1;
+	sgl.sg_nr_out = 1;
+	sgl.sg_iovs = &iov;
+	rc = crt_bulk_create(ctx, daos2crt_sg(&sgl), CRT_BULK_RW,
+			     &odb->odb_hdl);
+	if (rc) {
+		D_ERROR("Register DMA chunk %p error (%d).\n", chk_ptr, rc);
+		D_FREE_PTR(odb);
+		return NULL;
+	}
+
+	D_DEBUG(DB_IO, "Registered DMA chunk %p size "DF_U64"\n", chk_ptr,
+		(uint64_t)chk_sz);
+	odb->odb_ptr = chk_ptr;
+	odb->odb_sz = chk_sz;
+	d_list_add(&odb->odb_link, &tls->ot_dma_bulks);
+found:
+	D_ASSERT(eiov->ei_buf >= odb->odb_ptr);
+	*off = eiov->ei_buf - odb->odb_ptr;
+	return odb->odb_hdl;
+}
+
 /**
  * Simulate bulk transfer by memcpy, all data are actually dropped.
  */
@@ -193,6 +261,7 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 		 daos_sg_list_t **sgls, int sgl_nr)
 {
 	struct ds_bulk_async_args arg = { 0 };
+	struct eio_desc		*eiod = NULL;
 	crt_bulk_opid_t		bulk_opid;
 	crt_bulk_perm_t		bulk_perm;
 	int			i, rc, *status, ret;
@@ -206,9 +275,12 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 
 	for (i = 0; i < sgl_nr; i++) {
 		daos_sg_list_t		*sgl, tmp_sgl;
+		struct eio_sglist	*esgl = NULL;
 		struct crt_bulk_desc	 bulk_desc;
 		crt_bulk_t		 local_bulk_hdl;
+		crt_bulk_cb_t		 complete_cb;
 		daos_size_t		 offset = 0;
+		daos_off_t		 local_off;
 		unsigned int		 idx = 0;
 
 		if (remote_bulks[i] == NULL)
@@ -217,9 +289,8 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 		if (sgls != NULL) {
 			sgl = sgls[i];
 		} else {
-			struct eio_sglist *esgl;
-
 			D_ASSERT(!daos_handle_is_inval(ioh));
+			eiod = vos_ioh2desc(ioh);
 			esgl = vos_iod_sgl_at(ioh, i);
 			D_ASSERT(esgl != NULL);
 
@@ -263,13 +334,36 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 				break;
 
 			start = idx;
+			local_off = 0;
+			local_bulk_hdl = NULL;
+			if (esgl != NULL &&
+			    esgl->es_iovs[idx].ei_addr.ea_type == EIO_ADDR_NVME)
+				local_bulk_hdl = obj_dma_bulk_get(rpc->cr_ctx,
+						eiod, &esgl->es_iovs[idx],
+						&local_off);
+
+			if (local_bulk_hdl != NULL) {
+				/* Transfer with the registered DMA chunk */
+				complete_cb = bulk_dma_complete_cb;
+				length = sgl->sg_iovs[idx].iov_len;
+				idx++;
+				goto transfer;
+			}
+
+			complete_cb = bulk_complete_cb;
 			sgl_sent.sg_iovs = &sgl->sg_iovs[start];
-			/* Find the end of the non-empty record */
-			while (sgl->sg_iovs[idx].iov_buf != NULL &&
-			       idx < sgl->sg_nr_out) {
+			/*
+			 * Find the end of the non-empty record, stop at the
+			 * NVMe record which can use the registered DMA chunk.
+			 */
+			do {
 				length += sgl->sg_iovs[idx].iov_len;
 				idx++;
-			}
+			} while (idx < sgl->sg_nr_out &&
+				 sgl->sg_iovs[idx].iov_buf != NULL &&
+				 (esgl == NULL ||
+				  esgl->es_iovs[idx].ei_addr.ea_type !=
+				  EIO_ADDR_NVME));
 
 			sgl_sent.sg_nr = idx - start;
 			sgl_sent.sg_nr_out = idx - start;
@@ -282,7 +376,7 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 					i, rc);
 				break;
 			}
-
+transfer:
 			crt_req_addref(rpc);
 
 			bulk_desc.bd_rpc	= rpc;
@@ -291,16 +385,17 @@ ds_bulk_transfer(crt_rpc_t *rpc, crt_bulk_op_t bulk_op,
 			bulk_desc.bd_local_hdl	= local_bulk_hdl;
 			bulk_desc.bd_len	= length;
 			bulk_desc.bd_remote_off	= offset;
-			bulk_desc.bd_local_off	= 0;
+			bulk_desc.bd_local_off	= local_off;
 
 			arg.bulks_inflight++;
-			rc = crt_bulk_transfer(&bulk_desc, bulk_complete_cb,
+			rc = crt_bulk_transfer(&bulk_desc, complete_cb,
 					       &arg, &bulk_opid);
 			if (rc < 0) {
 				D_ERROR("crt_bulk_transfer %d error (%d).\n",
 					i, rc);
 				arg.bulks_inflight--;
-				crt_bulk_free(local_bulk_hdl);
+				if (complete_cb == bulk_complete_cb)
+					crt_bulk_free(local_bulk_hdl);
 				crt_req_decref(rpc);
 				break;
 			}
@@ -324,6 +419,177 @@ next:
 	return rc;
 }
 
+struct ds_obj_fwd_args {
+	int		fw_inflight;
+	int		fw_result;
+	uint32_t	fw_map_ver;
+	ABT_eventual	fw_eventual;
+};
+
+static void
+ds_obj_fwd_cb(const struct crt_cb_info *cb_info)
+{
+	struct ds_obj_fwd_args	*arg = cb_info->cci_arg;
+	crt_rpc_t		*req = cb_info->cci_rpc;
+	struct obj_rw_in	*orw = crt_req_get(req);
+	uint32_t		 map_ver;
+	int			 rc = cb_info->cci_rc;
+
+	if (rc == 0)
+		rc = obj_reply_get_status(req);
+
+	if (rc != 0)
+		D_ERROR(DF_UOID" forwarded update failed: %d\n",
+			DP_UOID(orw->orw_oid), rc);
+
+	/* only one thread accesses arg, see bulk_complete_cb() */
+	if (arg->fw_result == 0 || obj_retry_error(rc))
+		arg->fw_result = rc;
+
+	if (cb_info->cci_rc == 0) {
+		map_ver = obj_reply_map_version_get(req);
+		if (map_ver > arg->fw_map_ver)
+			arg->fw_map_ver = map_ver;
+	}
+
+	D_ASSERT(arg->fw_inflight > 0);
+	arg->fw_inflight--;
+	if (arg->fw_inflight == 0)
+		ABT_eventual_set(arg->fw_eventual, &arg->fw_result,
+				 sizeof(arg->fw_result));
+}
+
+/**
+ * Forward an update which has landed in the local buffers of \a ioh to the
+ * other replicas in orw_shard_tgts, and wait for all of them to reply. With
+ * ORF_FWD_CHAIN the update only goes to the first one, which forwards it to
+ * the rest, otherwise it is sent to all of them at once.
+ *
+ * Data of a bulk update are pulled by the replicas from the local buffers,
+ * so this must be called before eio_iod_post(). The highest pool map version
+ * replied by the replicas is returned in \a map_ver.
+ */
+static int
+ds_obj_rw_fwd(crt_rpc_t *rpc, daos_handle_t ioh, bool rma, uint32_t *map_ver)
+{
+	struct obj_rw_in	*orw = crt_req_get(rpc);
+	struct obj_shard_tgt	*tgts = orw->orw_shard_tgts.ca_arrays;
+	struct ds_obj_fwd_args	 arg = { 0 };
+	crt_bulk_t		*remote_bulks = orw->orw_bulks.ca_arrays;
+	crt_bulk_t		*bulks = NULL;
+	unsigned int		 tgt_nr = orw->orw_shard_tgts.ca_count;
+	bool			 chain = orw->orw_flags & ORF_FWD_CHAIN;
+	int			 i, rc = 0, *status, ret;
+
+	D_ASSERT(tgt_nr > 0);
+	if (rma) {
+		D_ALLOC(bulks, orw->orw_nr * sizeof(*bulks));
+		if (bulks == NULL)
+			return -DER_NOMEM;
+
+		for (i = 0; i < orw->orw_nr; i++) {
+			struct eio_sglist	*esgl;
+			daos_sg_list_t		 sgl;
+
+			if (remote_bulks[i] == NULL)
+				continue;
+
+			esgl = vos_iod_sgl_at(ioh, i);
+			D_ASSERT(esgl != NULL);
+			rc = eio_sgl_convert(esgl, &sgl);
+			if (rc)
+				D_GOTO(out_bulks, rc);
+
+			rc = crt_bulk_create(rpc->cr_ctx, daos2crt_sg(&sgl),
+					     CRT_BULK_RO, &bulks[i]);
+			daos_sgl_fini(&sgl, false);
+			if (rc != 0) {
+				D_ERROR("crt_bulk_create %d error (%d).\n",
+					i, rc);
+				D_GOTO(out_bulks, rc);
+			}
+		}
+	}
+
+	rc = ABT_eventual_create(sizeof(*status), &arg.fw_eventual);
+	if (rc != 0)
+		D_GOTO(out_bulks, rc = dss_abterr2der(rc));
+
+	arg.fw_map_ver = *map_ver;
+	/* Hold one reference until all forwards are sent. */
+	arg.fw_inflight = 1;
+	for (i = 0; i < (chain ? 1 : tgt_nr); i++) {
+		crt_endpoint_t		 tgt_ep;
+		crt_rpc_t		*req;
+		struct obj_rw_in	*fwd;
+
+		tgt_ep.ep_grp	= NULL;
+		tgt_ep.ep_rank	= tgts[i].st_rank;
+		tgt_ep.ep_tag	= tgts[i].st_tag;
+		rc = obj_req_create(rpc->cr_ctx, &tgt_ep, DAOS_OBJ_RPC_UPDATE,
+				    &req);
+		if (rc != 0)
+			break;
+
+		fwd = crt_req_get(req);
+		fwd->orw_oid = orw->orw_oid;
+		fwd->orw_oid.id_shard = tgts[i].st_shard;
+		uuid_copy(fwd->orw_co_hdl, orw->orw_co_hdl);
+		uuid_copy(fwd->orw_co_uuid, orw->orw_co_uuid);
+		fwd->orw_epoch = orw->orw_epoch;
+		fwd->orw_map_ver = orw->orw_map_ver;
+		fwd->orw_nr = orw->orw_nr;
+		fwd->orw_dkey = orw->orw_dkey;
+		fwd->orw_iods = orw->orw_iods;
+		if (rma) {
+			fwd->orw_bulks.ca_count = orw->orw_nr;
+			fwd->orw_bulks.ca_arrays = bulks;
+		} else {
+			fwd->orw_sgls = orw->orw_sgls;
+		}
+
+		fwd->orw_flags = orw->orw_flags;
+		if (chain) {
+			fwd->orw_shard_tgts.ca_count = tgt_nr - 1;
+			fwd->orw_shard_tgts.ca_arrays = &tgts[1];
+		}
+
+		D_DEBUG(DB_IO, DF_UOID" forward update to rank %u tag %u\n",
+			DP_UOID(fwd->orw_oid), tgt_ep.ep_rank, tgt_ep.ep_tag);
+
+		arg.fw_inflight++;
+		rc = crt_req_send(req, ds_obj_fwd_cb, &arg);
+		if (rc != 0) {
+			/* ds_obj_fwd_cb() is still called for this request. */
+			D_ERROR("forward update to rank %u failed: %d\n",
+				tgt_ep.ep_rank, rc);
+			break;
+		}
+	}
+
+	if (rc != 0 && arg.fw_result == 0)
+		arg.fw_result = rc;
+	arg.fw_inflight--;
+	if (arg.fw_inflight == 0)
+		ABT_eventual_set(arg.fw_eventual, &arg.fw_result,
+				 sizeof(arg.fw_result));
+
+	ret = ABT_eventual_wait(arg.fw_eventual, (void **)&status);
+	rc = ret ? dss_abterr2der(ret) : *status;
+
+	ABT_eventual_free(&arg.fw_eventual);
+	*map_ver = arg.fw_map_ver;
+out_bulks:
+	if (bulks != NULL) {
+		for (i = 0; i < orw->orw_nr; i++) {
+			if (bulks[i] != NULL)
+				crt_bulk_free(bulks[i]);
+		}
+		D_FREE(bulks);
+	}
+	return rc;
+}
+
 static int
 ds_sgls_prep(daos_sg_list_t *dst_sgls, daos_sg_list_t *sgls, int number)
 {
@@ -678,6 +944,10 @@ ds_obj_rw_handler(crt_rpc_t *rpc)
 	else if (orw->orw_sgls.ca_arrays != NULL)
 		rc = eio_iod_copy(eiod, orw->orw_sgls.ca_arrays, orw->orw_nr);
 
+	/* the leader of a forwarded update passes it on to other replicas */
+	if (rc == 0 && update && orw->orw_shard_tgts.ca_count != 0)
+		rc = ds_obj_rw_fwd(rpc, ioh, rma, &map_ver);
+
 	err = eio_iod_post(eiod);
 	rc = rc ? : err;
 out:
@@ -771,6 +1041,7 @@ ds_iter_single_vos(void *data)
 		enum_arg->fill_recxs = true;
 	} else if (arg->opc == DAOS_OBJ_DKEY_RPC_ENUMERATE) {
 		type = VOS_ITER_DKEY;
+		enum_arg->latest_vals = oei->oei_flags & OEF_LATEST_VALS;
 	} else if (arg->opc == DAOS_OBJ_AKEY_RPC_ENUMERATE) {
 		type = VOS_ITER_AKEY;
 	} else {
@@ -881,7 +1152,11 @@ ds_obj_enum_handler(crt_rpc_t *rpc)
 	enum_arg->recx_anchor = oei->oei_anchor;
 
 	/* TODO: Transfer the inline_thres from enumerate RPC */
-	enum_arg->inline_thres = 32;
+	if (task_arg.opc == DAOS_OBJ_DKEY_RPC_ENUMERATE &&
+	    oei->oei_flags & OEF_LATEST_VALS)
+		enum_arg->inline_thres = OBJ_ENUM_VAL_MAX;
+	else
+		enum_arg->inline_thres = 32;
 
 	if (task_arg.opc == DAOS_OBJ_RECX_RPC_ENUMERATE ||
 	    task_arg.opc == DAOS_OBJ_RPC_ENUMERATE) {
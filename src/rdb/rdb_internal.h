@@ -67,10 +67,18 @@ struct rdb {
 	struct rdb_lc_record	d_lc_record;	/* of d_lc */
 	daos_handle_t		d_slc;		/* staging log container */
 	struct rdb_lc_record	d_slc_record;	/* of d_slc */
+	ABT_cond		d_slc_cv;	/* for d_slc_record updates */
 	d_rank_list_t	       *d_replicas;
 	uint64_t		d_applied;	/* last applied index */
 	uint64_t		d_debut;	/* first entry in a term */
+	double			d_lease;	/* leader lease period (s) */
+	double			d_contact;	/* last leader contact (s) */
 	ABT_cond		d_applied_cv;	/* for d_applied updates */
+	d_list_t		d_gc_queue;	/* rdb_raft_gc_req queue */
+	int			d_gc_cnt;	/* d_gc_queue len */
+	size_t			d_gc_size;	/* of entries in d_gc_queue */
+	bool			d_gc_leader;	/* batch leader exists */
+	ABT_cond		d_gc_cv;	/* for batch submissions */
 	struct d_hash_table	d_results;	/* rdb_raft_result hash */
 	d_list_t		d_requests;	/* RPCs waiting for replies */
 	d_list_t		d_replies;	/* RPCs received replies */
@@ -79,6 +87,7 @@ struct rdb {
 	int			d_nevents;	/* d_events queue len from 0 */
 	ABT_cond		d_events_cv;	/* for d_events enqueues */
 	uint64_t		d_compact_thres;/* of compactable entries */
+	unsigned int		d_is_window;	/* of in-flight IS chunks */
 	ABT_cond		d_compact_cv;	/* for base updates */
 	bool			d_stop;		/* for rdb_stop() */
 	ABT_thread		d_timerd;
@@ -123,12 +132,16 @@ int rdb_stop_aggregator(crt_rpc_t *source, crt_rpc_t *result, void *priv);
  * Per-raft_node_t INSTALLSNAPSHOT state
  *
  * dis_seq and dis_anchor track the last chunk successfully received by the
- * follower.
+ * follower. dis_sent_seq and dis_sent_anchor track the last chunk sent, which
+ * may be up to db->d_is_window chunks ahead.
  */
 struct rdb_raft_is {
 	uint64_t		dis_index;	/* snapshot index */
 	uint64_t		dis_seq;	/* last sequence number */
 	struct rdb_anchor	dis_anchor;	/* last anchor */
+	uint64_t		dis_sent_seq;	/* last sequence number sent */
+	struct rdb_anchor	dis_sent_anchor;/* last anchor sent */
+	double			dis_progress;	/* time of last dis_seq update */
 };
 
 /* Per-raft_node_t data */
@@ -138,6 +151,8 @@ struct rdb_raft_node {
 	/* Leader fields */
 	uint64_t		dn_term;	/* of leader */
 	struct rdb_raft_is	dn_is;
+	uint64_t		dn_ack_term;	/* of dn_ack */
+	double			dn_ack;		/* send time of last acked AE */
 };
 
 int rdb_raft_init(daos_handle_t pool, daos_handle_t mc,
@@ -146,13 +161,15 @@ int rdb_raft_start(struct rdb *db);
 void rdb_raft_stop(struct rdb *db);
 void rdb_raft_resign(struct rdb *db, uint64_t term);
 int rdb_raft_verify_leadership(struct rdb *db);
+bool rdb_raft_lease_valid(struct rdb *db);
 int rdb_raft_append_apply(struct rdb *db, void *entry, size_t size,
 			  void *result);
 int rdb_raft_wait_applied(struct rdb *db, uint64_t index, uint64_t term);
 void rdb_requestvote_handler(crt_rpc_t *rpc);
 void rdb_appendentries_handler(crt_rpc_t *rpc);
 void rdb_installsnapshot_handler(crt_rpc_t *rpc);
-void rdb_raft_process_reply(struct rdb *db, raft_node_t *node, crt_rpc_t *rpc);
+void rdb_raft_process_reply(struct rdb *db, raft_node_t *node, crt_rpc_t *rpc,
+			    double sent);
 void rdb_raft_free_request(struct rdb *db, crt_rpc_t *rpc);
 
 /* rdb_rpc.c ******************************************************************/
@@ -365,8 +365,9 @@ rdb_raft_pack_chunk(daos_handle_t lc, struct rdb_raft_is *is, daos_iov_t *kds,
 	 */
 	memset(&arg, 0, sizeof(arg));
 	arg.param.ip_hdl = lc;
-	rdb_anchor_to_hashes(&is->dis_anchor, &arg.obj_anchor, &arg.dkey_anchor,
-			     &arg.akey_anchor, &arg.recx_anchor);
+	rdb_anchor_to_hashes(&is->dis_sent_anchor, &arg.obj_anchor,
+			     &arg.dkey_anchor, &arg.akey_anchor,
+			     &arg.recx_anchor);
 	arg.param.ip_epr.epr_lo = is->dis_index;
 	arg.param.ip_epr.epr_hi = is->dis_index;
 	arg.param.ip_epc_expr = VOS_IT_EPC_LE;
@@ -405,11 +406,11 @@ rdb_raft_pack_chunk(daos_handle_t lc, struct rdb_raft_is *is, daos_iov_t *kds,
 	return 0;
 }
 
+/* Pack and send the chunk following the last one sent to node. */
 static int
-rdb_raft_cb_send_installsnapshot(raft_server_t *raft, void *arg,
-				 raft_node_t *node, msg_installsnapshot_t *msg)
+rdb_raft_send_is_chunk(struct rdb *db, raft_node_t *node,
+		       msg_installsnapshot_t *msg)
 {
-	struct rdb		       *db = arg;
 	struct rdb_raft_node	       *rdb_node = raft_node_get_udata(node);
 	struct rdb_raft_is	       *is = &rdb_node->dn_is;
 	crt_rpc_t		       *rpc;
@@ -447,23 +448,11 @@ rdb_raft_cb_send_installsnapshot(raft_server_t *raft, void *arg,
 	if (data.iov_buf == NULL)
 		goto err_kds;
 
-	/*
-	 * If the INSTALLSNAPSHOT state tracks a different term or snapshot,
-	 * reinitialize it for the current term and snapshot.
-	 */
-	if (rdb_node->dn_term != raft_get_current_term(raft) ||
-	    is->dis_index != msg->last_idx) {
-		rdb_node->dn_term = raft_get_current_term(raft);
-		is->dis_index = msg->last_idx;
-		is->dis_seq = 0;
-		rdb_anchor_set_zero(&is->dis_anchor);
-	}
-
 	/* Pack the chunk's data, anchor, and seq. */
 	rc = rdb_raft_pack_chunk(db->d_lc, is, &kds, &data, &in->isi_anchor);
 	if (rc != 0)
 		goto err_data;
-	in->isi_seq = is->dis_seq + 1;
+	in->isi_seq = is->dis_sent_seq + 1;
 
 	/*
 	 * Create bulks for the buffers. crt_bulk_create looks at iov_buf_len
@@ -499,6 +488,9 @@ rdb_raft_cb_send_installsnapshot(raft_server_t *raft, void *arg,
 		goto err_data_bulk;
 	}
 
+	is->dis_sent_seq = in->isi_seq;
+	is->dis_sent_anchor = in->isi_anchor;
+
 	D_DEBUG(DB_TRACE, DF_DB": sent is to node %u rank %u: term=%d "
 		"last_idx=%d seq="DF_U64" kds.len="DF_U64" data.len="DF_U64"\n",
 		DP_DB(db), raft_node_get_id(node), rdb_node->dn_rank,
@@ -520,6 +512,70 @@ err:
 	return rc;
 }
 
+/*
+ * Keep up to db->d_is_window chunks in flight to node, so that the follower
+ * transfers the next chunks while storing the current one. Chunks are packed
+ * from the last anchor sent; if no chunk is acknowledged within the request
+ * timeout, the in-flight chunks are considered lost and resent from the last
+ * anchor acknowledged.
+ */
+static int
+rdb_raft_cb_send_installsnapshot(raft_server_t *raft, void *arg,
+				 raft_node_t *node, msg_installsnapshot_t *msg)
+{
+	struct rdb	       *db = arg;
+	struct rdb_raft_node   *rdb_node = raft_node_get_udata(node);
+	struct rdb_raft_is     *is = &rdb_node->dn_is;
+	double			now = ABT_get_wtime();
+	double			timeout;
+	int			n = 0;
+	int			rc = 0;
+
+	/*
+	 * If the INSTALLSNAPSHOT state tracks a different term or snapshot,
+	 * reinitialize it for the current term and snapshot.
+	 */
+	if (rdb_node->dn_term != raft_get_current_term(raft) ||
+	    is->dis_index != msg->last_idx) {
+		rdb_node->dn_term = raft_get_current_term(raft);
+		is->dis_index = msg->last_idx;
+		is->dis_seq = 0;
+		rdb_anchor_set_zero(&is->dis_anchor);
+		is->dis_sent_seq = 0;
+		rdb_anchor_set_zero(&is->dis_sent_anchor);
+		is->dis_progress = now;
+	}
+
+	timeout = raft_get_request_timeout(raft) / 1000.0;
+	if (is->dis_sent_seq < is->dis_seq ||
+	    (is->dis_sent_seq > is->dis_seq &&
+	     now - is->dis_progress > timeout)) {
+		D_DEBUG(DB_TRACE, DF_DB": rank %u: resending from chunk %d/"
+			DF_U64"("DF_U64")\n", DP_DB(db), rdb_node->dn_rank,
+			msg->last_idx, is->dis_seq, is->dis_sent_seq);
+		is->dis_sent_seq = is->dis_seq;
+		is->dis_sent_anchor = is->dis_anchor;
+		is->dis_progress = now;
+	}
+
+	while (is->dis_sent_seq - is->dis_seq < db->d_is_window &&
+	       !rdb_anchor_is_eof(&is->dis_sent_anchor)) {
+		/*
+		 * The follower may be resuming a snapshot received from a
+		 * previous leader. Learn its cursor with the first chunk
+		 * before sending more.
+		 */
+		if (is->dis_seq == 0 && is->dis_sent_seq > 0)
+			break;
+		rc = rdb_raft_send_is_chunk(db, node, msg);
+		if (rc != 0)
+			break;
+		n++;
+	}
+
+	return n > 0 ? 0 : rc;
+}
+
 struct rdb_raft_bulk {
 	ABT_eventual	drb_eventual;
 	int		drb_n;
@@ -762,14 +818,34 @@ rdb_raft_cb_recv_installsnapshot(raft_server_t *raft, void *arg,
 					slc_record->dlr_base);
 				destroy = true;
 			}
+		} else if (msg->last_idx == slc_record->dlr_base) {
+			uint64_t	term = slc_record->dlr_term;
+			daos_iov_t	value;
+
+			/*
+			 * The new leader is sending the same snapshot. Adopt
+			 * the SLC in the new term, so that the transfer
+			 * resumes from the last chunk stored rather than
+			 * starting over. The new leader learns our cursor
+			 * from the reply to its first chunk.
+			 */
+			D_DEBUG(DB_TRACE, DF_DB": new leader: %d != "DF_U64
+				", resuming slc: "DF_U64"/"DF_U64"\n",
+				DP_DB(db), msg->term, term,
+				slc_record->dlr_base, slc_record->dlr_seq);
+			slc_record->dlr_term = msg->term;
+			daos_iov_set(&value, slc_record, sizeof(*slc_record));
+			rc = rdb_mc_update(db->d_mc, RDB_MC_ATTRS, 1 /* n */,
+					   &rdb_mc_slc, &value);
+			if (rc != 0) {
+				D_ERROR(DF_DB": failed to update SLC record: "
+					"%d\n", DP_DB(db), rc);
+				slc_record->dlr_term = term;
+				return rc;
+			}
 		} else {
 			D_DEBUG(DB_TRACE, DF_DB": new leader: %d != "DF_U64"\n",
 				DP_DB(db), msg->term, slc_record->dlr_term);
-			/*
-			 * We destroy the SLC anyway, even when the index
-			 * matches, as the new leader may use a different
-			 * maximal chunk size (once tunable).
-			 */
 			destroy = true;
 		}
 
@@ -811,7 +887,7 @@ rdb_raft_cb_recv_installsnapshot(raft_server_t *raft, void *arg,
 		out->iso_anchor = slc_record->dlr_anchor;
 		return 0;
 	} else if (in->isi_seq > slc_record->dlr_seq + 1) {
-		/* Chunks are sent one by one for now. */
+		/* rdb_raft_wait_is_chunk() timed out on a previous chunk. */
 		D_ERROR(DF_DB": might have lost chunks: "DF_U64" > "DF_U64"\n",
 			DP_DB(db), in->isi_seq, slc_record->dlr_seq);
 		return -DER_IO;
@@ -955,6 +1031,7 @@ rdb_raft_cb_recv_installsnapshot_resp(raft_server_t *raft, void *arg,
 	/* Update the last sequence number and anchor. */
 	is->dis_seq = out->iso_seq;
 	is->dis_anchor = out->iso_anchor;
+	is->dis_progress = ABT_get_wtime();
 
 	return 0;
 }
@@ -996,10 +1073,8 @@ rdb_raft_cb_persist_term(raft_server_t *raft, void *arg, int term, int vote)
 }
 
 static int
-rdb_raft_log_offer_single(raft_server_t *raft, void *arg,
-			  raft_entry_t *entry, uint64_t index)
+rdb_raft_log_offer_single(struct rdb *db, raft_entry_t *entry, uint64_t index)
 {
-	struct rdb	       *db = arg;
 	daos_iov_t		keys[2];
 	daos_iov_t		values[2];
 	struct rdb_entry	header;
@@ -1007,8 +1082,6 @@ rdb_raft_log_offer_single(raft_server_t *raft, void *arg,
 	int			rc;
 	int			rc_tmp;
 
-	D_ASSERTF(index == db->d_lc_record.dlr_tail, DF_U64" == "DF_U64"\n",
-		  index, db->d_lc_record.dlr_tail);
 	/*
 	 * If this is an rdb_tx entry, apply it. Note that the updates involved
 	 * won't become visible to queries until entry index is committed.
@@ -1061,19 +1134,7 @@ rdb_raft_log_offer_single(raft_server_t *raft, void *arg,
 		entry->data.buf = NULL;
 	}
 
-	/* Update the log tail. See the log tail assertion above. */
-	db->d_lc_record.dlr_tail++;
-	daos_iov_set(&values[0], &db->d_lc_record, sizeof(db->d_lc_record));
-	rc = rdb_mc_update(db->d_mc, RDB_MC_ATTRS, 1 /* n */, &rdb_mc_lc,
-			   &values[0]);
-	if (rc != 0) {
-		D_ERROR(DF_DB": failed to update log tail "DF_U64": %d\n",
-			DP_DB(db), db->d_lc_record.dlr_tail, rc);
-		db->d_lc_record.dlr_tail--;
-		goto err_discard;
-	}
-
-	D_DEBUG(DB_TRACE, DF_DB": appended entry "DF_U64": term=%d type=%d "
+	D_DEBUG(DB_TRACE, DF_DB": persisted entry "DF_U64": term=%d type=%d "
 		"buf=%p len=%u\n", DP_DB(db), index, entry->term, entry->type,
 		entry->data.buf, entry->data.len);
 	return 0;
@@ -1090,14 +1151,49 @@ static int
 rdb_raft_cb_log_offer(raft_server_t *raft, void *arg, raft_entry_t *entries,
 		      int index, int *n_entries)
 {
-	int i;
-	int rc = 0;
+	struct rdb     *db = arg;
+	daos_iov_t	value;
+	uint64_t	tail = db->d_lc_record.dlr_tail;
+	int		i;
+	int		rc = 0;
+	int		rc_tmp;
+
+	D_ASSERTF(index == tail, "%d == "DF_U64"\n", index, tail);
 
+	/*
+	 * Persist all entries before updating the log tail once for the whole
+	 * batch. Entries beyond the tail are discarded when the log is loaded,
+	 * so a crash before the tail update leaves no partial batch behind.
+	 */
 	for (i = 0; i < *n_entries; ++i) {
-		rc = rdb_raft_log_offer_single(raft, arg, entries, index + i);
+		rc = rdb_raft_log_offer_single(db, &entries[i], index + i);
 		if (rc != 0)
 			break;
 	}
+	if (i == 0)
+		goto out;
+
+	db->d_lc_record.dlr_tail = tail + i;
+	daos_iov_set(&value, &db->d_lc_record, sizeof(db->d_lc_record));
+	rc_tmp = rdb_mc_update(db->d_mc, RDB_MC_ATTRS, 1 /* n */, &rdb_mc_lc,
+			       &value);
+	if (rc_tmp != 0) {
+		D_ERROR(DF_DB": failed to update log tail "DF_U64": %d\n",
+			DP_DB(db), db->d_lc_record.dlr_tail, rc_tmp);
+		db->d_lc_record.dlr_tail = tail;
+		rc = rc_tmp;
+		rc_tmp = rdb_lc_discard(db->d_lc, index, index + i - 1);
+		if (rc_tmp != 0)
+			D_ERROR(DF_DB": failed to discard entries "DF_U64"-"
+				DF_U64": %d\n", DP_DB(db), tail, tail + i - 1,
+				rc_tmp);
+		i = 0;
+		goto out;
+	}
+
+	D_DEBUG(DB_TRACE, DF_DB": appended entries "DF_U64"-"DF_U64"\n",
+		DP_DB(db), tail, db->d_lc_record.dlr_tail - 1);
+out:
 	*n_entries = i;
 	return rc;
 }
@@ -1670,27 +1766,51 @@ rdb_raft_unregister_result(struct rdb *db, uint64_t index)
 	D_FREE_PTR(result);
 }
 
-/* Append and wait for \a entry to be applied. */
-int
-rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
+/*
+ * Group commit: concurrent rdb_raft_append_apply() calls queue their entries
+ * in db->d_gc_queue. The first caller becomes the batch leader, yields a few
+ * times to let other TXs join (up to RDB_GC_CNT_MAX entries or
+ * RDB_GC_SIZE_MAX bytes), and then appends the whole batch to the raft log
+ * back to back without yielding, so that the entries are sent to followers
+ * and persisted by them together.
+ */
+#define RDB_GC_CNT_MAX		64
+#define RDB_GC_SIZE_MAX		(1UL << 20)
+
+/* Number of yields the batch leader waits for followers, 0 disables it */
+static unsigned int rdb_gc_yield = 2;
+
+struct rdb_raft_gc_req {
+	d_list_t	drg_link;	/* in db->d_gc_queue */
+	void	       *drg_entry;
+	size_t		drg_size;
+	void	       *drg_result;
+	uint64_t	drg_index;	/* assigned index */
+	uint64_t	drg_term;	/* term of drg_index */
+	int		drg_rc;
+	bool		drg_done;	/* submitted by the batch leader */
+};
+
+static void
+rdb_raft_gc_submit_one(struct rdb *db, struct rdb_raft_gc_req *req)
 {
 	msg_entry_t		mentry = {};
 	msg_entry_response_t	mresponse;
 	struct rdb_raft_state	state;
-	uint64_t		index;
 	int			rc;
 
 	mentry.type = RAFT_LOGTYPE_NORMAL;
-	mentry.data.buf = entry;
-	mentry.data.len = size;
+	mentry.data.buf = req->drg_entry;
+	mentry.data.len = req->drg_size;
 
 	/*
 	 * Do not yield before calling rdb_recv_entry(), so that the index
 	 * assertion below will hold.
 	 */
-	index = raft_get_current_idx(db->d_raft) + 1;
-	if (result != NULL) {
-		rc = rdb_raft_register_result(db, index, result);
+	req->drg_index = raft_get_current_idx(db->d_raft) + 1;
+	if (req->drg_result != NULL) {
+		rc = rdb_raft_register_result(db, req->drg_index,
+					      req->drg_result);
 		if (rc != 0)
 			goto out;
 	}
@@ -1702,19 +1822,208 @@ rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
 		if (rc != -DER_NOTLEADER)
 			D_ERROR(DF_DB": failed to append entry: %d\n",
 				DP_DB(db), rc);
-		goto out_result;
+		if (req->drg_result != NULL)
+			rdb_raft_unregister_result(db, req->drg_index);
+		goto out;
 	}
 
 	/* The actual index must match the expected index. */
-	D_ASSERTF(mresponse.idx == index, "%d == "DF_U64"\n", mresponse.idx,
-		  index);
+	D_ASSERTF(mresponse.idx == req->drg_index, "%d == "DF_U64"\n",
+		  mresponse.idx, req->drg_index);
+	req->drg_term = mresponse.term;
+out:
+	req->drg_rc = rc;
+	req->drg_done = true;
+}
+
+/*
+ * Append the \a cnt entries in \a reqs to the log with one
+ * raft_append_entries() call, so that they are persisted with one log tail
+ * update (see rdb_raft_cb_log_offer()), and then send them to each follower
+ * in one AppendEntries request.
+ */
+static void
+rdb_raft_gc_append(struct rdb *db, struct rdb_raft_gc_req **reqs, int cnt)
+{
+	raft_entry_t	       *entries;
+	struct rdb_raft_state	state;
+	uint64_t		index;
+	int			term;
+	int			n = 0;
+	int			i;
+	int			rc;
 
-	rc = rdb_raft_wait_applied(db, mresponse.idx, mresponse.term);
+	if (!raft_is_leader(db->d_raft)) {
+		rc = -DER_NOTLEADER;
+		goto out;
+	}
+
+	D_ALLOC(entries, sizeof(*entries) * cnt);
+	if (entries == NULL) {
+		rc = -DER_NOMEM;
+		goto out;
+	}
+
+	/*
+	 * Do not yield before calling raft_append_entries(), so that the
+	 * expected indices remain valid.
+	 */
+	index = raft_get_current_idx(db->d_raft) + 1;
+	term = raft_get_current_term(db->d_raft);
+	for (i = 0; i < cnt; i++) {
+		reqs[i]->drg_index = index + i;
+		reqs[i]->drg_term = term;
+		if (reqs[i]->drg_result != NULL) {
+			rc = rdb_raft_register_result(db, reqs[i]->drg_index,
+						      reqs[i]->drg_result);
+			if (rc != 0)
+				break;
+		}
+		entries[i].term = term;
+		entries[i].id = 0;
+		entries[i].type = RAFT_LOGTYPE_NORMAL;
+		entries[i].data.buf = reqs[i]->drg_entry;
+		entries[i].data.len = reqs[i]->drg_size;
+	}
+
+	/* Entries beyond a failed result registration are not appended. */
+	n = i;
+	if (n > 0) {
+		rdb_raft_save_state(db, &state);
+		rc = raft_append_entries(db->d_raft, entries, &n);
+		rc = rdb_raft_check_state(db, &state, rc);
+		if (rc == 0 && n < i)
+			rc = -DER_IO;
+		if (rc != 0)
+			D_ERROR(DF_DB": failed to append entries "DF_U64"-"
+				DF_U64": %d\n", DP_DB(db), index + n,
+				index + i - 1, rc);
+		for (; i > n; i--)
+			if (reqs[i - 1]->drg_result != NULL)
+				rdb_raft_unregister_result(db,
+							reqs[i - 1]->drg_index);
+	}
+	D_FREE(entries);
+
+	if (n > 0) {
+		int rc_tmp;
+
+		/*
+		 * Send the appended entries now instead of waiting for the
+		 * next heartbeat: a full request timeout makes raft_periodic()
+		 * send one AppendEntries request to every follower.
+		 */
+		rdb_raft_save_state(db, &state);
+		rc_tmp = raft_periodic(db->d_raft,
+				       raft_get_request_timeout(db->d_raft));
+		rc_tmp = rdb_raft_check_state(db, &state, rc_tmp);
+		if (rc_tmp != 0)
+			D_ERROR(DF_DB": failed to send entries: %d\n",
+				DP_DB(db), rc_tmp);
+	}
 
-out_result:
-	if (result != NULL)
-		rdb_raft_unregister_result(db, mresponse.idx);
 out:
+	for (i = 0; i < cnt; i++) {
+		reqs[i]->drg_rc = i < n ? 0 : rc;
+		reqs[i]->drg_done = true;
+	}
+}
+
+/* Let other TXs join the batch, then submit all queued entries. */
+static void
+rdb_raft_gc_submit(struct rdb *db)
+{
+	struct rdb_raft_gc_req **reqs = NULL;
+	struct rdb_raft_gc_req *req;
+	struct rdb_raft_gc_req *tmp;
+	d_list_t		batch;
+	unsigned int		i;
+	int			cnt;
+
+	for (i = 0; i < rdb_gc_yield; i++) {
+		if (db->d_gc_cnt >= RDB_GC_CNT_MAX ||
+		    db->d_gc_size >= RDB_GC_SIZE_MAX)
+			break;
+		ABT_thread_yield();
+	}
+
+	D_INIT_LIST_HEAD(&batch);
+	ABT_mutex_lock(db->d_mutex);
+	d_list_splice_init(&db->d_gc_queue, &batch);
+	cnt = db->d_gc_cnt;
+	db->d_gc_cnt = 0;
+	db->d_gc_size = 0;
+	db->d_gc_leader = false;
+	ABT_mutex_unlock(db->d_mutex);
+
+	D_DEBUG(DB_TRACE, DF_DB": submitting %d entries\n", DP_DB(db), cnt);
+
+	/*
+	 * raft_append_entries() does not commit anything by itself, which a
+	 * single replica relies on raft_recv_entry() to do; append one entry
+	 * at a time there. Otherwise, fall back to that only if the request
+	 * array cannot be allocated.
+	 */
+	if (cnt > 1 && raft_get_num_nodes(db->d_raft) > 1)
+		D_ALLOC(reqs, sizeof(*reqs) * cnt);
+	if (reqs != NULL) {
+		i = 0;
+		d_list_for_each_entry_safe(req, tmp, &batch, drg_link) {
+			d_list_del_init(&req->drg_link);
+			reqs[i++] = req;
+		}
+		D_ASSERTF(i == cnt, "%u == %d\n", i, cnt);
+		rdb_raft_gc_append(db, reqs, cnt);
+		D_FREE(reqs);
+	} else {
+		d_list_for_each_entry_safe(req, tmp, &batch, drg_link) {
+			d_list_del_init(&req->drg_link);
+			rdb_raft_gc_submit_one(db, req);
+		}
+	}
+
+	ABT_mutex_lock(db->d_mutex);
+	ABT_cond_broadcast(db->d_gc_cv);
+	ABT_mutex_unlock(db->d_mutex);
+}
+
+/* Append and wait for \a entry to be applied. */
+int
+rdb_raft_append_apply(struct rdb *db, void *entry, size_t size, void *result)
+{
+	struct rdb_raft_gc_req	req = {};
+	bool			leader = false;
+	int			rc;
+
+	req.drg_entry = entry;
+	req.drg_size = size;
+	req.drg_result = result;
+
+	ABT_mutex_lock(db->d_mutex);
+	d_list_add_tail(&req.drg_link, &db->d_gc_queue);
+	db->d_gc_cnt++;
+	db->d_gc_size += size;
+	if (!db->d_gc_leader) {
+		db->d_gc_leader = true;
+		leader = true;
+	}
+	ABT_mutex_unlock(db->d_mutex);
+
+	if (leader)
+		rdb_raft_gc_submit(db);
+
+	ABT_mutex_lock(db->d_mutex);
+	while (!req.drg_done)
+		ABT_cond_wait(db->d_gc_cv, db->d_mutex);
+	ABT_mutex_unlock(db->d_mutex);
+
+	rc = req.drg_rc;
+	if (rc != 0)
+		return rc;
+
+	rc = rdb_raft_wait_applied(db, req.drg_index, req.drg_term);
+	if (result != NULL)
+		rdb_raft_unregister_result(db, req.drg_index);
 	return rc;
 }
 
@@ -2067,6 +2376,37 @@ rdb_raft_get_request_timeout(void)
 	return t;
 }
 
+static unsigned int
+rdb_raft_get_is_window(void)
+{
+	unsigned int i = 4;
+
+	d_getenv_int("RDB_IS_WINDOW", &i);
+	return i == 0 ? 1 : i;
+}
+
+/*
+ * Leader lease period in ms, shorter than the election timeout to allow for
+ * clock drift among replicas. 0 disables leases.
+ */
+static int
+rdb_raft_get_lease_period(int election_timeout)
+{
+	const char     *s;
+	int		t;
+
+	s = getenv("RDB_LEASE_PERIOD");
+	if (s == NULL)
+		t = election_timeout / 4 * 3;
+	else
+		t = atoi(s);
+	if (t < 0 || t >= election_timeout) {
+		D_WARN("invalid lease period %dms, disabling leases\n", t);
+		t = 0;
+	}
+	return t;
+}
+
 static uint64_t
 rdb_raft_get_compact_thres(void)
 {
@@ -2084,11 +2424,15 @@ rdb_raft_start(struct rdb *db)
 	int		vote;
 	int		election_timeout;
 	int		request_timeout;
+	int		lease_period;
 	int		rc;
 
 	D_INIT_LIST_HEAD(&db->d_requests);
 	D_INIT_LIST_HEAD(&db->d_replies);
+	D_INIT_LIST_HEAD(&db->d_gc_queue);
 	db->d_compact_thres = rdb_raft_get_compact_thres();
+	db->d_is_window = rdb_raft_get_is_window();
+	d_getenv_int("RDB_GC_YIELD", &rdb_gc_yield);
 
 	rc = d_hash_table_create_inplace(D_HASH_FT_NOLOCK, 4 /* bits */,
 					 NULL /* priv */,
@@ -2105,12 +2449,20 @@ rdb_raft_start(struct rdb *db)
 		goto err_results;
 	}
 
+	rc = ABT_cond_create(&db->d_gc_cv);
+	if (rc != ABT_SUCCESS) {
+		D_ERROR(DF_DB": failed to create group commit CV: %d\n",
+			DP_DB(db), rc);
+		rc = dss_abterr2der(rc);
+		goto err_applied_cv;
+	}
+
 	rc = ABT_cond_create(&db->d_events_cv);
 	if (rc != ABT_SUCCESS) {
 		D_ERROR(DF_DB": failed to create events CV: %d\n", DP_DB(db),
 			rc);
 		rc = dss_abterr2der(rc);
-		goto err_applied_cv;
+		goto err_gc_cv;
 	}
 
 	rc = ABT_cond_create(&db->d_replies_cv);
@@ -2129,11 +2481,18 @@ rdb_raft_start(struct rdb *db)
 		goto err_replies_cv;
 	}
 
+	rc = ABT_cond_create(&db->d_slc_cv);
+	if (rc != ABT_SUCCESS) {
+		D_ERROR(DF_DB": failed to create SLC CV: %d\n", DP_DB(db), rc);
+		rc = dss_abterr2der(rc);
+		goto err_compact_cv;
+	}
+
 	db->d_raft = raft_new();
 	if (db->d_raft == NULL) {
 		D_ERROR(DF_DB": failed to create raft object\n", DP_DB(db));
 		rc = -DER_NOMEM;
-		goto err_compact_cv;
+		goto err_slc_cv;
 	}
 
 	/*
@@ -2167,6 +2526,8 @@ rdb_raft_start(struct rdb *db)
 	request_timeout = rdb_raft_get_request_timeout();
 	raft_set_election_timeout(db->d_raft, election_timeout);
 	raft_set_request_timeout(db->d_raft, request_timeout);
+	lease_period = rdb_raft_get_lease_period(election_timeout);
+	db->d_lease = lease_period / 1000.0;
 
 	rc = dss_ult_create(rdb_recvd, db, -1, 0, &db->d_recvd);
 	if (rc != 0)
@@ -2182,8 +2543,9 @@ rdb_raft_start(struct rdb *db)
 		goto err_callbackd;
 
 	D_DEBUG(DB_MD, DF_DB": raft started: election_timeout=%dms "
-		"request_timeout=%dms compact_thres="DF_U64"\n", DP_DB(db),
-		election_timeout, request_timeout, db->d_compact_thres);
+		"request_timeout=%dms lease_period=%dms compact_thres="DF_U64
+		"\n", DP_DB(db), election_timeout, request_timeout,
+		lease_period, db->d_compact_thres);
 	return 0;
 
 err_callbackd:
@@ -2206,12 +2568,16 @@ err_lc:
 	rdb_raft_unload_lc(db);
 err_raft:
 	raft_free(db->d_raft);
+err_slc_cv:
+	ABT_cond_free(&db->d_slc_cv);
 err_compact_cv:
 	ABT_cond_free(&db->d_compact_cv);
 err_replies_cv:
 	ABT_cond_free(&db->d_replies_cv);
 err_events_cv:
 	ABT_cond_free(&db->d_events_cv);
+err_gc_cv:
+	ABT_cond_free(&db->d_gc_cv);
 err_applied_cv:
 	ABT_cond_free(&db->d_applied_cv);
 err_results:
@@ -2235,6 +2601,7 @@ rdb_raft_stop(struct rdb *db)
 	ABT_cond_broadcast(db->d_events_cv);
 	ABT_cond_broadcast(db->d_replies_cv);
 	ABT_cond_broadcast(db->d_compact_cv);
+	ABT_cond_broadcast(db->d_slc_cv);
 
 	/* Abort all in-flight RPCs. */
 	rdb_abort_raft_rpcs(db);
@@ -2268,9 +2635,11 @@ rdb_raft_stop(struct rdb *db)
 
 	rdb_raft_unload_lc(db);
 	raft_free(db->d_raft);
+	ABT_cond_free(&db->d_slc_cv);
 	ABT_cond_free(&db->d_compact_cv);
 	ABT_cond_free(&db->d_replies_cv);
 	ABT_cond_free(&db->d_events_cv);
+	ABT_cond_free(&db->d_gc_cv);
 	ABT_cond_free(&db->d_applied_cv);
 	d_hash_table_destroy_inplace(&db->d_results, true /* force */);
 }
@@ -2334,6 +2703,33 @@ rdb_raft_find_node(struct rdb *db, d_rank_t rank)
 	}
 }
 
+/*
+ * Record that the leader of \a term, the term of an AE or IS just processed,
+ * has contacted this follower.
+ */
+static void
+rdb_raft_contact_leader(struct rdb *db, int term)
+{
+	if (term == raft_get_current_term(db->d_raft) &&
+	    !raft_is_leader(db->d_raft))
+		db->d_contact = ABT_get_wtime();
+}
+
+/*
+ * Whether this follower has heard from a leader within the election timeout.
+ * If so, it must not vote for another candidate, or the lease of that leader
+ * (see rdb_raft_lease_valid()) would not hold.
+ */
+static bool
+rdb_raft_leader_alive(struct rdb *db)
+{
+	if (db->d_lease == 0 || db->d_contact == 0 ||
+	    raft_is_leader(db->d_raft))
+		return false;
+	return ABT_get_wtime() <
+	       db->d_contact + raft_get_election_timeout(db->d_raft) / 1000.0;
+}
+
 void
 rdb_requestvote_handler(crt_rpc_t *rpc)
 {
@@ -2355,6 +2751,13 @@ rdb_requestvote_handler(crt_rpc_t *rpc)
 	node = rdb_raft_find_node(db, rpc->cr_ep.ep_rank);
 	if (node == NULL)
 		D_GOTO(out_db, rc = -DER_UNKNOWN);
+	if (rdb_raft_leader_alive(db)) {
+		D_DEBUG(DB_TRACE, DF_DB": rejecting raft rv from rank %u: "
+			"leader alive\n", DP_DB(db), rpc->cr_ep.ep_rank);
+		out->rvo_msg.term = raft_get_current_term(db->d_raft);
+		out->rvo_msg.vote_granted = 0;
+		D_GOTO(out_db, rc = 0);
+	}
 	rdb_raft_save_state(db, &state);
 	rc = raft_recv_requestvote(db->d_raft, node, &in->rvi_msg,
 				   &out->rvo_msg);
@@ -2407,6 +2810,8 @@ rdb_appendentries_handler(crt_rpc_t *rpc)
 			"%d\n", DP_DB(db), rpc->cr_ep.ep_rank, rc);
 		/* raft_recv_appendentries() always generates a valid reply. */
 		rc = 0;
+	} else {
+		rdb_raft_contact_leader(db, in->aei_msg.term);
 	}
 
 out_db:
@@ -2420,6 +2825,47 @@ out:
 			rpc->cr_ep.ep_rank, rc);
 }
 
+/*
+ * With multiple chunks in flight, a chunk may arrive before its predecessors
+ * have been stored. Wait, up to the request timeout, for the SLC to catch up
+ * to the preceding chunk. Chunks of a different term or snapshot are left to
+ * rdb_raft_cb_recv_installsnapshot().
+ */
+static void
+rdb_raft_wait_is_chunk(struct rdb *db, struct rdb_installsnapshot_in *in)
+{
+	struct rdb_lc_record   *slc_record = &db->d_slc_record;
+	struct timespec		deadline;
+	int			timeout;
+	int			rc;
+
+	if (in->isi_seq <= 1)
+		return;
+
+	/* ABT_cond_timedwait() takes an absolute CLOCK_REALTIME deadline. */
+	timeout = raft_get_request_timeout(db->d_raft);
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout / 1000;
+	deadline.tv_nsec += (timeout % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	ABT_mutex_lock(db->d_mutex);
+	while (!db->d_stop) {
+		if (!daos_handle_is_inval(db->d_slc) &&
+		    (slc_record->dlr_term != in->isi_msg.term ||
+		     slc_record->dlr_base != in->isi_msg.last_idx ||
+		     in->isi_seq <= slc_record->dlr_seq + 1))
+			break;
+		rc = ABT_cond_timedwait(db->d_slc_cv, db->d_mutex, &deadline);
+		if (rc == ABT_ERR_COND_TIMEDOUT)
+			break;
+	}
+	ABT_mutex_unlock(db->d_mutex);
+}
+
 void
 rdb_installsnapshot_handler(crt_rpc_t *rpc)
 {
@@ -2452,6 +2898,9 @@ rdb_installsnapshot_handler(crt_rpc_t *rpc)
 		goto out_db;
 	}
 
+	/* Store chunks received out of order in sequence. */
+	rdb_raft_wait_is_chunk(db, in);
+
 	node = rdb_raft_find_node(db, rpc->cr_ep.ep_rank);
 	if (node == NULL) {
 		rc = -DER_UNKNOWN;
@@ -2468,7 +2917,11 @@ rdb_installsnapshot_handler(crt_rpc_t *rpc)
 		 * raft_recv_installsnapshot() always generates a valid reply.
 		 */
 		rc = 0;
+	} else {
+		rdb_raft_contact_leader(db, in->isi_msg.term);
 	}
+	/* Wake up the chunks waiting for this one to be stored. */
+	ABT_cond_broadcast(db->d_slc_cv);
 
 out_is:
 	D_FREE(in->isi_data_iov.iov_buf);
@@ -2484,8 +2937,68 @@ out:
 			rpc->cr_ep.ep_rank, rc);
 }
 
+/*
+ * A follower that replies to an AE in our term has reset its election timer
+ * no earlier than sent, the time the AE was sent. Record sent as the start of
+ * the lease granted by this follower.
+ */
+static void
+rdb_raft_renew_lease(struct rdb *db, raft_node_t *node,
+		     struct rdb_appendentries_out *out, double sent)
+{
+	struct rdb_raft_node   *rdb_node = raft_node_get_udata(node);
+	uint64_t		term = raft_get_current_term(db->d_raft);
+
+	if (!raft_is_leader(db->d_raft) || out->aeo_msg.term != term)
+		return;
+	if (rdb_node->dn_ack_term != term || rdb_node->dn_ack < sent) {
+		rdb_node->dn_ack_term = term;
+		rdb_node->dn_ack = sent;
+	}
+}
+
+/*
+ * Check if this leader holds a valid lease, i.e., a majority of the replicas
+ * (including this one) have acknowledged an AE sent within the last
+ * db->d_lease seconds in the current term. Since db->d_lease is shorter than
+ * the election timeout, none of these followers will vote for another
+ * candidate (see rdb_raft_leader_alive()), and hence no other leader can be
+ * elected, before the lease expires.
+ */
+bool
+rdb_raft_lease_valid(struct rdb *db)
+{
+	uint64_t	term = raft_get_current_term(db->d_raft);
+	double		now;
+	int		n;
+	int		nacks = 1 /* self */;
+	int		i;
+
+	if (db->d_lease == 0 || !raft_is_leader(db->d_raft))
+		return false;
+
+	now = ABT_get_wtime();
+	n = raft_get_num_nodes(db->d_raft);
+	for (i = 0; i < n; i++) {
+		raft_node_t	       *node;
+		struct rdb_raft_node   *rdb_node;
+
+		node = raft_get_node(db->d_raft, i /* id */);
+		if (node == NULL ||
+		    raft_node_get_id(node) == raft_get_nodeid(db->d_raft))
+			continue;
+		rdb_node = raft_node_get_udata(node);
+		if (rdb_node->dn_ack_term == term &&
+		    now < rdb_node->dn_ack + db->d_lease)
+			nacks++;
+	}
+
+	return nacks > n / 2;
+}
+
 void
-rdb_raft_process_reply(struct rdb *db, raft_node_t *node, crt_rpc_t *rpc)
+rdb_raft_process_reply(struct rdb *db, raft_node_t *node, crt_rpc_t *rpc,
+		       double sent)
 {
 	struct rdb_raft_state		state;
 	crt_opcode_t			opc = opc_get(rpc->cr_opc);
@@ -2513,6 +3026,8 @@ rdb_raft_process_reply(struct rdb *db, raft_node_t *node, crt_rpc_t *rpc)
 		out_ae = out;
 		rc = raft_recv_appendentries_response(db->d_raft, node,
 						      &out_ae->aeo_msg);
+		if (rc == 0)
+			rdb_raft_renew_lease(db, node, out_ae, sent);
 		break;
 	case RDB_INSTALLSNAPSHOT:
 		out_is = out;
@@ -83,11 +83,14 @@ rdb_tx_begin(struct rdb *db, uint64_t term, struct rdb_tx *tx)
 		return rc;
 	/*
 	 * If this verification succeeds, then queries in this TX will return
-	 * valid results.
+	 * valid results. A valid leader lease guarantees the same without a
+	 * quorum round trip.
 	 */
-	rc = rdb_raft_verify_leadership(db);
-	if (rc != 0)
-		return rc;
+	if (!rdb_raft_lease_valid(db)) {
+		rc = rdb_raft_verify_leadership(db);
+		if (rc != 0)
+			return rc;
+	}
 	rdb_get(db);
 	t.dt_db = db;
 	t.dt_term = term;
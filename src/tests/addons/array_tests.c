@@ -885,6 +885,229 @@ strided_array(void **state)
 	MPI_Barrier(MPI_COMM_WORLD);
 } /* End str_mem_str_arr_io */
 
+#define SIZE_CHUNKS	1000
+#define SIZE_LOOPS	100
+
+/** metadata of arrays created before the size index, see dac_array.c */
+#define LEGACY_MAGIC	0xdaca55a9daca55a9
+#define LEGACY_MD_DKEY	"0"
+#define LEGACY_MD_AKEY	"daos_array_metadata"
+
+static void
+check_array_size(daos_handle_t oh, daos_epoch_t epoch, daos_size_t expected)
+{
+	daos_size_t	size;
+	int		rc;
+
+	rc = daos_array_get_size(oh, epoch, &size, NULL);
+	assert_int_equal(rc, 0);
+	if (size != expected) {
+		fprintf(stderr, "Size = %zu, expected: %zu\n", size, expected);
+		assert_int_equal(size, expected);
+	}
+}
+
+/**
+ * Check the size of array \a oid through a newly opened handle, through
+ * \a oh2, another handle opened before the updates, and through \a oh.
+ */
+static void
+check_array_size_handles(daos_handle_t coh, daos_obj_id_t oid,
+			 daos_handle_t oh, daos_handle_t oh2,
+			 daos_epoch_t epoch, daos_size_t expected)
+{
+	daos_handle_t	oh3;
+	daos_size_t	cell_size;
+	daos_size_t	chunk_size;
+	int		rc;
+
+	rc = daos_array_open(coh, oid, epoch, DAOS_OO_RO, &cell_size,
+			     &chunk_size, &oh3, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size(oh3, epoch, expected);
+	rc = daos_array_close(oh3, NULL);
+	assert_int_equal(rc, 0);
+
+	check_array_size(oh2, epoch, expected);
+	check_array_size(oh, epoch, expected);
+}
+
+/** Create array \a oid with the metadata layout of LEGACY_MAGIC */
+static void
+legacy_array_create(daos_handle_t coh, daos_obj_id_t oid, daos_epoch_t epoch,
+		    daos_size_t cell_size, daos_size_t chunk_size)
+{
+	daos_handle_t	oh;
+	daos_key_t	dkey;
+	daos_iod_t	iod;
+	daos_recx_t	recx;
+	daos_sg_list_t	sgl;
+	daos_iov_t	sg_iovs[3];
+	uint64_t	magic = LEGACY_MAGIC;
+	char		dkey_str[] = LEGACY_MD_DKEY;
+	char		akey_str[] = LEGACY_MD_AKEY;
+	int		rc;
+
+	rc = daos_obj_open(coh, oid, epoch, DAOS_OO_RW, &oh, NULL);
+	assert_int_equal(rc, 0);
+
+	daos_iov_set(&dkey, dkey_str, strlen(dkey_str));
+	daos_iov_set(&sg_iovs[0], &magic, sizeof(magic));
+	daos_iov_set(&sg_iovs[1], &cell_size, sizeof(cell_size));
+	daos_iov_set(&sg_iovs[2], &chunk_size, sizeof(chunk_size));
+	sgl.sg_nr = 3;
+	sgl.sg_nr_out = 0;
+	sgl.sg_iovs = sg_iovs;
+
+	memset(&iod, 0, sizeof(iod));
+	daos_iov_set(&iod.iod_name, akey_str, strlen(akey_str));
+	iod.iod_type = DAOS_IOD_ARRAY;
+	iod.iod_size = sizeof(uint64_t);
+	iod.iod_nr = 1;
+	recx.rx_idx = 0;
+	recx.rx_nr = 3;
+	iod.iod_recxs = &recx;
+
+	rc = daos_obj_update(oh, epoch, &dkey, 1, &iod, &sgl, NULL);
+	assert_int_equal(rc, 0);
+	rc = daos_obj_close(oh, NULL);
+	assert_int_equal(rc, 0);
+}
+
+/**
+ * Check the array size across writes and truncates, \a legacy arrays have
+ * no size index, their size is found by enumeration.
+ */
+static void
+array_size_index_helper(void **state, daos_ofeat_t ofeats, bool legacy)
+{
+	test_arg_t	*arg = *state;
+	daos_obj_id_t	oid;
+	daos_handle_t	oh;
+	daos_handle_t	oh2;
+	daos_array_iod_t iod;
+	daos_range_t	rg;
+	daos_sg_list_t	sgl;
+	daos_iov_t	iov;
+	daos_epoch_t	epoch;
+	daos_size_t	chunk_size = 16;
+	daos_size_t	cell_size;
+	daos_size_t	i;
+	double		start;
+	char		val = 'a';
+	int		rc;
+
+	if (arg->myrank != 0)
+		goto out;
+
+	oid = dts_oid_gen(DTS_OCLASS_DEF, ofeats, arg->myrank);
+	epoch = 1;
+
+	if (legacy) {
+		legacy_array_create(arg->coh, oid, epoch, 1, chunk_size);
+		rc = daos_array_open(arg->coh, oid, epoch, DAOS_OO_RW,
+				     &cell_size, &chunk_size, &oh, NULL);
+	} else {
+		rc = daos_array_create(arg->coh, oid, epoch, 1, chunk_size,
+				       &oh, NULL);
+	}
+	assert_int_equal(rc, 0);
+
+	/** the size hint of this handle is not refreshed by the updates */
+	rc = daos_array_open(arg->coh, oid, epoch, DAOS_OO_RW, &cell_size,
+			     &chunk_size, &oh2, NULL);
+	assert_int_equal(rc, 0);
+	assert_int_equal(cell_size, 1);
+	assert_int_equal(chunk_size, 16);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch, 0);
+
+	iod.arr_nr = 1;
+	iod.arr_rgs = &rg;
+	rg.rg_len = 1;
+	daos_iov_set(&iov, &val, 1);
+	sgl.sg_nr = 1;
+	sgl.sg_iovs = &iov;
+
+	/** write one record in each chunk, from the last chunk down */
+	epoch++;
+	for (i = SIZE_CHUNKS; i > 0; i--) {
+		rg.rg_idx = (i - 1) * chunk_size;
+		rc = daos_array_write(oh, epoch, &iod, &sgl, NULL, NULL);
+		assert_int_equal(rc, 0);
+	}
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch,
+				 (SIZE_CHUNKS - 1) * chunk_size + 1);
+
+	start = dts_time_now();
+	for (i = 0; i < SIZE_LOOPS; i++)
+		check_array_size(oh, epoch, (SIZE_CHUNKS - 1) * chunk_size + 1);
+	print_message("get_size of %d chunks: %.1f usec\n", SIZE_CHUNKS,
+		      (dts_time_now() - start) * 1000000 / SIZE_LOOPS);
+
+	/** shrink, the older size is still visible at the older epoch */
+	epoch++;
+	rc = daos_array_set_size(oh, epoch, 100, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch, 100);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch - 1,
+				 (SIZE_CHUNKS - 1) * chunk_size + 1);
+
+	/** a write below the size does not change it */
+	epoch++;
+	rg.rg_idx = 10;
+	rc = daos_array_write(oh, epoch, &iod, &sgl, NULL, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch, 100);
+
+	/** grow inside the last chunk, then write below the size in it */
+	rg.rg_idx = 110;
+	rc = daos_array_write(oh, epoch, &iod, &sgl, NULL, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch, 111);
+	rg.rg_idx = 105;
+	rc = daos_array_write(oh, epoch, &iod, &sgl, NULL, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch, 111);
+
+	/** extend across a group of the size index */
+	epoch++;
+	rg.rg_idx = 1 << 20;
+	rc = daos_array_write(oh, epoch, &iod, &sgl, NULL, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch,
+				 (1 << 20) + 1);
+
+	epoch++;
+	rc = daos_array_set_size(oh, epoch, 0, NULL);
+	assert_int_equal(rc, 0);
+	check_array_size_handles(arg->coh, oid, oh, oh2, epoch, 0);
+
+	rc = daos_array_close(oh2, NULL);
+	assert_int_equal(rc, 0);
+	rc = daos_array_close(oh, NULL);
+	assert_int_equal(rc, 0);
+out:
+	MPI_Barrier(MPI_COMM_WORLD);
+} /* End array_size_index_helper */
+
+static void
+array_size_index(void **state)
+{
+	array_size_index_helper(state, 0, false);
+}
+
+static void
+array_size_index_uint64(void **state)
+{
+	array_size_index_helper(state, DAOS_OF_DKEY_UINT64, false);
+}
+
+static void
+array_size_legacy(void **state)
+{
+	array_size_index_helper(state, 0, true);
+}
+
 static const struct CMUnitTest array_io_tests[] = {
 	{"Array I/O: create/open/close (blocking)",
 	 simple_array_mgmt, async_disable, NULL},
@@ -904,6 +1127,12 @@ static const struct CMUnitTest array_io_tests[] = {
 	 read_empty_records, async_disable, NULL},
 	{"Array I/O: strided_array (blocking)",
 	 strided_array, async_disable, NULL},
+	{"Array I/O: size index (blocking)",
+	 array_size_index, async_disable, NULL},
+	{"Array I/O: size index, integer dkeys (blocking)",
+	 array_size_index_uint64, async_disable, NULL},
+	{"Array I/O: size of arrays without size index (blocking)",
+	 array_size_legacy, async_disable, NULL},
 };
 
 int
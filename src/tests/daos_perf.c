@@ -34,6 +34,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <mpi.h>
 #include <daos/common.h>
 #include <daos/tests_lib.h>
@@ -76,11 +77,16 @@ bool			 ts_zero_copy;
 bool			 ts_verify_fetch;
 
 uuid_t			 ts_cookie;		/* update cookie for VOS */
-daos_handle_t		 ts_oh;			/* object open handle */
-daos_obj_id_t		 ts_oid;		/* object ID */
-daos_unit_oid_t		 ts_uoid;		/* object shard ID (for VOS) */
+__thread daos_handle_t	 ts_oh;			/* object open handle */
+__thread daos_obj_id_t	 ts_oid;		/* object ID */
+__thread daos_unit_oid_t ts_uoid;		/* object shard ID (for VOS) */
 
-struct dts_context	 ts_ctx;
+/* I/O context of the calling thread, see ts_write_perf_threads() */
+__thread struct dts_context ts_ctx;
+/* # I/O threads of each process */
+unsigned int		 ts_threads = 1;
+/* index of the calling I/O thread */
+static __thread unsigned int ts_thread_id;
 
 /* rebuild only with iteration */
 bool			ts_rebuild_only_iteration = false;
@@ -326,7 +332,8 @@ ts_write_records_internal(d_rank_t rank, bool with_fetch)
 	}
 
 	for (i = 0; i < ts_obj_p_cont; i++) {
-		ts_oid = dts_oid_gen(ts_class, 0, ts_ctx.tsc_mpi_rank);
+		ts_oid = dts_oid_gen(ts_class, 0, ts_ctx.tsc_mpi_rank +
+				     ts_thread_id * ts_ctx.tsc_mpi_size);
 		if (ts_class == DAOS_OC_R2S_SPEC_RANK)
 			ts_oid = dts_oid_set_rank(ts_oid, rank);
 		for (j = 0; j < ts_dkey_p_obj; j++) {
@@ -574,11 +581,95 @@ ts_iterate_records_internal(d_rank_t rank)
 	return rc;
 }
 
+struct ts_thread_arg {
+	pthread_t		 ta_thread;
+	/* context of the main thread, ts_ctx is thread local */
+	struct dts_context	*ta_parent;
+	unsigned int		 ta_id;
+	double			 ta_start;
+	double			 ta_end;
+	int			 ta_rc;
+};
+
+static void *
+ts_write_thread(void *data)
+{
+	struct ts_thread_arg	*arg = data;
+	int			 rc;
+
+	ts_thread_id = arg->ta_id;
+	/* own EQ and credits, pool and container are shared */
+	rc = dts_ctx_clone(&ts_ctx, arg->ta_parent);
+	if (rc)
+		goto out;
+
+	arg->ta_start = dts_time_now();
+	rc = ts_write_records_internal(RANK_ZERO, WITHOUT_FETCH);
+	arg->ta_end = dts_time_now();
+
+	dts_ctx_clone_fini(&ts_ctx);
+out:
+	arg->ta_rc = rc;
+	return NULL;
+}
+
+/**
+ * Run the update test from \a ts_threads threads, each of them has its own
+ * EQ, so it has its own network context if DAOS_EQ_PRIVATE_CTX is set.
+ */
+static int
+ts_write_perf_threads(double *start_time, double *end_time)
+{
+	struct ts_thread_arg	*args;
+	unsigned int		 nr;
+	unsigned int		 i;
+	bool			 first = true;
+	int			 rc = 0;
+
+	args = calloc(ts_threads, sizeof(*args));
+	if (args == NULL)
+		return -DER_NOMEM;
+
+	for (nr = 0; nr < ts_threads; nr++) {
+		args[nr].ta_parent = &ts_ctx;
+		args[nr].ta_id = nr;
+		rc = pthread_create(&args[nr].ta_thread, NULL, ts_write_thread,
+				    &args[nr]);
+		if (rc) {
+			fprintf(stderr, "failed to create thread: %d\n", rc);
+			rc = daos_errno2der(rc);
+			break;
+		}
+	}
+
+	/* elapsed time is from the first start to the last end */
+	for (i = 0; i < nr; i++) {
+		pthread_join(args[i].ta_thread, NULL);
+		if (args[i].ta_rc != 0) {
+			if (rc == 0)
+				rc = args[i].ta_rc;
+			continue;
+		}
+
+		if (first || args[i].ta_start < *start_time)
+			*start_time = args[i].ta_start;
+		if (first || args[i].ta_end > *end_time)
+			*end_time = args[i].ta_end;
+		first = false;
+	}
+
+	free(args);
+	return rc;
+}
+
 static int
 ts_write_perf(double *start_time, double *end_time)
 {
 	int	rc;
 
+	if (ts_threads > 1)
+		return ts_write_perf_threads(start_time, end_time);
+
 	*start_time = dts_time_now();
 	rc = ts_write_records_internal(RANK_ZERO, WITHOUT_FETCH);
 	*end_time = dts_time_now();
@@ -761,6 +852,12 @@ ts_class_name(void)
 		return "ECHO (network only)";
 	case DAOS_OC_TINY_RW:
 		return "DAOS (full stack)";
+	case DAOS_OC_R3_RW:
+		return "DAOS (full stack, 3 replicas sent by client)";
+	case DAOS_OC_R3_FWD_RW:
+		return "DAOS (full stack, 3 replicas forwarded by server)";
+	case DAOS_OC_R3_CHAIN_RW:
+		return "DAOS (full stack, 3 replicas chained by server)";
 	}
 }
 
@@ -792,13 +889,18 @@ The options are as follows:\n\
 	Pool size, which can have M (megatbytes)or G (gigabytes) as postfix\n\
 	of number. E.g. -P 512M, -P 8G.\n\
 \n\
--T vos|echo|daos\n\
+-T vos|echo|daos|daos_r3|daos_r3_fwd|daos_r3_chain\n\
 	Tyes of test, it can be 'vos', 'echo' and 'daos'.\n\
 	vos  : run directly on top of Versioning Object Store (VOS).\n\
 	echo : I/O traffic generated by the utility only goes through the\n\
 	       network stack and never lands to storage.\n\
 	daos : I/O traffic goes through the full DAOS stack, including both\n\
 	       network and storage.\n\
+	daos_r3, daos_r3_fwd, daos_r3_chain :\n\
+	       full DAOS stack with 3 replicas. The client sends the data\n\
+	       to each replica (daos_r3), or only to one replica which\n\
+	       forwards it to the others at once (daos_r3_fwd) or one\n\
+	       after another (daos_r3_chain).\n\
 	The default value is 'vos'\n\
 \n\
 -C number\n\
@@ -806,6 +908,13 @@ The options are as follows:\n\
 	and 64. The utility runs in synchronous mode if credits is set to 0.\n\
 	This option is ignored for mode 'vos'.\n\
 \n\
+-N number\n\
+	Number of I/O threads of each process, each thread has its own EQ\n\
+	and credits. Every EQ has a private network context unless\n\
+	DAOS_EQ_PRIVATE_CTX is set to 0, synchronous I/O (-C 0) always uses\n\
+	the shared context. It can only run the update test and is ignored\n\
+	for mode 'vos'.\n\
+\n\
 -o number\n\
 	Number of objects are used by the utility.\n\
 \n\
@@ -856,6 +965,7 @@ static struct option ts_ops[] = {
 	{ "pool",	required_argument,	NULL,	'P' },
 	{ "type",	required_argument,	NULL,	'T' },
 	{ "credits",	required_argument,	NULL,	'C' },
+	{ "threads",	required_argument,	NULL,	'N' },
 	{ "obj",	required_argument,	NULL,	'o' },
 	{ "dkey",	required_argument,	NULL,	'd' },
 	{ "akey",	required_argument,	NULL,	'a' },
@@ -910,7 +1020,7 @@ void show_result(double now, double then, int vsize, char *test_name)
 		double		latency;
 		double		rate;
 
-		total = ts_ctx.tsc_mpi_size *
+		total = ts_ctx.tsc_mpi_size * ts_threads *
 			ts_obj_p_cont * ts_dkey_p_obj *
 			ts_akey_p_dkey * ts_recx_p_akey;
 
@@ -971,7 +1081,7 @@ main(int argc, char **argv)
 	MPI_Comm_size(MPI_COMM_WORLD, &ts_ctx.tsc_mpi_size);
 
 	memset(ts_pmem_file, 0, sizeof(ts_pmem_file));
-	while ((rc = getopt_long(argc, argv, "P:T:C:o:d:a:r:As:ztf:hUFRBvIiu",
+	while ((rc = getopt_long(argc, argv, "P:T:C:N:o:d:a:r:As:ztf:hUFRBvIiu",
 				 ts_ops, NULL)) != -1) {
 		char	*endp;
 
@@ -988,6 +1098,15 @@ main(int argc, char **argv)
 				/* full stack: network + storage */
 				ts_class = DAOS_OC_TINY_RW;
 
+			} else if (!strcasecmp(optarg, "daos_r3")) {
+				ts_class = DAOS_OC_R3_RW;
+
+			} else if (!strcasecmp(optarg, "daos_r3_fwd")) {
+				ts_class = DAOS_OC_R3_FWD_RW;
+
+			} else if (!strcasecmp(optarg, "daos_r3_chain")) {
+				ts_class = DAOS_OC_R3_CHAIN_RW;
+
 			} else if (!strcasecmp(optarg, "vos")) {
 				/* pure storage */
 				ts_class = DAOS_OC_RAW;
@@ -1001,6 +1120,9 @@ main(int argc, char **argv)
 		case 'C':
 			credits = strtoul(optarg, &endp, 0);
 			break;
+		case 'N':
+			ts_threads = strtoul(optarg, &endp, 0);
+			break;
 		case 'P':
 			pool_size = strtoul(optarg, &endp, 0);
 			pool_size = ts_val_factor(pool_size, *endp);
@@ -1102,6 +1224,19 @@ main(int argc, char **argv)
 		return -1;
 	}
 
+	if (ts_class == DAOS_OC_RAW || ts_threads == 0)
+		ts_threads = 1;
+
+	if (ts_threads > 1 &&
+	    (perf_tests[FETCH_TEST] != NULL ||
+	     perf_tests[REBUILD_TEST] != NULL ||
+	     perf_tests[UPDATE_FETCH_TEST] != NULL)) {
+		fprintf(stderr, "-N can only run the update test\n");
+		if (ts_ctx.tsc_mpi_rank == 0)
+			ts_print_usage();
+		return -1;
+	}
+
 	if (ts_dkey_p_obj == 0 || ts_akey_p_dkey == 0 ||
 	    ts_recx_p_akey == 0) {
 		fprintf(stderr, "Invalid arguments %d/%d/%d/\n",
@@ -1131,6 +1266,9 @@ main(int argc, char **argv)
 		ts_ctx.tsc_cred_nr = credits;
 		ts_ctx.tsc_svc.rl_nr = 1;
 		ts_ctx.tsc_svc.rl_ranks  = &svc_rank;
+		/* the EQ of each thread has its own network context */
+		if (ts_threads > 1)
+			setenv("DAOS_EQ_PRIVATE_CTX", "1", 0);
 	}
 	ts_ctx.tsc_cred_vsize	= vsize;
 	ts_ctx.tsc_pool_size	= pool_size;
@@ -1141,6 +1279,7 @@ main(int argc, char **argv)
 			"Parameters :\n"
 			"\tpool size     : %u MB\n"
 			"\tcredits       : %d (sync I/O for -ve)\n"
+			"\tthreads       : %u\n"
 			"\tobj_per_cont  : %u x %d (procs)\n"
 			"\tdkey_per_obj  : %u\n"
 			"\takey_per_dkey : %u\n"
@@ -1154,6 +1293,7 @@ main(int argc, char **argv)
 			ts_class_name(),
 			(unsigned int)(pool_size >> 20),
 			credits,
+			ts_threads,
 			ts_obj_p_cont,
 			ts_ctx.tsc_mpi_size,
 			ts_dkey_p_obj,
@@ -396,3 +396,46 @@ dts_ctx_fini(struct dts_context *tsc)
 		daos_debug_fini();
 	}
 }
+
+/* see comments in dts_common.h */
+int
+dts_ctx_clone(struct dts_context *tsc, struct dts_context *src)
+{
+	int	rc;
+
+	D_ASSERT(src->tsc_init == DTS_INIT_CREDITS);
+	memset(tsc, 0, sizeof(*tsc));
+	tsc->tsc_pmem_file	= src->tsc_pmem_file;
+	tsc->tsc_svc		= src->tsc_svc;
+	tsc->tsc_mpi_rank	= src->tsc_mpi_rank;
+	tsc->tsc_mpi_size	= src->tsc_mpi_size;
+	uuid_copy(tsc->tsc_pool_uuid, src->tsc_pool_uuid);
+	uuid_copy(tsc->tsc_cont_uuid, src->tsc_cont_uuid);
+	tsc->tsc_pool_size	= src->tsc_pool_size;
+	tsc->tsc_cred_vsize	= src->tsc_cred_vsize;
+	/* credits_init() has changed tsc_cred_nr of synchronous mode */
+	tsc->tsc_cred_nr	= daos_handle_is_inval(src->tsc_eqh) ?
+				  -1 : src->tsc_cred_nr;
+
+	tsc->tsc_poh		= src->tsc_poh;
+	tsc->tsc_coh		= src->tsc_coh;
+	tsc->tsc_init		= DTS_INIT_CONT;
+
+	rc = credits_init(tsc);
+	if (rc) {
+		fprintf(stderr, "Failed to initialize credits, rc=%d\n", rc);
+		return rc;
+	}
+	tsc->tsc_init = DTS_INIT_CREDITS;
+	return 0;
+}
+
+/* see comments in dts_common.h */
+void
+dts_ctx_clone_fini(struct dts_context *tsc)
+{
+	/* pool and container are owned by the source context */
+	if (tsc->tsc_init == DTS_INIT_CREDITS)
+		credits_fini(tsc);
+	tsc->tsc_init = DTS_INIT_NONE;
+}
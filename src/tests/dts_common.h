@@ -106,6 +106,17 @@ int dts_ctx_init(struct dts_context *tsc);
  * - disconnect and destroy the test pool
  */
 void dts_ctx_fini(struct dts_context *tsc);
+/**
+ * Initialize I/O test context \a tsc from the initialized context \a src,
+ * it shares the pool and container handles of \a src, but has its own EQ
+ * and I/O credits, so it can be used by another thread.
+ */
+int dts_ctx_clone(struct dts_context *tsc, struct dts_context *src);
+/**
+ * Finalize I/O test context initialized by \a dts_ctx_clone, it only
+ * releases the EQ and the I/O credits.
+ */
+void dts_ctx_clone_fini(struct dts_context *tsc);
 
 /**
  * Try to obtain a free credit from the I/O context.
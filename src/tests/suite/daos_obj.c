@@ -1939,6 +1939,283 @@ update_overlapped_recxs(void **state)
 	print_message("all good\n");
 }
 
+static int
+enumerate_dkey_val(daos_epoch_t epoch, uint32_t *number, daos_key_desc_t *kds,
+		   daos_anchor_t *anchor, void *buf, daos_size_t len,
+		   struct ioreq *req)
+{
+	int rc;
+
+	ioreq_sgl_simple_set(req, &buf, &len, 1);
+	rc = daos_obj_list_dkey_val(req->oh, epoch, number, kds, req->sgl,
+				    anchor, req->arg->async ? &req->ev : NULL);
+	if (req->arg->async) {
+		bool ev_flag;
+
+		assert_int_equal(rc, 0);
+		rc = daos_event_test(&req->ev, DAOS_EQ_WAIT, &ev_flag);
+		assert_int_equal(rc, 0);
+		assert_int_equal(ev_flag, true);
+		rc = req->ev.ev_error;
+	}
+
+	if (rc != -DER_KEY2BIG)
+		assert_int_equal(rc, 0);
+
+	return rc;
+}
+
+#define LV_DKEY_NR	40
+#define LV_AKEY_NR	3
+#define LV_KEY_BUF	32
+#define LV_LARGE_VAL	8192
+/** room for two dkeys with their values, see iter_val_dkey_cb() */
+#define LV_DESC_NR	(2 * (2 * LV_AKEY_NR + 1) + 2)
+
+/**
+ * Enumerate all the dkeys with their values at \a epoch, with a buffer too
+ * small for any dkey every third call, and verify each dkey is returned
+ * once with the latest value of each of its single value akeys.
+ */
+static void
+enumerate_latest_vals_verify(daos_epoch_t epoch, struct ioreq *req)
+{
+	char		 buf[ENUM_DESC_BUF];
+	char		 key[LV_KEY_BUF];
+	char		 val[LV_KEY_BUF];
+	daos_key_desc_t  kds[LV_DESC_NR];
+	daos_anchor_t	 anchor;
+	bool		 seen[LV_DKEY_NR] = { 0 };
+	int		 dkey = -1;
+	int		 vals = 0;
+	int		 dkey_nr = 0;
+	int		 calls = 0;
+	uint32_t	 number;
+	char		*ptr;
+	int		 akey;
+	int		 i;
+	int		 rc;
+
+	memset(&anchor, 0, sizeof(anchor));
+	while (!daos_anchor_is_eof(&anchor)) {
+		daos_size_t	len = ++calls % 3 == 0 ? 4 : sizeof(buf);
+
+		number = LV_DESC_NR;
+		memset(buf, 0, sizeof(buf));
+		rc = enumerate_dkey_val(epoch, &number, kds, &anchor, buf, len,
+					req);
+		if (rc == -DER_KEY2BIG) {
+			/** resumed from the same anchor by the next call */
+			print_message("got -DER_KEY2BIG, key_len "DF_U64"\n",
+				      kds[0].kd_key_len);
+			assert_true(kds[0].kd_key_len > len);
+			continue;
+		}
+
+		for (ptr = buf, i = 0; i < number; i++) {
+			daos_size_t	klen = kds[i].kd_key_len;
+
+			/** an akey is always followed by its value */
+			if (kds[i].kd_val_types == DAOS_IOD_NONE &&
+			    (i + 1 == number ||
+			     kds[i + 1].kd_val_types != DAOS_IOD_SINGLE)) {
+				if (dkey >= 0)
+					assert_int_equal(vals, LV_AKEY_NR);
+				assert_true(klen < LV_KEY_BUF);
+				snprintf(key, klen + 1, "%s", ptr);
+				assert_int_equal(sscanf(key, "lv_dkey_%d",
+							&dkey), 1);
+				assert_in_range(dkey, 0, LV_DKEY_NR - 1);
+				assert_false(seen[dkey]);
+				seen[dkey] = true;
+				dkey_nr++;
+				vals = 0;
+				ptr += klen;
+				continue;
+			}
+
+			assert_int_equal(kds[i].kd_val_types, DAOS_IOD_NONE);
+			assert_true(klen < LV_KEY_BUF);
+			snprintf(key, klen + 1, "%s", ptr);
+			assert_int_equal(sscanf(key, "lv_akey_%d", &akey), 1);
+			ptr += klen;
+
+			i++;
+			sprintf(val, "v%d_%d_e"DF_U64, dkey, akey,
+				akey == 0 ? epoch : 1);
+			assert_int_equal(kds[i].kd_key_len, strlen(val) + 1);
+			assert_memory_equal(ptr, val, strlen(val) + 1);
+			ptr += kds[i].kd_key_len;
+			vals++;
+		}
+	}
+
+	if (dkey >= 0)
+		assert_int_equal(vals, LV_AKEY_NR);
+	assert_int_equal(dkey_nr, LV_DKEY_NR);
+}
+
+/** enumerate dkeys with the latest values of their akeys */
+static void
+enumerate_latest_vals(void **state)
+{
+	test_arg_t	*arg = *state;
+	char		 dkey[LV_KEY_BUF];
+	char		 akey[LV_KEY_BUF];
+	char		 val[LV_KEY_BUF];
+	char		*large_val;
+	daos_obj_id_t	 oid;
+	struct ioreq	 req;
+	daos_epoch_t	 e;
+	int		 i;
+	int		 j;
+
+	oid = dts_oid_gen(dts_obj_class, 0, arg->myrank);
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_SINGLE, arg);
+
+	large_val = malloc(LV_LARGE_VAL);
+	assert_non_null(large_val);
+	memset(large_val, 'L', LV_LARGE_VAL);
+
+	print_message("Insert %d dkeys with %d values\n", LV_DKEY_NR,
+		      LV_AKEY_NR);
+	for (i = 0; i < LV_DKEY_NR; i++) {
+		sprintf(dkey, "lv_dkey_%d", i);
+		for (j = 0; j < LV_AKEY_NR; j++) {
+			sprintf(akey, "lv_akey_%d", j);
+			sprintf(val, "v%d_%d_e1", i, j);
+			insert_single(dkey, akey, 0, val, strlen(val) + 1, 1,
+				      &req);
+		}
+		/** the first value is overwritten in the next epoch */
+		sprintf(val, "v%d_0_e2", i);
+		insert_single(dkey, "lv_akey_0", 0, val, strlen(val) + 1, 2,
+			      &req);
+
+		/** neither large values nor arrays are returned */
+		if (i % 4 == 1)
+			insert_single(dkey, "lv_large", 0, large_val,
+				      LV_LARGE_VAL, 1, &req);
+		if (i % 4 == 2) {
+			req.iod_type = DAOS_IOD_ARRAY;
+			insert_single(dkey, "lv_array", 0, "data",
+				      strlen("data") + 1, 1, &req);
+			req.iod_type = DAOS_IOD_SINGLE;
+		}
+	}
+
+	for (e = 1; e <= 2; e++) {
+		print_message("Enumerate dkeys and values at epoch "DF_U64"\n",
+			      e);
+		enumerate_latest_vals_verify(e, &req);
+	}
+
+	free(large_val);
+	ioreq_fini(&req);
+}
+
+/** cell size of the erasure coded classes, in bytes */
+#define EC_CELL_SIZE	(64 << 10)
+
+/**
+ * Fetch \a len bytes from offset 0 of an EC object and compare them with
+ * \a expect, with the shards of the redundancy group in \a lost unavailable.
+ */
+static void
+ec_lookup_verify(struct ioreq *req, daos_epoch_t epoch, char *expect,
+		 daos_size_t len, uint32_t lost)
+{
+	daos_recx_t	 recx;
+	char		*buf;
+
+	buf = calloc(len, 1);
+	assert_non_null(buf);
+
+	if (lost != 0) {
+		daos_fail_loc_set(DAOS_OBJ_EC_LOST_SHARDS | DAOS_FAIL_VALUE);
+		daos_fail_value_set(lost);
+	}
+
+	recx.rx_idx = 0;
+	recx.rx_nr = len;
+	lookup_recxs("ec dkey", "ec akey", 1, epoch, &recx, 1, buf, len, req);
+	daos_fail_loc_set(0);
+
+	assert_memory_equal(buf, expect, len);
+	free(buf);
+}
+
+/**
+ * Write full, partial and unaligned stripes to an object of class \a oc, read
+ * them back with all shards available, then with each data shard, and with
+ * the first \a p data shards, unavailable.
+ */
+static void
+ec_io(test_arg_t *arg, daos_oclass_id_t oc, unsigned int k, unsigned int p)
+{
+	daos_obj_id_t	 oid;
+	struct ioreq	 req;
+	daos_recx_t	 recx;
+	daos_size_t	 len;
+	daos_size_t	 off;
+	char		*data;
+	char		*expect;
+	unsigned int	 i;
+
+	if (!test_runable(arg, k + p))
+		skip();
+
+	oid = dts_oid_gen(oc, 0, arg->myrank);
+	ioreq_init(&req, arg->coh, oid, DAOS_IOD_ARRAY, arg);
+
+	/* two full stripes and half a cell of the third one */
+	len = 2 * k * EC_CELL_SIZE + EC_CELL_SIZE / 2;
+	data = malloc(len);
+	expect = malloc(len);
+	assert_non_null(data);
+	assert_non_null(expect);
+
+	print_message("EC k=%u p=%u: update full stripes\n", k, p);
+	dts_buf_render(data, len);
+	memcpy(expect, data, len);
+	recx.rx_idx = 0;
+	recx.rx_nr = len;
+	insert_recxs("ec dkey", "ec akey", 1, 1, &recx, 1, data, len, &req);
+	ec_lookup_verify(&req, 1, expect, len, 0);
+
+	/* crosses a cell boundary inside the first stripe */
+	print_message("EC k=%u p=%u: update a partial stripe\n", k, p);
+	off = EC_CELL_SIZE / 2 + 7;
+	dts_buf_render(data, EC_CELL_SIZE);
+	memcpy(expect + off, data, EC_CELL_SIZE);
+	recx.rx_idx = off;
+	recx.rx_nr = EC_CELL_SIZE;
+	insert_recxs("ec dkey", "ec akey", 1, 2, &recx, 1, data, EC_CELL_SIZE,
+		     &req);
+	ec_lookup_verify(&req, 2, expect, len, 0);
+
+	print_message("EC k=%u p=%u: degraded fetch\n", k, p);
+	for (i = 0; i < k; i++)
+		ec_lookup_verify(&req, 2, expect, len, 1U << i);
+	ec_lookup_verify(&req, 2, expect, len, (1U << p) - 1);
+
+	free(expect);
+	free(data);
+	ioreq_fini(&req);
+}
+
+static void
+ec_io_k2p1(void **state)
+{
+	ec_io(*state, DAOS_OC_EC_K2P1_RW, 2, 1);
+}
+
+static void
+ec_io_k4p2(void **state)
+{
+	ec_io(*state, DAOS_OC_EC_K4P2_RW, 4, 2);
+}
+
 static const struct CMUnitTest io_tests[] = {
 	{ "IO1: simple update/fetch/verify",
 	  io_simple, async_disable, test_case_teardown},
@@ -1997,6 +2274,12 @@ static const struct CMUnitTest io_tests[] = {
 	  async_enable, test_case_teardown},
 	{ "IO29: update with overlapped recxs", update_overlapped_recxs,
 	  async_enable, test_case_teardown},
+	{ "IO30: enumerate dkeys with latest values", enumerate_latest_vals,
+	  async_enable, test_case_teardown},
+	{ "IO31: EC update/fetch/degraded fetch (2+1)", ec_io_k2p1,
+	  async_disable, test_case_teardown},
+	{ "IO32: EC update/fetch/degraded fetch (4+2)", ec_io_k4p2,
+	  async_disable, test_case_teardown},
 };
 
 int
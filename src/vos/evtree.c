@@ -282,280 +282,221 @@ evt_cmp_rect_helper(const struct evt_rect *rt1, const struct evt_rect *rt2)
 	return 0;
 }
 
-int evt_ent_cmp(const void *p1, const void *p2)
+/** An extent being swept, it is an element of the epoch-ordered heap */
+struct evt_sweep_item {
+	/** epoch of the extent */
+	daos_epoch_t		 si_epc;
+	/** end offset of the extent */
+	daos_off_t		 si_hi;
+	/** the found entry */
+	struct evt_entry	*si_ent;
+	/** the last visible segment emitted for this extent, or NULL */
+	struct evt_entry	*si_out;
+};
+
+static int
+evt_sweep_cmp(const void *p1, const void *p2)
 {
-	const struct evt_entry	*ent1	= p1;
-	const struct evt_entry	*ent2	= p2;
+	const struct evt_entry	*ent1 = *(const struct evt_entry **)p1;
+	const struct evt_entry	*ent2 = *(const struct evt_entry **)p2;
 
-	return evt_cmp_rect_helper(&ent1->en_sel_rect, &ent2->en_sel_rect);
+	if (ent1->en_sel_rect.rc_off_lo < ent2->en_sel_rect.rc_off_lo)
+		return -1;
+	if (ent1->en_sel_rect.rc_off_lo > ent2->en_sel_rect.rc_off_lo)
+		return 1;
+	return 0;
 }
 
+/** Sift down the max-heap (by epoch) from position \a at */
 static void
-evt_sort_and_merge(struct evt_entry *ents, int count, d_list_t *sorted)
+evt_sweep_heap_down(struct evt_sweep_item *heap, int nr, int at)
 {
-	d_list_t		*current;
-	struct evt_entry	*ent;
-	int			 index;
-	int			 cmp;
-
-	qsort(ents, count, sizeof(ents[0]), evt_ent_cmp);
+	struct evt_sweep_item	item = heap[at];
+	int			child;
 
-	/* Now merge into sorted list */
-	for (index = 0, current = sorted->next; index < count;) {
-		if (current == sorted) {
-			d_list_add_tail(&ents[index].en_link, sorted);
-			index++;
-			continue;
-		}
-
-		ent = d_list_entry(current, struct evt_entry, en_link);
-
-		cmp = evt_cmp_rect_helper(&ents[index].en_sel_rect,
-					       &ent->en_sel_rect);
-		D_ASSERTF(cmp != 0, "Same epoch overwrite detected r1="DF_RECT
-			  " r2="DF_RECT"\n", DP_RECT(&ent->en_rect),
-			  DP_RECT(&ents[index].en_rect));
-		if (cmp < 0) {
-			d_list_add(&ents[index].en_link, current->prev);
-			index++;
-		} else {
-			/* Skip to next entry */
-			current = current->next;
-		}
+	while ((child = 2 * at + 1) < nr) {
+		if (child + 1 < nr &&
+		    heap[child + 1].si_epc > heap[child].si_epc)
+			child++;
+		if (heap[child].si_epc <= item.si_epc)
+			break;
+		heap[at] = heap[child];
+		at = child;
 	}
+	heap[at] = item;
 }
 
-/* Use top bit of inob field to temporarily mark a partial rectangle as part
- * of another rectangle so we don't return it in the covered list
- */
-#define EVT_PARTIAL_FLAG (1 << 31)
+static void
+evt_sweep_heap_push(struct evt_sweep_item *heap, int *nr,
+		    struct evt_entry *ent)
+{
+	struct evt_sweep_item	item;
+	int			at = (*nr)++;
 
-static struct evt_entry *
-evt_find_next_uncovered(struct evt_entry *this_ent, d_list_t *head,
-			d_list_t **next, d_list_t *free_list, int *flag_bit)
-{
-	d_list_t		*temp;
-	struct evt_rect		*this_rect;
-	struct evt_rect		*next_rect;
-	struct evt_entry	*next_ent;
-	struct evt_ptr		*next_ptr;
-
-	while (*next != head) {
-		next_ent = d_list_entry(*next, struct evt_entry, en_link);
-		next_ptr = &next_ent->en_ptr;
-
-		/* NB: Flag is set if part of the extent is visible */
-		*flag_bit = next_ptr->pt_inob & EVT_PARTIAL_FLAG;
-		next_ptr->pt_inob &= ~(EVT_PARTIAL_FLAG);
-
-		this_rect = &this_ent->en_sel_rect;
-		next_rect = &next_ent->en_sel_rect;
-		if (next_rect->rc_epc_lo > this_rect->rc_epc_lo)
-			return next_ent; /* next_ent is a later update */
-		if (next_rect->rc_off_hi > this_rect->rc_off_hi)
-			return next_ent; /* next_ent extends past end */
-
-		temp = *next;
-		*next = temp->next;
-		if (*flag_bit) /* NB: part of the extent is visible */
-			d_list_move(temp, free_list);
+	item.si_epc = ent->en_sel_rect.rc_epc_lo;
+	item.si_hi  = ent->en_sel_rect.rc_off_hi;
+	item.si_ent = ent;
+	item.si_out = NULL;
 
+	while (at > 0 && heap[(at - 1) / 2].si_epc < item.si_epc) {
+		heap[at] = heap[(at - 1) / 2];
+		at = (at - 1) / 2;
 	}
-
-	return NULL;
+	heap[at] = item;
 }
 
-static struct evt_entry *
-evt_get_unused_entry(struct evt_entry_list *ent_list, d_list_t *unused)
+/** Remove the top extent, it goes to \a covered if nothing of it is visible */
+static void
+evt_sweep_heap_pop(struct evt_sweep_item *heap, int *nr, d_list_t *covered)
 {
-	d_list_t *entry;
-
-	if (d_list_empty(unused))
-		return evt_ent_list_alloc(ent_list, false);
-
-	entry = unused->next;
-	d_list_del(entry);
+	if (heap[0].si_out == NULL)
+		d_list_add_tail(&heap[0].si_ent->en_link, covered);
 
-	return d_list_entry(entry, struct evt_entry, en_link);
+	heap[0] = heap[--(*nr)];
+	if (*nr > 0)
+		evt_sweep_heap_down(heap, *nr, 0);
 }
 
-static void
-evt_split_entry(struct evt_entry *current, struct evt_entry *next,
-		struct evt_entry *split)
+/**
+ * Emit [\a lo, \a hi] of the top extent of the heap as a visible segment. It
+ * extends the previous segment of the same extent if they are contiguous,
+ * otherwise the entry of the extent is reused for its first segment and a
+ * copy of the entry is taken for each of the following ones.
+ */
+static int
+evt_sweep_emit(struct evt_entry_list *ent_list, struct evt_sweep_item *item,
+	       daos_off_t lo, daos_off_t hi)
 {
-	struct evt_ptr	*ptr = &split->en_ptr;
-	daos_off_t	 diff;
-
-	*split = *current;
-	diff = next->en_sel_rect.rc_off_hi + 1 - split->en_sel_rect.rc_off_lo;
-	split->en_sel_rect.rc_off_lo = next->en_sel_rect.rc_off_hi + 1;
-	ptr->pt_ex_addr.ea_off += diff * ptr->pt_inob;
-	/* Mark the split entry so we don't keep it in covered list */
-	ptr->pt_inob |= EVT_PARTIAL_FLAG;
+	struct evt_entry	*ent = item->si_out;
+	struct evt_ptr		*ptr;
+	daos_off_t		 diff;
 
-	current->en_sel_rect.rc_off_hi = next->en_sel_rect.rc_off_lo - 1;
-}
+	if (ent != NULL && ent->en_sel_rect.rc_off_hi + 1 == lo) {
+		ent->en_sel_rect.rc_off_hi = hi;
+		return 0;
+	}
 
-static d_list_t *
-evt_insert_sorted(struct evt_entry *this_ent, d_list_t *head, d_list_t *current)
-{
-	d_list_t		*start = current;
-	struct evt_entry	*next_ent;
-	int			 cmp;
+	if (ent == NULL) {
+		ent = item->si_ent;
+	} else {
+		struct evt_entry *split;
 
-	while (current != head) {
-		next_ent = d_list_entry(current, struct evt_entry, en_link);
-		cmp = evt_cmp_rect_helper(&this_ent->en_sel_rect,
-					       &next_ent->en_sel_rect);
-		if (cmp < 0) {
-			d_list_add(&this_ent->en_link, current->prev);
-			goto out;
-		}
-		current = current->next;
+		split = evt_ent_list_alloc(ent_list, false);
+		if (split == NULL)
+			return -DER_NOMEM;
+		*split = *ent;
+		ent = split;
 	}
-	d_list_add_tail(&this_ent->en_link, head);
-out:
-	if (start == current)
-		return &this_ent->en_link;
-	return start;
+
+	ptr = &ent->en_ptr;
+	diff = lo - ent->en_sel_rect.rc_off_lo;
+	if (diff != 0 && !eio_addr_is_hole(&ptr->pt_ex_addr))
+		ptr->pt_ex_addr.ea_off += diff * ptr->pt_inob;
+
+	ent->en_sel_rect.rc_off_lo = lo;
+	ent->en_sel_rect.rc_off_hi = hi;
+	d_list_add_tail(&ent->en_link, &ent_list->el_list);
+	item->si_out = ent;
+	return 0;
 }
 
+/**
+ * Sweep-line kernel of visibility resolution.
+ *
+ * Extents are sorted by start offset and swept from left to right, extents
+ * covering the sweep position are kept in a max-heap ordered by epoch, so
+ * the top of the heap is always the visible one. Each step emits the top
+ * extent until either it ends or another extent starts, ended extents are
+ * dropped lazily when they reach the top.
+ */
 static int
-evt_uncover_entries(struct evt_entry_list *ent_list, d_list_t *covered)
+evt_sweep(struct evt_entry_list *ent_list, struct evt_entry **ents,
+	  struct evt_sweep_item *heap, int nr, d_list_t *covered)
 {
-	struct evt_rect		*this_rect;
-	struct evt_rect		*next_rect;
-	struct evt_entry	*this_ent;
-	struct evt_entry	*next_ent;
-	struct evt_entry	*temp_ent;
-	struct evt_ptr		*ptr;
-	d_list_t		*current;
-	d_list_t		*next;
-	d_list_t		 unused;
-	daos_size_t		 diff;
-	int			 flag_bit;
-	bool			 insert;
+	struct evt_sweep_item	*top;
+	daos_off_t		 pos;
+	daos_off_t		 end;
+	int			 heap_nr = 0;
+	int			 i;
+	int			 rc;
 
-	D_INIT_LIST_HEAD(&unused);  /* list of entries that can be reclaimed */
+	qsort(ents, nr, sizeof(ents[0]), evt_sweep_cmp);
 
-	/* reset the linked list.  We'll reconstruct it */
 	D_INIT_LIST_HEAD(&ent_list->el_list);
+	pos = ents[0]->en_sel_rect.rc_off_lo;
+	for (i = 0; ;) {
+		for (; i < nr && ents[i]->en_sel_rect.rc_off_lo <= pos; i++)
+			evt_sweep_heap_push(heap, &heap_nr, ents[i]);
 
-	insert = true;
-	/* Now uncover entries */
-	current = covered->next;
-	/* Some compilers can't tell that this_ent will be initialized */
-	this_ent = d_list_entry(current, struct evt_entry,
-				en_link);
-	next = current->next;
-
-	while (next != covered) {
-		if (insert) {
-			this_ent = d_list_entry(current, struct evt_entry,
-						en_link);
-			d_list_move_tail(current, &ent_list->el_list);
-		}
+		while (heap_nr > 0 && heap[0].si_hi < pos)
+			evt_sweep_heap_pop(heap, &heap_nr, covered);
 
-		insert = true;
+		if (heap_nr == 0) {
+			if (i == nr)
+				break;
+			pos = ents[i]->en_sel_rect.rc_off_lo;
+			continue;
+		}
 
-		/* Find next uncovered rectangle */
-		next_ent = evt_find_next_uncovered(this_ent, covered, &next,
-						   &unused, &flag_bit);
-		if (next_ent == NULL)
-			return 0;
+		top = &heap[0];
+		end = top->si_hi;
+		if (i < nr && ents[i]->en_sel_rect.rc_off_lo <= end)
+			end = ents[i]->en_sel_rect.rc_off_lo - 1;
 
-		this_rect = &this_ent->en_sel_rect;
-		next_rect = &next_ent->en_sel_rect;
-		current = next;
-		next = current->next;
-		/* NB: Three possibilities
-		 * 1. No intersection.  Current entry is inserted in entirety
-		 * 2. Partial intersection, next is earlier. Next is truncated
-		 * 3. Partial intersection, next is later. Current is truncated
-		 * 4. Current entry contains next_entry.  Current is split
-		 * in two and both are truncated.
-		 */
-		if (next_rect->rc_off_lo >= this_rect->rc_off_hi + 1) {
-			/* Case #1, entry already inserted, nothing to do */
-		} else if (next_rect->rc_epc_lo < this_rect->rc_epc_lo) {
-			/* Case #2, next rect is partially under this rect,
-			 * Truncate left end of next_rec, reinsert.
-			 */
-			ptr = &next_ent->en_ptr;
-			diff = this_rect->rc_off_hi + 1 - next_rect->rc_off_lo;
-			next_rect->rc_off_lo = this_rect->rc_off_hi + 1;
-			ptr->pt_ex_addr.ea_off +=
-				diff * ptr->pt_inob;
-			/* current now points at next_ent.  Remove it and
-			 * reinsert it in the list in case truncation moved
-			 * it to a new position
-			 */
-			d_list_del(current);
-			next = evt_insert_sorted(next_ent, covered, next);
-			/* Reset the flag bit */
-			ptr->pt_inob |= flag_bit;
+		rc = evt_sweep_emit(ent_list, top, pos, end);
+		if (rc != 0)
+			return rc;
 
-			/* Now we need to rerun this iteration without
-			 * inserting this_ent again
-			 */
-			insert = false;
-		} else if (next_rect->rc_off_hi >= this_rect->rc_off_hi) {
-			/* Case #3, truncate entry */
-			this_rect->rc_off_hi = next_rect->rc_off_lo - 1;
-		} else {
-			/* Case #4, split, insert tail into sorted list */
-			temp_ent = evt_get_unused_entry(ent_list, &unused);
-			if (temp_ent == NULL)
-				return -DER_NOMEM;
-			evt_split_entry(this_ent, next_ent, temp_ent);
-			/* Current points at next_ent */
-			next = evt_insert_sorted(temp_ent, covered, next);
-		}
+		if (end == ~0ULL) /* reached the end of address space */
+			break;
+		pos = end + 1;
 	}
 
-	d_list_move_tail(current, &ent_list->el_list);
-
+	while (heap_nr > 0)
+		evt_sweep_heap_pop(heap, &heap_nr, covered);
 	return 0;
 }
 
-/** Place all entries into covered list in sorted order based on selected
- * range.   Then walk through the range to find only extents that are visible
- * and place them in the main list.   Update the selection bounds for visible
- * rectangles.
+/**
+ * Resolve visibility of all found entries: \a ent_list will only contain the
+ * visible parts of entries sorted by offset, and the selected range of them
+ * are updated. Entries which are entirely covered are moved to \a covered.
  */
 static int
 evt_ent_list_sort(struct evt_entry_list *ent_list, d_list_t *covered)
 {
-	d_list_t		*current = &ent_list->el_pool;
-	struct evt_entry_pool	*pool;
-	struct evt_entry	*ents;
-	int			 count;
-	int			 todo;
+	struct evt_entry	*ents_buf[ERT_ENT_EMBEDDED];
+	struct evt_sweep_item	 heap_buf[ERT_ENT_EMBEDDED];
+	struct evt_entry	**ents = ents_buf;
+	struct evt_sweep_item	*heap = heap_buf;
+	struct evt_entry	*ent;
+	int			 nr = ent_list->el_ent_nr;
+	int			 i;
+	int			 rc;
 
 	D_INIT_LIST_HEAD(covered);
 
-	if (ent_list->el_ent_nr <= 1)
+	if (nr <= 1)
 		return 0;
 
-	/* First, sort the entries and place all in covered list */
-	todo = ent_list->el_ent_nr;
-	ents = &ent_list->el_ents[0]; /* start with embedded pool */
-
-	for (todo = ent_list->el_ent_nr; todo != 0; todo -= count) {
-		count = min(todo, ERT_ENT_EMBEDDED);
+	if (nr > ERT_ENT_EMBEDDED) {
+		/* one buffer for both of the array and the heap */
+		D_ALLOC(heap, nr * (sizeof(*heap) + sizeof(*ents)));
+		if (heap == NULL)
+			return -DER_NOMEM;
+		ents = (struct evt_entry **)&heap[nr];
+	}
 
-		evt_sort_and_merge(ents, count, covered);
+	i = 0;
+	evt_ent_list_for_each(ent, ent_list)
+		ents[i++] = ent;
+	D_ASSERT(i == nr);
 
-		if (current->next == &ent_list->el_pool)
-			break;
+	rc = evt_sweep(ent_list, ents, heap, nr, covered);
 
-		current = current->next;
-		pool = d_list_entry(current, struct evt_entry_pool, ep_link);
-		ents = &pool->ep_ents[0];
-	}
-
-	/* Now separate entries into covered and visible */
-	return evt_uncover_entries(ent_list, covered);
+	if (heap != heap_buf)
+		D_FREE(heap);
+	return rc;
 }
 
 daos_handle_t
@@ -869,6 +810,168 @@ evt_node_rect_at(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	return &rects[at];
 }
 
+/**
+ * Per-xstream DRAM cache of non-leaf nodes.
+ *
+ * Every lookup walks the upper levels of the tree, these nodes are few and
+ * hot, so the rectangles and children of them can be kept in DRAM. A cached
+ * copy is valid only if both mmid and generation match the node, because
+ * evt_node_dirty() bumps the generation of a node within the transaction
+ * which modifies it, the committed change invalidates the cached copy.
+ */
+#define EVT_CACHE_BITS		8
+#define EVT_CACHE_SIZE		(1U << EVT_CACHE_BITS)
+
+struct evt_cache_ent {
+	/** mmid of the cached node */
+	TMMID(struct evt_node)	 ce_mmid;
+	/** generation of the node while it was cached */
+	uint32_t		 ce_gen;
+	/** number of cached children */
+	uint16_t		 ce_nr;
+	/** capacity of \a ce_rects and \a ce_children */
+	uint16_t		 ce_order;
+	/** rectangles of children */
+	struct evt_rect		*ce_rects;
+	/** mmids of children, it shares the buffer of \a ce_rects */
+	TMMID(struct evt_node)	*ce_children;
+};
+
+struct evt_cache {
+	struct evt_cache_ent	 ec_ents[EVT_CACHE_SIZE];
+	struct evt_cache_stats	 ec_stats;
+};
+
+/** NULL if the cache is disabled for the current xstream */
+static __thread struct evt_cache *evt_cache;
+
+int
+evt_cache_enable(bool enable)
+{
+	int	i;
+
+	if (enable) {
+		if (evt_cache == NULL) {
+			D_ALLOC_PTR(evt_cache);
+			if (evt_cache == NULL)
+				return -DER_NOMEM;
+		}
+		return 0;
+	}
+
+	if (evt_cache == NULL)
+		return 0;
+
+	for (i = 0; i < EVT_CACHE_SIZE; i++) {
+		if (evt_cache->ec_ents[i].ce_rects != NULL)
+			D_FREE(evt_cache->ec_ents[i].ce_rects);
+	}
+	D_FREE_PTR(evt_cache);
+	return 0;
+}
+
+void
+evt_cache_stats_get(struct evt_cache_stats *stats, bool reset)
+{
+	if (evt_cache == NULL) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	*stats = evt_cache->ec_stats;
+	if (reset)
+		memset(&evt_cache->ec_stats, 0, sizeof(evt_cache->ec_stats));
+}
+
+static inline struct evt_cache_ent *
+evt_cache_slot(TMMID(struct evt_node) nd_mmid)
+{
+	uint64_t	key;
+
+	key = nd_mmid.oid.off ^ nd_mmid.oid.pool_uuid_lo;
+	key *= 0x9e3779b97f4a7c15ULL;
+	return &evt_cache->ec_ents[key >> (64 - EVT_CACHE_BITS)];
+}
+
+/**
+ * Return the cached copy of non-leaf node \a nd_mmid, the node is (re)loaded
+ * into the cache if it is not cached or the cached copy is stale. NULL is
+ * returned if the cache is disabled or out of memory, caller should read the
+ * node directly in this case.
+ */
+static struct evt_cache_ent *
+evt_cache_lookup(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
+{
+	struct evt_cache_ent	*ce;
+	struct evt_node		*nd;
+	struct evt_rect		*rects;
+
+	if (evt_cache == NULL)
+		return NULL;
+
+	nd = evt_tmmid2ptr(tcx, nd_mmid);
+	ce = evt_cache_slot(nd_mmid);
+	if (ce->ce_gen == nd->tn_gen &&
+	    umem_id_equal_typed(evt_umm(tcx), ce->ce_mmid, nd_mmid)) {
+		evt_cache->ec_stats.cs_hit++;
+		return ce;
+	}
+	evt_cache->ec_stats.cs_miss++;
+
+	if (ce->ce_order < tcx->tc_order) {
+		D_ALLOC(rects, tcx->tc_order * (sizeof(*ce->ce_rects) +
+						sizeof(*ce->ce_children)));
+		if (rects == NULL) {
+			ce->ce_mmid = EVT_NODE_NULL;
+			return NULL;
+		}
+		if (ce->ce_rects != NULL)
+			D_FREE(ce->ce_rects);
+
+		ce->ce_rects	= rects;
+		ce->ce_children	= (TMMID(struct evt_node) *)
+				  &rects[tcx->tc_order];
+		ce->ce_order	= tcx->tc_order;
+	}
+
+	ce->ce_mmid = nd_mmid;
+	ce->ce_gen  = nd->tn_gen;
+	ce->ce_nr   = nd->tn_nr;
+	memcpy(ce->ce_rects, evt_node_rect_at(tcx, nd_mmid, 0),
+	       nd->tn_nr * sizeof(*ce->ce_rects));
+	memcpy(ce->ce_children, evt_node_child_at(tcx, nd_mmid, 0),
+	       nd->tn_nr * sizeof(*ce->ce_children));
+	return ce;
+}
+
+/** Drop the cached copy of a node which is going to be freed */
+static void
+evt_cache_evict(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
+{
+	struct evt_cache_ent	*ce;
+
+	if (evt_cache == NULL)
+		return;
+
+	ce = evt_cache_slot(nd_mmid);
+	if (umem_id_equal_typed(evt_umm(tcx), ce->ce_mmid, nd_mmid)) {
+		ce->ce_mmid = EVT_NODE_NULL;
+		evt_cache->ec_stats.cs_evict++;
+	}
+}
+
+/**
+ * Bump generation of a node which is going to be changed, it should be
+ * called by all functions modifying content of a node.
+ */
+static inline void
+evt_node_dirty(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
+{
+	struct evt_node	*nd = evt_tmmid2ptr(tcx, nd_mmid);
+
+	nd->tn_gen++;
+}
+
 /**
  * Update the rectangle stored at the offset \a at of the specified node.
  * This function should update the MBR of the tree node the new rectangle
@@ -889,6 +992,7 @@ evt_node_rect_update(struct evt_context *tcx, TMMID(struct evt_node) tn_mmid,
 	struct evt_rect *rtmp;
 	bool		 changed;
 
+	evt_node_dirty(tcx, tn_mmid);
 	/* update the rectangle at the specified position */
 	rtmp = evt_node_rect_at(tcx, tn_mmid, at);
 	*rtmp = *rect;
@@ -951,6 +1055,7 @@ evt_node_alloc(struct evt_context *tcx, unsigned int flags,
 static void
 evt_node_free(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 {
+	evt_cache_evict(tcx, nd_mmid);
 	umem_free_typed(evt_umm(tcx), nd_mmid);
 }
 
@@ -1024,6 +1129,7 @@ evt_node_mbr_cal(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid)
 	node = evt_tmmid2ptr(tcx, nd_mmid);
 	D_ASSERT(node->tn_nr != 0);
 
+	evt_node_dirty(tcx, nd_mmid);
 	mbr = &node->tn_mbr;
 	*mbr = *evt_node_rect_at(tcx, nd_mmid, 0);
 	for (i = 1; i < node->tn_nr; i++) {
@@ -1080,6 +1186,7 @@ evt_node_insert(struct evt_context *tcx, TMMID(struct evt_node) nd_mmid,
 	D_DEBUG(DB_TRACE, "Insert "DF_RECT" into "DF_RECT"("TMMID_PF")\n",
 		DP_RECT(&ent->en_rect), DP_RECT(mbr), TMMID_P(nd_mmid));
 
+	evt_node_dirty(tcx, nd_mmid);
 	rc = tcx->tc_ops->po_insert(tcx, nd_mmid, in_mmid, ent);
 	if (rc == 0) {
 		if (nd->tn_nr == 1) {
@@ -1271,7 +1378,7 @@ evt_root_deactivate(struct evt_context *tcx)
 
 	evt_root_tx_add(tcx);
 	root->tr_depth = 0;
-	umem_free_typed(evt_umm(tcx), root->tr_node);
+	evt_node_free(tcx, root->tr_node);
 
 	root->tr_node = TMMID_NULL(struct evt_node);
 	evt_tcx_set_dep(tcx, 0);
@@ -1633,9 +1740,11 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 	level = at = 0;
 	nd_mmid = tcx->tc_root->tr_node;
 	while (1) {
-		struct evt_rect *mbr;
-		struct evt_node	*node;
-		bool		 leaf;
+		struct evt_cache_ent	*ce = NULL;
+		struct evt_rect		*mbr;
+		struct evt_node		*node;
+		unsigned int		 nr;
+		bool			 leaf;
 
 		node = evt_tmmid2ptr(tcx, nd_mmid);
 		leaf = evt_node_is_leaf(tcx, nd_mmid);
@@ -1646,13 +1755,21 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 			"Checking "DF_RECT"("TMMID_PF"), l=%d, a=%d, f=%d\n",
 			DP_RECT(mbr), TMMID_P(nd_mmid), level, at, leaf);
 
-		for (i = at; i < node->tn_nr; i++) {
+		/* NB: only plain lookup can use the node cache, others are
+		 * called by modifications which may run in a transaction.
+		 */
+		if (!leaf && find_opc == EVT_FIND_ALL)
+			ce = evt_cache_lookup(tcx, nd_mmid);
+		nr = ce ? ce->ce_nr : node->tn_nr;
+
+		for (i = at; i < nr; i++) {
 			struct evt_entry	*ent;
 			struct evt_rect		*rtmp;
 			int			 time_overlap;
 			int			 range_overlap;
 
-			rtmp = evt_node_rect_at(tcx, nd_mmid, i);
+			rtmp = ce ? &ce->ce_rects[i] :
+				    evt_node_rect_at(tcx, nd_mmid, i);
 			D_DEBUG(DB_TRACE, " rect[%d]="DF_RECT"\n",
 				i, DP_RECT(rtmp));
 
@@ -1753,10 +1870,11 @@ evt_find_ent_list(struct evt_context *tcx, enum evt_find_opc find_opc,
 			}
 		}
 
-		if (i < node->tn_nr) {
+		if (i < nr) {
 			/* overlapped with a non-leaf node, dive into it. */
 			evt_tcx_set_trace(tcx, level, nd_mmid, i);
-			nd_mmid = *evt_node_child_at(tcx, nd_mmid, i);
+			nd_mmid = ce ? ce->ce_children[i] :
+				       *evt_node_child_at(tcx, nd_mmid, i);
 			at = 0;
 			level++;
 
@@ -2526,12 +2644,13 @@ evt_node_delete(struct evt_context *tcx)
 				return 0;
 			}
 
-			umem_free_typed(evt_umm(tcx), nm_cur);
+			evt_node_free(tcx, nm_cur);
 			level--;
 			continue;
 		}
 
 		/* Ok, remove the rect at the current trace */
+		evt_node_dirty(tcx, nm_cur);
 		rect_ptr = evt_node_rect_at(tcx, nm_cur, trace->tr_at);
 		count = node->tn_nr - trace->tr_at - 1;
 		node->tn_nr--;
@@ -2581,6 +2700,7 @@ evt_node_delete(struct evt_context *tcx)
 		nm_cur = trace->tr_node;
 		node = evt_tmmid2ptr(tcx, nm_cur);
 
+		evt_node_dirty(tcx, nm_cur);
 		rect_ptr = evt_node_rect_at(tcx, nm_cur, trace->tr_at);
 		*rect_ptr = mbr;
 
@@ -435,6 +435,11 @@ ts_list_rect(void)
 
 #define TS_VAL_CYCLE	4
 
+/* extents added by the last many_add, they are used by the perf test */
+static long		ts_many_off;
+static int		ts_many_size;
+static int		ts_many_nr;
+
 static int
 ts_many_add(char *args)
 {
@@ -526,6 +531,522 @@ ts_many_add(char *args)
 
 	free(buf);
 	free(seq);
+	if (rc == 0) {
+		ts_many_off  = offset;
+		ts_many_size = size;
+		ts_many_nr   = nr;
+	}
+	return rc;
+}
+
+static int
+ts_find_perf_run(int *seq, int nr, bool cached)
+{
+	struct evt_cache_stats	 stats;
+	struct evt_entry_list	 enlist;
+	struct evt_rect		 rect;
+	double			 then;
+	double			 now;
+	int			 i;
+	int			 rc;
+
+	rc = evt_cache_enable(cached);
+	if (rc != 0)
+		return rc;
+
+	if (cached) { /* warm up the cache */
+		for (i = 0; i < nr; i++) {
+			rect.rc_off_lo = ts_many_off + seq[i] * ts_many_size;
+			rect.rc_off_hi = rect.rc_off_lo + ts_many_size - 1;
+			rect.rc_epc_lo = TS_VAL_CYCLE;
+
+			rc = evt_find(ts_toh, &rect, &enlist, NULL);
+			if (rc != 0)
+				return rc;
+			evt_ent_list_fini(&enlist);
+		}
+		evt_cache_stats_get(&stats, true);
+	}
+
+	then = dts_time_now();
+	for (i = 0; i < nr; i++) {
+		rect.rc_off_lo = ts_many_off + seq[i] * ts_many_size;
+		rect.rc_off_hi = rect.rc_off_lo + ts_many_size - 1;
+		rect.rc_epc_lo = TS_VAL_CYCLE;
+
+		rc = evt_find(ts_toh, &rect, &enlist, NULL);
+		if (rc != 0) {
+			D_FATAL("Find rect %d failed %d\n", i, rc);
+			return rc;
+		}
+
+		if (enlist.el_ent_nr != 1) {
+			D_FATAL("Find rect %d returned %d entries\n",
+				i, enlist.el_ent_nr);
+			evt_ent_list_fini(&enlist);
+			return -1;
+		}
+		evt_ent_list_fini(&enlist);
+	}
+	now = dts_time_now();
+
+	D_PRINT("%s find = %10.2f/sec, %8.1f ns/op\n",
+		cached ? "cached  " : "uncached", nr / (now - then),
+		(now - then) * 1e9 / nr);
+	if (cached) {
+		evt_cache_stats_get(&stats, true);
+		D_PRINT("cache hit "DF_U64", miss "DF_U64", evict "DF_U64"\n",
+			stats.cs_hit, stats.cs_miss, stats.cs_evict);
+		evt_cache_enable(false);
+	}
+	return 0;
+}
+
+/**
+ * Compare lookup latency with and without the node cache, it searches all
+ * extents added by the last many_add in random order.
+ * argument format: "NUM", number of rounds
+ */
+static int
+ts_find_perf(char *args)
+{
+	int	*seq;
+	int	 loop;
+	int	 i;
+	int	 rc = 0;
+
+	if (ts_many_nr == 0) {
+		D_PRINT("Please run many_add first\n");
+		return -1;
+	}
+
+	loop = atoi(args);
+	if (loop <= 0)
+		loop = 1;
+
+	seq = dts_rand_iarr_alloc(ts_many_nr, 0);
+	if (!seq)
+		return -1;
+
+	D_PRINT("Lookup %d extents for %d rounds\n", ts_many_nr, loop);
+	for (i = 0; i < loop && rc == 0; i++) {
+		rc = ts_find_perf_run(seq, ts_many_nr, false);
+		if (rc == 0)
+			rc = ts_find_perf_run(seq, ts_many_nr, true);
+	}
+	free(seq);
+	return rc;
+}
+
+#define TS_OW_EXT	64
+#define TS_OW_FETCH	256
+#define TS_OW_LOOP	1000
+
+/**
+ * Measure fetch cost against overwrite depth. For each depth, a new tree is
+ * created and the same range is overwritten by \a depth epochs, extents of
+ * each epoch are shifted so they partially overlap with the older ones.
+ * argument format: "d:NUM,n:NUM"
+ * d: maximum overwrite depth, it is doubled from 1 for each run
+ * n: number of records of the written range
+ */
+static int
+ts_overwrite_perf(char *args)
+{
+	char		*buf;
+	char		*tmp;
+	daos_handle_t	 toh;
+	TMMID(struct evt_root) root_mmid;
+	int		 depth_max;
+	int		 depth;
+	int		 nr;
+	int		 rc = 0;
+
+	if (args[0] != 'd' || args[1] != EVT_SEP_VAL) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	depth_max = strtol(&args[2], &tmp, 0);
+	if (depth_max <= 0 || *tmp != EVT_SEP) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	args = tmp + 1;
+
+	if (args[0] != 'n' || args[1] != EVT_SEP_VAL) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	nr = strtol(&args[2], NULL, 0);
+	if (nr < TS_OW_FETCH) {
+		D_PRINT("Range should have at least %d records\n",
+			TS_OW_FETCH);
+		return -1;
+	}
+
+	buf = malloc(TS_OW_EXT + 1);
+	if (!buf)
+		return -1;
+	memset(buf, 'o', TS_OW_EXT);
+	buf[TS_OW_EXT] = '\0';
+
+	for (depth = 1; depth <= depth_max && rc == 0; depth *= 2) {
+		struct evt_entry_list	 enlist;
+		struct evt_rect		 rect;
+		d_list_t		 covered;
+		eio_addr_t		 addr = {0};
+		double			 then;
+		double			 now;
+		long			 found = 0;
+		int			 shift;
+		int			 i;
+		int			 e;
+
+		rc = evt_create(EVT_FEAT_DEFAULT, ts_order, &ts_uma,
+				&root_mmid, &toh);
+		if (rc != 0) {
+			D_PRINT("Tree create failed: %d\n", rc);
+			break;
+		}
+
+		for (e = 1; e <= depth && rc == 0; e++) {
+			shift = (e * 7) % TS_OW_EXT;
+			for (i = shift; i + TS_OW_EXT <= nr; i += TS_OW_EXT) {
+				rect.rc_off_lo = i;
+				rect.rc_off_hi = i + TS_OW_EXT - 1;
+				rect.rc_epc_lo = e;
+
+				rc = eio_strdup(&addr, buf);
+				if (rc != 0)
+					break;
+
+				rc = evt_insert(toh, ts_uuid, 0, &rect, 1,
+						addr);
+				if (rc != 0) {
+					D_FATAL("Add rect failed %d\n", rc);
+					break;
+				}
+			}
+		}
+
+		then = dts_time_now();
+		for (i = 0; i < TS_OW_LOOP && rc == 0; i++) {
+			rect.rc_off_lo = rand() % (nr - TS_OW_FETCH + 1);
+			rect.rc_off_hi = rect.rc_off_lo + TS_OW_FETCH - 1;
+			rect.rc_epc_lo = depth;
+
+			rc = evt_find(toh, &rect, &enlist, &covered);
+			if (rc != 0) {
+				D_FATAL("Find rect failed %d\n", rc);
+				break;
+			}
+			found += enlist.el_ent_nr;
+			evt_ent_list_fini(&enlist);
+		}
+		now = dts_time_now();
+
+		if (rc == 0)
+			D_PRINT("depth %4d: fetch %8.1f ns/op, %6.1f entries/op\n",
+				depth, (now - then) * 1e9 / TS_OW_LOOP,
+				(double)found / TS_OW_LOOP);
+		evt_destroy(toh);
+	}
+
+	free(buf);
+	return rc;
+}
+
+#define TS_SW_RANGE	256
+#define TS_SW_EXT_MAX	32
+#define TS_SW_FIND	64
+
+/** An extent inserted by the visibility check, it is the reference copy */
+struct ts_sw_ext {
+	struct evt_rect		se_rect;
+	/** address of the value, it is unique for each extent */
+	eio_addr_t		se_addr;
+	/** it has a visible part in the current find */
+	bool			se_visible;
+};
+
+static struct ts_sw_ext *
+ts_sw_ext_lookup(struct ts_sw_ext *exts, int nr, struct evt_rect *rect)
+{
+	int	i;
+
+	for (i = 0; i < nr; i++) {
+		if (exts[i].se_rect.rc_off_lo == rect->rc_off_lo &&
+		    exts[i].se_rect.rc_off_hi == rect->rc_off_hi &&
+		    exts[i].se_rect.rc_epc_lo == rect->rc_epc_lo)
+			return &exts[i];
+	}
+	return NULL;
+}
+
+/**
+ * Check the result of evt_find against a per-record scan of the inserted
+ * extents. For each record of the searched range, the extent with the
+ * highest epoch not above the searched epoch is the visible one, which is
+ * the rule the sorted list has to follow.
+ */
+static int
+ts_sweep_check(struct ts_sw_ext *exts, int nr, struct evt_rect *rect)
+{
+	struct evt_entry	*vis[TS_SW_RANGE + TS_SW_EXT_MAX];
+	struct evt_entry_list	 enlist;
+	struct evt_entry	*ent;
+	struct ts_sw_ext	*ext;
+	struct ts_sw_ext	*best;
+	d_list_t		 covered;
+	daos_off_t		 prev_hi = 0;
+	daos_off_t		 idx;
+	bool			 first = true;
+	int			 i;
+	int			 rc;
+
+	rc = evt_find(ts_toh, rect, &enlist, &covered);
+	if (rc != 0) {
+		D_FATAL("Find rect failed %d\n", rc);
+		return rc;
+	}
+
+	memset(vis, 0, sizeof(vis));
+	for (i = 0; i < nr; i++)
+		exts[i].se_visible = false;
+
+	rc = -1;
+	evt_ent_list_for_each(ent, &enlist) {
+		struct evt_rect	*sel = &ent->en_sel_rect;
+
+		if (sel->rc_off_lo > sel->rc_off_hi ||
+		    sel->rc_off_lo < rect->rc_off_lo ||
+		    sel->rc_off_hi > rect->rc_off_hi ||
+		    (!first && sel->rc_off_lo <= prev_hi)) {
+			D_FATAL("Unsorted or overlapped entry "DF_RECT"\n",
+				DP_RECT(sel));
+			goto out;
+		}
+		first = false;
+		prev_hi = sel->rc_off_hi;
+
+		for (idx = sel->rc_off_lo; idx <= sel->rc_off_hi; idx++)
+			vis[idx - rect->rc_off_lo] = ent;
+	}
+
+	for (idx = rect->rc_off_lo; idx <= rect->rc_off_hi; idx++) {
+		best = NULL;
+		for (i = 0; i < nr; i++) {
+			ext = &exts[i];
+			if (ext->se_rect.rc_off_lo > idx ||
+			    ext->se_rect.rc_off_hi < idx ||
+			    ext->se_rect.rc_epc_lo > rect->rc_epc_lo)
+				continue;
+			if (best == NULL ||
+			    ext->se_rect.rc_epc_lo > best->se_rect.rc_epc_lo)
+				best = ext;
+		}
+
+		ent = vis[idx - rect->rc_off_lo];
+		if (best == NULL) {
+			if (ent != NULL) {
+				D_FATAL("Record "DF_U64" should be empty\n",
+					idx);
+				goto out;
+			}
+			continue;
+		}
+		best->se_visible = true;
+
+		if (ent == NULL ||
+		    ts_sw_ext_lookup(exts, nr, &ent->en_rect) != best ||
+		    eio_addr_is_hole(&ent->en_ptr.pt_ex_addr) !=
+		    eio_addr_is_hole(&best->se_addr)) {
+			D_FATAL("Record "DF_U64" should come from "DF_RECT"\n",
+				idx, DP_RECT(&best->se_rect));
+			goto out;
+		}
+
+		if (!eio_addr_is_hole(&best->se_addr) &&
+		    ent->en_ptr.pt_ex_addr.ea_off +
+		    (idx - ent->en_sel_rect.rc_off_lo) !=
+		    best->se_addr.ea_off + (idx - best->se_rect.rc_off_lo)) {
+			D_FATAL("Wrong data address for record "DF_U64"\n",
+				idx);
+			goto out;
+		}
+	}
+
+	/* all found extents without visible part should be covered */
+	d_list_for_each_entry(ent, &covered, en_link) {
+		ext = ts_sw_ext_lookup(exts, nr, &ent->en_rect);
+		if (ext == NULL || ext->se_visible) {
+			D_FATAL("Unexpected covered extent "DF_RECT"\n",
+				DP_RECT(&ent->en_rect));
+			goto out;
+		}
+		ext->se_visible = true; /* mark it as checked */
+	}
+
+	for (i = 0; i < nr; i++) {
+		ext = &exts[i];
+		if (ext->se_visible ||
+		    ext->se_rect.rc_off_lo > rect->rc_off_hi ||
+		    ext->se_rect.rc_off_hi < rect->rc_off_lo ||
+		    ext->se_rect.rc_epc_lo > rect->rc_epc_lo)
+			continue;
+
+		D_FATAL("Extent "DF_RECT" is neither visible nor covered\n",
+			DP_RECT(&ext->se_rect));
+		goto out;
+	}
+	rc = 0;
+out:
+	if (rc != 0)
+		D_FATAL("Visibility mismatch for search "DF_RECT"\n",
+			DP_RECT(rect));
+	evt_ent_list_fini(&enlist);
+	return rc;
+}
+
+/**
+ * Verify visibility resolution of evt_find with random overlapping extents
+ * and punches of multiple epochs.
+ * argument format: "r:NUM,n:NUM,e:NUM"
+ * r: number of rounds, each round runs against a new tree
+ * n: number of extents inserted in each round
+ * e: number of epochs
+ */
+static int
+ts_sweep_verify(char *args)
+{
+	struct ts_sw_ext	*exts;
+	struct ts_sw_ext	*ext;
+	struct evt_rect		 rect;
+	char			 buf[TS_SW_EXT_MAX + 1];
+	char			*tmp;
+	eio_addr_t		 addr;
+	int			 rounds;
+	int			 epochs;
+	int			 ext_nr;
+	int			 nr;
+	int			 r;
+	int			 i;
+	int			 rc = 0;
+
+	if (!daos_handle_is_inval(ts_toh)) {
+		D_PRINT("Tree has been opened\n");
+		return -1;
+	}
+
+	if (args[0] != 'r' || args[1] != EVT_SEP_VAL) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	rounds = strtol(&args[2], &tmp, 0);
+	if (rounds <= 0 || *tmp != EVT_SEP) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	args = tmp + 1;
+
+	if (args[0] != 'n' || args[1] != EVT_SEP_VAL) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	ext_nr = strtol(&args[2], &tmp, 0);
+	if (ext_nr <= 0 || *tmp != EVT_SEP) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	args = tmp + 1;
+
+	if (args[0] != 'e' || args[1] != EVT_SEP_VAL) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+	epochs = strtol(&args[2], NULL, 0);
+	if (epochs <= 0) {
+		D_PRINT("Invalid parameter %s\n", args);
+		return -1;
+	}
+
+	exts = calloc(ext_nr, sizeof(*exts));
+	if (exts == NULL)
+		return -1;
+
+	memset(buf, 'v', TS_SW_EXT_MAX);
+	D_PRINT("Verify visibility: %d rounds, %d extents, %d epochs\n",
+		rounds, ext_nr, epochs);
+
+	for (r = 0; r < rounds && rc == 0; r++) {
+		rc = ts_open_create(true, NULL);
+		if (rc != 0)
+			break;
+
+		for (nr = i = 0; i < ext_nr; i++) {
+			int	width = rand() % TS_SW_EXT_MAX + 1;
+			bool	punch = (rand() % 5 == 0);
+
+			rect.rc_off_lo = rand() % (TS_SW_RANGE - width + 1);
+			rect.rc_off_hi = rect.rc_off_lo + width - 1;
+			rect.rc_epc_lo = rand() % epochs + 1;
+
+			memset(&addr, 0, sizeof(addr));
+			buf[width] = '\0';
+			rc = eio_strdup(&addr, punch ? NULL : buf);
+			buf[width] = 'v';
+			if (rc != 0) {
+				D_FATAL("Insufficient memory for test\n");
+				break;
+			}
+
+			rc = evt_insert(ts_toh, ts_uuid, 0, &rect,
+					punch ? 0 : 1, addr);
+			if (rc == -DER_NO_PERM) {
+				/* partial overwrite within the same epoch */
+				if (!punch) {
+					umem_id_t	mmid;
+
+					mmid.off = addr.ea_off;
+					mmid.pool_uuid_lo = ts_pool_uuid;
+					umem_free(&ts_umm, mmid);
+				}
+				rc = 0;
+				continue;
+			}
+			if (rc != 0) {
+				D_FATAL("Add rect failed %d\n", rc);
+				break;
+			}
+
+			/* overwrite of the same extent and epoch keeps the
+			 * existing value, the new one is freed by evt_insert
+			 */
+			if (ts_sw_ext_lookup(exts, nr, &rect) != NULL)
+				continue;
+
+			ext = &exts[nr++];
+			ext->se_rect = rect;
+			ext->se_addr = addr;
+		}
+
+		for (i = 0; i < TS_SW_FIND && rc == 0; i++) {
+			rect.rc_off_lo = rand() % TS_SW_RANGE;
+			rect.rc_off_hi = rect.rc_off_lo +
+					 rand() % (TS_SW_RANGE + TS_SW_EXT_MAX -
+						   rect.rc_off_lo);
+			rect.rc_epc_lo = rand() % (epochs + 1) + 1;
+
+			rc = ts_sweep_check(exts, nr, &rect);
+		}
+
+		if (ts_close_destroy(true) != 0 && rc == 0)
+			rc = -1;
+	}
+
+	free(exts);
+	if (rc == 0)
+		D_PRINT("Visibility verified\n");
 	return rc;
 }
 
@@ -601,6 +1122,9 @@ static struct option ts_ops[] = {
 	{ "list",	no_argument,		NULL,	'l'	},
 	{ "get_max",	required_argument,	NULL,	'g'	},
 	{ "debug",	required_argument,	NULL,	'b'	},
+	{ "perf",	required_argument,	NULL,	'p'	},
+	{ "overwrite",	required_argument,	NULL,	'w'	},
+	{ "sweep",	required_argument,	NULL,	's'	},
 	{ NULL,		0,			NULL,	0	},
 };
 
@@ -643,6 +1167,15 @@ ts_cmd_run(char opc, char *args)
 	case 'b':
 		rc = ts_tree_debug(args);
 		break;
+	case 'p':
+		rc = ts_find_perf(args);
+		break;
+	case 'w':
+		rc = ts_overwrite_perf(args);
+		break;
+	case 's':
+		rc = ts_sweep_verify(args);
+		break;
 	default:
 		D_PRINT("Unsupported command %c\n", opc);
 		rc = 0;
@@ -679,7 +1212,7 @@ main(int argc, char **argv)
 	}
 
 	optind = 0;
-	while ((rc = getopt_long(argc, argv, "C:a:m:f:g:d:b:Docl",
+	while ((rc = getopt_long(argc, argv, "C:a:m:f:g:d:b:p:w:s:Docl",
 				 ts_ops, NULL)) != -1) {
 		rc = ts_cmd_run(rc, optarg);
 		if (rc != 0)
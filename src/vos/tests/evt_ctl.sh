@@ -135,6 +135,10 @@ EOF
 )
 
 cmd+=" -b -2 -D"
+
+# check visibility of random overlapping extents and punches, each round runs
+# against a new tree
+cmd+=" -s r:20,n:128,e:8 -s r:10,n:512,e:64 -s r:5,n:64,e:1"
 echo "$cmd"
 
 $cmd
@@ -1610,6 +1610,72 @@ failed:
 	assert_int_equal(rc, 0);
 }
 
+#define MULTI_AKEY_NR	8
+
+/**
+ * Update several akeys of a new dkey in one call, which inserts them into
+ * the empty akey tree in one batch, then fetch and verify each akey.
+ */
+static void
+io_multi_akey_update(void **state)
+{
+	struct io_test_args	*arg = *state;
+	daos_iov_t		val_iov[MULTI_AKEY_NR];
+	daos_iod_t		iod[MULTI_AKEY_NR];
+	daos_sg_list_t		sgl[MULTI_AKEY_NR];
+	char			akey_buf[MULTI_AKEY_NR][UPDATE_AKEY_SIZE];
+	char			update_buf[MULTI_AKEY_NR][UPDATE_BUF_SIZE];
+	char			fetch_buf[UPDATE_BUF_SIZE];
+	char			dkey_buf[UPDATE_DKEY_SIZE];
+	daos_key_t		dkey;
+	daos_epoch_t		epoch = gen_rand_epoch();
+	struct d_uuid		cookie;
+	int			i;
+	int			rc;
+
+	memset(iod, 0, sizeof(iod));
+	memset(sgl, 0, sizeof(sgl));
+
+	dts_key_gen(&dkey_buf[0], arg->dkey_size, arg->dkey);
+	set_iov(&dkey, &dkey_buf[0], arg->ofeat & DAOS_OF_DKEY_UINT64);
+
+	for (i = 0; i < MULTI_AKEY_NR; i++) {
+		dts_key_gen(&akey_buf[i][0], arg->akey_size, arg->akey);
+		set_iov(&iod[i].iod_name, &akey_buf[i][0],
+			arg->ofeat & DAOS_OF_AKEY_UINT64);
+
+		dts_buf_render(&update_buf[i][0], UPDATE_BUF_SIZE);
+		update_buf[i][0] = 'a' + i; /* make each value unique */
+		daos_iov_set(&val_iov[i], &update_buf[i][0], UPDATE_BUF_SIZE);
+		sgl[i].sg_nr = 1;
+		sgl[i].sg_iovs = &val_iov[i];
+
+		iod[i].iod_type = DAOS_IOD_SINGLE;
+		iod[i].iod_size = UPDATE_BUF_SIZE;
+		iod[i].iod_nr	= 1;
+	}
+
+	/* the akey tree of the new dkey must be bulk built */
+	cookie = gen_rand_cookie();
+	daos_fail_loc_set(DAOS_BTR_BATCH_NO_BULK);
+	rc = vos_obj_update(arg->ctx.tc_co_hdl, arg->oid, epoch, cookie.uuid,
+			    0, &dkey, MULTI_AKEY_NR, iod, sgl);
+	daos_fail_loc_set(0);
+	assert_int_equal(rc, 0);
+
+	for (i = 0; i < MULTI_AKEY_NR; i++) {
+		memset(fetch_buf, 0, UPDATE_BUF_SIZE);
+		daos_iov_set(&val_iov[i], &fetch_buf[0], UPDATE_BUF_SIZE);
+		iod[i].iod_size = DAOS_REC_ANY;
+
+		rc = vos_obj_fetch(arg->ctx.tc_co_hdl, arg->oid, epoch,
+				   &dkey, 1, &iod[i], &sgl[i]);
+		assert_int_equal(rc, 0);
+		assert_int_equal(iod[i].iod_size, UPDATE_BUF_SIZE);
+		assert_memory_equal(update_buf[i], fetch_buf, UPDATE_BUF_SIZE);
+	}
+}
+
 static void
 io_simple_punch(void **state)
 {
@@ -1745,6 +1811,8 @@ static const struct CMUnitTest io_tests[] = {
 		io_simple_punch, NULL, NULL},
 	{ "VOS205: Simple near-epoch retrieval test",
 		io_simple_near_epoch, NULL, NULL},
+	{ "VOS206: Update multiple akeys of a new dkey",
+		io_multi_akey_update, NULL, NULL},
 	{ "VOS220: 100K update/fetch/verify test",
 		io_multiple_dkey, NULL, NULL},
 	{ "VOS222: overwrite test",
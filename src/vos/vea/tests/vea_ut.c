@@ -379,6 +379,60 @@ ut_unload(void **state)
 	args->vua_vsi = NULL;
 }
 
+static void
+ut_reload(void **state)
+{
+	struct vea_ut_args *args = *state;
+	struct vea_unmap_context unmap_ctxt;
+	struct vea_free_extent *snap;
+	int rc;
+
+	unmap_ctxt.vnc_unmap = NULL;
+	unmap_ctxt.vnc_data = NULL;
+
+	/* vea_unload() saved the free extents in snapshot */
+	assert_false(UMMID_IS_NULL(args->vua_md->vsd_snap));
+	assert_true(args->vua_md->vsd_snap_cnt > 0);
+
+	print_message("load from free extent snapshot\n");
+	rc = vea_load(&args->vua_umm, &args->vua_txd, args->vua_md, &unmap_ctxt,
+		      &args->vua_vsi);
+	assert_int_equal(rc, 0);
+	/* snapshot is discarded once loaded */
+	assert_true(UMMID_IS_NULL(args->vua_md->vsd_snap));
+	vea_dump(args->vua_vsi, true);
+	vea_unload(args->vua_vsi);
+
+	print_message("load from corrupted free extent snapshot\n");
+	assert_false(UMMID_IS_NULL(args->vua_md->vsd_snap));
+	snap = umem_id2ptr(&args->vua_umm, args->vua_md->vsd_snap);
+	snap[0].vfe_blk_cnt++;
+	rc = vea_load(&args->vua_umm, &args->vua_txd, args->vua_md, &unmap_ctxt,
+		      &args->vua_vsi);
+	assert_int_equal(rc, 0);
+	assert_true(UMMID_IS_NULL(args->vua_md->vsd_snap));
+	vea_dump(args->vua_vsi, true);
+	vea_unload(args->vua_vsi);
+
+	print_message("load layout version 1 without snapshot\n");
+	assert_false(UMMID_IS_NULL(args->vua_md->vsd_snap));
+	rc = umem_tx_begin(&args->vua_umm, &args->vua_txd);
+	assert_int_equal(rc, 0);
+	discard_snapshot(&args->vua_umm, args->vua_md);
+	rc = umem_tx_commit(&args->vua_umm);
+	assert_int_equal(rc, 0);
+	args->vua_md->vsd_magic = VEA_MAGIC_V1;
+	rc = vea_load(&args->vua_umm, &args->vua_txd, args->vua_md, &unmap_ctxt,
+		      &args->vua_vsi);
+	assert_int_equal(rc, 0);
+	vea_dump(args->vua_vsi, true);
+	vea_unload(args->vua_vsi);
+	/* snapshot isn't saved for layout version 1 */
+	assert_true(UMMID_IS_NULL(args->vua_md->vsd_snap));
+	args->vua_md->vsd_magic = VEA_MAGIC;
+	args->vua_vsi = NULL;
+}
+
 static int
 ut_setup(struct vea_ut_args *test_args)
 {
@@ -1146,6 +1200,7 @@ static const struct CMUnitTest vea_uts[] = {
 	{ "vea_free", ut_free, NULL, NULL},
 	{ "vea_hint_unload", ut_hint_unload, NULL, NULL},
 	{ "vea_unload", ut_unload, NULL, NULL},
+	{ "vea_reload", ut_reload, NULL, NULL},
 	{ "vea_reserve_too_big", ut_reserve_too_big, NULL, NULL},
 	{ "vea_inval_params_format", ut_inval_params_format, NULL, NULL},
 	{ "vea_inval_params_load", ut_inval_params_load, NULL, NULL},
@@ -73,7 +73,7 @@ vea_format(struct umem_instance *umem, struct umem_tx_stage_data *txd,
 	D_ASSERT(umem != NULL);
 	D_ASSERT(md != NULL);
 	/* Can't reformat without 'force' specified */
-	if (md->vsd_magic == VEA_MAGIC) {
+	if (vea_md_formatted(md)) {
 		D_DEBUG(force ? DLOG_WARN : DLOG_ERR,
 			"reformat %p force=%d\n", md, force);
 		if (!force)
@@ -122,6 +122,15 @@ vea_format(struct umem_instance *umem, struct umem_tx_stage_data *txd,
 	if (rc != 0)
 		goto out;
 
+	/* Snapshot of the erased free extent tree */
+	if (vea_md_has_snap(md)) {
+		discard_snapshot(umem, md);
+	} else {
+		md->vsd_snap = UMMID_NULL;
+		md->vsd_snap_cnt = 0;
+		md->vsd_snap_csum = 0;
+	}
+
 	md->vsd_magic = VEA_MAGIC;
 	md->vsd_blk_sz = blk_sz;
 	md->vsd_tot_blks = tot_blks;
@@ -172,6 +181,7 @@ void
 vea_unload(struct vea_space_info *vsi)
 {
 	D_ASSERT(vsi != NULL);
+	save_space_info(vsi);
 	unload_space_info(vsi);
 
 	/* Destroy the in-memory free extent tree */
@@ -215,7 +225,7 @@ vea_load(struct umem_instance *umem, struct umem_tx_stage_data *txd,
 	D_ASSERT(unmap_ctxt != NULL);
 	D_ASSERT(vsip != NULL);
 
-	if (md->vsd_magic != VEA_MAGIC) {
+	if (!vea_md_formatted(md)) {
 		D_DEBUG(DB_IO, "load unformated blob\n");
 		return -DER_UNINIT;
 	}
@@ -164,9 +164,12 @@ compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 		dummy.ve_ext.vfe_age = cur_time;
 	}
 
-	rc = merge_free_ext(vsi, vfe, &dummy.ve_ext, VEA_TYPE_COMPOUND, flags);
-	if (rc)
-		return rc;
+	if (!(flags & VEA_FL_LOAD)) {
+		rc = merge_free_ext(vsi, vfe, &dummy.ve_ext, VEA_TYPE_COMPOUND,
+				   flags);
+		if (rc)
+			return rc;
+	}
 
 	/* Add to in-memory free extent tree */
 	D_ASSERT(!daos_handle_is_inval(vsi->vsi_free_btr));
@@ -189,6 +192,21 @@ compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 		return rc;
 
 	entry = (struct vea_entry *)val.iov_buf;
+	return free_class_add(vfc, entry, (flags & VEA_FL_LOAD) ||
+			      ((flags & VEA_FL_GEN_AGE) &&
+			       entry->ve_ext.vfe_age == cur_time));
+}
+
+/*
+ * Add the in-tree free extent entry to the heap or the size classed LRU,
+ * the LRU is sorted by free extent age unless @append is specified.
+ */
+int
+free_class_add(struct vea_free_class *vfc, struct vea_entry *entry,
+	       bool append)
+{
+	int rc;
+
 	D_INIT_LIST_HEAD(&entry->ve_link);
 
 	/* Add to heap if it's a large free extent */
@@ -204,8 +222,7 @@ compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 
 		lru_head = blkcnt_to_lru(vfc, entry->ve_ext.vfe_blk_cnt);
 
-		if ((flags & VEA_FL_GEN_AGE) &&
-		    entry->ve_ext.vfe_age == cur_time) {
+		if (append) {
 			d_list_add_tail(&entry->ve_link, lru_head);
 		} else {
 			/* Sort by free extent age */
@@ -141,23 +141,270 @@ unload_space_info(struct vea_space_info *vsi)
 	}
 }
 
+/* Free extents are loaded in offset order, see VEA_FL_LOAD */
+struct load_free_arg {
+	struct vea_space_info	*lfa_vsi;
+	struct vea_free_extent	 lfa_prev;
+};
+
 static int
-load_free_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val, void *arg)
+load_free_one(struct load_free_arg *lfa, uint64_t *off,
+	      struct vea_free_extent *vfe)
 {
-	struct vea_free_extent *vfe;
-	struct vea_space_info *vsi;
-	uint64_t *off;
 	int rc;
 
-	vsi = (struct vea_space_info *)arg;
-	off = (uint64_t *)key->iov_buf;
-	vfe = (struct vea_free_extent *)val->iov_buf;
-
 	rc = verify_free_entry(off, vfe);
 	if (rc != 0)
 		return rc;
 
-	return compound_free(vsi, vfe, VEA_FL_NO_MERGE);
+	/* Cheap overlapping & adjacent check against the previous one */
+	if (lfa->lfa_prev.vfe_blk_cnt != 0) {
+		rc = ext_adjacent(&lfa->lfa_prev, vfe);
+		if (rc != 0) {
+			D_ERROR("unexpected extents: ["DF_U64", %u], "
+				"["DF_U64", %u]\n",
+				lfa->lfa_prev.vfe_blk_off,
+				lfa->lfa_prev.vfe_blk_cnt,
+				vfe->vfe_blk_off, vfe->vfe_blk_cnt);
+			return -DER_INVAL;
+		}
+	}
+	lfa->lfa_prev = *vfe;
+
+	return compound_free(lfa->lfa_vsi, vfe, VEA_FL_NO_MERGE | VEA_FL_LOAD);
+}
+
+static int
+load_free_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val, void *arg)
+{
+	return load_free_one((struct load_free_arg *)arg,
+			     (uint64_t *)key->iov_buf,
+			     (struct vea_free_extent *)val->iov_buf);
+}
+
+static int
+entry_age_cmp(const void *a, const void *b)
+{
+	const struct vea_entry *ea = *(struct vea_entry * const *)a;
+	const struct vea_entry *eb = *(struct vea_entry * const *)b;
+
+	if (ea->ve_ext.vfe_age == eb->ve_ext.vfe_age)
+		return 0;
+	return ea->ve_ext.vfe_age < eb->ve_ext.vfe_age ? -1 : 1;
+}
+
+/*
+ * Extents are appended to the size classed LRUs on loading, sort each LRU
+ * by free extent age once all extents are loaded.
+ */
+static int
+sort_free_class(struct vea_free_class *vfc)
+{
+	struct vea_entry	**entries, *entry;
+	int			  i, j, cnt;
+
+	for (i = 0; i < vfc->vfc_lru_cnt; i++) {
+		cnt = 0;
+		d_list_for_each_entry(entry, &vfc->vfc_lrus[i], ve_link)
+			cnt++;
+		if (cnt < 2)
+			continue;
+
+		D_ALLOC(entries, sizeof(*entries) * cnt);
+		if (entries == NULL)
+			return -DER_NOMEM;
+
+		j = 0;
+		d_list_for_each_entry(entry, &vfc->vfc_lrus[i], ve_link)
+			entries[j++] = entry;
+		/* Extents of same age stay in offset order */
+		qsort(entries, cnt, sizeof(*entries), entry_age_cmp);
+
+		D_INIT_LIST_HEAD(&vfc->vfc_lrus[i]);
+		for (j = 0; j < cnt; j++)
+			d_list_add_tail(&entries[j]->ve_link,
+					&vfc->vfc_lrus[i]);
+		D_FREE(entries);
+	}
+
+	return 0;
+}
+
+static inline uint64_t
+snapshot_csum(struct vea_free_extent *snap, uint64_t cnt)
+{
+	return d_hash_murmur64((unsigned char *)snap, cnt * sizeof(*snap),
+			       VEA_MAGIC);
+}
+
+static int
+load_class_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val,
+		 void *arg)
+{
+	return free_class_add((struct vea_free_class *)arg,
+			      (struct vea_entry *)val->iov_buf, true);
+}
+
+/*
+ * Load free extents from the snapshot. The snapshot is sorted by offset, so
+ * the in-memory free extent tree is built bottom up by a single batched
+ * update, then the in-tree entries are added to the free class by one pass
+ * over the tree. @touched is set once the in-memory index is changed, the
+ * caller can't fallback to tree scan after that.
+ */
+static int
+load_snapshot(struct vea_space_info *vsi, bool *touched)
+{
+	struct vea_space_df	*md = vsi->vsi_md;
+	struct vea_free_extent	*snap;
+	struct vea_entry	*entries = NULL;
+	daos_iov_t		*keys = NULL, *vals = NULL;
+	uint64_t		 i, cnt = md->vsd_snap_cnt;
+	int			 rc;
+
+	if (!vea_md_has_snap(md) || UMMID_IS_NULL(md->vsd_snap))
+		return -DER_NONEXIST;
+
+	snap = umem_id2ptr(vsi->vsi_umem, md->vsd_snap);
+	if (cnt == 0 || cnt > UINT32_MAX / sizeof(*snap) ||
+	    snapshot_csum(snap, cnt) != md->vsd_snap_csum) {
+		D_ERROR("corrupted free extent snapshot, cnt:"DF_U64"\n", cnt);
+		return -DER_INVAL;
+	}
+
+	/* Verify all extents before touching the in-memory index */
+	for (i = 0; i < cnt; i++) {
+		rc = verify_free_entry(NULL, &snap[i]);
+		if (rc == 0 && i > 0 && ext_adjacent(&snap[i - 1], &snap[i]))
+			rc = -DER_INVAL;
+		if (rc) {
+			D_ERROR("corrupted free extent snapshot["DF_U64"]\n",
+				i);
+			return rc;
+		}
+	}
+
+	D_ALLOC(entries, sizeof(*entries) * cnt);
+	D_ALLOC(keys, sizeof(*keys) * cnt);
+	D_ALLOC(vals, sizeof(*vals) * cnt);
+	if (entries == NULL || keys == NULL || vals == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	for (i = 0; i < cnt; i++) {
+		entries[i].ve_ext = snap[i];
+		daos_iov_set(&keys[i], &entries[i].ve_ext.vfe_blk_off,
+			     sizeof(entries[i].ve_ext.vfe_blk_off));
+		daos_iov_set(&vals[i], &entries[i], sizeof(entries[i]));
+	}
+
+	*touched = true;
+	rc = dbtree_update_batch(vsi->vsi_free_btr, keys, vals, cnt);
+	if (rc != 0)
+		goto out;
+
+	rc = dbtree_iterate(vsi->vsi_free_btr, false, load_class_entry,
+			    &vsi->vsi_class);
+	if (rc == 0)
+		D_DEBUG(DB_MGMT, "loaded "DF_U64" free extents from snapshot\n",
+			cnt);
+out:
+	if (vals != NULL)
+		D_FREE(vals);
+	if (keys != NULL)
+		D_FREE(keys);
+	if (entries != NULL)
+		D_FREE(entries);
+	return rc;
+}
+
+/* Free the snapshot, it'll be stale once the free extents are changed */
+void
+discard_snapshot(struct umem_instance *umem, struct vea_space_df *md)
+{
+	if (UMMID_IS_NULL(md->vsd_snap))
+		return;
+
+	umem_free(umem, md->vsd_snap);
+	md->vsd_snap = UMMID_NULL;
+	md->vsd_snap_cnt = 0;
+	md->vsd_snap_csum = 0;
+}
+
+struct save_free_arg {
+	struct vea_free_extent	*sfa_snap;
+	uint64_t		 sfa_cnt;
+	uint64_t		 sfa_max;
+};
+
+static int
+save_free_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val, void *arg)
+{
+	struct save_free_arg *sfa = arg;
+
+	if (sfa->sfa_cnt == sfa->sfa_max)
+		return -DER_OVERFLOW;
+
+	sfa->sfa_snap[sfa->sfa_cnt++] = *(struct vea_free_extent *)val->iov_buf;
+	return 0;
+}
+
+/*
+ * Save all free extents in the persistent free extent tree into a snapshot,
+ * the next load_space_info() will load the snapshot instead of scanning the
+ * free extent tree.
+ */
+void
+save_space_info(struct vea_space_info *vsi)
+{
+	struct umem_instance	*umem = vsi->vsi_umem;
+	struct vea_space_df	*md = vsi->vsi_md;
+	struct save_free_arg	 sfa = { 0 };
+	struct btr_stat		 stat;
+	umem_id_t		 snap;
+	int			 rc;
+
+	if (daos_handle_is_inval(vsi->vsi_md_free_btr) ||
+	    !vea_md_has_snap(md))
+		return;
+
+	rc = dbtree_query(vsi->vsi_md_free_btr, NULL, &stat);
+	if (rc != 0 || stat.bs_rec_nr == 0 ||
+	    stat.bs_rec_nr * sizeof(*sfa.sfa_snap) > UINT32_MAX)
+		return;
+
+	rc = umem_tx_begin(umem, vsi->vsi_txd);
+	if (rc != 0)
+		return;
+
+	rc = umem_tx_add_ptr(umem, md, sizeof(*md));
+	if (rc != 0)
+		goto out;
+
+	discard_snapshot(umem, md);
+
+	snap = umem_alloc(umem, stat.bs_rec_nr * sizeof(*sfa.sfa_snap));
+	if (UMMID_IS_NULL(snap)) {
+		rc = -DER_NOSPACE;
+		goto out;
+	}
+
+	sfa.sfa_snap = umem_id2ptr(umem, snap);
+	sfa.sfa_max = stat.bs_rec_nr;
+	rc = dbtree_iterate(vsi->vsi_md_free_btr, false, save_free_entry,
+			    &sfa);
+	if (rc != 0)
+		goto out;
+
+	md->vsd_snap = snap;
+	md->vsd_snap_cnt = sfa.sfa_cnt;
+	md->vsd_snap_csum = snapshot_csum(sfa.sfa_snap, sfa.sfa_cnt);
+out:
+	if (rc)
+		D_ERROR("failed to save free extent snapshot: %d\n", rc);
+	rc = rc ? umem_tx_abort(umem, rc) : umem_tx_commit(umem);
+	if (rc == 0)
+		D_DEBUG(DB_MGMT, "saved "DF_U64" free extents in snapshot\n",
+			sfa.sfa_cnt);
 }
 
 static int
@@ -182,7 +429,9 @@ load_vec_entry(daos_handle_t ih, daos_iov_t *key, daos_iov_t *val, void *arg)
 int
 load_space_info(struct vea_space_info *vsi)
 {
+	struct load_free_arg lfa;
 	struct umem_attr uma;
+	bool touched = false;
 	int rc;
 
 	D_ASSERT(vsi->vsi_umem != NULL);
@@ -205,12 +454,43 @@ load_space_info(struct vea_space_info *vsi)
 	if (rc != 0)
 		goto error;
 
-	/* Build up in-memory compound free extent index */
-	rc = dbtree_iterate(vsi->vsi_md_free_btr, false, load_free_entry,
-			    (void *)vsi);
+	/*
+	 * Build up in-memory compound free extent index, from the snapshot
+	 * saved on last unload if it's valid, otherwise scan the free extent
+	 * tree.
+	 */
+	rc = load_snapshot(vsi, &touched);
+	if (rc != 0 && !touched) {
+		memset(&lfa, 0, sizeof(lfa));
+		lfa.lfa_vsi = vsi;
+		rc = dbtree_iterate(vsi->vsi_md_free_btr, false,
+				    load_free_entry, &lfa);
+	}
 	if (rc != 0)
 		goto error;
 
+	rc = sort_free_class(&vsi->vsi_class);
+	if (rc != 0)
+		goto error;
+
+	/* Discard the snapshot since the free extents will be changed */
+	if (vea_md_has_snap(vsi->vsi_md) &&
+	    !UMMID_IS_NULL(vsi->vsi_md->vsd_snap)) {
+		rc = umem_tx_begin(vsi->vsi_umem, vsi->vsi_txd);
+		if (rc != 0)
+			goto error;
+
+		rc = umem_tx_add_ptr(vsi->vsi_umem, vsi->vsi_md,
+				     sizeof(*vsi->vsi_md));
+		if (rc == 0)
+			discard_snapshot(vsi->vsi_umem, vsi->vsi_md);
+
+		rc = rc ? umem_tx_abort(vsi->vsi_umem, rc) :
+			  umem_tx_commit(vsi->vsi_umem);
+		if (rc != 0)
+			goto error;
+	}
+
 	/* Build up in-memory extent vector tree */
 	rc = dbtree_iterate(vsi->vsi_md_vec_btr, false, load_vec_entry,
 			    (void *)vsi);
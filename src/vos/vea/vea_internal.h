@@ -30,7 +30,26 @@
 #include <daos/btree.h>
 #include <daos_srv/vea.h>
 
-#define VEA_MAGIC	(0xea201804)
+/* Layout version 1, vea_space_df doesn't have the free extent snapshot */
+#define VEA_MAGIC_V1	(0xea201804)
+/* Layout version 2, vea_space_df has the free extent snapshot */
+#define VEA_MAGIC	(0xea201811)
+
+static inline bool
+vea_md_formatted(struct vea_space_df *md)
+{
+	return md->vsd_magic == VEA_MAGIC || md->vsd_magic == VEA_MAGIC_V1;
+}
+
+/*
+ * The space formatted by layout version 1 is loaded as it is, without saving
+ * or loading the snapshot, it's upgraded on reformat.
+ */
+static inline bool
+vea_md_has_snap(struct vea_space_df *md)
+{
+	return md->vsd_magic == VEA_MAGIC;
+}
 
 /* Per I/O stream hint context */
 struct vea_hint_context {
@@ -149,6 +168,12 @@ static inline int get_current_age(uint64_t *age)
 enum vea_free_flags {
 	VEA_FL_NO_MERGE		= (1 << 0),
 	VEA_FL_GEN_AGE		= (1 << 1),
+	/*
+	 * Loading free extents in offset order, the caller has verified there
+	 * isn't any overlapping or adjacent extent, and it sorts the size
+	 * classed LRUs after all extents loaded.
+	 */
+	VEA_FL_LOAD		= (1 << 2),
 };
 
 /* vea_init.c */
@@ -156,6 +181,8 @@ void destroy_free_class(struct vea_free_class *vfc);
 int create_free_class(struct vea_free_class *vfc, struct vea_space_df *md);
 void unload_space_info(struct vea_space_info *vsi);
 int load_space_info(struct vea_space_info *vsi);
+void save_space_info(struct vea_space_info *vsi);
+void discard_snapshot(struct umem_instance *umem, struct vea_space_df *md);
 
 /* vea_util.c */
 int verify_free_entry(uint64_t *off, struct vea_free_extent *vfe);
@@ -180,6 +207,8 @@ int reserve_vector(struct vea_space_info *vsi, uint32_t blk_cnt,
 int persistent_alloc(struct vea_space_info *vsi, struct vea_free_extent *vfe);
 
 /* vea_free.c */
+int free_class_add(struct vea_free_class *vfc, struct vea_entry *entry,
+		   bool append);
 int compound_free(struct vea_space_info *vsi, struct vea_free_extent *vfe,
 		  unsigned int flags);
 int persistent_free(struct vea_space_info *vsi, struct vea_free_extent *vfe);
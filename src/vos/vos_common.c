@@ -109,6 +109,8 @@ vos_imem_strts_destroy(struct vos_imem_strts *imem_inst)
 
 	if (imem_inst->vis_cont_hhash)
 		d_uhash_destroy(imem_inst->vis_cont_hhash);
+
+	evt_cache_enable(false);
 }
 
 static inline int
@@ -150,6 +152,17 @@ vos_imem_strts_create(struct vos_imem_strts *imem_inst)
 		imem_inst->vis_enable_checksum = 1;
 	}
 
+	/* DRAM cache of evtree upper level nodes, for read-mostly workloads */
+	env = getenv("VOS_EVT_CACHE");
+	if (env != NULL && atoi(env) != 0) {
+		rc = evt_cache_enable(true);
+		if (rc != 0) {
+			D_ERROR("Error in enabling evtree node cache\n");
+			goto failed;
+		}
+		D_DEBUG(DB_IO, "Enable evtree node cache\n");
+	}
+
 	return 0;
 
 failed:
@@ -716,6 +716,78 @@ out:
 	return rc;
 }
 
+/** parameters of an akey inserted by akey_insert_batch */
+struct akey_batch_ent {
+	struct vos_key_bundle	abe_kbund;
+	struct vos_rec_bundle	abe_rbund;
+	daos_csum_buf_t		abe_csum;
+};
+
+/**
+ * Insert records of all akeys of the I/O into the empty akey tree of a new
+ * dkey by one dbtree_update_batch, instead of probing the tree for each of
+ * them in key_tree_prepare, e.g. rebuild writes all akeys of a dkey in one
+ * update. akey_update still updates values of each akey.
+ */
+static int
+akey_insert_batch(struct vos_io_context *ioc, daos_handle_t ak_toh)
+{
+	struct akey_batch_ent	*ents;
+	daos_iov_t		*kiovs;
+	daos_iov_t		*riovs;
+	int			 nr = 0;
+	int			 i;
+	int			 rc;
+
+	if (ioc->ic_iod_nr < 2 || dbtree_is_empty(ak_toh) != 1)
+		return 0;
+
+	D_ALLOC(ents, ioc->ic_iod_nr * sizeof(*ents));
+	D_ALLOC(kiovs, ioc->ic_iod_nr * sizeof(*kiovs));
+	D_ALLOC(riovs, ioc->ic_iod_nr * sizeof(*riovs));
+	if (ents == NULL || kiovs == NULL || riovs == NULL)
+		D_GOTO(out, rc = -DER_NOMEM);
+
+	for (i = 0; i < ioc->ic_iod_nr; i++) {
+		daos_iod_t		*iod = &ioc->ic_iods[i];
+		struct akey_batch_ent	*ent = &ents[nr];
+
+		if (iod->iod_size == 0)
+			continue;
+
+		/* the same as a new key created by key_tree_prepare */
+		tree_key_bundle2iov(&ent->abe_kbund, &kiovs[nr]);
+		ent->abe_kbund.kb_key	= &iod->iod_name;
+		ent->abe_kbund.kb_epoch	= DAOS_EPOCH_MAX;
+
+		tree_rec_bundle2iov(&ent->abe_rbund, &riovs[nr]);
+		memset(&ent->abe_csum, 0, sizeof(ent->abe_csum));
+		ent->abe_rbund.rb_mmid	= UMMID_NULL;
+		ent->abe_rbund.rb_csum	= &ent->abe_csum;
+		ent->abe_rbund.rb_tclass = VOS_BTR_AKEY;
+		ent->abe_rbund.rb_iov	= &iod->iod_name;
+		nr++;
+	}
+
+	rc = 0;
+	if (nr > 1) {
+		/* in the order of the tree, so that it is bulk built */
+		rc = dbtree_sort_batch(ak_toh, kiovs, riovs, nr);
+		if (rc == 0)
+			rc = dbtree_update_batch(ak_toh, kiovs, riovs, nr);
+		if (rc != 0)
+			D_ERROR("Failed to insert %d akeys: %d\n", nr, rc);
+	}
+out:
+	if (ents != NULL)
+		D_FREE(ents);
+	if (kiovs != NULL)
+		D_FREE(kiovs);
+	if (riovs != NULL)
+		D_FREE(riovs);
+	return rc;
+}
+
 static int
 dkey_update(struct vos_io_context *ioc, uuid_t cookie, uint32_t pm_ver,
 	    daos_key_t *dkey)
@@ -746,6 +818,10 @@ dkey_update(struct vos_io_context *ioc, uuid_t cookie, uint32_t pm_ver,
 			if (rc != 0)
 				goto out;
 			subtr_created = true;
+
+			rc = akey_insert_batch(ioc, ak_toh);
+			if (rc != 0)
+				goto out;
 		}
 
 		rc = akey_update(ioc, cookie, pm_ver, ak_toh, &max_eph);
@@ -171,6 +171,17 @@ vos_blob_format_cb(void *cb_data)
 	return 0;
 }
 
+/* Called by VEA when a freed extent is about to be reusable */
+static int
+vos_blk_unmap(uint64_t off, uint64_t cnt, void *data)
+{
+	struct eio_io_context *ioctxt = data;
+
+	/* Drop the stale pages of the freed extent from the DRAM cache */
+	eio_cache_evict(ioctxt, off, cnt);
+	return 0;
+}
+
 /**
  * Create a Versioning Object Storage Pool (VOSP) and its root object.
  */
@@ -458,9 +469,9 @@ vos_pool_open(const char *path, uuid_t uuid, daos_handle_t *poh)
 	if (xs_ctxt != NULL) {
 		struct vea_unmap_context unmap_ctxt;
 
-		/* TODO: unmap callback */
-		unmap_ctxt.vnc_unmap = NULL;
-		unmap_ctxt.vnc_data = NULL;
+		/* TODO: unmap (TRIM) the freed extent */
+		unmap_ctxt.vnc_unmap = vos_blk_unmap;
+		unmap_ctxt.vnc_data = pool->vp_io_ctxt;
 		rc = vea_load(&pool->vp_umm, vos_txd_get(), &pool_df->pd_vea_df,
 			      &unmap_ctxt, &pool->vp_vea_info);
 		if (rc) {
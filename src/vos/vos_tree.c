@@ -27,6 +27,7 @@
  */
 #define D_LOGFAC	DD_FAC(vos)
 
+#include <endian.h>
 #include <daos/btree.h>
 #include <daos_srv/vos.h>
 #include <daos_api.h> /* For ofeat bits */
@@ -174,6 +175,19 @@ ktr_hkey_gen(struct btr_instance *tins, daos_iov_t *key_iov, void *hkey)
 	kkey->kh_epoch	 = kbund->kb_epoch;
 }
 
+/** big endian image of the hashed key, the padding is not compared */
+static void
+ktr_hkey_image(struct btr_instance *tins, void *hkey, void *image)
+{
+	struct ktr_hkey *src = (struct ktr_hkey *)hkey;
+	struct ktr_hkey *dst = (struct ktr_hkey *)image;
+
+	dst->kh_hash[0]	= htobe64(src->kh_hash[0]);
+	dst->kh_hash[1]	= htobe64(src->kh_hash[1]);
+	dst->kh_epoch	= htobe64(src->kh_epoch);
+	dst->kh_pad_64	= 0;
+}
+
 /** compare the hashed key */
 static int
 ktr_hkey_cmp(struct btr_instance *tins, struct btr_record *rec, void *hkey)
@@ -333,6 +347,8 @@ ktr_rec_alloc(struct btr_instance *tins, daos_iov_t *key_iov,
 			tree_feats |= VOS_KEY_CMP_UINT64_SET;
 		else if (obj_feats & DAOS_OF_AKEY_LEXICAL)
 			tree_feats |= VOS_KEY_CMP_LEXICAL_SET;
+		else
+			tree_feats |= BTR_FEAT_KEY_ARRAY;
 	}
 
 	umem_attr_get(&tins->ti_umm, &uma);
@@ -440,6 +456,7 @@ static btr_ops_t key_btr_ops = {
 	.to_hkey_size		= ktr_hkey_size,
 	.to_hkey_gen		= ktr_hkey_gen,
 	.to_hkey_cmp		= ktr_hkey_cmp,
+	.to_hkey_image		= ktr_hkey_image,
 	.to_key_cmp		= ktr_key_cmp,
 	.to_rec_alloc		= ktr_rec_alloc,
 	.to_rec_free		= ktr_rec_free,
@@ -695,14 +712,16 @@ static struct vos_btr_attr vos_btr_attrs[] = {
 	{
 		.ta_class	= VOS_BTR_DKEY,
 		.ta_order	= VOS_KTR_ORDER,
-		.ta_feats	= VOS_OFEAT_BITS | BTR_FEAT_DIRECT_KEY,
+		.ta_feats	= VOS_OFEAT_BITS | BTR_FEAT_DIRECT_KEY |
+				  BTR_FEAT_KEY_ARRAY,
 		.ta_name	= "vos_dkey",
 		.ta_ops		= &key_btr_ops,
 	},
 	{
 		.ta_class	= VOS_BTR_AKEY,
 		.ta_order	= VOS_KTR_ORDER,
-		.ta_feats	= VOS_OFEAT_BITS | BTR_FEAT_DIRECT_KEY,
+		.ta_feats	= VOS_OFEAT_BITS | BTR_FEAT_DIRECT_KEY |
+				  BTR_FEAT_KEY_ARRAY,
 		.ta_name	= "vos_akey",
 		.ta_ops		= &key_btr_ops,
 	},
@@ -918,6 +937,8 @@ obj_tree_init(struct vos_object *obj)
 			tree_feats |= VOS_KEY_CMP_UINT64_SET;
 		else if (obj_feats & DAOS_OF_DKEY_LEXICAL)
 			tree_feats |= VOS_KEY_CMP_LEXICAL_SET;
+		else
+			tree_feats |= BTR_FEAT_KEY_ARRAY;
 
 		rc = dbtree_create_inplace(ta->ta_class, tree_feats,
 					   ta->ta_order, vos_obj2uma(obj),
@@ -49,6 +49,8 @@ if [ -d "/mnt/daos" ]; then
     run_test src/common/tests/btree.sh ukey -s 20000
     run_test src/common/tests/btree.sh direct -s 20000
     run_test src/common/tests/btree.sh -s 20000
+    run_test src/common/tests/btree.sh karr -s 20000
+    run_test src/common/tests/btree.sh karr hcmp -s 20000
     run_test src/common/tests/btree.sh perf -s 20000
     run_test src/common/tests/btree.sh perf direct -s 20000
     run_test src/common/tests/btree.sh perf ukey -s 20000